@@ -25,9 +25,10 @@ my $file = dirname($0) . "/../src/schema.tmpl";	# name the file
 
 my ($state, %output, $eol, $fk_bol, $fk_eol, $ltab, $pkey, $table_name, $pkey_name);
 my ($szcol1, $szcol2, $szcol3, $szcol4, $sequences, $sql_suffix, $triggers);
-my ($fkeys, $fkeys_prefix, $fkeys_suffix, $uniq, $delete_cascade);
+my ($fkeys, $fkeys_prefix, $fkeys_suffix, $uniq);
 
 my %table_types;	# for making sure that table types aren't duplicated
+my %delete_cascade;	# tables referenced by foreign keys with cascaded deletes
 
 my %c = (
 	"type"		=>	"code",
@@ -220,7 +221,7 @@ sub process_table($)
 
 	newstate("table");
 
-	$delete_cascade = 0;
+	%delete_cascade = ();
 
 	($table_name, $pkey_name, $flags) = split(/\|/, $line, 3);
 
@@ -335,12 +336,16 @@ sub process_field($)
 				$fk_field = $name;
 			}
 
+			if (not $fk_flags or $fk_flags eq "")
+			{
+				$delete_cascade{$fk_table} = 1;
+			}
+
 			$fk_table = "\"${fk_table}\"";
 			$fk_field = "\"${fk_field}\"";
 
 			if (not $fk_flags or $fk_flags eq "")
 			{
-				$delete_cascade = 1;
 				$fk_flags = "ZBX_FK_CASCADE_DELETE";
 			}
 			elsif ($fk_flags eq "RESTRICT")
@@ -422,7 +427,7 @@ sub process_field($)
 
 			if (not $fk_flags or $fk_flags eq "")
 			{
-				$delete_cascade = 1;
+				$delete_cascade{$fk_table} = 1;
 				$fk_flags = " ON DELETE CASCADE";
 			}
 			elsif ($fk_flags eq "RESTRICT")
@@ -789,9 +794,9 @@ sub unix_timestamp()
 	}
 }
 
-sub open_trigger($)
+sub open_trigger($;$)
 {
-	my $type = shift;
+	my ($type, $update_fields) = @_;
 	my $out;
 
 	$out = "create trigger ${table_name}_${type} ";
@@ -802,6 +807,12 @@ sub open_trigger($)
 	elsif ($type eq "update")
 	{
 		$out .= "after update";
+
+		# MySQL does not support column list in update trigger, the values are compared instead
+		if (defined($update_fields) && $output{"database"} ne "mysql")
+		{
+			$out .= " of ${update_fields}";
+		}
 	}
 	elsif ($type eq "delete")
 	{
@@ -883,11 +894,18 @@ sub close_function($)
 
 sub process_changelog($)
 {
-	my $table_type = shift;
+	# optional list of fields limits the registered updates to changes of these fields
+	my ($table_type, $update_fields) = split(/\|/, shift, 2);
 
-	if ($delete_cascade)
+	# rows removed by cascaded deletes are not registered in changelog by all databases, so such removals
+	# must be detected by changes of the referenced table which then also must have CHANGELOG token
+	foreach my $fk_table (sort(keys(%delete_cascade)))
 	{
-		die("table '$table_name' foreign keys without RESTRICT flag are not compatible with table CHANGELOG token");
+		if (not grep { $_ eq $fk_table } values(%table_types))
+		{
+			die("table '$table_name' foreign keys without RESTRICT flag are compatible with table CHANGELOG token" .
+					" only if referenced table '$fk_table' has CHANGELOG token");
+		}
 	}
 
 	if (exists($table_types{$table_type}) && $table_types{$table_type} ne $table_name)
@@ -908,8 +926,18 @@ sub process_changelog($)
 		$triggers .= "values (${table_type},new.${pkey_name},1,${unix_timestamp});${eol}\n";
 		$triggers .= close_trigger();
 
-		$triggers .= open_trigger('update');
-		$triggers .= "values (${table_type},old.${pkey_name},2,${unix_timestamp});${eol}\n";
+		$triggers .= open_trigger('update', $update_fields);
+		if (defined($update_fields) && $output{"database"} eq "mysql")
+		{
+			my $condition = join(" or ", map { "old.$_<>new.$_" } split(/,/, $update_fields));
+
+			$triggers .= "select ${table_type},old.${pkey_name},2,${unix_timestamp} from dual" .
+					" where ${condition};${eol}\n";
+		}
+		else
+		{
+			$triggers .= "values (${table_type},old.${pkey_name},2,${unix_timestamp});${eol}\n";
+		}
 		$triggers .= close_trigger();
 
 		$triggers .= open_trigger('delete');
@@ -927,7 +955,7 @@ sub process_changelog($)
 		$triggers .= open_function('update');
 		$triggers .= "values (${table_type},old.${pkey_name},2,${unix_timestamp});${eol}\n";
 		$triggers .= close_function('update');
-		$triggers .= open_trigger('update');
+		$triggers .= open_trigger('update', $update_fields);
 		$triggers .= close_trigger();
 
 		$triggers .= open_function('delete');
@@ -942,7 +970,7 @@ sub process_changelog($)
 		$triggers .= "values (${table_type},:new.${pkey_name},1,${unix_timestamp});${eol}\n";
 		$triggers .= close_trigger();
 
-		$triggers .= open_trigger('update');
+		$triggers .= open_trigger('update', $update_fields);
 		$triggers .= "values (${table_type},:old.${pkey_name},2,${unix_timestamp});${eol}\n";
 		$triggers .= close_trigger();
 
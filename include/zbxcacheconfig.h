@@ -321,6 +321,7 @@ ZBX_PTR_VECTOR_DECL(item_tag, zbx_item_tag_t *)
 typedef struct _DC_TRIGGER
 {
 	zbx_uint64_t		triggerid;
+	zbx_uint64_t		revision;
 	char			*description;
 	char			*expression;
 	char			*recovery_expression;
@@ -759,7 +760,7 @@ typedef struct zbx_um_cache zbx_um_cache_t;
 
 zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config_t synced,
 		zbx_vector_uint64_t *deleted_itemids, const zbx_config_vault_t *config_vault,
-		int proxyconfig_frequency);
+		int proxyconfig_frequency, int load_threads);
 void	zbx_dc_sync_kvs_paths(const struct zbx_json_parse *jp_kvs_paths, const zbx_config_vault_t *config_vault,
 		const char *config_source_ip, const char *config_ssl_ca_location, const char *config_ssl_cert_location,
 		const char *config_ssl_key_location);
@@ -777,6 +778,7 @@ void	zbx_dc_config_get_hosts_by_itemids(zbx_dc_host_t *hosts, const zbx_uint64_t
 void	zbx_dc_config_get_hosts_by_hostids(zbx_dc_host_t *hosts, const zbx_uint64_t *hostids, int *errcodes, int num);
 void	zbx_dc_config_get_items_by_keys(zbx_dc_item_t *items, zbx_host_key_t *keys, int *errcodes, size_t num);
 void	zbx_dc_config_get_items_by_itemids(zbx_dc_item_t *items, const zbx_uint64_t *itemids, int *errcodes, size_t num);
+void	zbx_dc_config_get_item_value_types(zbx_vector_uint64_pair_t *items);
 
 void	zbx_dc_config_history_sync_get_items_by_itemids(zbx_history_sync_item_t *items, const zbx_uint64_t *itemids,
 		int *errcodes, size_t num, unsigned int mode);
@@ -881,6 +883,7 @@ void	zbx_dc_requeue_proxy(zbx_uint64_t proxyid, unsigned char update_nextcheck,
 		int proxyconfig_frequency, int proxydata_frequency);
 int	zbx_dc_check_host_permissions(const char *host, const zbx_socket_t *sock, zbx_uint64_t *hostid,
 		zbx_uint64_t *revision, char **error);
+int	zbx_dc_get_lld_rule_revision(zbx_uint64_t itemid, zbx_uint64_t *revision);
 int	zbx_dc_is_autoreg_host_changed(const char *host, unsigned short port, const char *host_metadata,
 		zbx_conn_flags_t flag, const char *interface, int now, int heartbeat);
 
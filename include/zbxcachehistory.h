@@ -22,6 +22,7 @@
 
 #include "zbxcacheconfig.h"
 #include "zbxshmem.h"
+#include "zbxmutexs.h"
 
 #define ZBX_SYNC_DONE		0
 #define	ZBX_SYNC_MORE		1
@@ -52,6 +53,48 @@ typedef struct
 }
 zbx_wcache_info_t;
 
+/* the maximum number of history cache shards */
+#define ZBX_HC_SHARDS_MAX	(ZBX_MUTEX_CACHE_SHARDS_NUM + 1)
+
+/* the maximum number of history ingestion ring slots */
+#define ZBX_HC_RING_SIZE_MAX	4194304
+
+/* the history cache shard diagnostic statistics */
+typedef struct
+{
+	zbx_uint64_t	items_num;
+	zbx_uint64_t	values_num;
+	zbx_uint64_t	locks_num;		/* the number of shard lock acquisitions */
+	zbx_uint64_t	locks_contended;	/* the number of shard lock acquisitions that had to wait */
+}
+zbx_hc_shard_stats_t;
+
+ZBX_VECTOR_DECL(hc_shard_stats, zbx_hc_shard_stats_t)
+
+/* the history ingestion ring diagnostic statistics */
+typedef struct
+{
+	zbx_uint64_t	size;		/* the number of ring slots */
+	zbx_uint64_t	values_num;	/* the number of values waiting in ring */
+	zbx_uint64_t	pushed_num;	/* the number of values added to ring */
+	zbx_uint64_t	drained_num;	/* the number of values moved from ring to history cache */
+	zbx_uint64_t	full_num;	/* the number of flushes that found ring full (backpressure) */
+	zbx_uint64_t	waits_num;	/* the number of flushes that waited for ring to be drained */
+}
+zbx_hc_ring_stats_t;
+
+/* the trigger recalculation diagnostic statistics */
+typedef struct
+{
+	zbx_uint64_t	batches_num;		/* the number of recalculated trigger batches */
+	zbx_uint64_t	triggers_num;		/* the number of recalculated triggers */
+	zbx_uint64_t	parallel_batches_num;	/* the number of batches evaluated by multiple threads */
+	zbx_uint64_t	parallel_triggers_num;	/* the number of triggers evaluated by multiple threads */
+	double		time_total;		/* the total time spent evaluating trigger expressions */
+	double		time_max;		/* the longest batch evaluation time */
+}
+zbx_hc_trigger_stats_t;
+
 void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, int *values_num, int *triggers_num, int *more);
 void	zbx_log_sync_history_cache_progress(void);
 
@@ -61,8 +104,8 @@ void	zbx_log_sync_history_cache_progress(void);
 typedef void (*zbx_history_sync_f)(int *values_num, int *triggers_num, const zbx_events_funcs_t *events_cbs, int *more);
 
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history_sync_f sync_history,
-		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size,zbx_uint64_t *trends_cache_size,
-		char **error);
+		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size, int history_cache_shards,
+		int history_ring_size, zbx_uint64_t *trends_cache_size, char **error);
 
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs);
 
@@ -120,7 +163,10 @@ zbx_uint64_t	zbx_dc_get_nextid(const char *table_name, int num);
 
 void	zbx_dc_update_interfaces_availability(void);
 
-void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num);
+void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num,
+		zbx_vector_hc_shard_stats_t *shards);
+int	zbx_hc_get_ring_stats(zbx_hc_ring_stats_t *stats);
+void	zbx_hc_get_trigger_stats(zbx_hc_trigger_stats_t *stats);
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index);
 void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items);
 
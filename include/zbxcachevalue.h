@@ -50,6 +50,21 @@
  *   either zbx_history_record_vector_destroy() function (free the zbx_vc_get_values()
  *   call output) or zbx_history_record_clear() function (free the zbx_vc_get_value() call output).
  *
+ *   Numeric aggregates can use zbx_vc_iterate_values() function instead, which passes the
+ *   cached values to callback directly from cache memory without copying them.
+ *
+ *   Time based count, sum, avg, min and max aggregates are also maintained incrementally
+ *   by cache and can be retrieved with zbx_vc_get_aggregate() function, falling back to
+ *   the functions above if it fails. Floating point sums are maintained with Kahan summation,
+ *   so the sum and avg results can differ in the last digits from the fallback results.
+ *
+ * Snapshots
+ *
+ *   The cache contents can be saved with zbx_vc_save_snapshot() function at shutdown, after
+ *   history cache has been flushed to database, and loaded back with zbx_vc_load_snapshot()
+ *   function after the configuration cache has been synced, to avoid reading item history
+ *   from database for all items after restart.
+ *
  * Locking
  *
  *   The cache ensures synchronization between processes by using automatic locks whenever
@@ -108,6 +123,21 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value);
 
+typedef void	(*zbx_vc_values_func_t)(const zbx_history_record_t *values, int values_num, void *data);
+
+int	zbx_vc_iterate_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_values_func_t values_func, void *data);
+
+/* aggregate functions supported by zbx_vc_get_aggregate() */
+#define ZBX_VC_FUNCTION_COUNT	0
+#define ZBX_VC_FUNCTION_SUM	1
+#define ZBX_VC_FUNCTION_AVG	2
+#define ZBX_VC_FUNCTION_MIN	3
+#define ZBX_VC_FUNCTION_MAX	4
+
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, int func, int seconds,
+		const zbx_timespec_t *ts, zbx_history_value_t *value, int *values_num);
+
 int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
@@ -121,4 +151,7 @@ void	zbx_vc_flush_stats(void);
 
 void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items);
 
+int	zbx_vc_save_snapshot(const char *path, char **error);
+int	zbx_vc_load_snapshot(const char *path, const zbx_vector_uint64_pair_t *items, char **error);
+
 #endif
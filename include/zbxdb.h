@@ -59,6 +59,7 @@ typedef struct
 	char	*config_db_tls_cipher;
 	char	*config_db_tls_cipher_13;
 	int	config_dbport;
+	int	config_db_history_copy;
 }
 zbx_config_dbhigh_t;
 
@@ -84,6 +85,7 @@ int	zbx_db_connect_basic(const zbx_config_dbhigh_t *cfg);
 void	zbx_db_close_basic(void);
 
 int	zbx_db_begin_basic(void);
+int	zbx_db_begin_pipeline_basic(void);
 int	zbx_db_commit_basic(void);
 int	zbx_db_rollback_basic(void);
 int	zbx_db_txn_level(void);
@@ -109,6 +111,7 @@ zbx_err_codes_t	zbx_db_last_errcode(void);
 
 #ifdef HAVE_POSTGRESQL
 int	zbx_tsdb_get_version(void);
+int	zbx_db_copy_basic(const char *sql, const char *data, size_t data_len);
 #endif
 
 #ifdef HAVE_ORACLE
@@ -506,6 +506,7 @@ zbx_db_result_t	zbx_db_select_n(const char *query, int n);
 zbx_db_row_t	zbx_db_fetch(zbx_db_result_t result);
 int		zbx_db_is_null(const char *field);
 void		zbx_db_begin(void);
+void		zbx_db_begin_pipeline(void);
 int		zbx_db_commit(void);
 void		zbx_db_rollback(void);
 int		zbx_db_end(int ret);
@@ -692,6 +693,8 @@ typedef struct
 	int			autoincrement;
 	/* the last id assigned by autoincrement */
 	zbx_uint64_t		lastid;
+	/* the rows are inserted with COPY protocol instead of insert statements */
+	int			copy;
 }
 zbx_db_insert_t;
 
@@ -703,6 +706,7 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...);
 int	zbx_db_insert_execute(zbx_db_insert_t *self);
 void	zbx_db_insert_clean(zbx_db_insert_t *self);
 void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name);
+void	zbx_db_insert_use_copy(zbx_db_insert_t *self);
 zbx_uint64_t	zbx_db_insert_get_lastid(zbx_db_insert_t *self);
 
 int	zbx_db_get_database_type(void);
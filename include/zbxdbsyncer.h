@@ -27,6 +27,7 @@ typedef struct
 {
 	const zbx_events_funcs_t	*events_cbs;
 	int				config_histsyncer_frequency;
+	int				config_trigger_threads;
 }
 zbx_thread_dbsyncer_args;
 
@@ -31,6 +31,9 @@
 
 #define ZBX_IPC_WAIT_FOREVER	-1
 
+#define ZBX_IPC_RING_SIZE_MIN	(64 * ZBX_KIBIBYTE)
+#define ZBX_IPC_RING_SIZE_MAX	ZBX_GIBIBYTE
+
 typedef struct
 {
 	/* the message code */
@@ -44,6 +47,8 @@ typedef struct
 }
 zbx_ipc_message_t;
 
+typedef struct zbx_ipc_ring zbx_ipc_ring_t;
+
 /* Messaging socket, providing blocking connections to IPC service. */
 /* The IPC socket api is used for simple write/read operations.     */
 typedef struct
@@ -55,11 +60,25 @@ typedef struct
 	unsigned char	rx_buffer[ZBX_IPC_SOCKET_BUFFER_SIZE];
 	zbx_uint32_t	rx_buffer_bytes;
 	zbx_uint32_t	rx_buffer_offset;
+
+	/* shared memory ring for outgoing data, NULL if data is written to socket */
+	zbx_ipc_ring_t	*tx_ring;
 }
 zbx_ipc_socket_t;
 
 typedef struct zbx_ipc_client zbx_ipc_client_t;
 
+/* IPC client traffic counters, the number of messages per read/write system call */
+/* shows how well the messages are batched                                       */
+typedef struct
+{
+	zbx_uint64_t	rx_messages;
+	zbx_uint64_t	rx_reads;
+	zbx_uint64_t	tx_messages;
+	zbx_uint64_t	tx_writes;
+}
+zbx_ipc_client_stats_t;
+
 /* IPC service */
 typedef struct
 {
@@ -112,6 +131,7 @@ zbx_uint64_t		zbx_ipc_client_id(const zbx_ipc_client_t *client);
 zbx_ipc_client_t	*zbx_ipc_client_by_id(const zbx_ipc_service_t *service, zbx_uint64_t id);
 void	zbx_ipc_client_set_userdata(zbx_ipc_client_t *client, void *userdata);
 void	*zbx_ipc_client_get_userdata(zbx_ipc_client_t *client);
+void	zbx_ipc_client_get_stats(const zbx_ipc_client_t *client, zbx_ipc_client_stats_t *stats);
 
 int	zbx_ipc_socket_open(zbx_ipc_socket_t *csocket, const char *service_name, int timeout, char **error);
 void	zbx_ipc_socket_close(zbx_ipc_socket_t *csocket);
@@ -140,5 +160,6 @@ void	zbx_ipc_message_copy(zbx_ipc_message_t *dst, const zbx_ipc_message_t *src);
 #endif
 
 void	zbx_init_library_ipcservice(unsigned char program_type);
+void	zbx_ipc_set_ring_size(zbx_uint64_t size);
 
 #endif
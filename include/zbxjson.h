@@ -287,10 +287,13 @@ struct zbx_json
 	int			level;
 };
 
+typedef struct zbx_json_index zbx_json_index_t;
+
 struct zbx_json_parse
 {
 	const char		*start;
 	const char		*end;
+	const zbx_json_index_t	*index;	/* optional structural index of large buffers */
 };
 
 const char	*zbx_json_strerror(void);
@@ -376,9 +379,21 @@ zbx_jsonobj_el_t;
 
 typedef struct zbx_jsonpath_index zbx_jsonpath_index_t;
 
+typedef struct
+{
+	zbx_jsonpath_t	*path;		/* [IN] compiled jsonpath */
+	char		*output;	/* [OUT] query result, NULL if no data matched the path */
+	char		*error;		/* [OUT] error message, NULL if the query succeeded */
+}
+zbx_jsonpath_query_t;
+
 int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath);
 int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output);
 int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output);
+int	zbx_jsonobj_query_path(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, zbx_jsonpath_t *jsonpath,
+		char **output);
+void	zbx_jsonobj_query_paths(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, zbx_jsonpath_query_t *queries,
+		int queries_num);
 void	zbx_jsonpath_clear(zbx_jsonpath_t *jsonpath);
 
 zbx_jsonpath_index_t	*zbx_jsonpath_index_create(char **error);
@@ -35,6 +35,9 @@ typedef HANDLE zbx_mutex_t;
 #	define zbx_mutex_lock(mutex)		__zbx_mutex_lock(__FILE__, __LINE__, mutex)
 #	define zbx_mutex_unlock(mutex)		__zbx_mutex_unlock(__FILE__, __LINE__, mutex)
 #else	/* not _WINDOWS */
+/* the number of additional history cache shard mutexes, the first shard is protected by ZBX_MUTEX_CACHE */
+#define ZBX_MUTEX_CACHE_SHARDS_NUM	31
+
 typedef enum
 {
 	ZBX_MUTEX_LOG = 0,
@@ -57,6 +60,9 @@ typedef enum
 	ZBX_MUTEX_REMOTE_COMMANDS,
 	ZBX_MUTEX_PROXY_BUFFER,
 	ZBX_MUTEX_VPS_MONITOR,
+	ZBX_MUTEX_CACHE_RING,
+	ZBX_MUTEX_CACHE_SHARD,
+	ZBX_MUTEX_CACHE_SHARD_LAST = ZBX_MUTEX_CACHE_SHARD + ZBX_MUTEX_CACHE_SHARDS_NUM - 1,
 	/* NOTE: Do not forget to sync changes here with mutex names in diag_add_locks_info()! */
 	ZBX_MUTEX_COUNT
 }
@@ -157,6 +163,10 @@ int		zbx_rwlock_create(zbx_rwlock_t *rwlock, zbx_rwlock_name_t name, char **erro
 zbx_mutex_t	zbx_mutex_addr_get(zbx_mutex_name_t mutex_name);
 zbx_rwlock_t	zbx_rwlock_addr_get(zbx_rwlock_name_t rwlock_name);
 
+#	define zbx_mutex_trylock(mutex)		__zbx_mutex_trylock(__FILE__, __LINE__, mutex)
+
+int	__zbx_mutex_trylock(const char *filename, int line, zbx_mutex_t mutex);
+
 #	define zbx_mutex_lock(mutex)					\
 									\
 	do								\
@@ -47,6 +47,9 @@ ZBX_PTR_VECTOR_DECL(expression, zbx_expression_t *)
 int	zbx_regexp_compile(const char *pattern, zbx_regexp_t **regexp, char **err_msg);
 int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp, int flags, char **err_msg);
 void	zbx_regexp_free(zbx_regexp_t *regexp);
+int	zbx_regexp_compile_cached(const char *pattern, const zbx_regexp_t **regexp, char **err_msg);
+int	zbx_regexp_compile_cached_ext(const char *pattern, const zbx_regexp_t **regexp, int flags, char **err_msg);
+void	zbx_regexp_cache_get_stats(zbx_uint64_t *hits, zbx_uint64_t *misses);
 int	zbx_regexp_match_precompiled(const char *string, const zbx_regexp_t *regexp);
 int	zbx_regexp_match_precompiled2(const char *string, const zbx_regexp_t *regexp, char **err_msg);
 char	*zbx_regexp_match(const char *string, const char *pattern, int *len);
@@ -66,6 +69,14 @@ int	zbx_regexp_sub_ex(const zbx_vector_expression_t *regexps, const char *string
 		int case_sensitive, const char *output_template, char **output);
 int	zbx_regexp_sub_ex2(const zbx_vector_expression_t *regexps, const char *string, const char *pattern,
 		int case_sensitive, const char *output_template, char **output, char **err_msg);
+typedef struct zbx_regexp_set zbx_regexp_set_t;
+
+zbx_regexp_set_t	*zbx_regexp_set_create(const zbx_vector_expression_t *regexps, const char *pattern,
+		int case_sensitive);
+void	zbx_regexp_set_free(zbx_regexp_set_t *set);
+int	zbx_regexp_set_sub(zbx_regexp_set_t *set, const char *string, const char *output_template, char **output,
+		char **err_msg);
+int	zbx_regexp_set_match(zbx_regexp_set_t *set, const char *string);
 int	zbx_global_regexp_exists(const char *name, const zbx_vector_expression_t *regexps);
 void	zbx_regexp_escape(char **string);
 
@@ -47,6 +47,9 @@ typedef struct
 
 	const char	*mem_descr;
 	const char	*mem_param;
+
+	/* size class slabs for small allocations, NULL when slab mode is disabled */
+	void		*slabs;
 }
 zbx_shmem_info_t;
 
@@ -60,9 +63,17 @@ typedef struct
 	unsigned int	chunks_num[ZBX_SHMEM_BUCKET_COUNT];
 	unsigned int	free_chunks;
 	unsigned int	used_chunks;
+	zbx_uint64_t	slab_runs;		/* the number of chunks split into small objects */
+	zbx_uint64_t	slab_used_size;		/* the size of used small objects */
+	zbx_uint64_t	slab_free_size;		/* the size of free small objects */
 }
 zbx_shmem_stats_t;
 
+#define ZBX_SHMEM_SLAB_DISABLED	0
+#define ZBX_SHMEM_SLAB_ENABLED	1
+
+void	zbx_shmem_set_slab_mode(int mode);
+
 int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error);
 int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
@@ -0,0 +1,432 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxalgo.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Open addressing hashset with Robin Hood hashing.                           *
+ *                                                                            *
+ * Entries are stored inline in the slot array right after the slot header   *
+ * (hash and probe sequence length), so a lookup usually touches a single     *
+ * cache line. The number of slots is a power of two, the home slot of an     *
+ * entry is its hash masked by the number of slots.                           *
+ *                                                                            *
+ * When inserting, an entry that is further from its home slot takes over     *
+ * the slot of an entry that is closer to its home slot, keeping probe        *
+ * sequences short. Removed entries are not marked with tombstones - the      *
+ * following entries of the same cluster are shifted back instead.            *
+ *                                                                            *
+ * The slot array has two extra slots at the end that are used as buffers     *
+ * when swapping entries during insertion.                                    *
+ *                                                                            *
+ ******************************************************************************/
+
+#define OA_CRIT_LOAD_FACTOR	7/8
+
+#define ZBX_OAHASHSET_DEFAULT_SLOTS	16
+
+#define OA_SLOT(hs, slot)	((zbx_oahashset_slot_t *)((hs)->slots + (size_t)(slot) * (hs)->slot_size))
+#define OA_ENTRY(hs, slot)	((char *)(OA_SLOT(hs, slot) + 1))
+
+/* private open addressing hashset functions */
+
+static int	oahashset_init_slots(zbx_oahashset_t *hs, int num_slots)
+{
+	hs->num_data = 0;
+
+	if (0 == num_slots)
+	{
+		hs->num_slots = 0;
+		hs->slots = NULL;
+
+		return SUCCEED;
+	}
+
+	if (NULL == (hs->slots = (char *)hs->mem_malloc_func(NULL, (size_t)(num_slots + 2) * hs->slot_size)))
+		return FAIL;
+
+	for (int slot = 0; slot < num_slots; slot++)
+		OA_SLOT(hs, slot)->psl = 0;
+
+	hs->num_slots = num_slots;
+
+	return SUCCEED;
+}
+
+static int	oahashset_slots_by_size(size_t size)
+{
+	int	num_slots = ZBX_OAHASHSET_DEFAULT_SLOTS;
+
+	while ((size_t)num_slots * OA_CRIT_LOAD_FACTOR <= size)
+		num_slots *= 2;
+
+	return num_slots;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds slot of the entry matching the specified data               *
+ *                                                                            *
+ * Return value: the slot index or -1 if the entry was not found              *
+ *                                                                            *
+ ******************************************************************************/
+static int	oahashset_find(const zbx_oahashset_t *hs, zbx_hash_t hash, const void *data)
+{
+	int		mask = hs->num_slots - 1, slot = (int)(hash & (zbx_hash_t)mask);
+	zbx_uint32_t	psl = 1;
+
+	/* the probe sequence ends at an empty slot or at an entry closer to its home slot */
+	while (OA_SLOT(hs, slot)->psl >= psl)
+	{
+		if (OA_SLOT(hs, slot)->hash == hash && 0 == hs->compare_func(OA_ENTRY(hs, slot), data))
+			return slot;
+
+		psl++;
+		slot = (slot + 1) & mask;
+	}
+
+	return -1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: places new entry into hashset                                     *
+ *                                                                            *
+ * Parameters: hs   - [IN] the hashset                                        *
+ *             hash - [IN] the entry hash                                     *
+ *                                                                            *
+ * Return value: the slot index of placed entry                               *
+ *                                                                            *
+ * Comments: The entry data must be copied to the first swap slot and the     *
+ *           hashset must have at least one free slot.                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	oahashset_place(zbx_oahashset_t *hs, zbx_hash_t hash)
+{
+	int			mask = hs->num_slots - 1, slot = (int)(hash & (zbx_hash_t)mask), placed = -1;
+	zbx_oahashset_slot_t	*carry = OA_SLOT(hs, hs->num_slots), *swap = OA_SLOT(hs, hs->num_slots + 1), *tmp;
+
+	carry->hash = hash;
+	carry->psl = 1;
+
+	while (0 != OA_SLOT(hs, slot)->psl)
+	{
+		if (OA_SLOT(hs, slot)->psl < carry->psl)
+		{
+			/* take over the slot of entry that is closer to its home slot */
+			memcpy(swap, OA_SLOT(hs, slot), hs->slot_size);
+			memcpy(OA_SLOT(hs, slot), carry, hs->slot_size);
+
+			tmp = carry;
+			carry = swap;
+			swap = tmp;
+
+			if (-1 == placed)
+				placed = slot;
+		}
+
+		carry->psl++;
+		slot = (slot + 1) & mask;
+	}
+
+	memcpy(OA_SLOT(hs, slot), carry, hs->slot_size);
+
+	return -1 == placed ? slot : placed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes entry from the specified slot, shifting back the          *
+ *          following entries of the same cluster                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	oahashset_remove_slot(zbx_oahashset_t *hs, int slot)
+{
+	int	mask = hs->num_slots - 1, next;
+
+	if (NULL != hs->clean_func)
+		hs->clean_func(OA_ENTRY(hs, slot));
+
+	for (next = (slot + 1) & mask; 1 < OA_SLOT(hs, next)->psl; next = (slot + 1) & mask)
+	{
+		memcpy(OA_SLOT(hs, slot), OA_SLOT(hs, next), hs->slot_size);
+		OA_SLOT(hs, slot)->psl--;
+
+		slot = next;
+	}
+
+	OA_SLOT(hs, slot)->psl = 0;
+	hs->num_data--;
+}
+
+/* public open addressing hashset interface */
+
+void	zbx_oahashset_create(zbx_oahashset_t *hs, size_t init_size, size_t entry_size,
+				zbx_hash_func_t hash_func,
+				zbx_compare_func_t compare_func)
+{
+	zbx_oahashset_create_ext(hs, init_size, entry_size, hash_func, compare_func, NULL,
+					ZBX_DEFAULT_MEM_MALLOC_FUNC,
+					ZBX_DEFAULT_MEM_REALLOC_FUNC,
+					ZBX_DEFAULT_MEM_FREE_FUNC);
+}
+
+void	zbx_oahashset_create_ext(zbx_oahashset_t *hs, size_t init_size, size_t entry_size,
+				zbx_hash_func_t hash_func,
+				zbx_compare_func_t compare_func,
+				zbx_clean_func_t clean_func,
+				zbx_mem_malloc_func_t mem_malloc_func,
+				zbx_mem_realloc_func_t mem_realloc_func,
+				zbx_mem_free_func_t mem_free_func)
+{
+	hs->hash_func = hash_func;
+	hs->compare_func = compare_func;
+	hs->clean_func = clean_func;
+	hs->mem_malloc_func = mem_malloc_func;
+	hs->mem_realloc_func = mem_realloc_func;
+	hs->mem_free_func = mem_free_func;
+
+	/* keep entries aligned for 64-bit values and pointers */
+	hs->entry_size = (entry_size + 7) & ~(size_t)7;
+	hs->slot_size = sizeof(zbx_oahashset_slot_t) + hs->entry_size;
+
+	oahashset_init_slots(hs, 0 < init_size ? oahashset_slots_by_size(init_size) : 0);
+}
+
+void	zbx_oahashset_destroy(zbx_oahashset_t *hs)
+{
+	zbx_oahashset_clear(hs);
+
+	if (NULL != hs->slots)
+	{
+		hs->mem_free_func(hs->slots);
+		hs->slots = NULL;
+	}
+
+	hs->num_slots = 0;
+
+	hs->hash_func = NULL;
+	hs->compare_func = NULL;
+	hs->mem_malloc_func = NULL;
+	hs->mem_realloc_func = NULL;
+	hs->mem_free_func = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates enough slots for the required number of entries         *
+ *                                                                            *
+ * Parameters: hs       - [IN] the hashset                                    *
+ *             num_data - [IN] the number of entries to store                 *
+ *                                                                            *
+ * Return value: SUCCEED - the slots were allocated                           *
+ *               FAIL    - out of memory                                      *
+ *                                                                            *
+ * Comments: Entries are moved to the new slots, so any pointers to entries   *
+ *           become invalid when hashset grows.                               *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_oahashset_reserve(zbx_oahashset_t *hs, int num_data)
+{
+	zbx_oahashset_t	old = *hs;
+	int		slot;
+
+	if (0 != hs->num_slots && num_data < hs->num_slots * OA_CRIT_LOAD_FACTOR)
+		return SUCCEED;
+
+	if (SUCCEED != oahashset_init_slots(hs, oahashset_slots_by_size((size_t)num_data)))
+	{
+		*hs = old;
+		return FAIL;
+	}
+
+	for (slot = 0; slot < old.num_slots; slot++)
+	{
+		if (0 == OA_SLOT(&old, slot)->psl)
+			continue;
+
+		memcpy(OA_ENTRY(hs, hs->num_slots), OA_ENTRY(&old, slot), hs->entry_size);
+		(void)oahashset_place(hs, OA_SLOT(&old, slot)->hash);
+	}
+
+	hs->num_data = old.num_data;
+
+	if (NULL != old.slots)
+		hs->mem_free_func(old.slots);
+
+	return SUCCEED;
+}
+
+void	*zbx_oahashset_insert(zbx_oahashset_t *hs, const void *data, size_t size)
+{
+	return zbx_oahashset_insert_ext(hs, data, size, 0);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: inserts entry into hashset if it does not exist                   *
+ *                                                                            *
+ * Parameters: hs     - [IN] the hashset                                      *
+ *             data   - [IN] the entry data                                   *
+ *             size   - [IN] the entry data size, must not exceed the entry   *
+ *                           size given when creating hashset                 *
+ *             offset - [IN] the offset of data to copy, the data before      *
+ *                           offset is left for caller to initialize          *
+ *                                                                            *
+ * Return value: the inserted or existing entry or NULL if out of memory      *
+ *                                                                            *
+ ******************************************************************************/
+void	*zbx_oahashset_insert_ext(zbx_oahashset_t *hs, const void *data, size_t size, size_t offset)
+{
+	int		slot;
+	zbx_hash_t	hash;
+
+	if (size > hs->entry_size)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return NULL;
+	}
+
+	if (0 == hs->num_slots && SUCCEED != zbx_oahashset_reserve(hs, 1))
+		return NULL;
+
+	hash = hs->hash_func(data);
+
+	if (-1 != (slot = oahashset_find(hs, hash, data)))
+		return OA_ENTRY(hs, slot);
+
+	if (SUCCEED != zbx_oahashset_reserve(hs, hs->num_data + 1))
+		return NULL;
+
+	memcpy(OA_ENTRY(hs, hs->num_slots) + offset, (const char *)data + offset, size - offset);
+	slot = oahashset_place(hs, hash);
+	hs->num_data++;
+
+	return OA_ENTRY(hs, slot);
+}
+
+void	*zbx_oahashset_search(const zbx_oahashset_t *hs, const void *data)
+{
+	int	slot;
+
+	if (0 == hs->num_data)
+		return NULL;
+
+	if (-1 == (slot = oahashset_find(hs, hs->hash_func(data), data)))
+		return NULL;
+
+	return OA_ENTRY(hs, slot);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove a hashset entry using comparison with the given data       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_oahashset_remove(zbx_oahashset_t *hs, const void *data)
+{
+	int	slot;
+
+	if (0 == hs->num_data)
+		return;
+
+	if (-1 != (slot = oahashset_find(hs, hs->hash_func(data), data)))
+		oahashset_remove_slot(hs, slot);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove a hashset entry using a data pointer returned to the user  *
+ *          by zbx_oahashset_insert[_ext]() and zbx_oahashset_search()        *
+ *          functions                                                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_oahashset_remove_direct(zbx_oahashset_t *hs, void *data)
+{
+	oahashset_remove_slot(hs, (int)(((char *)data - hs->slots) / (ptrdiff_t)hs->slot_size));
+}
+
+void	zbx_oahashset_clear(zbx_oahashset_t *hs)
+{
+	for (int slot = 0; slot < hs->num_slots; slot++)
+	{
+		if (0 == OA_SLOT(hs, slot)->psl)
+			continue;
+
+		if (NULL != hs->clean_func)
+			hs->clean_func(OA_ENTRY(hs, slot));
+
+		OA_SLOT(hs, slot)->psl = 0;
+	}
+
+	hs->num_data = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets hashset iterator                                           *
+ *                                                                            *
+ * Comments: Iteration starts at a slot that is empty or holds entry in its   *
+ *           home slot. Entries shifted back by removal can never cross such  *
+ *           slot, so removing entries while iterating does not make iterator *
+ *           return entries twice or skip them.                               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_oahashset_iter_reset(zbx_oahashset_t *hs, zbx_oahashset_iter_t *iter)
+{
+	iter->hashset = hs;
+	iter->start = 0;
+	iter->offset = 0;
+
+	while (iter->start < hs->num_slots && 1 < OA_SLOT(hs, iter->start)->psl)
+		iter->start++;
+}
+
+void	*zbx_oahashset_iter_next(zbx_oahashset_iter_t *iter)
+{
+	zbx_oahashset_t	*hs = iter->hashset;
+
+	while (iter->offset < hs->num_slots)
+	{
+		int	slot = (iter->start + iter->offset++) & (hs->num_slots - 1);
+
+		if (0 != OA_SLOT(hs, slot)->psl)
+			return OA_ENTRY(hs, slot);
+	}
+
+	return NULL;
+}
+
+void	zbx_oahashset_iter_remove(zbx_oahashset_iter_t *iter)
+{
+	zbx_oahashset_t	*hs = iter->hashset;
+	int		slot;
+
+	if (0 == iter->offset || 0 == OA_SLOT(hs, slot = (iter->start + iter->offset - 1) & (hs->num_slots - 1))->psl)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "removing an open addressing hashset entry through a bad iterator");
+		exit(EXIT_FAILURE);
+	}
+
+	oahashset_remove_slot(hs, slot);
+
+	/* the next entry might have been shifted into the removed slot */
+	iter->offset--;
+}
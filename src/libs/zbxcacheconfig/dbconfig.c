@@ -1637,6 +1637,9 @@ static void	DCsync_hosts(zbx_dbsync_t *sync, zbx_uint64_t revision, zbx_vector_u
 		host = (ZBX_DC_HOST *)DCfind_id(&config->hosts, hostid, sizeof(ZBX_DC_HOST), &found);
 		host->revision = revision;
 
+		if (0 == found)
+			host->prototype_revision = 0;
+
 		/* see whether we should and can update 'hosts_h' and 'proxies_p' indexes at this point */
 
 		update_index_h = 0;
@@ -3850,7 +3853,20 @@ static void	DCsync_template_items(zbx_dbsync_t *sync)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
-static void	DCsync_prototype_items(zbx_dbsync_t *sync)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates item prototype revision of the host owning the prototype  *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_host_update_prototype_revision(zbx_uint64_t hostid, zbx_uint64_t revision)
+{
+	ZBX_DC_HOST	*host;
+
+	if (NULL != (host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &hostid)))
+		host->prototype_revision = revision;
+}
+
+static void	DCsync_prototype_items(zbx_dbsync_t *sync, zbx_uint64_t revision)
 {
 	char			**row;
 	zbx_uint64_t		rowid, itemid;
@@ -3872,6 +3888,8 @@ static void	DCsync_prototype_items(zbx_dbsync_t *sync)
 
 		ZBX_STR2UINT64(item->hostid, row[1]);
 		ZBX_DBROW2UINT64(item->templateid, row[2]);
+
+		dc_host_update_prototype_revision(item->hostid, revision);
 	}
 
 	/* remove deleted prototype items from buffer */
@@ -3880,6 +3898,7 @@ static void	DCsync_prototype_items(zbx_dbsync_t *sync)
 		if (NULL == (item = (ZBX_DC_PROTOTYPE_ITEM *)zbx_hashset_search(&config->prototype_items, &rowid)))
 			continue;
 
+		dc_host_update_prototype_revision(item->hostid, revision);
 		zbx_hashset_remove_direct(&config->prototype_items, item);
 	}
 
@@ -7424,7 +7443,8 @@ static void	dc_add_new_items_to_trends(const zbx_vector_dc_item_ptr_t *items)
  *                                                                            *
  ******************************************************************************/
 zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config_t synced,
-		zbx_vector_uint64_t *deleted_itemids, const zbx_config_vault_t *config_vault, int proxyconfig_frequency)
+		zbx_vector_uint64_t *deleted_itemids, const zbx_config_vault_t *config_vault, int proxyconfig_frequency,
+		int load_threads)
 {
 	static int	sync_status = ZBX_DBSYNC_STATUS_UNKNOWN;
 
@@ -7460,6 +7480,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	int				connectors_num = 0;
 	zbx_hashset_t			psk_owners;
 	zbx_vector_dc_item_ptr_t	new_items, *pnew_items = NULL;
+	zbx_dbsync_load_t		item_loads[8], trigger_loads[11];
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -7491,10 +7512,10 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_dbsync_init(&autoreg_host_sync, mode);
 	zbx_dbsync_init(&hosts_sync, changelog_sync_mode);
 	zbx_dbsync_init(&hi_sync, mode);
-	zbx_dbsync_init(&htmpl_sync, mode);
-	zbx_dbsync_init(&gmacro_sync, mode);
-	zbx_dbsync_init(&hmacro_sync, mode);
-	zbx_dbsync_init(&if_sync, mode);
+	zbx_dbsync_init(&htmpl_sync, changelog_sync_mode);
+	zbx_dbsync_init(&gmacro_sync, changelog_sync_mode);
+	zbx_dbsync_init(&hmacro_sync, changelog_sync_mode);
+	zbx_dbsync_init(&if_sync, changelog_sync_mode);
 	zbx_dbsync_init(&items_sync, changelog_sync_mode);
 	zbx_dbsync_init(&template_items_sync, mode);
 	zbx_dbsync_init(&prototype_items_sync, mode);
@@ -7503,7 +7524,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_dbsync_init(&tdep_sync, mode);
 	zbx_dbsync_init(&func_sync, changelog_sync_mode);
 	zbx_dbsync_init(&expr_sync, mode);
-	zbx_dbsync_init(&action_sync, mode);
+	zbx_dbsync_init(&action_sync, changelog_sync_mode);
 
 	/* Action operation sync produces virtual rows with two columns - actionid, opflags. */
 	/* Because of this it cannot return the original database select and must always be  */
@@ -7517,16 +7538,16 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_dbsync_init(&correlation_sync, mode);
 	zbx_dbsync_init(&corr_condition_sync, mode);
 	zbx_dbsync_init(&corr_operation_sync, mode);
-	zbx_dbsync_init(&hgroups_sync, mode);
-	zbx_dbsync_init(&hgroup_host_sync, mode);
+	zbx_dbsync_init(&hgroups_sync, changelog_sync_mode);
+	zbx_dbsync_init(&hgroup_host_sync, changelog_sync_mode);
 	zbx_dbsync_init(&itempp_sync, changelog_sync_mode);
 	zbx_dbsync_init(&itemscrp_sync, mode);
 
-	zbx_dbsync_init(&maintenance_sync, mode);
-	zbx_dbsync_init(&maintenance_period_sync, mode);
-	zbx_dbsync_init(&maintenance_tag_sync, mode);
-	zbx_dbsync_init(&maintenance_group_sync, mode);
-	zbx_dbsync_init(&maintenance_host_sync, mode);
+	zbx_dbsync_init(&maintenance_sync, changelog_sync_mode);
+	zbx_dbsync_init(&maintenance_period_sync, changelog_sync_mode);
+	zbx_dbsync_init(&maintenance_tag_sync, changelog_sync_mode);
+	zbx_dbsync_init(&maintenance_group_sync, changelog_sync_mode);
+	zbx_dbsync_init(&maintenance_host_sync, changelog_sync_mode);
 
 	zbx_dbsync_init(&drules_sync, changelog_sync_mode);
 	zbx_dbsync_init(&dchecks_sync, changelog_sync_mode);
@@ -7742,45 +7763,36 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 
 	/* sync item data to support item lookups when resolving macros during configuration sync */
 
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_interfaces(&if_sync))
+	/* during full sync tables are loaded by multiple threads and applied in dependency order afterwards */
+	zbx_dbsync_load_init(&item_loads[0], "interface", &if_sync, zbx_dbsync_compare_interfaces);
+	zbx_dbsync_load_init(&item_loads[1], "items", &items_sync, zbx_dbsync_compare_items);
+	zbx_dbsync_load_init(&item_loads[2], "template items", &template_items_sync,
+			zbx_dbsync_compare_template_items);
+	zbx_dbsync_load_init(&item_loads[3], "prototype items", &prototype_items_sync,
+			zbx_dbsync_compare_prototype_items);
+	zbx_dbsync_load_init(&item_loads[4], "item_discovery", &item_discovery_sync,
+			zbx_dbsync_compare_item_discovery);
+	zbx_dbsync_load_init(&item_loads[5], "item_preproc", &itempp_sync, zbx_dbsync_compare_item_preprocs);
+	zbx_dbsync_load_init(&item_loads[6], "item_parameter", &itemscrp_sync, zbx_dbsync_compare_item_script_param);
+	zbx_dbsync_load_init(&item_loads[7], "functions", &func_sync, zbx_dbsync_compare_functions);
+
+	if (FAIL == zbx_dbsync_load(item_loads, (int)ARRSIZE(item_loads), load_threads))
 		goto out;
-	ifsec = zbx_time() - sec;
 
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_items(&items_sync))
-		goto out;
-	isec = zbx_time() - sec;
+	if (ZBX_DBSYNC_INIT == if_sync.mode)
+		zbx_dbsync_env_set_um_revision();
 
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_template_items(&template_items_sync))
-		goto out;
-	tisec = zbx_time() - sec;
+	ifsec = item_loads[0].sec;
+	isec = item_loads[1].sec;
+	tisec = item_loads[2].sec;
+	pisec = item_loads[3].sec;
+	idsec = item_loads[4].sec;
+	itempp_sec = item_loads[5].sec;
+	itemscrp_sec = item_loads[6].sec;
+	fsec = item_loads[7].sec;
 
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_prototype_items(&prototype_items_sync))
-		goto out;
-	pisec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_item_discovery(&item_discovery_sync))
-		goto out;
-	idsec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_item_preprocs(&itempp_sync))
-		goto out;
-	itempp_sec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_item_script_param(&itemscrp_sync))
-		goto out;
-	itemscrp_sec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_functions(&func_sync))
-		goto out;
-	fsec = zbx_time() - sec;
+	/* Configuration cache write lock is released between groups of objects that are not referenced by each */
+	/* other, so that large changesets do not block cache readers during the whole apply phase.             */
 
 	START_SYNC;
 
@@ -7789,6 +7801,10 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	DCsync_interfaces(&if_sync, new_revision);
 	ifsec2 = zbx_time() - sec;
 
+	FINISH_SYNC;
+
+	START_SYNC;
+
 	/* relies on hosts, proxies and interfaces, must be after DCsync_{hosts,interfaces}() */
 
 	sec = zbx_time();
@@ -7800,7 +7816,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	tisec2 = zbx_time() - sec;
 
 	sec = zbx_time();
-	DCsync_prototype_items(&prototype_items_sync);
+	DCsync_prototype_items(&prototype_items_sync, new_revision);
 	pisec2 = zbx_time() - sec;
 
 	sec = zbx_time();
@@ -7832,61 +7848,36 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_dc_flush_history();	/* misconfigured items generate pseudo-historic values to become notsupported */
 
 	/* sync rest of the data */
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_triggers(&triggers_sync))
-		goto out;
-	tsec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_trigger_dependency(&tdep_sync))
-		goto out;
-	dsec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_expressions(&expr_sync))
-		goto out;
-	expr_sec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_actions(&action_sync))
-		goto out;
-	action_sec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_action_ops(&action_op_sync))
-		goto out;
-	action_op_sec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_action_conditions(&action_condition_sync))
-		goto out;
-	action_condition_sec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_trigger_tags(&trigger_tag_sync))
-		goto out;
-	trigger_tag_sec = zbx_time() - sec;
-
+	zbx_dbsync_load_init(&trigger_loads[0], "triggers", &triggers_sync, zbx_dbsync_compare_triggers);
+	zbx_dbsync_load_init(&trigger_loads[1], "trigger_depends", &tdep_sync, zbx_dbsync_compare_trigger_dependency);
+	zbx_dbsync_load_init(&trigger_loads[2], "expressions", &expr_sync, zbx_dbsync_compare_expressions);
+	zbx_dbsync_load_init(&trigger_loads[3], "actions", &action_sync, zbx_dbsync_compare_actions);
+	zbx_dbsync_load_init(&trigger_loads[4], "operations", &action_op_sync, zbx_dbsync_compare_action_ops);
+	zbx_dbsync_load_init(&trigger_loads[5], "conditions", &action_condition_sync,
+			zbx_dbsync_compare_action_conditions);
+	zbx_dbsync_load_init(&trigger_loads[6], "trigger_tag", &trigger_tag_sync, zbx_dbsync_compare_trigger_tags);
 	/* relies on items, must be after DCsync_items() */
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_item_tags(&item_tag_sync))
-		goto out;
-	item_tag_sec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_correlations(&correlation_sync))
+	zbx_dbsync_load_init(&trigger_loads[7], "item_tag", &item_tag_sync, zbx_dbsync_compare_item_tags);
+	zbx_dbsync_load_init(&trigger_loads[8], "correlation", &correlation_sync, zbx_dbsync_compare_correlations);
+	zbx_dbsync_load_init(&trigger_loads[9], "corr_condition", &corr_condition_sync,
+			zbx_dbsync_compare_corr_conditions);
+	zbx_dbsync_load_init(&trigger_loads[10], "corr_operation", &corr_operation_sync,
+			zbx_dbsync_compare_corr_operations);
+
+	if (FAIL == zbx_dbsync_load(trigger_loads, (int)ARRSIZE(trigger_loads), load_threads))
 		goto out;
-	correlation_sec = zbx_time() - sec;
 
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_corr_conditions(&corr_condition_sync))
-		goto out;
-	corr_condition_sec = zbx_time() - sec;
-
-	sec = zbx_time();
-	if (FAIL == zbx_dbsync_compare_corr_operations(&corr_operation_sync))
-		goto out;
-	corr_operation_sec = zbx_time() - sec;
+	tsec = trigger_loads[0].sec;
+	dsec = trigger_loads[1].sec;
+	expr_sec = trigger_loads[2].sec;
+	action_sec = trigger_loads[3].sec;
+	action_op_sec = trigger_loads[4].sec;
+	action_condition_sec = trigger_loads[5].sec;
+	trigger_tag_sec = trigger_loads[6].sec;
+	item_tag_sec = trigger_loads[7].sec;
+	correlation_sec = trigger_loads[8].sec;
+	corr_condition_sec = trigger_loads[9].sec;
+	corr_operation_sec = trigger_loads[10].sec;
 
 	START_SYNC;
 
@@ -7902,18 +7893,6 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	DCsync_expressions(&expr_sync, new_revision);
 	expr_sec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_actions(&action_sync);
-	action_sec2 = zbx_time() - sec;
-
-	sec = zbx_time();
-	DCsync_action_ops(&action_op_sync);
-	action_op_sec2 = zbx_time() - sec;
-
-	sec = zbx_time();
-	DCsync_action_conditions(&action_condition_sync);
-	action_condition_sec2 = zbx_time() - sec;
-
 	sec = zbx_time();
 	/* relies on triggers, must be after DCsync_triggers() */
 	DCsync_trigger_tags(&trigger_tag_sync);
@@ -7923,32 +7902,6 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	DCsync_item_tags(&item_tag_sync);
 	item_tag_sec2 = zbx_time() - sec;
 
-	sec = zbx_time();
-	DCsync_correlations(&correlation_sync);
-	correlation_sec2 = zbx_time() - sec;
-
-	sec = zbx_time();
-	/* relies on correlation rules, must be after DCsync_correlations() */
-	DCsync_corr_conditions(&corr_condition_sync);
-	corr_condition_sec2 = zbx_time() - sec;
-
-	sec = zbx_time();
-	/* relies on correlation rules, must be after DCsync_correlations() */
-	DCsync_corr_operations(&corr_operation_sync);
-	corr_operation_sec2 = zbx_time() - sec;
-
-	sec = zbx_time();
-	dc_sync_drules(&drules_sync, new_revision);
-	dc_sync_dchecks(&dchecks_sync, new_revision);
-	drules_sec2 = zbx_time() - sec;
-
-	sec = zbx_time();
-	dc_sync_httptests(&httptest_sync, new_revision);
-	dc_sync_httptest_fields(&httptest_field_sync, new_revision);
-	dc_sync_httpsteps(&httpstep_sync, new_revision);
-	dc_sync_httpstep_fields(&httpstep_field_sync, new_revision);
-	httptest_sec2 = zbx_time() - sec;
-
 	sec = zbx_time();
 
 	if (0 != hosts_sync.add_num + hosts_sync.update_num + hosts_sync.remove_num)
@@ -7975,12 +7928,6 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	if (0 != htmpl_sync.add_num + htmpl_sync.update_num + htmpl_sync.remove_num)
 		update_flags |= ZBX_DBSYNC_UPDATE_MACROS;
 
-	if (0 != connector_sync.add_num + connector_sync.update_num + connector_sync.remove_num +
-			connector_tag_sync.add_num + connector_tag_sync.update_num + connector_tag_sync.remove_num)
-	{
-		connectors_num = config->connectors.num_data;
-	}
-
 	/* update trigger topology if trigger dependency was changed */
 	if (0 != (update_flags & ZBX_DBSYNC_UPDATE_TRIGGER_DEPENDENCY))
 		dc_trigger_update_topology();
@@ -7995,8 +7942,62 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 
 	update_sec = zbx_time() - sec;
 
+	FINISH_SYNC;
+
+	START_SYNC;
+
+	sec = zbx_time();
+	DCsync_actions(&action_sync);
+	action_sec2 = zbx_time() - sec;
+
+	sec = zbx_time();
+	DCsync_action_ops(&action_op_sync);
+	action_op_sec2 = zbx_time() - sec;
+
+	sec = zbx_time();
+	DCsync_action_conditions(&action_condition_sync);
+	action_condition_sec2 = zbx_time() - sec;
+
+	sec = zbx_time();
+	DCsync_correlations(&correlation_sync);
+	correlation_sec2 = zbx_time() - sec;
+
+	sec = zbx_time();
+	/* relies on correlation rules, must be after DCsync_correlations() */
+	DCsync_corr_conditions(&corr_condition_sync);
+	corr_condition_sec2 = zbx_time() - sec;
+
+	sec = zbx_time();
+	/* relies on correlation rules, must be after DCsync_correlations() */
+	DCsync_corr_operations(&corr_operation_sync);
+	corr_operation_sec2 = zbx_time() - sec;
+
+	FINISH_SYNC;
+
+	START_SYNC;
+
+	sec = zbx_time();
+	dc_sync_drules(&drules_sync, new_revision);
+	dc_sync_dchecks(&dchecks_sync, new_revision);
+	drules_sec2 = zbx_time() - sec;
+
+	sec = zbx_time();
+	dc_sync_httptests(&httptest_sync, new_revision);
+	dc_sync_httptest_fields(&httptest_field_sync, new_revision);
+	dc_sync_httpsteps(&httpstep_sync, new_revision);
+	dc_sync_httpstep_fields(&httpstep_field_sync, new_revision);
+	httptest_sec2 = zbx_time() - sec;
+
+	if (0 != connector_sync.add_num + connector_sync.update_num + connector_sync.remove_num +
+			connector_tag_sync.add_num + connector_tag_sync.update_num + connector_tag_sync.remove_num)
+	{
+		connectors_num = config->connectors.num_data;
+	}
+
 	config->revision.config = new_revision;
 
+	FINISH_SYNC;
+
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
 		total = csec + hsec + hisec + htsec + gmsec + hmsec + ifsec + idsec + isec +  tisec + pisec + tsec +
@@ -8178,6 +8179,8 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() total sql  : " ZBX_FS_DBL " sec.", __func__, total);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() total sync : " ZBX_FS_DBL " sec.", __func__, total2);
 
+		RDLOCK_CACHE;
+
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() proxies    : %d (%d slots)", __func__,
 				config->proxies.num_data, config->proxies.num_slots);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() proxies_p    : %d (%d slots)", __func__,
@@ -8321,6 +8324,8 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 				config->strpool.num_data, config->strpool.num_slots);
 
 		zbx_shmem_dump_stats(LOG_LEVEL_DEBUG, config_mem);
+
+		UNLOCK_CACHE;
 	}
 
 	dberr = ZBX_DB_OK;
@@ -9224,6 +9229,47 @@ int	zbx_dc_check_host_permissions(const char *host, const zbx_socket_t *sock, zb
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get configuration revision affecting low level discovery rule     *
+ *                                                                            *
+ * Parameters: itemid   - [IN] the discovery rule identifier                  *
+ *             revision - [OUT] the configuration revision                    *
+ *                                                                            *
+ * Return value: SUCCEED - the revision was returned                          *
+ *               FAIL    - the discovery rule was not found                   *
+ *                                                                            *
+ * Comments: The revision covers the discovery rule itself, items and item    *
+ *           prototypes of its host, global regular expressions and user      *
+ *           macros visible to the host.                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dc_get_lld_rule_revision(zbx_uint64_t itemid, zbx_uint64_t *revision)
+{
+	const ZBX_DC_ITEM	*dc_item;
+	const ZBX_DC_HOST	*dc_host;
+	int			ret = FAIL;
+
+	RDLOCK_CACHE;
+
+	if (NULL != (dc_item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemid)) &&
+			NULL != (dc_host = (const ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &dc_item->hostid)))
+	{
+		*revision = MAX(dc_item->revision, dc_host->revision);
+		*revision = MAX(*revision, dc_host->prototype_revision);
+		*revision = MAX(*revision, config->revision.expression);
+
+		um_cache_get_host_revision(config->um_cache, ZBX_UM_CACHE_GLOBAL_MACRO_HOSTID, revision);
+		um_cache_get_host_revision(config->um_cache, dc_host->hostid, revision);
+
+		ret = SUCCEED;
+	}
+
+	UNLOCK_CACHE;
+
+	return ret;
+}
+
 int	zbx_dc_is_autoreg_host_changed(const char *host, unsigned short port, const char *host_metadata,
 		zbx_conn_flags_t flag, const char *interface, int now, int heartbeat)
 {
@@ -9889,6 +9935,7 @@ void	DCget_trigger(zbx_dc_trigger_t *dst_trigger, const ZBX_DC_TRIGGER *src_trig
 	int	i;
 
 	dst_trigger->triggerid = src_trigger->triggerid;
+	dst_trigger->revision = src_trigger->revision;
 	dst_trigger->description = zbx_strdup(NULL, src_trigger->description);
 	dst_trigger->error = zbx_strdup(NULL, src_trigger->error);
 	dst_trigger->timespec.sec = 0;
@@ -10080,6 +10127,35 @@ void	zbx_dc_config_get_items_by_itemids(zbx_dc_item_t *items, const zbx_uint64_t
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets value types of all configured items                          *
+ *                                                                            *
+ * Parameters: items - [OUT] itemid, value type pairs sorted by itemid        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_config_get_item_value_types(zbx_vector_uint64_pair_t *items)
+{
+	zbx_hashset_iter_t	iter;
+	const ZBX_DC_ITEM	*dc_item;
+
+	RDLOCK_CACHE;
+
+	zbx_vector_uint64_pair_reserve(items, (size_t)config->items.num_data);
+
+	zbx_hashset_iter_reset(&config->items, &iter);
+	while (NULL != (dc_item = (const ZBX_DC_ITEM *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_uint64_pair_t	pair = {.first = dc_item->itemid, .second = dc_item->value_type};
+
+		zbx_vector_uint64_pair_append(items, pair);
+	}
+
+	UNLOCK_CACHE;
+
+	zbx_vector_uint64_pair_sort(items, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
 int	zbx_dc_config_get_active_items_count_by_hostid(zbx_uint64_t hostid)
 {
 	const ZBX_DC_HOST	*dc_host;
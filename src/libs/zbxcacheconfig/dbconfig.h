@@ -385,6 +385,7 @@ typedef struct
 	int		maintenance_from;
 	int		data_expected_from;
 	zbx_uint64_t	revision;
+	zbx_uint64_t	prototype_revision;	/* revision of the last item prototype change */
 
 	unsigned char	maintenance_status;
 	unsigned char	maintenance_type;
@@ -401,6 +401,19 @@ void	DCsync_maintenance_groups(zbx_dbsync_t *sync)
 		zbx_vector_uint64_remove_noorder(&maintenance->groupids, index);
 	}
 
+	/* full scan after incomplete initialization can return already cached links */
+	if (ZBX_DBSYNC_INIT == sync->mode)
+	{
+		zbx_hashset_iter_t	iter;
+
+		zbx_hashset_iter_reset(&config->maintenances, &iter);
+		while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
+		{
+			zbx_vector_uint64_sort(&maintenance->groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+			zbx_vector_uint64_uniq(&maintenance->groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		}
+	}
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -484,6 +497,10 @@ void	DCsync_maintenance_hosts(zbx_dbsync_t *sync)
 	{
 		maintenance = (zbx_dc_maintenance_t *)maintenances.values[i];
 		zbx_vector_uint64_sort(&maintenance->hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		/* full scan after incomplete initialization can return already cached links */
+		if (ZBX_DBSYNC_INIT == sync->mode)
+			zbx_vector_uint64_uniq(&maintenance->hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 	}
 
 	zbx_vector_ptr_destroy(&maintenances);
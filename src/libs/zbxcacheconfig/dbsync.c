@@ -29,6 +29,8 @@
 #include "zbxdbhigh.h"
 #include "zbxexpr.h"
 #include "zbxstr.h"
+#include "zbxthreads.h"
+#include "zbxtime.h"
 
 /* global correlation constants */
 #define ZBX_CORRELATION_ENABLED				0
@@ -53,8 +55,22 @@
 #define ZBX_DBSYNC_OBJ_CONNECTOR	17
 #define ZBX_DBSYNC_OBJ_CONNECTOR_TAG	18
 #define ZBX_DBSYNC_OBJ_PROXY		19
+#define ZBX_DBSYNC_OBJ_GLOBALMACRO	20
+#define ZBX_DBSYNC_OBJ_HOSTMACRO	21
+#define ZBX_DBSYNC_OBJ_INTERFACE	22
+#define ZBX_DBSYNC_OBJ_INTERFACE_SNMP	23
+#define ZBX_DBSYNC_OBJ_HOST_TEMPLATE	24
+#define ZBX_DBSYNC_OBJ_HOSTGROUP	25
+#define ZBX_DBSYNC_OBJ_HOSTGROUP_HOST	26
+#define ZBX_DBSYNC_OBJ_ACTION		27
+#define ZBX_DBSYNC_OBJ_MAINTENANCE	28
+#define ZBX_DBSYNC_OBJ_MAINTENANCE_TAG	29
+#define ZBX_DBSYNC_OBJ_TIMEPERIOD	30
+#define ZBX_DBSYNC_OBJ_MAINTENANCE_WINDOW	31
+#define ZBX_DBSYNC_OBJ_MAINTENANCE_GROUP	32
+#define ZBX_DBSYNC_OBJ_MAINTENANCE_HOST	33
 /* number of dbsync objects - keep in sync with above defines */
-#define ZBX_DBSYNC_OBJ_COUNT		19
+#define ZBX_DBSYNC_OBJ_COUNT		33
 
 #define ZBX_DBSYNC_JOURNAL(X)		(X - 1)
 
@@ -94,6 +110,9 @@ typedef struct
 
 	zbx_vector_dbsync_t 			syncs;
 	zbx_vector_dbsync_obj_changelog_t	changelog;
+
+	/* all changes are processed by full table compare */
+	unsigned char				full_compare;
 }
 zbx_dbsync_journal_t;
 
@@ -105,6 +124,9 @@ typedef struct
 	zbx_hashset_t			changelog;
 
 	zbx_dbsync_journal_t		journals[ZBX_DBSYNC_OBJ_COUNT];
+
+	/* user macro cache revision used to resolve macros in interface fields */
+	zbx_uint64_t			um_revision;
 }
 zbx_dbsync_env_t;
 
@@ -316,6 +338,8 @@ static void	dbsync_journal_init(zbx_dbsync_journal_t *journal)
 	zbx_vector_dbsync_create(&journal->syncs);
 
 	zbx_vector_dbsync_obj_changelog_create(&journal->changelog);
+
+	journal->full_compare = 0;
 }
 
 static void	dbsync_journal_destroy(zbx_dbsync_journal_t *journal)
@@ -535,6 +559,17 @@ static void	dbsync_env_flush_journal(zbx_dbsync_journal_t *journal)
 	if (0 == journal->changelog.values_num)
 		return;
 
+	if (0 != journal->full_compare)
+	{
+		for (i = 0; i < journal->changelog.values_num; i++)
+		{
+			zbx_hashset_insert(&dbsync_env.changelog, &journal->changelog.values[i].changelog,
+					sizeof(zbx_dbsync_changelog_t));
+		}
+
+		return;
+	}
+
 	objects_num = journal->inserts.values_num + journal->updates.values_num;
 
 	for (i = 0; i < journal->syncs.values_num; i++)
@@ -601,6 +636,21 @@ int	zbx_dbsync_env_changelog_num(void)
 	return dbsync_env.changelog.num_data;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remembers user macro cache revision the interface macros were     *
+ *          resolved with                                                     *
+ *                                                                            *
+ * Comments: Must be called by the syncing process after initial interface    *
+ *           sync, as interfaces can be selected by configuration loader      *
+ *           threads.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dbsync_env_set_um_revision(void)
+{
+	dbsync_env.um_revision = dbsync_env.cache->um_cache->revision;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get rows changed since last sync                                  *
@@ -702,6 +752,52 @@ static int	dbsync_read_journal(zbx_dbsync_t *sync, char **sql, size_t *sql_alloc
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: marks journal changes to be processed by full table compare       *
+ *                                                                            *
+ * Parameter: journal - [IN] the changelog journal                            *
+ *                                                                            *
+ * Return value: the number of changelog records registered in journal        *
+ *                                                                            *
+ * Comments: Used by objects without primary key in configuration cache,      *
+ *           which are compared in full only when the journal has changes.    *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_journal_compare(zbx_dbsync_journal_t *journal)
+{
+	journal->full_compare = 1;
+
+	return journal->changelog.values_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds row removed by cascaded delete of its parent object          *
+ *                                                                            *
+ * Parameter: sync     - [IN] the changeset                                   *
+ *            rowid    - [IN] the cached object identifier                    *
+ *            parentid - [IN] the cached object parent identifier             *
+ *            parent   - [IN] the parent object changelog journal             *
+ *            journal  - [IN] the object changelog journal                    *
+ *                                                                            *
+ * Comments: Depending on database cascaded deletes might not be registered   *
+ *           in changelog, so such removals are detected by removed parents.  *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_add_cascade_row(zbx_dbsync_t *sync, zbx_uint64_t rowid, zbx_uint64_t parentid,
+		const zbx_dbsync_journal_t *parent, const zbx_dbsync_journal_t *journal)
+{
+	if (FAIL == zbx_vector_uint64_bsearch(&parent->deletes, parentid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		return;
+
+	if (FAIL != zbx_vector_uint64_bsearch(&journal->deletes, rowid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		return;
+
+	dbsync_add_row(sync, rowid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	sync->remove_num++;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initializes changeset                                             *
@@ -1152,6 +1248,9 @@ int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The table is compared in full only when host template links      *
+ *           were changed or hosts were removed.                              *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 {
@@ -1165,6 +1264,20 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 	char			hostid_s[MAX_ID_LEN + 1], templateid_s[MAX_ID_LEN + 1];
 	char			*del_row[2] = {hostid_s, templateid_s};
 
+	if (ZBX_DBSYNC_UPDATE == sync->mode)
+	{
+		int	changes_num;
+
+		changes_num = dbsync_journal_compare(&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOST_TEMPLATE)]);
+		changes_num += dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOST)].deletes.values_num;
+
+		if (0 == changes_num)
+		{
+			dbsync_prepare(sync, 2, NULL);
+			return SUCCEED;
+		}
+	}
+
 	if (NULL == (result = zbx_db_select(
 			"select hostid,templateid"
 			" from hosts_templates"
@@ -1223,67 +1336,6 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: compares global macro table row with cached configuration data    *
- *                                                                            *
- * Parameter: gmacro - [IN] the cached global macro data                      *
- *            dbrow    - [IN] the database row                                *
- *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-static int	dbsync_compare_global_macro(const zbx_um_macro_t *gmacro, const zbx_db_row_t dbrow)
-{
-	char	*macro = NULL, *context = NULL;
-	int	ret = FAIL;
-	unsigned char	context_op;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[3], gmacro->type))
-		return FAIL;
-
-	if (ZBX_MACRO_VALUE_VAULT == atoi(dbrow[3]))
-	{
-		if (FAIL == um_macro_check_vault_location(gmacro, dbrow[2]))
-			return FAIL;
-	}
-	else
-	{
-		if (FAIL == dbsync_compare_str(dbrow[2], gmacro->value))
-			return FAIL;
-	}
-
-	if (SUCCEED != zbx_user_macro_parse_dyn(dbrow[1], &macro, &context, NULL, &context_op))
-		return FAIL;
-
-	if (0 != strcmp(gmacro->name, macro))
-		goto out;
-
-	if (NULL == context)
-	{
-		if (NULL != gmacro->context)
-			goto out;
-
-		ret = SUCCEED;
-		goto out;
-	}
-
-	if (NULL == gmacro->context)
-		goto out;
-
-	if (gmacro->context_op != context_op)
-		goto out;
-
-	if (0 == strcmp(gmacro->context, context))
-		ret = SUCCEED;
-out:
-	zbx_free(macro);
-	zbx_free(context);
-
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: compares global macros table with cached configuration data       *
@@ -1296,127 +1348,34 @@ out:
  ******************************************************************************/
 int	zbx_dbsync_compare_global_macros(zbx_dbsync_t *sync)
 {
-	zbx_db_row_t		dbrow;
-	zbx_db_result_t		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid, *prowid = &rowid;
-	zbx_um_macro_t		**pmacro;
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset = 0;
+	int	ret = SUCCEED;
 
-	if (NULL == (result = zbx_db_select(
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
 			"select globalmacroid,macro,value,type"
-			" from globalmacro")))
-	{
-		return FAIL;
-	}
+			" from globalmacro");
 
 	dbsync_prepare(sync, 4, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
-
-	zbx_hashset_create(&ids, (size_t)dbsync_env.cache->gmacros.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	while (NULL != (dbrow = zbx_db_fetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (pmacro = (zbx_um_macro_t **)zbx_hashset_search(&dbsync_env.cache->gmacros, &prowid)))
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_global_macro(*pmacro, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->gmacros, &iter);
-	while (NULL != (pmacro = (zbx_um_macro_t **)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &(*pmacro)->macroid))
-			dbsync_add_row(sync, (*pmacro)->macroid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
-
-	zbx_hashset_destroy(&ids);
-	zbx_db_free_result(result);
-
-	return SUCCEED;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: compares host macro table row with cached configuration data      *
- *                                                                            *
- * Parameter: hmacro - [IN] the cached host macro data                        *
- *            dbrow  - [IN] the database row                                  *
- *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-static int	dbsync_compare_host_macro(const zbx_um_macro_t *hmacro, const zbx_db_row_t dbrow)
-{
-	char		*macro = NULL, *context = NULL;
-	int		ret = FAIL;
-	unsigned char	context_op;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[4], hmacro->type))
-		return FAIL;
-
-	if (ZBX_MACRO_VALUE_VAULT == atoi(dbrow[4]))
-	{
-		if (FAIL == um_macro_check_vault_location(hmacro, dbrow[3]))
-			return FAIL;
-	}
-	else
-	{
-		if (FAIL == dbsync_compare_str(dbrow[3], hmacro->value))
-			return FAIL;
-	}
-
-	if (FAIL == dbsync_compare_uint64(dbrow[1], hmacro->hostid))
-		return FAIL;
-
-	if (SUCCEED != zbx_user_macro_parse_dyn(dbrow[2], &macro, &context, NULL, &context_op))
-		return FAIL;
-
-	if (0 != strcmp(hmacro->name, macro))
-		goto out;
-
-	if (NULL == context)
-	{
-		if (NULL != hmacro->context)
-			goto out;
-
-		ret = SUCCEED;
+		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+			ret = FAIL;
 		goto out;
 	}
 
-	if (NULL == hmacro->context)
-		goto out;
-
-	if (context_op != hmacro->context_op)
-		goto  out;
-
-	if (0 == strcmp(hmacro->context, context))
-		ret = SUCCEED;
+	ret = dbsync_read_journal(sync, &sql, &sql_alloc, &sql_offset, "globalmacroid", "where", NULL,
+			&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_GLOBALMACRO)]);
 out:
-	zbx_free(macro);
-	zbx_free(context);
+	zbx_free(sql);
 
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares global macros table with cached configuration data       *
+ * Purpose: compares host macros table with cached configuration data         *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -1426,165 +1385,49 @@ out:
  ******************************************************************************/
 int	zbx_dbsync_compare_host_macros(zbx_dbsync_t *sync)
 {
-	zbx_db_row_t		dbrow;
-	zbx_db_result_t		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid, *prowid = &rowid;
-	zbx_um_macro_t		**pmacro;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			ret = SUCCEED;
+	zbx_dbsync_journal_t	*journal, *hosts;
 
-	if (NULL == (result = zbx_db_select(
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select m.hostmacroid,m.hostid,m.macro,m.value,m.type"
 			" from hostmacro m"
 			" inner join hosts h on m.hostid=h.hostid"
-			" where h.flags<>%d", ZBX_FLAG_DISCOVERY_PROTOTYPE)))
-	{
-		return FAIL;
-	}
+			" where h.flags<>%d", ZBX_FLAG_DISCOVERY_PROTOTYPE);
 
 	dbsync_prepare(sync, 5, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+			ret = FAIL;
+		goto out;
 	}
 
-	zbx_hashset_create(&ids, (size_t)dbsync_env.cache->hmacros.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	journal = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOSTMACRO)];
 
-	while (NULL != (dbrow = zbx_db_fetch(result)))
+	if (SUCCEED != (ret = dbsync_read_journal(sync, &sql, &sql_alloc, &sql_offset, "m.hostmacroid", "and", NULL,
+			journal)))
 	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (pmacro = (zbx_um_macro_t **)zbx_hashset_search(&dbsync_env.cache->hmacros, &prowid)))
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_host_macro(*pmacro, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->hmacros, &iter);
-	while (NULL != (pmacro = (zbx_um_macro_t **)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &(*pmacro)->macroid))
-			dbsync_add_row(sync, (*pmacro)->macroid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		goto out;
 	}
 
-	zbx_hashset_destroy(&ids);
-	zbx_db_free_result(result);
-
-	return SUCCEED;
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: compares interface table row with cached configuration data       *
- *                                                                            *
- * Parameter: interface - [IN] the cached interface data                      *
- *            dbrow     - [IN] the database row                               *
- *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- * Comments: User macros used in ip, dns fields will always make compare to   *
- *           fail.                                                            *
- *                                                                            *
- ******************************************************************************/
-static int	dbsync_compare_interface(const ZBX_DC_INTERFACE *interface, const zbx_db_row_t dbrow)
-{
-	ZBX_DC_SNMPINTERFACE *snmp;
+	hosts = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOST)];
 
-	if (FAIL == dbsync_compare_uint64(dbrow[1], interface->hostid))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[2], interface->type))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[3], interface->main))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[4], interface->useip))
-		return FAIL;
-
-	if (NULL != strstr(dbrow[5], "{$"))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[5], interface->ip))
-		return FAIL;
-
-	if (NULL != strstr(dbrow[6], "{$"))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[6], interface->dns))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[7], interface->port))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[8], interface->available))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_int(dbrow[9], interface->disable_until))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[10], interface->error))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_int(dbrow[11], interface->errors_from))
-		return FAIL;
-	/* reset_availability, items_num and availability_ts are excluded from the comparison */
-
-	snmp = (ZBX_DC_SNMPINTERFACE *)zbx_hashset_search(&dbsync_env.cache->interfaces_snmp,
-			&interface->interfaceid);
-
-	if (INTERFACE_TYPE_SNMP == interface->type)
+	if (0 != hosts->deletes.values_num)
 	{
-		if (NULL == snmp || SUCCEED == zbx_db_is_null(dbrow[12]))	/* should never happen */
-			return FAIL;
-
-		if (FAIL == dbsync_compare_uchar(dbrow[12], snmp->version))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_uchar(dbrow[13], snmp->bulk))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_str(dbrow[14], snmp->community))
-			return FAIL;
+		zbx_hashset_iter_t	iter;
+		zbx_um_macro_t		**pmacro;
 
-		if (FAIL == dbsync_compare_str(dbrow[15], snmp->securityname))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_uchar(dbrow[16], snmp->securitylevel))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_str(dbrow[17], snmp->authpassphrase))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_str(dbrow[18], snmp->privpassphrase))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_uchar(dbrow[19], snmp->authprotocol))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_uchar(dbrow[20], snmp->privprotocol))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_str(dbrow[21], snmp->contextname))
-			return FAIL;
-
-		if (FAIL == dbsync_compare_int(dbrow[22], snmp->max_repetitions))
-			return FAIL;
+		zbx_hashset_iter_reset(&dbsync_env.cache->hmacros, &iter);
+		while (NULL != (pmacro = (zbx_um_macro_t **)zbx_hashset_iter_next(&iter)))
+			dbsync_add_cascade_row(sync, (*pmacro)->macroid, (*pmacro)->hostid, hosts, journal);
 	}
-	else if (NULL != snmp)
-		return FAIL;
+out:
+	zbx_free(sql);
 
-	return SUCCEED;
+	return ret;
 }
 
 /******************************************************************************
@@ -1616,6 +1459,41 @@ static char	**dbsync_interface_preproc_row(char **row)
 	return row;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets identifiers of interfaces with user macros in address fields *
+ *                                                                            *
+ * Parameter: interfaceids - [OUT] the interface identifiers                  *
+ *                                                                            *
+ * Return value: SUCCEED - the identifiers were retrieved successfully        *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_get_macro_interfaceids(zbx_vector_uint64_t *interfaceids)
+{
+	zbx_db_row_t	dbrow;
+	zbx_db_result_t	result;
+	zbx_uint64_t	interfaceid;
+
+	if (NULL == (result = zbx_db_select(
+			"select interfaceid"
+			" from interface"
+			" where ip like '%%{$%%'"
+				" or dns like '%%{$%%'")))
+	{
+		return FAIL;
+	}
+
+	while (NULL != (dbrow = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(interfaceid, dbrow[0]);
+		zbx_vector_uint64_append(interfaceids, interfaceid);
+	}
+	zbx_db_free_result(result);
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: compares interfaces table with cached configuration data          *
@@ -1625,68 +1503,79 @@ static char	**dbsync_interface_preproc_row(char **row)
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: Interfaces with user macros in ip, dns fields are read again     *
+ *           when user macro cache has been changed since the last sync.      *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
 {
-	zbx_db_row_t		dbrow;
-	zbx_db_result_t		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	ZBX_DC_INTERFACE	*interface;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			ret = SUCCEED;
+	zbx_dbsync_journal_t	*journal, *snmp, *hosts;
 
-	if (NULL == (result = zbx_db_select(
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
 			"select i.interfaceid,i.hostid,i.type,i.main,i.useip,i.ip,i.dns,i.port,"
 			"i.available,i.disable_until,i.error,i.errors_from,"
 			"s.version,s.bulk,s.community,s.securityname,s.securitylevel,s.authpassphrase,s.privpassphrase,"
 			"s.authprotocol,s.privprotocol,s.contextname,s.max_repetitions"
 			" from interface i"
-			" left join interface_snmp s on i.interfaceid=s.interfaceid")))
-	{
-		return FAIL;
-	}
+			" left join interface_snmp s on i.interfaceid=s.interfaceid");
 
 	dbsync_prepare(sync, 23, dbsync_interface_preproc_row);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		/* user macro cache revision is set by zbx_dbsync_env_set_um_revision() after parallel load */
+		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+			ret = FAIL;
+
+		goto out;
 	}
 
-	zbx_hashset_create(&ids, (size_t)dbsync_env.cache->interfaces.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	journal = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_INTERFACE)];
+	snmp = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_INTERFACE_SNMP)];
 
-	while (NULL != (dbrow = zbx_db_fetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-		char		**row;
+	/* interface_snmp rows are identified by interfaceid, so any changes in them are read as interface updates */
+	zbx_vector_dbsync_append(&snmp->syncs, sync);
+	zbx_vector_uint64_append_array(&journal->updates, snmp->inserts.values, snmp->inserts.values_num);
+	zbx_vector_uint64_append_array(&journal->updates, snmp->updates.values, snmp->updates.values_num);
+	zbx_vector_uint64_append_array(&journal->updates, snmp->deletes.values, snmp->deletes.values_num);
 
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
+	if (dbsync_env.um_revision != dbsync_env.cache->um_cache->revision)
+	{
+		if (SUCCEED != (ret = dbsync_get_macro_interfaceids(&journal->updates)))
+			goto out;
 
-		row = dbsync_preproc_row(sync, dbrow);
+		dbsync_env.um_revision = dbsync_env.cache->um_cache->revision;
+	}
 
-		if (NULL == (interface = (ZBX_DC_INTERFACE *)zbx_hashset_search(&dbsync_env.cache->interfaces, &rowid)))
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_interface(interface, row))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
+	zbx_vector_uint64_sort(&journal->updates, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&journal->updates, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	dbsync_remove_duplicate_ids(&journal->updates, &journal->deletes);
+	dbsync_remove_duplicate_ids(&journal->updates, &journal->inserts);
 
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, row);
+	if (SUCCEED != (ret = dbsync_read_journal(sync, &sql, &sql_alloc, &sql_offset, "i.interfaceid", "where", NULL,
+			journal)))
+	{
+		goto out;
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->interfaces, &iter);
-	while (NULL != (interface = (ZBX_DC_INTERFACE *)zbx_hashset_iter_next(&iter)))
+	hosts = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOST)];
+
+	if (0 != hosts->deletes.values_num)
 	{
-		if (NULL == zbx_hashset_search(&ids, &interface->interfaceid))
-			dbsync_add_row(sync, interface->interfaceid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
+		zbx_hashset_iter_t	iter;
+		ZBX_DC_INTERFACE	*interface;
 
-	zbx_hashset_destroy(&ids);
-	zbx_db_free_result(result);
+		zbx_hashset_iter_reset(&dbsync_env.cache->interfaces, &iter);
+		while (NULL != (interface = (ZBX_DC_INTERFACE *)zbx_hashset_iter_next(&iter)))
+			dbsync_add_cascade_row(sync, interface->interfaceid, interface->hostid, hosts, journal);
+	}
+out:
+	zbx_free(sql);
 
-	return SUCCEED;
+	return ret;
 }
 
 /******************************************************************************
@@ -2316,32 +2205,6 @@ int	zbx_dbsync_compare_expressions(zbx_dbsync_t *sync)
 	return SUCCEED;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: compares actions table row with cached configuration data         *
- *                                                                            *
- * Parameter: action - [IN] the cached action                                 *
- *            dbrow  - [IN] the database row                                  *
- *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-static int	dbsync_compare_action(const zbx_dc_action_t *action, const zbx_db_row_t dbrow)
-{
-
-	if (FAIL == dbsync_compare_uchar(dbrow[1], action->eventsource))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[2], action->evaltype))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_str(dbrow[3], action->formula))
-		return FAIL;
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: compares actions table with cached configuration data             *
@@ -2352,63 +2215,50 @@ static int	dbsync_compare_action(const zbx_dc_action_t *action, const zbx_db_row
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
-{
-	zbx_db_row_t		dbrow;
-	zbx_db_result_t		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_action_t		*action;
+int	zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
+{
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			i, ret = SUCCEED;
+	zbx_dbsync_journal_t	*journal;
 
-	if (NULL == (result = zbx_db_select(
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select actionid,eventsource,evaltype,formula"
 			" from actions"
 			" where eventsource<>%d"
 				" and status=%d",
-			EVENT_SOURCE_SERVICE, ZBX_ACTION_STATUS_ACTIVE)))
-	{
-		return FAIL;
-	}
+			EVENT_SOURCE_SERVICE, ZBX_ACTION_STATUS_ACTIVE);
 
 	dbsync_prepare(sync, 4, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
+		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+			ret = FAIL;
+		goto out;
 	}
 
-	zbx_hashset_create(&ids, (size_t)dbsync_env.cache->actions.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	journal = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_ACTION)];
 
-	while (NULL != (dbrow = zbx_db_fetch(result)))
+	if (SUCCEED != (ret = dbsync_read_journal(sync, &sql, &sql_alloc, &sql_offset, "actionid", "and", NULL,
+			journal)))
 	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		if (NULL == (action = (zbx_dc_action_t *)zbx_hashset_search(&dbsync_env.cache->actions, &rowid)))
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_action(action, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
+		goto out;
 	}
 
-	zbx_hashset_iter_reset(&dbsync_env.cache->actions, &iter);
-	while (NULL != (action = (zbx_dc_action_t *)zbx_hashset_iter_next(&iter)))
+	/* updated actions left in journal were disabled or changed to service actions */
+	for (i = 0; i < journal->updates.values_num; i++)
 	{
-		if (NULL == zbx_hashset_search(&ids, &action->actionid))
-			dbsync_add_row(sync, action->actionid, ZBX_DBSYNC_ROW_REMOVE, NULL);
-	}
+		if (NULL == zbx_hashset_search(&dbsync_env.cache->actions, &journal->updates.values[i]))
+			continue;
 
-	zbx_hashset_destroy(&ids);
-	zbx_db_free_result(result);
+		dbsync_add_row(sync, journal->updates.values[i], ZBX_DBSYNC_ROW_REMOVE, NULL);
+		sync->remove_num++;
+	}
+out:
+	zbx_free(sql);
 
-	return SUCCEED;
+	return ret;
 }
 
 /******************************************************************************
@@ -3069,6 +2919,9 @@ static int	dbsync_compare_host_group(const zbx_dc_hostgroup_t *group, const zbx_
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The table is compared in full only when host groups were         *
+ *           changed.                                                         *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 {
@@ -3079,6 +2932,19 @@ int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 	zbx_uint64_t		rowid;
 	zbx_dc_hostgroup_t	*group;
 
+	if (ZBX_DBSYNC_UPDATE == sync->mode)
+	{
+		int	changes_num;
+
+		changes_num = dbsync_journal_compare(&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOSTGROUP)]);
+
+		if (0 == changes_num)
+		{
+			dbsync_prepare(sync, 2, NULL);
+			return SUCCEED;
+		}
+	}
+
 	if (NULL == (result = zbx_db_select("select groupid,name from hstgrp where type=%d", HOSTGROUP_TYPE_HOST)))
 		return FAIL;
 
@@ -3159,34 +3025,6 @@ out:
 	return ret;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: compares maintenance table row with cached configuration data     *
- *                                                                            *
- * Parameter: maintenance - [IN] the cached maintenance data                  *
- *            dbrow       - [IN] the database row                             *
- *                                                                            *
- * Return value: SUCCEED - the row matches configuration data                 *
- *               FAIL    - otherwise                                          *
- *                                                                            *
- ******************************************************************************/
-static int	dbsync_compare_maintenance(const zbx_dc_maintenance_t *maintenance, const zbx_db_row_t dbrow)
-{
-	if (FAIL == dbsync_compare_uchar(dbrow[1], maintenance->type))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_int(dbrow[2], maintenance->active_since))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_int(dbrow[3], maintenance->active_until))
-		return FAIL;
-
-	if (FAIL == dbsync_compare_uchar(dbrow[4], maintenance->tags_evaltype))
-		return FAIL;
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: compares item script params table row with cached configuration   *
@@ -3308,59 +3146,29 @@ int	zbx_dbsync_compare_item_script_param(zbx_dbsync_t *sync)
  ******************************************************************************/
 int	zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 {
-	zbx_db_row_t		dbrow;
-	zbx_db_result_t		result;
-	zbx_hashset_t		ids;
-	zbx_hashset_iter_t	iter;
-	zbx_uint64_t		rowid;
-	zbx_dc_maintenance_t	*maintenance;
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset = 0;
+	int	ret = SUCCEED;
 
-	if (NULL == (result = zbx_db_select("select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
-						" from maintenances")))
-	{
-		return FAIL;
-	}
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
+			" from maintenances");
 
 	dbsync_prepare(sync, 5, NULL);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		sync->dbresult = result;
-		return SUCCEED;
-	}
-
-	zbx_hashset_create(&ids, (size_t)dbsync_env.cache->maintenances.num_data, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	while (NULL != (dbrow = zbx_db_fetch(result)))
-	{
-		unsigned char	tag = ZBX_DBSYNC_ROW_NONE;
-
-		ZBX_STR2UINT64(rowid, dbrow[0]);
-		zbx_hashset_insert(&ids, &rowid, sizeof(rowid));
-
-		maintenance = (zbx_dc_maintenance_t *)zbx_hashset_search(&dbsync_env.cache->maintenances, &rowid);
-
-		if (NULL == maintenance)
-			tag = ZBX_DBSYNC_ROW_ADD;
-		else if (FAIL == dbsync_compare_maintenance(maintenance, dbrow))
-			tag = ZBX_DBSYNC_ROW_UPDATE;
-
-		if (ZBX_DBSYNC_ROW_NONE != tag)
-			dbsync_add_row(sync, rowid, tag, dbrow);
-	}
-
-	zbx_hashset_iter_reset(&dbsync_env.cache->maintenances, &iter);
-	while (NULL != (maintenance = (zbx_dc_maintenance_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL == zbx_hashset_search(&ids, &maintenance->maintenanceid))
-			dbsync_add_row(sync, maintenance->maintenanceid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+			ret = FAIL;
+		goto out;
 	}
 
-	zbx_hashset_destroy(&ids);
-	zbx_db_free_result(result);
+	ret = dbsync_read_journal(sync, &sql, &sql_alloc, &sql_offset, "maintenanceid", "where", NULL,
+			&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE)]);
+out:
+	zbx_free(sql);
 
-	return SUCCEED;
+	return ret;
 }
 
 /******************************************************************************
@@ -3398,6 +3206,9 @@ static int	dbsync_compare_maintenance_tag(const zbx_dc_maintenance_tag_t *mainte
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The table is compared in full only when maintenance tags were    *
+ *           changed or maintenances were removed.                            *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_dbsync_compare_maintenance_tags(zbx_dbsync_t *sync)
 {
@@ -3408,6 +3219,20 @@ int	zbx_dbsync_compare_maintenance_tags(zbx_dbsync_t *sync)
 	zbx_uint64_t			rowid;
 	zbx_dc_maintenance_tag_t	*maintenance_tag;
 
+	if (ZBX_DBSYNC_UPDATE == sync->mode)
+	{
+		int	changes_num;
+
+		changes_num = dbsync_journal_compare(&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE_TAG)]);
+		changes_num += dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE)].deletes.values_num;
+
+		if (0 == changes_num)
+		{
+			dbsync_prepare(sync, 5, NULL);
+			return SUCCEED;
+		}
+	}
+
 	if (NULL == (result = zbx_db_select("select maintenancetagid,maintenanceid,operator,tag,value"
 						" from maintenance_tag")))
 	{
@@ -3507,6 +3332,9 @@ static int	dbsync_compare_maintenance_period(const zbx_dc_maintenance_period_t *
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The tables are compared in full only when time periods or their  *
+ *           links were changed or maintenances were removed.                 *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
 {
@@ -3517,6 +3345,22 @@ int	zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
 	zbx_uint64_t			rowid;
 	zbx_dc_maintenance_period_t	*period;
 
+	if (ZBX_DBSYNC_UPDATE == sync->mode)
+	{
+		int	changes_num;
+
+		changes_num = dbsync_journal_compare(&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_TIMEPERIOD)]);
+		changes_num += dbsync_journal_compare(
+				&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE_WINDOW)]);
+		changes_num += dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE)].deletes.values_num;
+
+		if (0 == changes_num)
+		{
+			dbsync_prepare(sync, 10, NULL);
+			return SUCCEED;
+		}
+	}
+
 	if (NULL == (result = zbx_db_select("select t.timeperiodid,t.timeperiod_type,t.every,t.month,t.dayofweek,t.day,"
 						"t.start_time,t.period,t.start_date,m.maintenanceid"
 					" from maintenances_windows m,timeperiods t"
@@ -3577,6 +3421,9 @@ int	zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The table is compared in full only when maintenance groups or    *
+ *           host groups were changed or maintenances were removed.           *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 {
@@ -3590,6 +3437,22 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 	char			maintenanceid_s[MAX_ID_LEN + 1], groupid_s[MAX_ID_LEN + 1];
 	char			*del_row[2] = {maintenanceid_s, groupid_s};
 
+	if (ZBX_DBSYNC_UPDATE == sync->mode)
+	{
+		int	changes_num;
+
+		changes_num = dbsync_journal_compare(
+				&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE_GROUP)]);
+		changes_num += dbsync_journal_compare(&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOSTGROUP)]);
+		changes_num += dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE)].deletes.values_num;
+
+		if (0 == changes_num)
+		{
+			dbsync_prepare(sync, 2, NULL);
+			return SUCCEED;
+		}
+	}
+
 	if (NULL == (result = zbx_db_select("select maintenanceid,groupid from maintenances_groups order by maintenanceid")))
 		return FAIL;
 
@@ -3652,6 +3515,9 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The table is compared in full only when maintenance hosts were   *
+ *           changed or maintenances or hosts were removed.                   *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 {
@@ -3665,6 +3531,21 @@ int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 	char			maintenanceid_s[MAX_ID_LEN + 1], hostid_s[MAX_ID_LEN + 1];
 	char			*del_row[2] = {maintenanceid_s, hostid_s};
 
+	if (ZBX_DBSYNC_UPDATE == sync->mode)
+	{
+		int	changes_num;
+
+		changes_num = dbsync_journal_compare(&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE_HOST)]);
+		changes_num += dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_MAINTENANCE)].deletes.values_num;
+		changes_num += dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOST)].deletes.values_num;
+
+		if (0 == changes_num)
+		{
+			dbsync_prepare(sync, 2, NULL);
+			return SUCCEED;
+		}
+	}
+
 	if (NULL == (result = zbx_db_select("select maintenanceid,hostid from maintenances_hosts order by maintenanceid")))
 		return FAIL;
 
@@ -3727,6 +3608,9 @@ int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
  * Return value: SUCCEED - the changeset was successfully calculated          *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The table is compared in full only when host group links or host *
+ *           groups were changed or hosts were removed.                       *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 {
@@ -3740,6 +3624,21 @@ int	zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 	char			groupid_s[MAX_ID_LEN + 1], hostid_s[MAX_ID_LEN + 1];
 	char			*del_row[2] = {groupid_s, hostid_s};
 
+	if (ZBX_DBSYNC_UPDATE == sync->mode)
+	{
+		int	changes_num;
+
+		changes_num = dbsync_journal_compare(&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOSTGROUP_HOST)]);
+		changes_num += dbsync_journal_compare(&dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOSTGROUP)]);
+		changes_num += dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOST)].deletes.values_num;
+
+		if (0 == changes_num)
+		{
+			dbsync_prepare(sync, 2, NULL);
+			return SUCCEED;
+		}
+	}
+
 	if (NULL == (result = zbx_db_select(
 			"select hg.groupid,hg.hostid"
 			" from hosts_groups hg,hosts h"
@@ -4116,3 +4015,219 @@ out:
 	return ret;
 }
 
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes table load                                            *
+ *                                                                            *
+ * Parameters: load    - [OUT] the table load                                 *
+ *             name    - [IN] the table name                                  *
+ *             sync    - [IN] the changeset                                   *
+ *             compare - [IN] the function calculating changeset              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dbsync_load_init(zbx_dbsync_load_t *load, const char *name, zbx_dbsync_t *sync,
+		zbx_dbsync_compare_func_t compare)
+{
+	load->name = name;
+	load->sync = sync;
+	load->compare = compare;
+	load->ret = SUCCEED;
+	load->sec = 0;
+}
+
+typedef struct
+{
+	pthread_mutex_t		lock;
+	zbx_dbsync_load_t	*loads;
+	unsigned char		*taken;
+	int			loads_num;
+}
+zbx_dbsync_loader_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: takes next table to load and loads it                             *
+ *                                                                            *
+ * Parameters: loader    - [IN] the table loader                              *
+ *             init_only - [IN] 1 - take only tables loaded in initial sync   *
+ *                                  mode, their changesets are database       *
+ *                                  result sets that can be selected by any   *
+ *                                  thread                                    *
+ *                              0 - take any table in the specified order     *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_load_tables(zbx_dbsync_loader_t *loader, int init_only)
+{
+	zbx_dbsync_load_t	*load;
+	double			sec;
+	int			i;
+
+	while (1)
+	{
+		load = NULL;
+
+		pthread_mutex_lock(&loader->lock);
+
+		for (i = 0; i < loader->loads_num; i++)
+		{
+			if (0 != loader->taken[i])
+				continue;
+
+			if (0 != init_only && ZBX_DBSYNC_INIT != loader->loads[i].sync->mode)
+				continue;
+
+			loader->taken[i] = 1;
+			load = &loader->loads[i];
+			break;
+		}
+
+		pthread_mutex_unlock(&loader->lock);
+
+		if (NULL == load)
+			break;
+
+		sec = zbx_time();
+		load->ret = load->compare(load->sync);
+		load->sec = zbx_time() - sec;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads tables using separate database connection                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	*dbsync_load_thread_entry(void *args)
+{
+	zbx_dbsync_loader_t	*loader = (zbx_dbsync_loader_t *)args;
+	sigset_t		mask;
+	int			err;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGUSR1);
+	sigaddset(&mask, SIGUSR2);
+	sigaddset(&mask, SIGHUP);
+	sigaddset(&mask, SIGQUIT);
+	sigaddset(&mask, SIGINT);
+
+	if (0 != (err = pthread_sigmask(SIG_BLOCK, &mask, NULL)))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot block signals: %s", zbx_strerror(err));
+
+	if (ZBX_DB_OK != zbx_db_connect(ZBX_DB_CONNECT_ONCE))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot connect to the database to load configuration in parallel");
+		return NULL;
+	}
+
+	dbsync_load_tables(loader, 1);
+
+	zbx_db_close();
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates changesets of independent tables                       *
+ *                                                                            *
+ * Parameters: loads       - [IN/OUT] the tables to load                      *
+ *             loads_num   - [IN] the number of tables to load                *
+ *             threads_num - [IN] the number of additional threads to use     *
+ *                                                                            *
+ * Return value: SUCCEED - all changesets were calculated successfully        *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Tables in initial sync mode are selected by threads using their  *
+ *           own database connections in parallel with the calling process,   *
+ *           while changesets of tables in update mode are calculated by the  *
+ *           calling process in the specified order. Parallel loading is      *
+ *           supported only with PostgreSQL, as its result sets do not depend *
+ *           on the connection after being received.                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_load(zbx_dbsync_load_t *loads, int loads_num, int threads_num)
+{
+	zbx_dbsync_loader_t	loader;
+	pthread_t		*threads = NULL;
+	int			i, err, started_num = 0, init_num = 0, ret = SUCCEED;
+	double			sec;
+
+	sec = zbx_time();
+
+	loader.loads = loads;
+	loader.loads_num = loads_num;
+	loader.taken = (unsigned char *)zbx_malloc(NULL, (size_t)loads_num);
+	memset(loader.taken, 0, (size_t)loads_num);
+
+	for (i = 0; i < loads_num; i++)
+	{
+		if (ZBX_DBSYNC_INIT == loads[i].sync->mode)
+			init_num++;
+	}
+
+	if (0 != (err = pthread_mutex_init(&loader.lock, NULL)))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize configuration loader mutex: %s", zbx_strerror(err));
+		exit(EXIT_FAILURE);
+	}
+
+#if defined(HAVE_POSTGRESQL)
+	threads_num = MIN(threads_num, init_num - 1);
+
+	if (0 < threads_num)
+	{
+		pthread_attr_t	attr;
+
+		threads = (pthread_t *)zbx_malloc(NULL, sizeof(pthread_t) * (size_t)threads_num);
+
+		zbx_pthread_init_attr(&attr);
+
+		for (i = 0; i < threads_num; i++)
+		{
+			if (0 != (err = pthread_create(&threads[started_num], &attr, dbsync_load_thread_entry,
+					(void *)&loader)))
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot create configuration loader thread: %s",
+						zbx_strerror(err));
+				break;
+			}
+
+			started_num++;
+		}
+
+		pthread_attr_destroy(&attr);
+	}
+#else
+	ZBX_UNUSED(threads_num);
+#endif
+	dbsync_load_tables(&loader, 0);
+
+	for (i = 0; i < started_num; i++)
+		pthread_join(threads[i], NULL);
+
+	zbx_free(threads);
+	zbx_free(loader.taken);
+	pthread_mutex_destroy(&loader.lock);
+
+	for (i = 0; i < loads_num; i++)
+	{
+		if (SUCCEED != loads[i].ret)
+			ret = FAIL;
+
+		if (ZBX_DBSYNC_INIT == loads[i].sync->mode)
+		{
+			zabbix_log(LOG_LEVEL_INFORMATION, "loaded configuration table %s in " ZBX_FS_DBL " sec",
+					loads[i].name, loads[i].sec);
+		}
+	}
+
+	if (0 != init_num)
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "loaded %d configuration tables using %d threads in " ZBX_FS_DBL
+				" sec", loads_num, started_num + 1, zbx_time() - sec);
+	}
+
+	return ret;
+}
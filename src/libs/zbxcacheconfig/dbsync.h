@@ -109,6 +109,7 @@ int	zbx_dbsync_env_prepare(unsigned char mode);
 void	zbx_dbsync_env_flush_changelog(void);
 void	zbx_dbsync_env_clear(void);
 int	zbx_dbsync_env_changelog_num(void);
+void	zbx_dbsync_env_set_um_revision(void);
 
 void	zbx_dbsync_init(zbx_dbsync_t *sync, unsigned char mode);
 void	zbx_dbsync_clear(zbx_dbsync_t *sync);
@@ -164,4 +165,25 @@ int	zbx_dbsync_compare_connector_tags(zbx_dbsync_t *sync);
 
 int	zbx_dbsync_compare_proxies(zbx_dbsync_t *sync);
 
+typedef int	(*zbx_dbsync_compare_func_t)(zbx_dbsync_t *sync);
+
+typedef struct
+{
+	/* the table name used in load statistics */
+	const char			*name;
+
+	/* the changeset and function to calculate it */
+	zbx_dbsync_t			*sync;
+	zbx_dbsync_compare_func_t	compare;
+
+	/* the result of changeset calculation and time spent on it */
+	int				ret;
+	double				sec;
+}
+zbx_dbsync_load_t;
+
+void	zbx_dbsync_load_init(zbx_dbsync_load_t *load, const char *name, zbx_dbsync_t *sync,
+		zbx_dbsync_compare_func_t compare);
+int	zbx_dbsync_load(zbx_dbsync_load_t *loads, int loads_num, int threads_num);
+
 #endif /* BUILD_SRC_LIBS_ZBXDBCACHE_DBSYNC_H_ */
@@ -39,9 +39,16 @@
 #include "zbxeval.h"
 
 static zbx_shmem_info_t	*hc_index_mem = NULL;
-static zbx_shmem_info_t	*hc_mem = NULL;
 static zbx_shmem_info_t	*trend_mem = NULL;
 
+/* history cache shard memory, the first shard index is stored in hc_index_mem */
+static zbx_shmem_info_t	*hc_shards_mem[ZBX_HC_SHARDS_MAX];
+static zbx_shmem_info_t	*hc_shards_index_mem[ZBX_HC_SHARDS_MAX];
+
+/* memory of the currently locked history cache shard */
+static zbx_shmem_info_t	*hc_mem = NULL;
+static zbx_shmem_info_t	*hc_shard_index_mem = NULL;
+
 #define	LOCK_CACHE	zbx_mutex_lock(cache_lock)
 #define	UNLOCK_CACHE	zbx_mutex_unlock(cache_lock)
 #define	LOCK_TRENDS	zbx_mutex_lock(trends_lock)
@@ -53,6 +60,9 @@ static zbx_mutex_t	cache_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	trends_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	cache_ids_lock = ZBX_MUTEX_NULL;
 
+/* the first history cache shard is protected by cache_lock */
+static zbx_mutex_t	hc_shard_locks[ZBX_HC_SHARDS_MAX];
+
 static char		*sql = NULL;
 static size_t		sql_alloc = 4 * ZBX_KIBIBYTE;
 
@@ -63,6 +73,9 @@ static zbx_history_sync_f	sync_history_cb = NULL;
 
 #define ZBX_HC_ITEMS_INIT_SIZE	1000
 
+/* the minimum history cache and history index cache size per shard */
+#define ZBX_HC_SHARD_MIN_SIZE	(128 * ZBX_KIBIBYTE)
+
 #define ZBX_TRENDS_CLEANUP_TIME	(SEC_PER_MIN * 55)
 
 /* the minimum processed item percentage of item candidates to continue synchronizing */
@@ -102,15 +115,25 @@ typedef struct
 }
 zbx_hc_proxyqueue_t;
 
+/* history cache shard, items are assigned to shards by itemid */
 typedef struct
 {
-	zbx_hashset_t		trends;
-	zbx_dc_stats_t		stats;
-
 	zbx_hashset_t		history_items;
 	zbx_binary_heap_t	history_queue;
-
+	zbx_dc_stats_t		stats;
 	int			history_num;
+	zbx_uint64_t		locks_num;
+	zbx_uint64_t		locks_contended;
+}
+zbx_hc_shard_t;
+
+typedef struct
+{
+	zbx_hashset_t		trends;
+
+	zbx_hc_shard_t		*shards;
+	int			shards_num;
+
 	int			trends_num;
 	int			trends_last_cleanup_hour;
 	int			history_num_total;
@@ -119,6 +142,8 @@ typedef struct
 	unsigned char		db_trigger_queue_lock;
 
 	zbx_hc_proxyqueue_t	proxyqueue;
+
+	zbx_hc_trigger_stats_t	trigger_stats;
 }
 ZBX_DC_CACHE;
 
@@ -167,8 +192,64 @@ static size_t		string_values_alloc = 0, string_values_offset = 0;
 static dc_item_value_t	*item_values = NULL;
 static size_t		item_values_alloc = 0, item_values_num = 0;
 
-static void	hc_add_item_values(dc_item_value_t *values, int values_num);
-static void	hc_queue_item(zbx_hc_item_t *item);
+#if defined(HAVE_ATOMIC_BUILTINS)
+/* the minimum number of history ingestion ring slots */
+#define ZBX_HC_RING_SIZE_MIN	1024
+
+/* the maximum number of values moved from ring to history cache at once */
+#define ZBX_HC_RING_DRAIN_MAX	4096
+
+/* history ingestion ring slot, holds a single numeric value */
+typedef struct
+{
+	zbx_uint64_t		sequence;	/* the slot state, see hc_ring_push() */
+	zbx_uint64_t		itemid;
+	zbx_uint64_t		lastlogsize;
+	zbx_history_value_t	value;
+	zbx_timespec_t		ts;
+	int			mtime;
+	unsigned char		item_value_type;
+	unsigned char		value_type;
+	unsigned char		flags;
+	unsigned char		done;		/* the value was moved to history cache */
+}
+zbx_hc_ring_slot_t;
+
+/* bounded multi-producer single-consumer queue of values waiting to be added to history cache */
+typedef struct
+{
+	zbx_uint64_t		head;		/* the next position to write, advanced by producers */
+	zbx_uint64_t		tail;		/* the next position to read, advanced by consumer */
+	zbx_uint64_t		size;
+	zbx_uint64_t		mask;
+	zbx_uint64_t		pushed_num;
+	zbx_uint64_t		drained_num;
+	zbx_uint64_t		full_num;
+	zbx_uint64_t		waits_num;
+	zbx_hc_ring_slot_t	*slots;
+}
+zbx_hc_ring_t;
+
+static zbx_shmem_info_t	*hc_ring_mem = NULL;
+static zbx_hc_ring_t	*hc_ring = NULL;
+
+/* the ring consumer lock */
+static zbx_mutex_t	hc_ring_lock = ZBX_MUTEX_NULL;
+
+/* the last ring position written by this process */
+static zbx_uint64_t	hc_ring_position;
+static int		hc_ring_position_set = FAIL;
+#endif
+
+static void	hc_add_item_values(int index, dc_item_value_t *values, int values_num);
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item);
+static zbx_hc_item_t	*hc_get_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid);
+static void	hc_append_item_data(zbx_hc_shard_t *shard, zbx_hc_item_t *item, zbx_uint64_t itemid,
+		zbx_hc_data_t *data);
+static int	hc_clone_history_data(zbx_dc_stats_t *stats, zbx_hc_data_t **data, const dc_item_value_t *item_value);
+static zbx_hc_shard_t	*hc_shard_lock(int index);
+static void	hc_shard_unlock(int index);
+static int	hc_get_history_num(void);
 static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
 static int	hc_get_history_compression_age(void);
 
@@ -178,6 +259,26 @@ void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
 		zbx_free(opt->source);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds history cache shard statistics to the total statistics       *
+ *                                                                            *
+ * Parameters: total - [IN/OUT] the total statistics                          *
+ *             stats - [IN] the shard statistics                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_stats_add(zbx_dc_stats_t *total, const zbx_dc_stats_t *stats)
+{
+	total->history_counter += stats->history_counter;
+	total->history_float_counter += stats->history_float_counter;
+	total->history_uint_counter += stats->history_uint_counter;
+	total->history_str_counter += stats->history_str_counter;
+	total->history_log_counter += stats->history_log_counter;
+	total->history_text_counter += stats->history_text_counter;
+	total->history_bin_counter += stats->history_bin_counter;
+	total->notsupported_counter += stats->notsupported_counter;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves all internal metrics of the database cache              *
@@ -187,21 +288,34 @@ void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
  ******************************************************************************/
 void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info)
 {
-	LOCK_CACHE;
+	int	i;
+
+	memset(wcache_info, 0, sizeof(zbx_wcache_info_t));
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard;
 
-	wcache_info->stats = cache->stats;
-	wcache_info->history_free = hc_mem->free_size;
-	wcache_info->history_total = hc_mem->total_size;
-	wcache_info->index_free = hc_index_mem->free_size;
-	wcache_info->index_total = hc_index_mem->total_size;
+		shard = hc_shard_lock(i);
+
+		hc_stats_add(&wcache_info->stats, &shard->stats);
+		wcache_info->history_free += hc_mem->free_size;
+		wcache_info->history_total += hc_mem->total_size;
+		wcache_info->index_free += hc_shard_index_mem->free_size;
+		wcache_info->index_total += hc_shard_index_mem->total_size;
+
+		hc_shard_unlock(i);
+	}
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
+		LOCK_TRENDS;
+
 		wcache_info->trend_free = trend_mem->free_size;
 		wcache_info->trend_total = trend_mem->orig_size;
-	}
 
-	UNLOCK_CACHE;
+		UNLOCK_TRENDS;
+	}
 }
 
 /******************************************************************************
@@ -214,111 +328,111 @@ void	*zbx_dc_get_stats(int request)
 	static zbx_uint64_t	value_uint;
 	static double		value_double;
 	void			*ret;
+	zbx_wcache_info_t	wcache_info;
 
-	LOCK_CACHE;
+	zbx_dc_get_stats_all(&wcache_info);
 
 	switch (request)
 	{
 		case ZBX_STATS_HISTORY_COUNTER:
-			value_uint = cache->stats.history_counter;
+			value_uint = wcache_info.stats.history_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FLOAT_COUNTER:
-			value_uint = cache->stats.history_float_counter;
+			value_uint = wcache_info.stats.history_float_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_UINT_COUNTER:
-			value_uint = cache->stats.history_uint_counter;
+			value_uint = wcache_info.stats.history_uint_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_STR_COUNTER:
-			value_uint = cache->stats.history_str_counter;
+			value_uint = wcache_info.stats.history_str_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_LOG_COUNTER:
-			value_uint = cache->stats.history_log_counter;
+			value_uint = wcache_info.stats.history_log_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TEXT_COUNTER:
-			value_uint = cache->stats.history_text_counter;
+			value_uint = wcache_info.stats.history_text_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_NOTSUPPORTED_COUNTER:
-			value_uint = cache->stats.notsupported_counter;
+			value_uint = wcache_info.stats.notsupported_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TOTAL:
-			value_uint = hc_mem->total_size;
+			value_uint = wcache_info.history_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_USED:
-			value_uint = hc_mem->total_size - hc_mem->free_size;
+			value_uint = wcache_info.history_total - wcache_info.history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FREE:
-			value_uint = hc_mem->free_size;
+			value_uint = wcache_info.history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_PUSED:
-			value_double = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+			value_double = 100 * (double)(wcache_info.history_total - wcache_info.history_free) /
+					wcache_info.history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_PFREE:
-			value_double = 100 * (double)hc_mem->free_size / hc_mem->total_size;
+			value_double = 100 * (double)wcache_info.history_free / wcache_info.history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_TOTAL:
-			value_uint = trend_mem->orig_size;
+			value_uint = wcache_info.trend_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_USED:
-			value_uint = trend_mem->orig_size - trend_mem->free_size;
+			value_uint = wcache_info.trend_total - wcache_info.trend_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_FREE:
-			value_uint = trend_mem->free_size;
+			value_uint = wcache_info.trend_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_TREND_PUSED:
-			value_double = 100 * (double)(trend_mem->orig_size - trend_mem->free_size) /
-					trend_mem->orig_size;
+			value_double = 100 * (double)(wcache_info.trend_total - wcache_info.trend_free) /
+					wcache_info.trend_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_PFREE:
-			value_double = 100 * (double)trend_mem->free_size / trend_mem->orig_size;
+			value_double = 100 * (double)wcache_info.trend_free / wcache_info.trend_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_TOTAL:
-			value_uint = hc_index_mem->total_size;
+			value_uint = wcache_info.index_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_USED:
-			value_uint = hc_index_mem->total_size - hc_index_mem->free_size;
+			value_uint = wcache_info.index_total - wcache_info.index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_FREE:
-			value_uint = hc_index_mem->free_size;
+			value_uint = wcache_info.index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PUSED:
-			value_double = 100 * (double)(hc_index_mem->total_size - hc_index_mem->free_size) /
-					hc_index_mem->total_size;
+			value_double = 100 * (double)(wcache_info.index_total - wcache_info.index_free) /
+					wcache_info.index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PFREE:
-			value_double = 100 * (double)hc_index_mem->free_size / hc_index_mem->total_size;
+			value_double = 100 * (double)wcache_info.index_free / wcache_info.index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_BIN_COUNTER:
-			value_uint = cache->stats.history_bin_counter;
+			value_uint = wcache_info.stats.history_bin_counter;
 			ret = (void *)&value_uint;
 			break;
 		default:
 			ret = NULL;
 	}
 
-	UNLOCK_CACHE;
-
 	return ret;
 }
 
@@ -400,6 +514,7 @@ static void	dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigne
 
 	zbx_db_insert_prepare(&db_insert, table_name, "itemid", "clock", "num", "value_min", "value_avg",
 			"value_max", (char *)NULL);
+	zbx_db_insert_use_copy(&db_insert);
 
 	for (i = 0; i < trends_num; i++)
 	{
@@ -1814,6 +1929,149 @@ static int	zbx_trigger_topoindex_compare(const void *d1, const void *d2)
 	return 0;
 }
 
+/* prepared trigger expressions, cached per history syncer process */
+typedef struct
+{
+	zbx_uint64_t		triggerid;
+	zbx_uint64_t		revision;
+	char			*expression;
+	char			*recovery_expression;
+	zbx_eval_context_t	*eval_ctx;
+	zbx_eval_context_t	*eval_ctx_r;
+	time_t			lastaccess;
+}
+zbx_trigger_expr_t;
+
+#define ZBX_TRIGGER_EXPR_CLEANUP_PERIOD	(SEC_PER_MIN * 10)
+#define ZBX_TRIGGER_EXPR_TTL		SEC_PER_HOUR
+
+static zbx_hashset_t	trigger_exprs;
+static int		trigger_exprs_init = FAIL;
+static time_t		trigger_exprs_cleanup;
+
+static void	trigger_expr_clear(zbx_trigger_expr_t *expr)
+{
+	if (NULL != expr->eval_ctx)
+	{
+		zbx_eval_clear(expr->eval_ctx);
+		zbx_free(expr->eval_ctx);
+	}
+
+	if (NULL != expr->eval_ctx_r)
+	{
+		zbx_eval_clear(expr->eval_ctx_r);
+		zbx_free(expr->eval_ctx_r);
+	}
+
+	zbx_free(expr->expression);
+	zbx_free(expr->recovery_expression);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates prepared expression evaluation context                    *
+ *                                                                            *
+ * Parameters: data       - [IN] serialized expression                        *
+ *             expression - [IN] expression, owned by the cached entry        *
+ *                                                                            *
+ * Return value: deserialized evaluation context with decoded and folded      *
+ *               constants                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_eval_context_t	*trigger_expr_prepare(const unsigned char *data, const char *expression)
+{
+	zbx_eval_context_t	*ctx;
+
+	ctx = zbx_eval_deserialize_dyn(data, expression, ZBX_EVAL_EXTRACT_ALL);
+	zbx_eval_fold_constants(ctx);
+
+	return ctx;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies prepared evaluation context for trigger evaluation         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_eval_context_t	*trigger_expr_copy(const zbx_eval_context_t *src, const char *expression)
+{
+	zbx_eval_context_t	*ctx;
+
+	ctx = (zbx_eval_context_t *)zbx_malloc(NULL, sizeof(zbx_eval_context_t));
+	memset(ctx, 0, sizeof(zbx_eval_context_t));
+	zbx_eval_copy(ctx, src, expression);
+
+	return ctx;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets prepared trigger expressions, deserializing them only when   *
+ *          trigger was not cached or has been changed                        *
+ *                                                                            *
+ * Parameters: tr  - [IN] trigger                                             *
+ *             now - [IN] current time                                        *
+ *                                                                            *
+ * Return value: cached trigger expressions                                   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_trigger_expr_t	*trigger_expr_get(const zbx_dc_trigger_t *tr, time_t now)
+{
+	zbx_trigger_expr_t	*expr, expr_local;
+
+	if (NULL == (expr = (zbx_trigger_expr_t *)zbx_hashset_search(&trigger_exprs, &tr->triggerid)))
+	{
+		memset(&expr_local, 0, sizeof(expr_local));
+		expr_local.triggerid = tr->triggerid;
+		expr = (zbx_trigger_expr_t *)zbx_hashset_insert(&trigger_exprs, &expr_local, sizeof(expr_local));
+	}
+	else if (expr->revision != tr->revision)
+		trigger_expr_clear(expr);
+	else
+		goto out;
+
+	expr->revision = tr->revision;
+	expr->expression = zbx_strdup(NULL, tr->expression);
+	expr->eval_ctx = trigger_expr_prepare(tr->expression_bin, expr->expression);
+
+	if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == tr->recovery_mode)
+	{
+		expr->recovery_expression = zbx_strdup(NULL, tr->recovery_expression);
+		expr->eval_ctx_r = trigger_expr_prepare(tr->recovery_expression_bin, expr->recovery_expression);
+	}
+out:
+	expr->lastaccess = now;
+
+	return expr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes prepared expressions of triggers that were not evaluated  *
+ *          for a while (deleted, disabled or not receiving data)             *
+ *                                                                            *
+ ******************************************************************************/
+static void	trigger_exprs_cleanup_unused(time_t now)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_trigger_expr_t	*expr;
+
+	if (now < trigger_exprs_cleanup)
+		return;
+
+	zbx_hashset_iter_reset(&trigger_exprs, &iter);
+	while (NULL != (expr = (zbx_trigger_expr_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (now - expr->lastaccess >= ZBX_TRIGGER_EXPR_TTL)
+		{
+			trigger_expr_clear(expr);
+			zbx_hashset_iter_remove(&iter);
+		}
+	}
+
+	trigger_exprs_cleanup = now + ZBX_TRIGGER_EXPR_CLEANUP_PERIOD;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: prepare triggers for evaluation.                                  *
@@ -1821,23 +2079,39 @@ static int	zbx_trigger_topoindex_compare(const void *d1, const void *d2)
  * Parameters: triggers     - [IN] array of zbx_dc_trigger_t pointers         *
  *             triggers_num - [IN] number of triggers to prepare              *
  *                                                                            *
+ * Comments: Evaluation contexts are modified during trigger evaluation, so   *
+ *           every trigger gets a copy of the prepared expression kept in     *
+ *           process local cache until the trigger revision changes.          *
+ *                                                                            *
  ******************************************************************************/
 static void	prepare_triggers(zbx_dc_trigger_t **triggers, int triggers_num)
 {
 	int	i;
+	time_t	now;
+
+	if (FAIL == trigger_exprs_init)
+	{
+		zbx_hashset_create(&trigger_exprs, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		trigger_exprs_cleanup = time(NULL) + ZBX_TRIGGER_EXPR_CLEANUP_PERIOD;
+		trigger_exprs_init = SUCCEED;
+	}
+
+	now = time(NULL);
 
 	for (i = 0; i < triggers_num; i++)
 	{
 		zbx_dc_trigger_t	*tr = triggers[i];
+		zbx_trigger_expr_t	*expr;
+
+		expr = trigger_expr_get(tr, now);
 
-		tr->eval_ctx = zbx_eval_deserialize_dyn(tr->expression_bin, tr->expression, ZBX_EVAL_EXTRACT_ALL);
+		tr->eval_ctx = trigger_expr_copy(expr->eval_ctx, tr->expression);
 
 		if (TRIGGER_RECOVERY_MODE_RECOVERY_EXPRESSION == tr->recovery_mode)
-		{
-			tr->eval_ctx_r = zbx_eval_deserialize_dyn(tr->recovery_expression_bin, tr->recovery_expression,
-					ZBX_EVAL_EXTRACT_ALL);
-		}
+			tr->eval_ctx_r = trigger_expr_copy(expr->eval_ctx_r, tr->recovery_expression);
 	}
+
+	trigger_exprs_cleanup_unused(now);
 }
 
 /******************************************************************************
@@ -1874,6 +2148,38 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates trigger recalculation statistics                          *
+ *                                                                            *
+ * Parameters: triggers_num - [IN] the number of evaluated triggers           *
+ *             threads_num  - [IN] the number of threads used for evaluation  *
+ *             time_eval    - [IN] the evaluation time                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_update_trigger_stats(int triggers_num, int threads_num, double time_eval)
+{
+	zbx_hc_trigger_stats_t	*stats = &cache->trigger_stats;
+
+	LOCK_CACHE;
+
+	stats->batches_num++;
+	stats->triggers_num += (zbx_uint64_t)triggers_num;
+
+	if (1 < threads_num)
+	{
+		stats->parallel_batches_num++;
+		stats->parallel_triggers_num += (zbx_uint64_t)triggers_num;
+	}
+
+	stats->time_total += time_eval;
+
+	if (stats->time_max < time_eval)
+		stats->time_max = time_eval;
+
+	UNLOCK_CACHE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: re-calculate and update values of triggers related to the items   *
@@ -1900,7 +2206,8 @@ static void	recalculate_triggers(const zbx_dc_history_t *history, int history_nu
 		zbx_vector_ptr_t *trigger_diff, zbx_uint64_t *itemids, zbx_timespec_t *timespecs,
 		zbx_hashset_t *trigger_info, zbx_vector_dc_trigger_t *trigger_order)
 {
-	int			i, item_num = 0, timers_num = 0;
+	int			i, item_num = 0, timers_num = 0, threads_num;
+	double			time_start;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1958,7 +2265,11 @@ static void	recalculate_triggers(const zbx_dc_history_t *history, int history_nu
 	}
 
 	zbx_vector_dc_trigger_sort(trigger_order, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
-	zbx_evaluate_expressions(trigger_order, history_itemids, history_items, history_errcodes);
+
+	time_start = zbx_time();
+	threads_num = zbx_evaluate_expressions(trigger_order, history_itemids, history_items, history_errcodes);
+	hc_update_trigger_stats(trigger_order->values_num, threads_num, zbx_time() - time_start);
+
 	process_triggers(trigger_order, add_event_cb, trigger_diff);
 
 	zbx_dc_free_triggers(trigger_order);
@@ -3042,17 +3353,13 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 		*more = ZBX_SYNC_DONE;
 
-		LOCK_CACHE;
 		hc_pop_items(&history_items);		/* select and take items out of history cache */
-		UNLOCK_CACHE;
 
 		if (0 != history_items.values_num)
 		{
 			if (0 == (history_num = zbx_dc_config_lock_triggers_by_history_items(&history_items, &triggerids)))
 			{
-				LOCK_CACHE;
 				hc_push_items(&history_items);
-				UNLOCK_CACHE;
 				zbx_vector_ptr_clear(&history_items);
 			}
 		}
@@ -3110,7 +3417,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 				do
 				{
-					zbx_db_begin();
+					zbx_db_begin_pipeline();
 
 					DBmass_update_trends(trends, trends_num, &trends_diff);
 
@@ -3123,7 +3430,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 				do
 				{
-					zbx_db_begin();
+					zbx_db_begin_pipeline();
 
 					DBmass_update_items(&item_diff, &inventory_values);
 
@@ -3230,9 +3537,7 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 		if (0 != history_num)
 		{
-			LOCK_CACHE;
 			hc_push_items(&history_items);	/* return items to history cache */
-			cache->history_num -= history_num;
 
 			if (0 != hc_queue_get_size())
 			{
@@ -3245,8 +3550,6 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 					*more = ZBX_SYNC_MORE;
 			}
 
-			UNLOCK_CACHE;
-
 			*values_num += history_num;
 		}
 
@@ -3390,12 +3693,12 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
  ******************************************************************************/
 static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 {
-	int			values_num = 0, triggers_num = 0, more;
+	int			values_num = 0, triggers_num = 0, more, i;
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
-	zbx_binary_heap_t	tmp_history_queue;
+	zbx_binary_heap_t	tmp_history_queue[ZBX_HC_SHARDS_MAX];
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	/* History index cache might be full without any space left for queueing items from history index to  */
 	/* history queue. The solution: replace the shared-memory history queue with heap-allocated one. Add  */
@@ -3414,18 +3717,24 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 		zbx_dc_config_unlock_all_triggers();
 	}
 
-	tmp_history_queue = cache->history_queue;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		tmp_history_queue[i] = shard->history_queue;
 
-	zbx_binary_heap_create(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+		zbx_binary_heap_create(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY);
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
 
-	/* add all items from history index to the new history queue */
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL != item->tail)
+		/* add all items from history index to the new history queue */
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
 		{
-			item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-			hc_queue_item(item);
+			if (NULL != item->tail)
+			{
+				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+				hc_queue_item(shard, item);
+			}
 		}
 	}
 
@@ -3438,15 +3747,18 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 			sync_history_cb(&values_num, &triggers_num, events_cbs, &more);
 
 			zabbix_log(LOG_LEVEL_WARNING, "syncing history data... " ZBX_FS_DBL "%%",
-					(double)values_num / (cache->history_num + values_num) * 100);
+					(double)values_num / (hc_get_history_num() + values_num) * 100);
 		}
 		while (0 != hc_queue_get_size());
 
 		zabbix_log(LOG_LEVEL_WARNING, "syncing history data done");
 	}
 
-	zbx_binary_heap_destroy(&cache->history_queue);
-	cache->history_queue = tmp_history_queue;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_binary_heap_destroy(&cache->shards[i].history_queue);
+		cache->shards[i].history_queue = tmp_history_queue[i];
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -3459,7 +3771,9 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 void	zbx_log_sync_history_cache_progress(void)
 {
 	double		pcnt = -1.0;
-	int		ts_last, ts_next, sec;
+	int		ts_last, ts_next, sec, history_num;
+
+	history_num = hc_get_history_num();
 
 	LOCK_CACHE;
 
@@ -3474,16 +3788,16 @@ void	zbx_log_sync_history_cache_progress(void)
 
 	if (0 == cache->history_progress_ts)
 	{
-		cache->history_num_total = cache->history_num;
+		cache->history_num_total = history_num;
 		cache->history_progress_ts = sec;
 	}
 
-	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == cache->history_num)
+	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == history_num)
 	{
 		if (0 != cache->history_num_total)
-			pcnt = 100 * (double)(cache->history_num_total - cache->history_num) / cache->history_num_total;
+			pcnt = 100 * (double)(cache->history_num_total - history_num) / cache->history_num_total;
 
-		cache->history_progress_ts = (0 == cache->history_num ? INT_MAX : sec);
+		cache->history_progress_ts = (0 == history_num ? INT_MAX : sec);
 	}
 
 	ts_next = cache->history_progress_ts;
@@ -3515,7 +3829,8 @@ void	zbx_log_sync_history_cache_progress(void)
  ******************************************************************************/
 void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, int *values_num, int *triggers_num, int *more)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
+		zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	*values_num = 0;
 	*triggers_num = 0;
@@ -4027,140 +4342,682 @@ void	zbx_dc_add_history_variant(zbx_uint64_t itemid, unsigned char value_type, u
 	}
 }
 
-void	zbx_dc_flush_history(void)
-{
-	if (0 == item_values_num)
-		return;
-
-	LOCK_CACHE;
-
-	hc_add_item_values(item_values, item_values_num);
-
-	cache->history_num += item_values_num;
-
-	UNLOCK_CACHE;
-
-	zbx_vps_monitor_add_collected((zbx_uint64_t)item_values_num);
-
-	item_values_num = 0;
-	string_values_offset = 0;
-}
-
 /******************************************************************************
  *                                                                            *
- * history cache storage                                                      *
+ * Purpose: returns index of history cache shard the item belongs to          *
  *                                                                            *
  ******************************************************************************/
-ZBX_SHMEM_FUNC_IMPL(__hc_index, hc_index_mem)
-ZBX_SHMEM_FUNC_IMPL(__hc, hc_mem)
+static int	hc_shard_index(zbx_uint64_t itemid)
+{
+	return (int)(itemid % (zbx_uint64_t)cache->shards_num);
+}
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares history queue elements                                   *
+ * Purpose: adds item values to the specified history cache shard             *
+ *                                                                            *
+ * Parameters: index      - [IN] the shard index                              *
+ *             values     - [IN] the item values to add                       *
+ *             values_num - [IN] the number of item values to add             *
  *                                                                            *
  ******************************************************************************/
-static int	hc_queue_elem_compare_func(const void *d1, const void *d2)
+static void	hc_flush_shard_values(int index, dc_item_value_t *values, int values_num)
 {
-	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
-	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+	zbx_hc_shard_t	*shard;
 
-	const zbx_hc_item_t	*item1 = (const zbx_hc_item_t *)e1->data;
-	const zbx_hc_item_t	*item2 = (const zbx_hc_item_t *)e2->data;
+	shard = hc_shard_lock(index);
 
-	/* compare by timestamp of the oldest value */
-	return zbx_timespec_compare(&item1->tail->ts, &item2->tail->ts);
+	hc_add_item_values(index, values, values_num);
+	shard->history_num += values_num;
+
+	hc_shard_unlock(index);
 }
 
+#if defined(HAVE_ATOMIC_BUILTINS)
 /******************************************************************************
  *                                                                            *
- * Purpose: free history item data allocated in history cache                 *
+ * history ingestion ring                                                     *
  *                                                                            *
- * Parameters: data - [IN] history item data                                  *
+ * Numeric values are passed from data collectors to history cache through a *
+ * bounded lock-free ring. Producers reserve slots by advancing ring head and *
+ * publish them by updating slot sequence. Values are moved from ring into    *
+ * history cache shards by a single consumer holding ring lock - normally a   *
+ * history syncer before popping items, or a producer that needs its values   *
+ * to reach history cache before adding values through the locked path.      *
  *                                                                            *
  ******************************************************************************/
-static void	hc_free_data(zbx_hc_data_t *data)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates history ingestion ring                                  *
+ *                                                                            *
+ * Parameters: ring_size - [IN] the requested number of ring slots            *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was allocated successfully                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_ring_init(int ring_size, char **error)
 {
-	if (ITEM_STATE_NOTSUPPORTED == data->state)
+	zbx_uint64_t	size = ZBX_HC_RING_SIZE_MIN, i;
+	int		ret;
+
+	while (size < (zbx_uint64_t)ring_size)
+		size <<= 1;
+
+	if (SUCCEED != (ret = zbx_mutex_create(&hc_ring_lock, ZBX_MUTEX_CACHE_RING, error)))
+		return ret;
+
+	if (SUCCEED != (ret = zbx_shmem_create_min(&hc_ring_mem, zbx_shmem_required_chunk_size(sizeof(zbx_hc_ring_t)) +
+			zbx_shmem_required_chunk_size(sizeof(zbx_hc_ring_slot_t) * size), "history ingestion ring",
+			"HistoryRingSize", 0, error)))
 	{
-		__hc_shmem_free_func(data->value.str);
+		return ret;
 	}
-	else
-	{
-		if (0 == (data->flags & ZBX_DC_FLAG_NOVALUE))
-		{
-			switch (data->value_type)
-			{
-				case ITEM_VALUE_TYPE_STR:
-				case ITEM_VALUE_TYPE_TEXT:
-				case ITEM_VALUE_TYPE_BIN:
-					__hc_shmem_free_func(data->value.str);
-					break;
-				case ITEM_VALUE_TYPE_LOG:
-					__hc_shmem_free_func(data->value.log->value);
 
-					if (NULL != data->value.log->source)
-						__hc_shmem_free_func(data->value.log->source);
+	hc_ring = (zbx_hc_ring_t *)zbx_shmem_malloc(hc_ring_mem, NULL, sizeof(zbx_hc_ring_t));
+	memset(hc_ring, 0, sizeof(zbx_hc_ring_t));
 
-					__hc_shmem_free_func(data->value.log);
-					break;
-				case ITEM_VALUE_TYPE_UINT64:
-				case ITEM_VALUE_TYPE_FLOAT:
-					break;
-				case ITEM_VALUE_TYPE_NONE:
-				default:
-					THIS_SHOULD_NEVER_HAPPEN;
-					exit(EXIT_FAILURE);
-			}
-		}
+	hc_ring->size = size;
+	hc_ring->mask = size - 1;
+	hc_ring->slots = (zbx_hc_ring_slot_t *)zbx_shmem_malloc(hc_ring_mem, NULL, sizeof(zbx_hc_ring_slot_t) * size);
+
+	for (i = 0; i < size; i++)
+	{
+		hc_ring->slots[i].sequence = i;
+		hc_ring->slots[i].done = 0;
 	}
 
-	__hc_shmem_free_func(data);
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() size:" ZBX_FS_UI64, __func__, size);
+
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: put back item into history queue                                  *
- *                                                                            *
- * Parameters: data - [IN] history item data                                  *
+ * Purpose: frees history ingestion ring                                      *
  *                                                                            *
  ******************************************************************************/
-static void	hc_queue_item(zbx_hc_item_t *item)
+static void	hc_ring_destroy(void)
 {
-	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
+	if (NULL != hc_ring_mem)
+	{
+		zbx_shmem_destroy(hc_ring_mem);
+		hc_ring_mem = NULL;
+		hc_ring = NULL;
+	}
+
+	zbx_mutex_destroy(&hc_ring_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if value can be passed through history ingestion ring      *
+ *                                                                            *
+ * Comments: Only numeric values are passed through ring, so they can be      *
+ *           stored in fixed size slots and added to history cache without    *
+ *           blocking.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_ring_is_value_supported(const dc_item_value_t *item_value)
+{
+	if (ITEM_STATE_NORMAL != item_value->state)
+		return FAIL;
+
+	if (0 != (item_value->flags & (ZBX_DC_FLAG_NOVALUE | ZBX_DC_FLAG_LLD)))
+		return FAIL;
+
+	if (ITEM_VALUE_TYPE_FLOAT != item_value->value_type && ITEM_VALUE_TYPE_UINT64 != item_value->value_type)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to history ingestion ring                              *
+ *                                                                            *
+ * Parameters: item_value - [IN] the value to add                             *
+ *             position   - [OUT] the ring position of added value            *
+ *                                                                            *
+ * Return value: SUCCEED - the value was added                                *
+ *               FAIL    - the ring is full                                   *
+ *                                                                            *
+ * Comments: Slot at position N is free for writing when its sequence is N    *
+ *           and contains published value when its sequence is N + 1. After   *
+ *           consuming the value the sequence is set to N + ring size, making *
+ *           the slot free for the next round.                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_ring_push(const dc_item_value_t *item_value, zbx_uint64_t *position)
+{
+	zbx_hc_ring_slot_t	*slot;
+	zbx_uint64_t		pos, sequence;
+
+	pos = __atomic_load_n(&hc_ring->head, __ATOMIC_RELAXED);
+
+	for (;;)
+	{
+		slot = &hc_ring->slots[pos & hc_ring->mask];
+		sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+		if (sequence == pos)
+		{
+			/* on failure pos is updated with the current head value */
+			if (0 != __atomic_compare_exchange_n(&hc_ring->head, &pos, pos + 1, 1, __ATOMIC_RELAXED,
+					__ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if (sequence < pos)
+			return FAIL;
+		else
+			pos = __atomic_load_n(&hc_ring->head, __ATOMIC_RELAXED);
+	}
+
+	slot->itemid = item_value->itemid;
+	slot->ts = item_value->ts;
+	slot->lastlogsize = item_value->lastlogsize;
+	slot->mtime = item_value->mtime;
+	slot->item_value_type = item_value->item_value_type;
+	slot->value_type = item_value->value_type;
+	slot->flags = item_value->flags;
+	slot->done = 0;
+
+	if (ITEM_VALUE_TYPE_FLOAT == item_value->value_type)
+		slot->value.dbl = item_value->value.value_dbl;
+	else
+		slot->value.ui64 = item_value->value.value_uint;
+
+	__atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+
+	*position = pos;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds ring value to the locked history cache shard without waiting *
+ *          for free space                                                    *
+ *                                                                            *
+ * Parameters: shard - [IN] the locked history cache shard                    *
+ *             slot  - [IN] the ring slot                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the value was added                                *
+ *               FAIL    - history cache is full                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_ring_add_value(zbx_hc_shard_t *shard, const zbx_hc_ring_slot_t *slot)
+{
+	dc_item_value_t	item_value;
+	zbx_hc_data_t	*data = NULL;
+
+	memset(&item_value, 0, sizeof(item_value));
+
+	item_value.itemid = slot->itemid;
+	item_value.ts = slot->ts;
+	item_value.lastlogsize = slot->lastlogsize;
+	item_value.mtime = slot->mtime;
+	item_value.item_value_type = slot->item_value_type;
+	item_value.value_type = slot->value_type;
+	item_value.state = ITEM_STATE_NORMAL;
+	item_value.flags = slot->flags;
+
+	if (ITEM_VALUE_TYPE_FLOAT == slot->value_type)
+		item_value.value.value_dbl = slot->value.dbl;
+	else
+		item_value.value.value_uint = slot->value.ui64;
+
+	/* numeric values are cloned with single allocation, so there is nothing to free on failure */
+	if (SUCCEED != hc_clone_history_data(&shard->stats, &data, &item_value))
+		return FAIL;
+
+	hc_append_item_data(shard, hc_get_item(shard, item_value.itemid), item_value.itemid, data);
+	shard->history_num++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: moves published values from history ingestion ring to history    *
+ *          cache                                                             *
+ *                                                                            *
+ * Return value: SUCCEED - all published values were moved                    *
+ *               FAIL    - history cache is full                              *
+ *                                                                            *
+ * Comments: Must be called with ring lock held. This function does not wait  *
+ *           for free space in history cache - values that cannot be added    *
+ *           are left in ring together with the following values of the same  *
+ *           shard, so the order of item values is kept.                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_ring_drain(void)
+{
+	static zbx_uint64_t	*positions = NULL;
+	zbx_uint64_t		tail, pos, drained_num = 0;
+	zbx_hc_ring_slot_t	*slot;
+	int			i, index, positions_num = 0, ret = SUCCEED;
+
+	if (NULL == positions)
+		positions = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * ZBX_HC_RING_DRAIN_MAX);
+
+	tail = __atomic_load_n(&hc_ring->tail, __ATOMIC_RELAXED);
+
+	for (pos = tail; ZBX_HC_RING_DRAIN_MAX > positions_num; pos++)
+	{
+		slot = &hc_ring->slots[pos & hc_ring->mask];
+
+		if (pos + 1 != __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE))
+			break;
+
+		if (0 == slot->done)
+			positions[positions_num++] = pos;
+	}
+
+	for (index = 0; index < cache->shards_num; index++)
+	{
+		zbx_hc_shard_t	*shard = NULL;
+
+		for (i = 0; i < positions_num; i++)
+		{
+			slot = &hc_ring->slots[positions[i] & hc_ring->mask];
+
+			if (index != hc_shard_index(slot->itemid))
+				continue;
+
+			if (NULL == shard)
+				shard = hc_shard_lock(index);
+
+			if (SUCCEED != hc_ring_add_value(shard, slot))
+			{
+				ret = FAIL;
+				break;
+			}
+
+			slot->done = 1;
+			drained_num++;
+		}
+
+		if (NULL != shard)
+			hc_shard_unlock(index);
+	}
+
+	/* release the consumed slots up to the first value left in ring */
+	for (; tail < pos; tail++)
+	{
+		slot = &hc_ring->slots[tail & hc_ring->mask];
+
+		if (0 == slot->done)
+			break;
+
+		slot->done = 0;
+		__atomic_store_n(&slot->sequence, tail + hc_ring->size, __ATOMIC_RELEASE);
+	}
+
+	__atomic_store_n(&hc_ring->tail, tail, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&hc_ring->drained_num, drained_num, __ATOMIC_RELAXED);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: moves values from history ingestion ring to history cache unless  *
+ *          another process is already doing it                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_ring_try_drain(void)
+{
+	if (__atomic_load_n(&hc_ring->head, __ATOMIC_RELAXED) == __atomic_load_n(&hc_ring->tail, __ATOMIC_RELAXED))
+		return;
+
+	if (SUCCEED != zbx_mutex_trylock(hc_ring_lock))
+		return;
+
+	(void)hc_ring_drain();
+
+	zbx_mutex_unlock(hc_ring_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits until the value at specified ring position is moved to      *
+ *          history cache                                                     *
+ *                                                                            *
+ * Parameters: position - [IN] the ring position                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_ring_wait(zbx_uint64_t position)
+{
+	if (position < __atomic_load_n(&hc_ring->tail, __ATOMIC_ACQUIRE))
+		return;
+
+	__atomic_fetch_add(&hc_ring->waits_num, 1, __ATOMIC_RELAXED);
+
+	for (;;)
+	{
+		int	ret;
+
+		zbx_mutex_lock(hc_ring_lock);
+		ret = hc_ring_drain();
+		zbx_mutex_unlock(hc_ring_lock);
+
+		if (position < __atomic_load_n(&hc_ring->tail, __ATOMIC_ACQUIRE))
+			break;
+
+		if (SUCCEED == ret)
+		{
+			struct timespec	poll_delay = {0, 1e6};
+
+			/* another producer has reserved, but not yet published an earlier slot */
+			nanosleep(&poll_delay, NULL);
+		}
+		else
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "History cache is full. Sleeping for 1 second.");
+			sleep(1);
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds values to history ingestion ring                             *
+ *                                                                            *
+ * Parameters: values     - [IN] the values to add                            *
+ *             values_num - [IN] the number of values                         *
+ *                                                                            *
+ * Return value: The number of values added to ring. The remaining values     *
+ *               must be added to history cache through the locked path.      *
+ *                                                                            *
+ * Comments: Before returning with values left, this function waits until all *
+ *           values this process has added to ring reach history cache, so    *
+ *           values of the same item are not stored out of order.             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	hc_ring_flush_values(const dc_item_value_t *values, size_t values_num)
+{
+	size_t	i;
+
+	for (i = 0; i < values_num; i++)
+	{
+		if (SUCCEED != hc_ring_is_value_supported(&values[i]))
+			break;
+
+		if (SUCCEED != hc_ring_push(&values[i], &hc_ring_position))
+		{
+			__atomic_fetch_add(&hc_ring->full_num, 1, __ATOMIC_RELAXED);
+			break;
+		}
+
+		hc_ring_position_set = SUCCEED;
+	}
+
+	if (0 != i)
+		__atomic_fetch_add(&hc_ring->pushed_num, (zbx_uint64_t)i, __ATOMIC_RELAXED);
+
+	if (i != values_num && SUCCEED == hc_ring_position_set)
+	{
+		hc_ring_wait(hc_ring_position);
+		hc_ring_position_set = FAIL;
+	}
+
+	return i;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item values to history cache, locking each affected shard    *
+ *          once                                                              *
+ *                                                                            *
+ * Parameters: values     - [IN] the values to add                            *
+ *             values_num - [IN] the number of values                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_flush_values(dc_item_value_t *values, size_t values_num)
+{
+	if (1 == cache->shards_num)
+	{
+		hc_flush_shard_values(0, values, (int)values_num);
+	}
+	else
+	{
+		static dc_item_value_t	*shard_values = NULL;
+		static size_t		shard_values_alloc = 0;
+		int			offsets[ZBX_HC_SHARDS_MAX + 1], i, start;
+		size_t			j;
+
+		if (shard_values_alloc < values_num)
+		{
+			shard_values_alloc = values_num;
+			shard_values = (dc_item_value_t *)zbx_realloc(shard_values,
+					sizeof(dc_item_value_t) * shard_values_alloc);
+		}
+
+		/* group values by shards keeping the order of values within shard, */
+		/* so each shard is locked only once per flush                      */
+		memset(offsets, 0, sizeof(offsets));
+
+		for (j = 0; j < values_num; j++)
+			offsets[hc_shard_index(values[j].itemid) + 1]++;
+
+		for (i = 0; i < cache->shards_num; i++)
+			offsets[i + 1] += offsets[i];
+
+		for (j = 0; j < values_num; j++)
+			shard_values[offsets[hc_shard_index(values[j].itemid)]++] = values[j];
+
+		for (i = 0, start = 0; i < cache->shards_num; i++)
+		{
+			if (start != offsets[i])
+				hc_flush_shard_values(i, shard_values + start, offsets[i] - start);
+
+			start = offsets[i];
+		}
+	}
+}
+
+void	zbx_dc_flush_history(void)
+{
+	size_t	values_offset = 0;
+
+	if (0 == item_values_num)
+		return;
+
+#if defined(HAVE_ATOMIC_BUILTINS)
+	if (NULL != hc_ring)
+		values_offset = hc_ring_flush_values(item_values, item_values_num);
+#endif
+	if (values_offset != item_values_num)
+		hc_flush_values(item_values + values_offset, item_values_num - values_offset);
+
+	zbx_vps_monitor_add_collected((zbx_uint64_t)item_values_num);
+
+	item_values_num = 0;
+	string_values_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * history cache storage                                                      *
+ *                                                                            *
+ ******************************************************************************/
+ZBX_SHMEM_FUNC_IMPL(__hc_index, hc_index_mem)
+ZBX_SHMEM_FUNC_IMPL(__hc_shard_index, hc_shard_index_mem)
+ZBX_SHMEM_FUNC_IMPL(__hc, hc_mem)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locks history cache shard and selects its memory for allocations  *
+ *                                                                            *
+ * Parameters: index - [IN] the shard index                                   *
+ *                                                                            *
+ * Return value: the locked shard                                             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_hc_shard_t	*hc_shard_lock(int index)
+{
+	zbx_hc_shard_t	*shard = &cache->shards[index];
+
+	if (SUCCEED != zbx_mutex_trylock(hc_shard_locks[index]))
+	{
+		zbx_mutex_lock(hc_shard_locks[index]);
+		shard->locks_contended++;
+	}
+
+	shard->locks_num++;
+
+	hc_mem = hc_shards_mem[index];
+	hc_shard_index_mem = hc_shards_index_mem[index];
+
+	return shard;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unlocks history cache shard                                       *
+ *                                                                            *
+ * Parameters: index - [IN] the shard index                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_shard_unlock(int index)
+{
+	zbx_mutex_unlock(hc_shard_locks[index]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the number of values in history cache                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_get_history_num(void)
+{
+	int	i, history_num = 0;
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		history_num += hc_shard_lock(i)->history_num;
+		hc_shard_unlock(i);
+	}
+
+	return history_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares history queue elements                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_queue_elem_compare_func(const void *d1, const void *d2)
+{
+	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
+	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+
+	const zbx_hc_item_t	*item1 = (const zbx_hc_item_t *)e1->data;
+	const zbx_hc_item_t	*item2 = (const zbx_hc_item_t *)e2->data;
 
-	zbx_binary_heap_insert(&cache->history_queue, &elem);
+	/* compare by timestamp of the oldest value */
+	return zbx_timespec_compare(&item1->tail->ts, &item2->tail->ts);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free history item data allocated in history cache                 *
+ *                                                                            *
+ * Parameters: data - [IN] history item data                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_free_data(zbx_hc_data_t *data)
+{
+	if (ITEM_STATE_NOTSUPPORTED == data->state)
+	{
+		__hc_shmem_free_func(data->value.str);
+	}
+	else
+	{
+		if (0 == (data->flags & ZBX_DC_FLAG_NOVALUE))
+		{
+			switch (data->value_type)
+			{
+				case ITEM_VALUE_TYPE_STR:
+				case ITEM_VALUE_TYPE_TEXT:
+				case ITEM_VALUE_TYPE_BIN:
+					__hc_shmem_free_func(data->value.str);
+					break;
+				case ITEM_VALUE_TYPE_LOG:
+					__hc_shmem_free_func(data->value.log->value);
+
+					if (NULL != data->value.log->source)
+						__hc_shmem_free_func(data->value.log->source);
+
+					__hc_shmem_free_func(data->value.log);
+					break;
+				case ITEM_VALUE_TYPE_UINT64:
+				case ITEM_VALUE_TYPE_FLOAT:
+					break;
+				case ITEM_VALUE_TYPE_NONE:
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	__hc_shmem_free_func(data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: put back item into history queue                                  *
+ *                                                                            *
+ * Parameters: shard - [IN] the history cache shard                           *
+ *             item  - [IN] history item                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item)
+{
+	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
+
+	zbx_binary_heap_insert(&shard->history_queue, &elem);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: returns history item by itemid                                    *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
+ * Parameters: shard  - [IN] the history cache shard                          *
+ *             itemid - [IN] the item id                                      *
  *                                                                            *
  * Return value: the history item or NULL if the requested item is not in     *
  *               history cache                                                *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_get_item(zbx_uint64_t itemid)
+static zbx_hc_item_t	*hc_get_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid)
 {
-	return (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid);
+	return (zbx_hc_item_t *)zbx_hashset_search(&shard->history_items, &itemid);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: adds a new item to history cache                                  *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
- *                      [IN] the item data                                    *
+ * Parameters: shard  - [IN] the history cache shard                          *
+ *             itemid - [IN] the item id                                      *
+ *             data   - [IN] the item data                                    *
  *                                                                            *
  * Return value: the added history item                                       *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
+static zbx_hc_item_t	*hc_add_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid, zbx_hc_data_t *data)
 {
 	zbx_hc_item_t	item_local = {itemid, ZBX_HC_ITEM_STATUS_NORMAL, 0, data, data};
 
-	return (zbx_hc_item_t *)zbx_hashset_insert(&cache->history_items, &item_local, sizeof(item_local));
+	return (zbx_hc_item_t *)zbx_hashset_insert(&shard->history_items, &item_local, sizeof(item_local));
 }
 
 /******************************************************************************
@@ -4257,7 +5114,8 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *                                                                            *
  * Purpose: clones item value from local cache into history cache             *
  *                                                                            *
- * Parameters: data       - [IN/OUT] a reference to the cloned value          *
+ * Parameters: stats      - [IN/OUT] the history cache shard statistics      *
+ *             data       - [IN/OUT] a reference to the cloned value          *
  *             item_value - [IN] the item value                               *
  *                                                                            *
  * Return value: SUCCESS - the item value was cloned successfully             *
@@ -4267,7 +5125,7 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *           until it finishes cloning item value.                            *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *item_value)
+static int	hc_clone_history_data(zbx_dc_stats_t *stats, zbx_hc_data_t **data, const dc_item_value_t *item_value)
 {
 	if (NULL == *data)
 	{
@@ -4293,7 +5151,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 			return FAIL;
 
 		(*data)->value_type = item_value->value_type;
-		cache->stats.notsupported_counter++;
+		stats->notsupported_counter++;
 
 		return SUCCEED;
 	}
@@ -4305,8 +5163,8 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 
 		(*data)->value_type = ITEM_VALUE_TYPE_TEXT;
 
-		cache->stats.history_text_counter++;
-		cache->stats.history_counter++;
+		stats->history_text_counter++;
+		stats->history_counter++;
 
 		return SUCCEED;
 	}
@@ -4343,22 +5201,22 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 		switch (item_value->item_value_type)
 		{
 			case ITEM_VALUE_TYPE_FLOAT:
-				cache->stats.history_float_counter++;
+				stats->history_float_counter++;
 				break;
 			case ITEM_VALUE_TYPE_UINT64:
-				cache->stats.history_uint_counter++;
+				stats->history_uint_counter++;
 				break;
 			case ITEM_VALUE_TYPE_STR:
-				cache->stats.history_str_counter++;
+				stats->history_str_counter++;
 				break;
 			case ITEM_VALUE_TYPE_TEXT:
-				cache->stats.history_text_counter++;
+				stats->history_text_counter++;
 				break;
 			case ITEM_VALUE_TYPE_LOG:
-				cache->stats.history_log_counter++;
+				stats->history_log_counter++;
 				break;
 			case ITEM_VALUE_TYPE_BIN:
-				cache->stats.history_bin_counter++;
+				stats->history_bin_counter++;
 				break;
 			case ITEM_VALUE_TYPE_NONE:
 			default:
@@ -4366,7 +5224,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 				exit(EXIT_FAILURE);
 		}
 
-		cache->stats.history_counter++;
+		stats->history_counter++;
 	}
 
 	(*data)->value_type = item_value->value_type;
@@ -4374,11 +5232,39 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends cloned value to history cache item                        *
+ *                                                                            *
+ * Parameters: shard  - [IN] the locked history cache shard                   *
+ *             item   - [IN] the history cache item, NULL if item is not      *
+ *                           cached yet                                       *
+ *             itemid - [IN] the item identifier                              *
+ *             data   - [IN] the cloned value                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_append_item_data(zbx_hc_shard_t *shard, zbx_hc_item_t *item, zbx_uint64_t itemid,
+		zbx_hc_data_t *data)
+{
+	if (NULL == item)
+	{
+		item = hc_add_item(shard, itemid, data);
+		hc_queue_item(shard, item);
+	}
+	else
+	{
+		item->head->next = data;
+		item->head = data;
+	}
+	item->values_num++;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds item values to the history cache                             *
  *                                                                            *
- * Parameters: values     - [IN] the item values to add                       *
+ * Parameters: index      - [IN] the locked history cache shard index         *
+ *             values     - [IN] the item values to add                       *
  *             values_num - [IN] the number of item values to add             *
  *                                                                            *
  * Comments: If the history cache is full this function will wait until       *
@@ -4386,11 +5272,12 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
  *           the new value.                                                   *
  *                                                                            *
  ******************************************************************************/
-static void	hc_add_item_values(dc_item_value_t *values, int values_num)
+static void	hc_add_item_values(int index, dc_item_value_t *values, int values_num)
 {
 	dc_item_value_t	*item_value;
 	int		i;
 	zbx_hc_item_t	*item;
+	zbx_hc_shard_t	*shard = &cache->shards[index];
 
 	for (i = 0; i < values_num; i++)
 	{
@@ -4400,7 +5287,8 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 
 		/* a record with metadata and no value can be dropped if  */
 		/* the metadata update is copied to the last queued value */
-		if (NULL != (item = hc_get_item(item_value->itemid)) && 0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
+		if (NULL != (item = hc_get_item(shard, item_value->itemid)) &&
+				0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
 		{
 			/* skip metadata updates when only one value is queued, */
 			/* because the item might be already being processed    */
@@ -4417,33 +5305,23 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 			}
 		}
 
-		if (SUCCEED != hc_clone_history_data(&data, item_value))
+		if (SUCCEED != hc_clone_history_data(&shard->stats, &data, item_value))
 		{
 			do
 			{
-				UNLOCK_CACHE;
+				hc_shard_unlock(index);
 
 				zabbix_log(LOG_LEVEL_DEBUG, "History cache is full. Sleeping for 1 second.");
 				sleep(1);
 
-				LOCK_CACHE;
+				shard = hc_shard_lock(index);
 			}
-			while (SUCCEED != hc_clone_history_data(&data, item_value));
+			while (SUCCEED != hc_clone_history_data(&shard->stats, &data, item_value));
 
-			item = hc_get_item(item_value->itemid);
+			item = hc_get_item(shard, item_value->itemid);
 		}
 
-		if (NULL == item)
-		{
-			item = hc_add_item(item_value->itemid, data);
-			hc_queue_item(item);
-		}
-		else
-		{
-			item->head->next = data;
-			item->head = data;
-		}
-		item->values_num++;
+		hc_append_item_data(shard, item, item_value->itemid, data);
 	}
 }
 
@@ -4522,21 +5400,47 @@ static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid,
  *                                                                            *
  * Comments: The history_items must be returned back to history cache with    *
  *           hc_push_items() function after they have been processed.         *
+ *           Shards are visited in round robin order starting with a          *
+ *           different shard on each call, so syncers do not compete for the  *
+ *           same shard lock.                                                 *
  *                                                                            *
  ******************************************************************************/
 void	hc_pop_items(zbx_vector_ptr_t *history_items)
 {
+	static int		shard_next = -1;
 	zbx_binary_heap_elem_t	*elem;
 	zbx_hc_item_t		*item;
+	int			i;
 
-	while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(&cache->history_queue))
+	if (-1 == shard_next)
+		shard_next = (int)(getpid() % cache->shards_num);
+
+#if defined(HAVE_ATOMIC_BUILTINS)
+	if (NULL != hc_ring)
+		hc_ring_try_drain();
+#endif
+
+	for (i = 0; i < cache->shards_num && ZBX_HC_SYNC_MAX > history_items->values_num; i++)
 	{
-		elem = zbx_binary_heap_find_min(&cache->history_queue);
-		item = (zbx_hc_item_t *)elem->data;
-		zbx_vector_ptr_append(history_items, item);
+		int		index = (shard_next + i) % cache->shards_num;
+		zbx_hc_shard_t	*shard;
+
+		shard = hc_shard_lock(index);
+
+		while (ZBX_HC_SYNC_MAX > history_items->values_num &&
+				FAIL == zbx_binary_heap_empty(&shard->history_queue))
+		{
+			elem = zbx_binary_heap_find_min(&shard->history_queue);
+			item = (zbx_hc_item_t *)elem->data;
+			zbx_vector_ptr_append(history_items, item);
+
+			zbx_binary_heap_remove_min(&shard->history_queue);
+		}
 
-		zbx_binary_heap_remove_min(&cache->history_queue);
+		hc_shard_unlock(index);
 	}
+
+	shard_next = (shard_next + 1) % cache->shards_num;
 }
 
 /******************************************************************************
@@ -4579,32 +5483,47 @@ void	hc_get_item_values(zbx_dc_history_t *history, zbx_vector_ptr_t *history_ite
  ******************************************************************************/
 void	hc_push_items(zbx_vector_ptr_t *history_items)
 {
-	int		i;
+	int		i, index;
 	zbx_hc_item_t	*item;
 	zbx_hc_data_t	*data_free;
 
-	for (i = 0; i < history_items->values_num; i++)
+	for (index = 0; index < cache->shards_num; index++)
 	{
-		item = (zbx_hc_item_t *)history_items->values[i];
+		zbx_hc_shard_t	*shard = NULL;
 
-		switch (item->status)
+		for (i = 0; i < history_items->values_num; i++)
 		{
-			case ZBX_HC_ITEM_STATUS_BUSY:
-				/* reset item status before returning it to queue */
-				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-				hc_queue_item(item);
-				break;
-			case ZBX_HC_ITEM_STATUS_NORMAL:
-				item->values_num--;
-				data_free = item->tail;
-				item->tail = item->tail->next;
-				hc_free_data(data_free);
-				if (NULL == item->tail)
-					zbx_hashset_remove(&cache->history_items, item);
-				else
-					hc_queue_item(item);
-				break;
+			item = (zbx_hc_item_t *)history_items->values[i];
+
+			if (index != hc_shard_index(item->itemid))
+				continue;
+
+			if (NULL == shard)
+				shard = hc_shard_lock(index);
+
+			switch (item->status)
+			{
+				case ZBX_HC_ITEM_STATUS_BUSY:
+					/* reset item status before returning it to queue */
+					item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+					hc_queue_item(shard, item);
+					break;
+				case ZBX_HC_ITEM_STATUS_NORMAL:
+					item->values_num--;
+					shard->history_num--;
+					data_free = item->tail;
+					item->tail = item->tail->next;
+					hc_free_data(data_free);
+					if (NULL == item->tail)
+						zbx_hashset_remove(&shard->history_items, item);
+					else
+						hc_queue_item(shard, item);
+					break;
+			}
 		}
+
+		if (NULL != shard)
+			hc_shard_unlock(index);
 	}
 }
 
@@ -4615,7 +5534,24 @@ void	hc_push_items(zbx_vector_ptr_t *history_items)
  ******************************************************************************/
 int	hc_queue_get_size(void)
 {
-	return cache->history_queue.elems_num;
+	int	i, size = 0;
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		size += hc_shard_lock(i)->history_queue.elems_num;
+		hc_shard_unlock(i);
+	}
+
+#if defined(HAVE_ATOMIC_BUILTINS)
+	/* values waiting in ring will be added to history queue by the next pop */
+	if (NULL != hc_ring)
+	{
+		size += (int)(__atomic_load_n(&hc_ring->head, __ATOMIC_RELAXED) -
+				__atomic_load_n(&hc_ring->tail, __ATOMIC_RELAXED));
+	}
+#endif
+
+	return size;
 }
 
 int	hc_get_history_compression_age(void)
@@ -4692,10 +5628,10 @@ out:
  *                                                                            *
  ******************************************************************************/
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history_sync_f sync_history,
-		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size,zbx_uint64_t *trends_cache_size,
-		char **error)
+		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size, int history_cache_shards,
+		int history_ring_size, zbx_uint64_t *trends_cache_size, char **error)
 {
-	int	ret;
+	int	ret, i;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -4714,30 +5650,91 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history
 	if (SUCCEED != (ret = zbx_mutex_create(&cache_ids_lock, ZBX_MUTEX_CACHE_IDS, error)))
 		goto out;
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_mem, history_cache_size, "history cache",
-			"HistoryCacheSize", 1, error)))
+	if (1 > history_cache_shards || ZBX_HC_SHARDS_MAX < history_cache_shards)
 	{
+		*error = zbx_dsprintf(*error, "invalid number of history cache shards %d", history_cache_shards);
+		ret = FAIL;
 		goto out;
 	}
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem, history_index_cache_size, "history index cache",
-			"HistoryIndexCacheSize", 0, error)))
+	if (ZBX_HC_SHARD_MIN_SIZE > history_cache_size / (zbx_uint64_t)history_cache_shards ||
+			ZBX_HC_SHARD_MIN_SIZE > history_index_cache_size / (zbx_uint64_t)history_cache_shards)
 	{
+		*error = zbx_dsprintf(*error, "HistoryCacheSize and HistoryIndexCacheSize must be at least "
+				ZBX_FS_UI64 " bytes per history cache shard", (zbx_uint64_t)ZBX_HC_SHARD_MIN_SIZE);
+		ret = FAIL;
 		goto out;
 	}
 
+	/* the first shard is protected by cache lock and its index is stored together with other */
+	/* history cache data, so the unsharded cache stays the same as before sharding           */
+	hc_shard_locks[0] = cache_lock;
+
+	for (i = 0; i < history_cache_shards; i++)
+	{
+		if (0 != i && SUCCEED != (ret = zbx_mutex_create(&hc_shard_locks[i], ZBX_MUTEX_CACHE_SHARD + i - 1,
+				error)))
+		{
+			goto out;
+		}
+
+		if (SUCCEED != (ret = zbx_shmem_create(&hc_shards_mem[i],
+				history_cache_size / (zbx_uint64_t)history_cache_shards, "history cache",
+				"HistoryCacheSize", 1, error)))
+		{
+			goto out;
+		}
+
+		if (SUCCEED != (ret = zbx_shmem_create(&hc_shards_index_mem[i],
+				history_index_cache_size / (zbx_uint64_t)history_cache_shards, "history index cache",
+				"HistoryIndexCacheSize", 0, error)))
+		{
+			goto out;
+		}
+	}
+
+	hc_index_mem = hc_shards_index_mem[0];
+
 	cache = (ZBX_DC_CACHE *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
 	memset(cache, 0, sizeof(ZBX_DC_CACHE));
 
 	ids = (ZBX_DC_IDS *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
 	memset(ids, 0, sizeof(ZBX_DC_IDS));
 
-	zbx_hashset_create_ext(&cache->history_items, ZBX_HC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+	cache->shards_num = history_cache_shards;
+	cache->shards = (zbx_hc_shard_t *)__hc_index_shmem_malloc_func(NULL,
+			sizeof(zbx_hc_shard_t) * (size_t)history_cache_shards);
+	memset(cache->shards, 0, sizeof(zbx_hc_shard_t) * (size_t)history_cache_shards);
 
-	zbx_binary_heap_create_ext(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+	for (i = 0; i < history_cache_shards; i++)
+	{
+		zbx_hc_shard_t	*shard = &cache->shards[i];
+
+		hc_shard_index_mem = hc_shards_index_mem[i];
+
+		zbx_hashset_create_ext(&shard->history_items, ZBX_HC_ITEMS_INIT_SIZE,
+				ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+				__hc_shard_index_shmem_malloc_func, __hc_shard_index_shmem_realloc_func,
+				__hc_shard_index_shmem_free_func);
+
+		zbx_binary_heap_create_ext(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY, __hc_shard_index_shmem_malloc_func,
+				__hc_shard_index_shmem_realloc_func, __hc_shard_index_shmem_free_func);
+	}
+
+	hc_mem = hc_shards_mem[0];
+	hc_shard_index_mem = hc_shards_index_mem[0];
+
+	if (0 != history_ring_size)
+	{
+#if defined(HAVE_ATOMIC_BUILTINS)
+		if (SUCCEED != (ret = hc_ring_init(history_ring_size, error)))
+			goto out;
+#else
+		zabbix_log(LOG_LEVEL_WARNING, "history ingestion ring is disabled: atomic operations are not"
+				" supported");
+#endif
+	}
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
@@ -4791,16 +5788,31 @@ static void	DCsync_all(const zbx_events_funcs_t *events_cbs)
  ******************************************************************************/
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs)
 {
+	int	i;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (ZBX_SYNC_ALL == sync)
 		DCsync_all(events_cbs);
 
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_shmem_destroy(hc_shards_mem[i]);
+		hc_shards_mem[i] = NULL;
+		zbx_shmem_destroy(hc_shards_index_mem[i]);
+		hc_shards_index_mem[i] = NULL;
+
+		if (0 != i)
+			zbx_mutex_destroy(&hc_shard_locks[i]);
+	}
+
+#if defined(HAVE_ATOMIC_BUILTINS)
+	hc_ring_destroy();
+#endif
 	cache = NULL;
 
-	zbx_shmem_destroy(hc_mem);
 	hc_mem = NULL;
-	zbx_shmem_destroy(hc_index_mem);
+	hc_shard_index_mem = NULL;
 	hc_index_mem = NULL;
 
 	zbx_mutex_destroy(&cache_lock);
@@ -4917,21 +5929,121 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+ZBX_VECTOR_IMPL(hc_shard_stats, zbx_hc_shard_stats_t)
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get history cache diagnostics statistics                          *
  *                                                                            *
+ * Parameters: items_num  - [OUT] the number of cached items                  *
+ *             values_num - [OUT] the number of cached values                 *
+ *             shards     - [OUT] the per shard statistics (optional)         *
+ *                                                                            *
  ******************************************************************************/
-void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
+void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num,
+		zbx_vector_hc_shard_stats_t *shards)
 {
-	LOCK_CACHE;
+	int	i;
+
+	*items_num = 0;
+	*values_num = 0;
+
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t		*shard;
+		zbx_hc_shard_stats_t	stats;
+
+		shard = hc_shard_lock(i);
+
+		stats.items_num = (zbx_uint64_t)shard->history_items.num_data;
+		stats.values_num = (zbx_uint64_t)shard->history_num;
+		stats.locks_num = shard->locks_num;
+		stats.locks_contended = shard->locks_contended;
+
+		hc_shard_unlock(i);
+
+		*items_num += stats.items_num;
+		*values_num += stats.values_num;
+
+		if (NULL != shards)
+			zbx_vector_hc_shard_stats_append(shards, stats);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get history ingestion ring diagnostic statistics                  *
+ *                                                                            *
+ * Parameters: stats - [OUT] the ring statistics                              *
+ *                                                                            *
+ * Return value: SUCCEED - the statistics were returned                       *
+ *               FAIL    - the ring is disabled                               *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_hc_get_ring_stats(zbx_hc_ring_stats_t *stats)
+{
+#if defined(HAVE_ATOMIC_BUILTINS)
+	if (NULL == hc_ring)
+		return FAIL;
+
+	stats->size = hc_ring->size;
+	stats->values_num = __atomic_load_n(&hc_ring->head, __ATOMIC_RELAXED) -
+			__atomic_load_n(&hc_ring->tail, __ATOMIC_RELAXED);
+	stats->pushed_num = __atomic_load_n(&hc_ring->pushed_num, __ATOMIC_RELAXED);
+	stats->drained_num = __atomic_load_n(&hc_ring->drained_num, __ATOMIC_RELAXED);
+	stats->full_num = __atomic_load_n(&hc_ring->full_num, __ATOMIC_RELAXED);
+	stats->waits_num = __atomic_load_n(&hc_ring->waits_num, __ATOMIC_RELAXED);
+
+	return SUCCEED;
+#else
+	ZBX_UNUSED(stats);
 
-	*values_num = cache->history_num;
-	*items_num = cache->history_items.num_data;
+	return FAIL;
+#endif
+}
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get trigger recalculation statistics                              *
+ *                                                                            *
+ * Parameters: stats - [OUT] the trigger recalculation statistics             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hc_get_trigger_stats(zbx_hc_trigger_stats_t *stats)
+{
+	LOCK_CACHE;
+	*stats = cache->trigger_stats;
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds shared memory allocator statistics                           *
+ *                                                                            *
+ * Parameters: total - [IN/OUT] the total statistics                          *
+ *             stats - [IN] the statistics to add                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_shmem_stats_add(zbx_shmem_stats_t *total, const zbx_shmem_stats_t *stats)
+{
+	int	i;
+
+	if (0 == total->used_chunks + total->free_chunks || stats->min_chunk_size < total->min_chunk_size)
+		total->min_chunk_size = stats->min_chunk_size;
+
+	if (stats->max_chunk_size > total->max_chunk_size)
+		total->max_chunk_size = stats->max_chunk_size;
+
+	total->free_size += stats->free_size;
+	total->used_size += stats->used_size;
+	total->overhead += stats->overhead;
+	total->free_chunks += stats->free_chunks;
+	total->used_chunks += stats->used_chunks;
+
+	for (i = 0; i < ZBX_SHMEM_BUCKET_COUNT; i++)
+		total->chunks_num[i] += stats->chunks_num[i];
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get shared memory allocator statistics                            *
@@ -4939,15 +6051,33 @@ void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
  ******************************************************************************/
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index)
 {
-	LOCK_CACHE;
+	int			i;
+	zbx_shmem_stats_t	stats;
 
 	if (NULL != data)
-		zbx_shmem_get_stats(hc_mem, data);
+		memset(data, 0, sizeof(zbx_shmem_stats_t));
 
 	if (NULL != index)
-		zbx_shmem_get_stats(hc_index_mem, index);
+		memset(index, 0, sizeof(zbx_shmem_stats_t));
 
-	UNLOCK_CACHE;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		(void)hc_shard_lock(i);
+
+		if (NULL != data)
+		{
+			zbx_shmem_get_stats(hc_mem, &stats);
+			hc_shmem_stats_add(data, &stats);
+		}
+
+		if (NULL != index)
+		{
+			zbx_shmem_get_stats(hc_shard_index_mem, &stats);
+			hc_shmem_stats_add(index, &stats);
+		}
+
+		hc_shard_unlock(i);
+	}
 }
 
 /******************************************************************************
@@ -4959,19 +6089,25 @@ void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items)
 {
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
+	int			i;
 
-	LOCK_CACHE;
+	for (i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard;
 
-	zbx_vector_uint64_pair_reserve(items, cache->history_items.num_data);
+		shard = hc_shard_lock(i);
 
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
-		zbx_vector_uint64_pair_append_ptr(items, &pair);
-	}
+		zbx_vector_uint64_pair_reserve(items, (size_t)(items->values_num + shard->history_items.num_data));
 
-	UNLOCK_CACHE;
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
+		{
+			zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
+			zbx_vector_uint64_pair_append_ptr(items, &pair);
+		}
+
+		hc_shard_unlock(i);
+	}
 }
 
 /******************************************************************************
@@ -5084,14 +6220,16 @@ static void	zbx_hc_proxyqueue_clear(void)
  ******************************************************************************/
 int	zbx_hc_check_proxy(zbx_uint64_t proxyid)
 {
-	double	hc_pused;
-	int	ret;
+	double			hc_pused;
+	int			ret;
+	zbx_wcache_info_t	wcache_info;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() proxyid:"ZBX_FS_UI64, __func__, proxyid);
 
-	LOCK_CACHE;
+	zbx_dc_get_stats_all(&wcache_info);
+	hc_pused = 100 * (double)(wcache_info.history_total - wcache_info.history_free) / wcache_info.history_total;
 
-	hc_pused = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+	LOCK_CACHE;
 
 	if (20 >= hc_pused)
 	{
@@ -5142,23 +6280,3 @@ out:
 
 	return ret;
 }
-
-void	dbcache_lock(void)
-{
-	LOCK_CACHE;
-}
-
-void	dbcache_unlock(void)
-{
-	UNLOCK_CACHE;
-}
-
-void	dbcache_set_history_num(int num)
-{
-	cache->history_num = num;
-}
-
-int	dbcache_get_history_num(void)
-{
-	return cache->history_num;
-}
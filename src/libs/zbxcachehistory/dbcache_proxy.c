@@ -380,13 +380,9 @@ void	zbx_sync_proxy_history(int *values_num, int *triggers_num, const zbx_events
 	{
 		*more = ZBX_SYNC_DONE;
 
-		dbcache_lock();
-
 		hc_pop_items(&history_items);		/* select and take items out of history cache */
 		history_num = history_items.values_num;
 
-		dbcache_unlock();
-
 		if (0 == history_num)
 			break;
 
@@ -405,8 +401,6 @@ void	zbx_sync_proxy_history(int *values_num, int *triggers_num, const zbx_events
 			while (ZBX_DB_DOWN == (txn_rc = zbx_db_commit()));
 		}
 
-		dbcache_lock();
-
 		hc_push_items(&history_items);	/* return items to history cache */
 
 		if (ZBX_DB_FAIL != txn_rc)
@@ -414,22 +408,15 @@ void	zbx_sync_proxy_history(int *values_num, int *triggers_num, const zbx_events
 			if (0 != item_diff.values_num)
 				zbx_dc_config_items_apply_changes(&item_diff);
 
-			dbcache_set_history_num(dbcache_get_history_num() - history_num);
-
 			if (0 != hc_queue_get_size())
 				*more = ZBX_SYNC_MORE;
 
-			dbcache_unlock();
-
 			*values_num += history_num;
 
 			hc_free_item_values(history, history_num);
 		}
 		else
-		{
 			*more = ZBX_SYNC_MORE;
-			dbcache_unlock();
-		}
 
 		zbx_vector_ptr_clear(&history_items);
 		zbx_vector_ptr_clear_ext(&item_diff, zbx_default_mem_free_func);
@@ -23,6 +23,8 @@
 #include "zbxtime.h"
 #include "zbxvariant.h"
 
+#include <sys/mman.h>
+
 /*
  * The cache (zbx_vc_cache_t) is organized as a hashset of item records (zbx_vc_item_t).
  *
@@ -113,6 +115,46 @@ zbx_vc_chunk_t;
 #define ZBX_VC_MAX_CHUNK_RECORDS	((64 * ZBX_KIBIBYTE - sizeof(zbx_vc_chunk_t)) / \
 		sizeof(zbx_history_record_t) + 1)
 
+/* the maximum number of incremental aggregates kept for an item */
+#define ZBX_VC_ITEM_AGGREGATES_MAX	8
+
+/* incrementally maintained aggregate of item values in a sliding time window */
+typedef struct zbx_vc_aggregate
+{
+	/* the next aggregate of the same item */
+	struct zbx_vc_aggregate	*next;
+
+	/* the aggregate function (ZBX_VC_FUNCTION_*) */
+	int			func;
+
+	/* the window length in seconds */
+	int			seconds;
+
+	/* the end of window at the last calculation, the window is (end - seconds, end] */
+	zbx_timespec_t		end;
+
+	/* The time when the aggregate must be recalculated from cached values to */
+	/* avoid accumulating rounding errors of floating point sums.             */
+	int			rebuild_time;
+
+	/* the last time the aggregate was used, the least used aggregate is */
+	/* replaced when item has too many aggregates                        */
+	int			last_accessed;
+
+	/* the number of values in window, -1 if the aggregate must be recalculated */
+	int			values_num;
+
+	/* the sum, minimum or maximum value */
+	zbx_history_value_t	value;
+
+	/* the lost low order bits of floating point sum (Kahan summation) */
+	double			compensation;
+
+	/* the timestamp of minimum or maximum value */
+	zbx_timespec_t		value_ts;
+}
+zbx_vc_aggregate_t;
+
 /* the value cache item data */
 typedef struct
 {
@@ -175,9 +217,81 @@ typedef struct
 
 	/* the first (oldest) chunk of item history data              */
 	zbx_vc_chunk_t	*tail;
+
+	/* The last removed chunk kept for reuse. When the item range */
+	/* is stable the chunks are rotated from tail to head without */
+	/* allocating and freeing cache memory for every new chunk.   */
+	zbx_vc_chunk_t	*spare;
+
+	/* The incremental aggregates of item values. Instead of      */
+	/* iterating all values in window on every request only the   */
+	/* values entering and leaving window since the last request  */
+	/* are processed.                                             */
+	zbx_vc_aggregate_t	*aggregates;
 }
 zbx_vc_item_t;
 
+/* value cache snapshot file format version and markers */
+#define ZBX_VC_SNAPSHOT_MAGIC		"ZBXVCSNP"
+#define ZBX_VC_SNAPSHOT_VERSION		1
+#define ZBX_VC_SNAPSHOT_BYTE_ORDER	__UINT64_C(0x0102030405060708)
+
+#define VC_SNAPSHOT_ALIGN(size)		(((size) + 7) & ~(size_t)7)
+
+/*
+ * The snapshot file starts with a header followed by item blocks. Each item block consists
+ * of item header, item values in zbx_history_record_t layout and, for string and log items,
+ * of log records and strings. String and log values are stored as offsets from the item
+ * block start and are replaced with pointers into private file mapping when the snapshot is
+ * loaded, so the values can be passed to cache directly from the mapped file.
+ */
+typedef struct
+{
+	char		magic[8];
+	zbx_uint32_t	version;
+
+	/* the size of zbx_history_record_t and byte order marker, snapshot files */
+	/* can be loaded only by the same platform they were saved on             */
+	zbx_uint32_t	record_size;
+	zbx_uint64_t	byte_order;
+
+	/* the total file size */
+	zbx_uint64_t	size;
+
+	int		created;
+	int		items_num;
+}
+zbx_vc_snapshot_header_t;
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+
+	/* the item block size including this header, aligned to 8 bytes */
+	zbx_uint64_t	size;
+
+	int		values_num;
+	int		active_range;
+	int		daily_range;
+	int		db_cached_from;
+	unsigned char	value_type;
+	unsigned char	status;
+	unsigned char	range_sync_hour;
+}
+zbx_vc_snapshot_item_t;
+
+typedef struct
+{
+	/* source and value string offsets from item block start, 0 source offset means no source */
+	zbx_uint64_t	source;
+	zbx_uint64_t	value;
+
+	int		timestamp;
+	int		logeventid;
+	int		severity;
+}
+zbx_vc_snapshot_log_t;
+
 /* the value cache data  */
 typedef struct
 {
@@ -912,7 +1026,7 @@ static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_
  *                                                                            *
  ******************************************************************************/
 static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector, int value_type,
-		zbx_history_record_t *value)
+		const zbx_history_record_t *value)
 {
 	zbx_history_record_t	record;
 
@@ -1266,7 +1380,13 @@ static void	vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
  * variable number of records (depending on largest request size).
  *
  * After adding a new chunk, the older chunks (outside the largest request
- * range) are automatically removed from cache.
+ * range) are automatically removed from cache. The last removed chunk is kept
+ * as item's spare chunk and reused when the next chunk is added, so items with
+ * stable request range rotate their chunks like a ring buffer.
+ *
+ * The values inside chunk are stored in ascending order, so the cached values
+ * can be passed to caller without copying as contiguous chunk slot ranges - see
+ * zbx_vc_iterate_values().
  */
 
 /******************************************************************************
@@ -1348,7 +1468,8 @@ static int	vch_item_chunk_slot_count(zbx_vc_item_t *item, int values_new)
  * Purpose: adds a new data chunk at the end of item's history data list      *
  *                                                                            *
  * Parameters: item          - [IN/OUT] the item to add chunk to              *
- *             nslots        - [IN] the number of slots in the new chunk      *
+ *             nslots        - [IN] the minimum number of slots in the new    *
+ *                             chunk                                          *
  *             insert_before - [IN] the target chunk before which the new     *
  *                             chunk must be inserted. If this value is NULL  *
  *                             then the new chunk is appended at the end of   *
@@ -1363,10 +1484,27 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
 	zbx_vc_chunk_t	*chunk;
 	size_t		chunk_size;
 
-	chunk_size =sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) * (size_t)(nslots - 1);
+	if (NULL != (chunk = item->spare))
+	{
+		item->spare = NULL;
+
+		/* the spare chunk is too small for the growing item range, allocate a new one */
+		if (chunk->slots_num < nslots)
+		{
+			__vc_shmem_free_func(chunk);
+			chunk = NULL;
+		}
+		else
+			nslots = chunk->slots_num;
+	}
 
-	if (NULL == (chunk = (zbx_vc_chunk_t *)vc_item_malloc(item, chunk_size)))
-		return FAIL;
+	if (NULL == chunk)
+	{
+		chunk_size = sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) * (size_t)(nslots - 1);
+
+		if (NULL == (chunk = (zbx_vc_chunk_t *)vc_item_malloc(item, chunk_size)))
+			return FAIL;
+	}
 
 	memset(chunk, 0, sizeof(zbx_vc_chunk_t));
 	chunk->slots_num = nslots;
@@ -1647,7 +1785,13 @@ static void	vch_item_remove_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 	if (chunk == item->tail)
 		item->tail = chunk->next;
 
-	vch_item_free_chunk(item, chunk);
+	if (NULL == item->spare)
+	{
+		vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
+		item->spare = chunk;
+	}
+	else
+		vch_item_free_chunk(item, chunk);
 }
 
 /******************************************************************************
@@ -1755,6 +1899,30 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: marks item aggregates with windows including the specified        *
+ *          timestamp to be recalculated                                      *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *             ts   - [IN] the timestamp of value being added                 *
+ *                                                                            *
+ * Comments: Values newer than aggregate window are accounted by the next     *
+ *           aggregate update, but values added inside the already            *
+ *           aggregated window would be missed.                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_invalidate_aggregates(zbx_vc_item_t *item, const zbx_timespec_t *ts)
+{
+	zbx_vc_aggregate_t	*aggregate;
+
+	for (aggregate = item->aggregates; NULL != aggregate; aggregate = aggregate->next)
+	{
+		if (0 <= zbx_timespec_compare(&aggregate->end, ts))
+			aggregate->values_num = -1;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds one item history value at the end of current item's history  *
@@ -1775,6 +1943,9 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 	int		ret = FAIL, index, sindex, nslots = 0;
 	zbx_vc_chunk_t	*chunk, *schunk;
 
+	if (NULL != item->aggregates)
+		vch_item_invalidate_aggregates(item, &value->timestamp);
+
 	if (NULL != item->head &&
 			0 < zbx_history_record_compare_asc_func(&item->head->slots[item->head->last_value], value))
 	{
@@ -1905,11 +2076,10 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 
 		if (0 == nslots)
 		{
-			nslots = vch_item_chunk_slot_count(item, count);
-
-			if (FAIL == vch_item_add_chunk(item, nslots, item->tail))
+			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, count), item->tail))
 				goto out;
 
+			nslots = item->tail->slots_num;
 			item->tail->last_value = nslots - 1;
 			item->tail->first_value = nslots;
 		}
@@ -2140,71 +2310,112 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: retrieves item history data with timestamps in (start, end]       *
+ *          range from cache                                                  *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order                           *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             ts        - [IN] the requested period end timestamp            *
+ * Parameters: item        - [IN] the item                                    *
+ *             start       - [IN] the range start timestamp (excluded)        *
+ *             end         - [IN] the range end timestamp (included)          *
+ *             values_func - [IN] the callback to process cached values       *
+ *             data        - [IN] the callback data                           *
+ *                                                                            *
+ * Return value: the number of retrieved values                               *
+ *                                                                            *
+ * Comments: The values are passed to callback as chunk slot ranges in        *
+ *           ascending order, starting with the newest range.                 *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		const zbx_timespec_t *ts)
+static int	vch_item_get_values_by_range(const zbx_vc_item_t *item, const zbx_timespec_t *start,
+		const zbx_timespec_t *end, zbx_vc_values_func_t values_func, void *data)
 {
-	int		index, now;
-	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
+	int		index, first, values_num = 0;
 	zbx_vc_chunk_t	*chunk;
 
-	/* Check if maximum request range is not set and all data are cached.  */
-	/* Because that indicates there was a count based request with unknown */
-	/* range which might be greater than the current request range.        */
-	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
-	{
-		now = (int)time(NULL);
-		/* add another second to include nanosecond shifts */
-		vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
-	}
-
-	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+	if (FAIL == vch_item_get_last_value(item, end, &chunk, &index))
 	{
 		/* Cache does not contain records for the specified timeshift & seconds range. */
-		/* Return empty vector with success.                                           */
-		return;
+		/* Return empty result with success.                                           */
+		return 0;
 	}
 
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	/* pass item history values to callback until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		for (first = index + 1; first > chunk->first_value &&
+				0 < zbx_timespec_compare(&chunk->slots[first - 1].timestamp, start); first--)
+			;
+
+		if (first <= index)
+		{
+			values_func(&chunk->slots[first], index - first + 1, data);
+			values_num += index - first + 1;
+		}
 
 		if (NULL == (chunk = chunk->prev))
 			break;
 
 		index = chunk->last_value;
 	}
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves item history data from cache                            *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period                               *
- *             count     - [IN] the number of history values to retrieve      *
- *             timestamp - [IN] the target timestamp                          *
+ * Parameters: item        - [IN] the item                                    *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             ts          - [IN] the requested period end timestamp          *
+ *             values_func - [IN] the callback to process cached values       *
+ *             data        - [IN] the callback data                           *
+ *                                                                            *
+ * Return value: the number of retrieved values                               *
+ *                                                                            *
+ * Comments: The values are passed to callback as chunk slot ranges in        *
+ *           ascending order, starting with the newest range.                 *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+static int	vch_item_get_values_by_time(const zbx_vc_item_t *item, int seconds, const zbx_timespec_t *ts,
+		zbx_vc_values_func_t values_func, void *data)
+{
+	int		now;
+	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
+
+	/* Check if maximum request range is not set and all data are cached.  */
+	/* Because that indicates there was a count based request with unknown */
+	/* range which might be greater than the current request range.        */
+	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
+	{
+		now = (int)time(NULL);
+		/* add another second to include nanosecond shifts */
+		vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+	}
+
+	return vch_item_get_values_by_range(item, &start, ts, values_func, data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieves item history data from cache                            *
+ *                                                                            *
+ * Parameters: item        - [IN] the item                                    *
+ *             seconds     - [IN] the time period                             *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the target timestamp                        *
+ *             values_func - [IN] the callback to process cached values       *
+ *             data        - [IN] the callback data                           *
+ *                                                                            *
+ * Return value: the number of retrieved values                               *
+ *                                                                            *
+ * Comments: The values are passed to callback as chunk slot ranges in        *
+ *           ascending order, starting with the newest range.                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_values_func_t values_func, void *data)
 {
-	int		index, now, range_timestamp;
+	int		index, now, range_timestamp, first, values_num = 0, oldest_timestamp = 0;
 	zbx_vc_chunk_t	*chunk;
 	zbx_timespec_t	start;
 
@@ -2222,20 +2433,25 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 
 	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
 	{
-		/* return empty vector with success */
+		/* return empty result with success */
 		goto out;
 	}
 
-	/* fill the values vector with item history values until the <count> values are read    */
-	/* or no more values within specified time period                                       */
-	/* fill the values vector with item history values until the start timestamp is reached */
+	/* pass item history values to callback until the <count> values are read */
+	/* or no more values within specified time period                         */
 	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
+		for (first = index + 1; first > chunk->first_value && index - first + 1 < count - values_num &&
+				0 < zbx_timespec_compare(&chunk->slots[first - 1].timestamp, &start); first--)
+			;
+
+		if (first <= index)
 		{
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+			values_func(&chunk->slots[first], index - first + 1, data);
+			values_num += index - first + 1;
+			oldest_timestamp = chunk->slots[first].timestamp.sec;
 
-			if (values->values_num == count)
+			if (values_num == count)
 				goto out;
 		}
 
@@ -2245,10 +2461,10 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 		index = chunk->last_value;
 	}
 out:
-	if (count > values->values_num)
+	if (count > values_num)
 	{
 		if (0 == seconds)
-			return;
+			return values_num;
 
 		/* not enough data in the requested period, set the range equal to the period plus */
 		/* one second to include nanosecond shifts                                         */
@@ -2257,29 +2473,28 @@ out:
 	else
 	{
 		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
-		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
+		range_timestamp = oldest_timestamp - 1;
 	}
 
 	now = (int)time(NULL);
 	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item values for the specified range                           *
+ * Purpose: passes item values for the specified range to callback            *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             count     - [IN] the number of history values to retrieve      *
- *             ts        - [IN] the target timestamp                          *
+ * Parameters: item        - [IN] the item                                    *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the target timestamp                        *
+ *             values_func - [IN] the callback to process cached values       *
+ *             data        - [IN] the callback data                           *
  *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
- *                FAIL    - the item history data was not retrieved           *
+ * Return value:  >=0  - the number of retrieved values                       *
+ *                FAIL - the item history data was not retrieved              *
  *                                                                            *
  * Comments: This function returns data from cache if necessary updating it   *
  *           from DB. If cache update was required and failed (not enough     *
@@ -2290,12 +2505,10 @@ out:
  *           seconds before <timestamp>.                                      *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+static int	vch_item_iterate_values(zbx_vc_item_t *item, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_values_func_t values_func, void *data)
 {
-	int	ret, records_read, hits, misses, range_start;
-
-	zbx_vector_history_record_clear(values);
+	int	ret, records_read, values_num, range_start;
 
 	if (0 == count)
 	{
@@ -2307,10 +2520,7 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time(item, values, seconds, ts);
-
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		values_num = vch_item_get_values_by_time(item, seconds, ts, values_func, data);
 	}
 	else
 	{
@@ -2321,115 +2531,434 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
-
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		values_num = vch_item_get_values_by_time_and_count(item, seconds, count, ts, values_func, data);
 	}
 
-	hits = values->values_num - records_read;
-	misses = records_read;
+	if (records_read > values_num)
+		records_read = values_num;
 
-	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, values_num - records_read, records_read);
 
-	ret = SUCCEED;
+	ret = values_num;
 out:
 	return ret;
 }
 
+typedef struct
+{
+	zbx_vector_history_record_t	*values;
+	int				value_type;
+}
+zbx_vc_values_vector_t;
+
 /******************************************************************************
  *                                                                            *
- * Purpose: frees resources allocated for item history data                   *
+ * Purpose: copies cached values to the values vector in descending order     *
  *                                                                            *
- * Parameters: item    - [IN] the item                                        *
+ ******************************************************************************/
+static void	vc_history_record_vector_append_values(const zbx_history_record_t *values, int values_num,
+		void *data)
+{
+	zbx_vc_values_vector_t	*vector = (zbx_vc_values_vector_t *)data;
+
+	for (int i = values_num - 1; i >= 0; i--)
+		vc_history_record_vector_append(vector->values, vector->value_type, &values[i]);
+}
+
+/******************************************************************************
  *                                                                            *
- * Return value: the size of freed memory (bytes)                             *
+ * Purpose: get item values for the specified range                           *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             values    - [OUT] the item history data stored time/value      *
+ *                         pairs in descending order                          *
+ *             seconds   - [IN] the time period to retrieve data for          *
+ *             count     - [IN] the number of history values to retrieve      *
+ *             ts        - [IN] the target timestamp                          *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
  *                                                                            *
  ******************************************************************************/
-static size_t	vch_item_free_cache(zbx_vc_item_t *item)
+static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts)
 {
-	size_t	freed = 0;
+	zbx_vc_values_vector_t	vector = {values, item->value_type};
 
-	zbx_vc_chunk_t	*chunk = item->tail;
+	zbx_vector_history_record_clear(values);
 
-	while (NULL != chunk)
+	if (FAIL == vch_item_iterate_values(item, seconds, count, ts, vc_history_record_vector_append_values,
+			&vector))
 	{
-		zbx_vc_chunk_t	*next = chunk->next;
-
-		freed += vch_item_free_chunk(item, chunk);
-		chunk = next;
+		return FAIL;
 	}
-	item->values_total = 0;
-	item->head = NULL;
-	item->tail = NULL;
 
-	return freed;
+	return SUCCEED;
 }
 
-/******************************************************************************************************************
- *                                                                                                                *
- * Public API                                                                                                     *
- *                                                                                                                *
- ******************************************************************************************************************/
+typedef struct
+{
+	zbx_vc_aggregate_t	*aggregate;
+	unsigned char		value_type;
+}
+zbx_vc_aggregate_data_t;
 
 /******************************************************************************
  *                                                                            *
- * Purpose: initializes value cache                                           *
+ * Purpose: adds value to floating point sum using Kahan summation            *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
+static void	vc_aggregate_add_dbl(zbx_vc_aggregate_t *aggregate, double value)
 {
-	zbx_uint64_t	size_reserved;
-	int		ret = FAIL;
-
-	if (0 == value_cache_size)
-		return SUCCEED;
+	double	y = value - aggregate->compensation, t = aggregate->value.dbl + y;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	aggregate->compensation = (t - aggregate->value.dbl) - y;
+	aggregate->value.dbl = t;
+}
 
-	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
-		goto out;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the value replaces current minimum or maximum value     *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_aggregate_is_min_or_max(const zbx_vc_aggregate_t *aggregate, unsigned char value_type,
+		const zbx_history_record_t *record)
+{
+	int	cmp;
 
-	size_reserved = zbx_shmem_required_size(1, "value cache size", "ValueCacheSize");
+	/* aggregate without values has the minimum/maximum value timestamp not set */
+	if (0 == aggregate->value_ts.sec && 0 == aggregate->value_ts.ns)
+		return SUCCEED;
 
-	if (SUCCEED != zbx_shmem_create(&vc_mem, value_cache_size, "value cache size", "ValueCacheSize", 1,
-			error))
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
 	{
-		goto out;
+		cmp = (record->value.dbl < aggregate->value.dbl ? -1 :
+				(record->value.dbl > aggregate->value.dbl ? 1 : 0));
 	}
-
-	value_cache_size -= size_reserved;
-
-	vc_cache = (zbx_vc_cache_t *)__vc_shmem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
-
-	if (NULL == vc_cache)
+	else
 	{
-		*error = zbx_strdup(*error, "cannot allocate value cache header");
-		goto out;
+		cmp = (record->value.ui64 < aggregate->value.ui64 ? -1 :
+				(record->value.ui64 > aggregate->value.ui64 ? 1 : 0));
 	}
-	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
-
-	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
 
-	if (NULL == vc_cache->items.slots)
-	{
-		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
-		goto out;
-	}
+	if (ZBX_VC_FUNCTION_MAX == aggregate->func)
+		cmp = -cmp;
 
-	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
-			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+	/* prefer the newest of equal values, so it would leave window later */
+	if (0 > cmp || (0 == cmp && 0 < zbx_timespec_compare(&record->timestamp, &aggregate->value_ts)))
+		return SUCCEED;
 
-	if (NULL == vc_cache->strpool.slots)
-	{
-		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
-		goto out;
-	}
+	return FAIL;
+}
 
-	/* the free space request should be 5% of cache size, but no more than 128KB */
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache callback to add values entering window to aggregate   *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_add_values(const zbx_history_record_t *values, int values_num, void *data)
+{
+	zbx_vc_aggregate_data_t	*agg_data = (zbx_vc_aggregate_data_t *)data;
+	zbx_vc_aggregate_t	*aggregate = agg_data->aggregate;
+	int			i;
+
+	aggregate->values_num += values_num;
+
+	switch (aggregate->func)
+	{
+		case ZBX_VC_FUNCTION_SUM:
+			if (ITEM_VALUE_TYPE_UINT64 == agg_data->value_type)
+			{
+				for (i = 0; i < values_num; i++)
+					aggregate->value.ui64 += values[i].value.ui64;
+				break;
+			}
+			ZBX_FALLTHROUGH;
+		case ZBX_VC_FUNCTION_AVG:
+			for (i = 0; i < values_num; i++)
+			{
+				vc_aggregate_add_dbl(aggregate, ITEM_VALUE_TYPE_FLOAT == agg_data->value_type ?
+						values[i].value.dbl : (double)values[i].value.ui64);
+			}
+			break;
+		case ZBX_VC_FUNCTION_MIN:
+		case ZBX_VC_FUNCTION_MAX:
+			for (i = 0; i < values_num; i++)
+			{
+				if (SUCCEED == vc_aggregate_is_min_or_max(aggregate, agg_data->value_type, &values[i]))
+				{
+					aggregate->value = values[i].value;
+					aggregate->value_ts = values[i].timestamp;
+				}
+			}
+			break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache callback to remove values leaving window from         *
+ *          aggregate                                                         *
+ *                                                                            *
+ * Comments: Minimum and maximum values are not updated here, instead the     *
+ *           window is scanned again if the current minimum or maximum value  *
+ *           has left it.                                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_remove_values(const zbx_history_record_t *values, int values_num, void *data)
+{
+	zbx_vc_aggregate_data_t	*agg_data = (zbx_vc_aggregate_data_t *)data;
+	zbx_vc_aggregate_t	*aggregate = agg_data->aggregate;
+	int			i;
+
+	aggregate->values_num -= values_num;
+
+	switch (aggregate->func)
+	{
+		case ZBX_VC_FUNCTION_SUM:
+			if (ITEM_VALUE_TYPE_UINT64 == agg_data->value_type)
+			{
+				for (i = 0; i < values_num; i++)
+					aggregate->value.ui64 -= values[i].value.ui64;
+				break;
+			}
+			ZBX_FALLTHROUGH;
+		case ZBX_VC_FUNCTION_AVG:
+			for (i = 0; i < values_num; i++)
+			{
+				vc_aggregate_add_dbl(aggregate, ITEM_VALUE_TYPE_FLOAT == agg_data->value_type ?
+						-values[i].value.dbl : -(double)values[i].value.ui64);
+			}
+			break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates aggregate from all cached values in window             *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_rebuild_aggregate(const zbx_vc_item_t *item, zbx_vc_aggregate_t *aggregate,
+		const zbx_timespec_t *start, const zbx_timespec_t *end)
+{
+	zbx_vc_aggregate_data_t	data = {.aggregate = aggregate, .value_type = item->value_type};
+
+	memset(&aggregate->value, 0, sizeof(aggregate->value));
+	aggregate->compensation = 0;
+	aggregate->value_ts.sec = 0;
+	aggregate->value_ts.ns = 0;
+	aggregate->values_num = 0;
+
+	vch_item_get_values_by_range(item, start, end, vc_aggregate_add_values, &data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: moves aggregate window to the specified end timestamp             *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             aggregate - [IN/OUT] the aggregate                             *
+ *             ts        - [IN] the new window end, must not be older than    *
+ *                              the current window end                        *
+ *                                                                            *
+ * Comments: Only the values entering and leaving window are processed, so    *
+ *           the amortized cost per item value does not depend on the window  *
+ *           size. The aggregate is recalculated from all window values if    *
+ *           it was invalidated, the windows do not overlap, the previous     *
+ *           window is not cached anymore or after every full window turnover *
+ *           to reset floating point sum rounding errors.                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_update_aggregate(const zbx_vc_item_t *item, zbx_vc_aggregate_t *aggregate,
+		const zbx_timespec_t *ts)
+{
+	zbx_vc_aggregate_data_t	data = {.aggregate = aggregate, .value_type = item->value_type};
+	zbx_timespec_t		start = {ts->sec - aggregate->seconds, ts->ns},
+				prev_start = {aggregate->end.sec - aggregate->seconds, aggregate->end.ns};
+
+	if (-1 == aggregate->values_num || ts->sec >= aggregate->rebuild_time ||
+			0 <= zbx_timespec_compare(&start, &aggregate->end) ||
+			(ZBX_ITEM_STATUS_CACHED_ALL != item->status && prev_start.sec < item->db_cached_from))
+	{
+		vch_item_rebuild_aggregate(item, aggregate, &start, ts);
+		aggregate->rebuild_time = ts->sec + aggregate->seconds;
+	}
+	else
+	{
+		vch_item_get_values_by_range(item, &aggregate->end, ts, vc_aggregate_add_values, &data);
+		vch_item_get_values_by_range(item, &prev_start, &start, vc_aggregate_remove_values, &data);
+
+		/* scan window again if the minimum or maximum value has left it */
+		if ((ZBX_VC_FUNCTION_MIN == aggregate->func || ZBX_VC_FUNCTION_MAX == aggregate->func) &&
+				0 != aggregate->values_num && 0 >= zbx_timespec_compare(&aggregate->value_ts, &start))
+		{
+			vch_item_rebuild_aggregate(item, aggregate, &start, ts);
+		}
+	}
+
+	aggregate->end = *ts;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds item aggregate or creates a new one                         *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *             func    - [IN] the aggregate function (ZBX_VC_FUNCTION_*)      *
+ *             seconds - [IN] the window length                               *
+ *                                                                            *
+ * Return value: the aggregate or NULL if there was not enough memory         *
+ *                                                                            *
+ * Comments: If item already has the maximum number of aggregates, the least  *
+ *           recently used aggregate is replaced.                             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_aggregate_t	*vch_item_get_aggregate(zbx_vc_item_t *item, int func, int seconds)
+{
+	zbx_vc_aggregate_t	*aggregate, *oldest = NULL;
+	int			aggregates_num = 0;
+
+	for (aggregate = item->aggregates; NULL != aggregate; aggregate = aggregate->next, aggregates_num++)
+	{
+		if (func == aggregate->func && seconds == aggregate->seconds)
+			return aggregate;
+
+		if (NULL == oldest || aggregate->last_accessed < oldest->last_accessed)
+			oldest = aggregate;
+	}
+
+	if (ZBX_VC_ITEM_AGGREGATES_MAX <= aggregates_num)
+	{
+		aggregate = oldest;
+	}
+	else
+	{
+		if (NULL == (aggregate = (zbx_vc_aggregate_t *)__vc_shmem_malloc_func(NULL, sizeof(zbx_vc_aggregate_t))))
+			return NULL;
+
+		aggregate->next = item->aggregates;
+		item->aggregates = aggregate;
+	}
+
+	aggregate->func = func;
+	aggregate->seconds = seconds;
+	aggregate->values_num = -1;
+	aggregate->end.sec = 0;
+	aggregate->end.ns = 0;
+
+	return aggregate;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees resources allocated for item history data                   *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_item_free_cache(zbx_vc_item_t *item)
+{
+	size_t	freed = 0;
+
+	zbx_vc_chunk_t	*chunk = item->tail;
+
+	while (NULL != chunk)
+	{
+		zbx_vc_chunk_t	*next = chunk->next;
+
+		freed += vch_item_free_chunk(item, chunk);
+		chunk = next;
+	}
+
+	if (NULL != item->spare)
+	{
+		freed += sizeof(zbx_vc_chunk_t) + (size_t)(item->spare->slots_num - 1) * sizeof(zbx_history_record_t);
+		__vc_shmem_free_func(item->spare);
+		item->spare = NULL;
+	}
+
+	while (NULL != item->aggregates)
+	{
+		zbx_vc_aggregate_t	*aggregate = item->aggregates;
+
+		item->aggregates = aggregate->next;
+		__vc_shmem_free_func(aggregate);
+		freed += sizeof(zbx_vc_aggregate_t);
+	}
+
+	item->values_total = 0;
+	item->head = NULL;
+	item->tail = NULL;
+
+	return freed;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * Public API                                                                                                     *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes value cache                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
+{
+	zbx_uint64_t	size_reserved;
+	int		ret = FAIL;
+
+	if (0 == value_cache_size)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
+		goto out;
+
+	size_reserved = zbx_shmem_required_size(1, "value cache size", "ValueCacheSize");
+
+	if (SUCCEED != zbx_shmem_create(&vc_mem, value_cache_size, "value cache size", "ValueCacheSize", 1,
+			error))
+	{
+		goto out;
+	}
+
+	value_cache_size -= size_reserved;
+
+	vc_cache = (zbx_vc_cache_t *)__vc_shmem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+
+	if (NULL == vc_cache)
+	{
+		*error = zbx_strdup(*error, "cannot allocate value cache header");
+		goto out;
+	}
+	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
+
+	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
+			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+
+	if (NULL == vc_cache->items.slots)
+	{
+		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
+		goto out;
+	}
+
+	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
+			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
+			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+
+	if (NULL == vc_cache->strpool.slots)
+	{
+		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
+		goto out;
+	}
+
+	/* the free space request should be 5% of cache size, but no more than 128KB */
 	vc_cache->min_free_request = (value_cache_size / 100) * 5;
 	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
 		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
@@ -2669,52 +3198,320 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get the last history value with a timestamp less or equal to the  *
- *          target timestamp                                                  *
+ * Purpose: pass item history data for the specified time period to callback  *
+ *          without copying                                                   *
  *                                                                            *
- * Parameters: itemid     - [IN] the item id                                  *
- *             value_type - [IN] the item value type                          *
- *             ts         - [IN] the target timestamp                         *
- *             value      - [OUT] the value found                             *
+ * Parameters: itemid      - [IN] the item id                                 *
+ *             value_type  - [IN] the item value type                         *
+ *             seconds     - [IN] the time period to retrieve data for        *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the period end timestamp                    *
+ *             values_func - [IN] the callback to process values              *
+ *             data        - [IN] the callback data                           *
  *                                                                            *
- * Return Value: SUCCEED - the item was retrieved                             *
- *               FAIL    - otherwise                                          *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
  *                                                                            *
- * Comments: Depending on the value type this function might allocate memory  *
- *           to store value data. To free it use zbx_vc_history_value_clear() *
- *           function.                                                        *
+ * Comments: The values are passed to callback as arrays of records sorted in *
+ *           ascending order, starting with the newest array - so iterating   *
+ *           every array backwards gives the same order as the values vector  *
+ *           returned by zbx_vc_get_values().                                 *
+ *                                                                            *
+ *           The cached values are passed directly from cache memory while    *
+ *           the cache is locked, so the callback must not store pointers to  *
+ *           the passed data and must not call value cache functions.         *
+ *                                                                            *
+ *           If the data is not in cache, it's read from DB and the callback  *
+ *           is called with the values read.                                  *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
-		zbx_history_record_t *value)
+int	zbx_vc_iterate_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_values_func_t values_func, void *data)
 {
-	zbx_vector_history_record_t	values;
-	int				ret = FAIL;
+	zbx_vc_item_t	*item, new_item;
+	int		ret = FAIL, cache_used = 1, values_num = 0;
 
-	zbx_history_record_vector_create(&values);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
+			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
 
-	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED == vc_state)
 		goto out;
 
-	*value = values.values[0];
+	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
 
-	/* reset values vector size so the returned value is not cleared when destroying the vector */
-	values.values_num = 0;
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
+			goto out;
 
-	ret = SUCCEED;
+		memset(&new_item, 0, sizeof(new_item));
+		new_item.itemid = itemid;
+		new_item.value_type = value_type;
+		item = &new_item;
+	}
+	else if (item->value_type != value_type)
+		goto out;
+
+	if (FAIL != (values_num = vch_item_iterate_values(item, seconds, count, ts, values_func, data)))
+		ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, value_type);
+	if (FAIL == ret)
+	{
+		zbx_vector_history_record_t	values;
 
-	return ret;
-}
+		cache_used = 0;
+		zbx_history_record_vector_create(&values);
 
-/******************************************************************************
- *                                                                            *
- * Purpose: retrieves usage cache statistics                                  *
- *                                                                            *
- * Parameters: stats     - [OUT] the cache usage statistics                   *
- *                                                                            *
- * Return value:  SUCCEED - the cache statistics were retrieved successfully  *
+		UNLOCK_CACHE;
+		ret = vc_db_get_values(itemid, value_type, &values, seconds, count, ts);
+		WRLOCK_CACHE;
+
+		if (ZBX_VC_DISABLED != vc_state)
+			vc_remove_item_by_id(itemid);
+
+		if (SUCCEED == ret)
+			vc_update_statistics(NULL, 0, values.values_num, (int)time(NULL));
+
+		UNLOCK_CACHE;
+
+		if (SUCCEED == ret && 0 != (values_num = values.values_num))
+		{
+			zbx_vector_history_record_sort(&values, (zbx_compare_func_t)zbx_history_record_compare_asc_func);
+			values_func(values.values, values.values_num, data);
+		}
+
+		zbx_history_record_vector_destroy(&values, value_type);
+	}
+	else
+		UNLOCK_CACHE;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
+			__func__, zbx_result_string(ret), values_num, cache_used);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds cached item with all values of aggregate window             *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             seconds    - [IN] the window length                            *
+ *             ts         - [IN] the window end timestamp                     *
+ *                                                                            *
+ * Return value: the item or NULL if the window values are not cached         *
+ *                                                                            *
+ * Comments: The cache must be locked.                                        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_item_t	*vc_get_aggregate_item(zbx_uint64_t itemid, unsigned char value_type, int seconds,
+		const zbx_timespec_t *ts)
+{
+	zbx_vc_item_t	*item;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)) ||
+			item->value_type != value_type)
+	{
+		return NULL;
+	}
+
+	/* the whole window must be cached */
+	if (ZBX_ITEM_STATUS_CACHED_ALL != item->status &&
+			(0 == item->db_cached_from || ts->sec - seconds < item->db_cached_from))
+	{
+		return NULL;
+	}
+
+	return item;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies aggregate result                                           *
+ *                                                                            *
+ * Parameters: item       - [IN] the item                                     *
+ *             aggregate  - [IN] the aggregate                                *
+ *             value      - [OUT] the aggregated value                        *
+ *             values_num - [OUT] the number of values in window              *
+ *                                                                            *
+ * Return value: SUCCEED - the value cache range of the item must be updated  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_get_aggregate_result(const zbx_vc_item_t *item, const zbx_vc_aggregate_t *aggregate,
+		zbx_history_value_t *value, int *values_num)
+{
+	*values_num = aggregate->values_num;
+	*value = aggregate->value;
+
+	if (ZBX_VC_FUNCTION_AVG == aggregate->func && 0 != aggregate->values_num)
+		value->dbl = aggregate->value.dbl / aggregate->values_num;
+
+	/* see vch_item_get_values_by_time() */
+	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
+		return SUCCEED;
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get aggregate of item values in time window                       *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             func       - [IN] the aggregate function (ZBX_VC_FUNCTION_*)   *
+ *             seconds    - [IN] the window length                            *
+ *             ts         - [IN] the window end timestamp                     *
+ *             value      - [OUT] the aggregated value:                       *
+ *                                  sum - dbl or ui64 depending on type       *
+ *                                  avg - dbl                                 *
+ *                                  min/max - dbl or ui64 depending on type   *
+ *                                  count - not set                           *
+ *             values_num - [OUT] the number of values in window              *
+ *                                                                            *
+ * Return value:  SUCCEED - the aggregate was calculated                      *
+ *                FAIL    - the window values are not cached or the window    *
+ *                          end is older than the last aggregate request,     *
+ *                          zbx_vc_get_values() or zbx_vc_iterate_values()    *
+ *                          must be used instead                              *
+ *                                                                            *
+ * Comments: The aggregates are kept for every item, function and window      *
+ *           combination and are updated only with values entering and        *
+ *           leaving the window since the last request.                       *
+ *                                                                            *
+ *           The cache is write locked only when the aggregate must be moved  *
+ *           to the new window end, otherwise read lock is enough.            *
+ *                                                                            *
+ *           Floating point sums are maintained with Kahan summation, so sum  *
+ *           and avg results can differ in the last digits from the results   *
+ *           calculated by adding window values one by one.                   *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, int func, int seconds,
+		const zbx_timespec_t *ts, zbx_history_value_t *value, int *values_num)
+{
+	zbx_vc_item_t		*item;
+	zbx_vc_aggregate_t	*aggregate;
+	int			ret = FAIL, now, update_range = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " func:%d period:%d end_timestamp '%s'",
+			__func__, itemid, func, seconds, zbx_timespec_str(ts));
+
+	if (ZBX_VC_DISABLED == vc_state || 0 >= seconds)
+		goto out;
+
+	now = (int)time(NULL);
+
+	RDLOCK_CACHE;
+
+	if (NULL == (item = vc_get_aggregate_item(itemid, value_type, seconds, ts)))
+		goto unlock;
+
+	/* the aggregate already moved to the requested window end can be used without write lock */
+	for (aggregate = item->aggregates; NULL != aggregate; aggregate = aggregate->next)
+	{
+		if (func != aggregate->func || seconds != aggregate->seconds)
+			continue;
+
+		if (-1 != aggregate->values_num && 0 == zbx_timespec_compare(ts, &aggregate->end))
+		{
+			update_range = vc_get_aggregate_result(item, aggregate, value, values_num);
+			ret = SUCCEED;
+			goto unlock;
+		}
+
+		break;
+	}
+
+	UNLOCK_CACHE;
+
+	WRLOCK_CACHE;
+
+	/* the item might have been removed or changed while cache was unlocked */
+	if (NULL == (item = vc_get_aggregate_item(itemid, value_type, seconds, ts)))
+		goto unlock;
+
+	if (NULL == (aggregate = vch_item_get_aggregate(item, func, seconds)))
+		goto unlock;
+
+	if (-1 != aggregate->values_num && 0 > zbx_timespec_compare(ts, &aggregate->end))
+		goto unlock;
+
+	vch_item_update_aggregate(item, aggregate, ts);
+	aggregate->last_accessed = now;
+
+	update_range = vc_get_aggregate_result(item, aggregate, value, values_num);
+
+	ret = SUCCEED;
+unlock:
+	UNLOCK_CACHE;
+
+	if (SUCCEED == ret)
+	{
+		if (SUCCEED == update_range)
+			vc_cache_item_update(itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+
+		vc_cache_item_update(itemid, ZBX_VC_UPDATE_STATS, *values_num, 0);
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the last history value with a timestamp less or equal to the  *
+ *          target timestamp                                                  *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             ts         - [IN] the target timestamp                         *
+ *             value      - [OUT] the value found                             *
+ *                                                                            *
+ * Return Value: SUCCEED - the item was retrieved                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Depending on the value type this function might allocate memory  *
+ *           to store value data. To free it use zbx_vc_history_value_clear() *
+ *           function.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
+		zbx_history_record_t *value)
+{
+	zbx_vector_history_record_t	values;
+	int				ret = FAIL;
+
+	zbx_history_record_vector_create(&values);
+
+	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
+		goto out;
+
+	*value = values.values[0];
+
+	/* reset values vector size so the returned value is not cleared when destroying the vector */
+	values.values_num = 0;
+
+	ret = SUCCEED;
+out:
+	zbx_history_record_vector_destroy(&values, value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieves usage cache statistics                                  *
+ *                                                                            *
+ * Parameters: stats     - [OUT] the cache usage statistics                   *
+ *                                                                            *
+ * Return value:  SUCCEED - the cache statistics were retrieved successfully  *
  *                FAIL    - failed to retrieve cache statistics               *
  *                          (cache was not initialized)                       *
  *                                                                            *
@@ -2929,3 +3726,547 @@ void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items)
 
 	UNLOCK_CACHE;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates size of item block in value cache snapshot             *
+ *                                                                            *
+ * Parameters: item       - [IN] the item                                     *
+ *             values_num - [OUT] the number of cached item values            *
+ *                                                                            *
+ * Return value: the item block size                                          *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_snapshot_item_size(const zbx_vc_item_t *item, int *values_num)
+{
+	const zbx_vc_chunk_t	*chunk;
+	size_t			size = sizeof(zbx_vc_snapshot_item_t);
+	int			i;
+
+	*values_num = 0;
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		*values_num += chunk->last_value - chunk->first_value + 1;
+
+		for (i = chunk->first_value; i <= chunk->last_value; i++)
+		{
+			const zbx_history_record_t	*value = &chunk->slots[i];
+
+			switch (item->value_type)
+			{
+				case ITEM_VALUE_TYPE_STR:
+				case ITEM_VALUE_TYPE_TEXT:
+					size += strlen(value->value.str) + 1;
+					break;
+				case ITEM_VALUE_TYPE_LOG:
+					size += sizeof(zbx_vc_snapshot_log_t) + strlen(value->value.log->value) + 1;
+
+					if (NULL != value->value.log->source)
+						size += strlen(value->value.log->source) + 1;
+					break;
+			}
+		}
+	}
+
+	return VC_SNAPSHOT_ALIGN(size + (size_t)*values_num * sizeof(zbx_history_record_t));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies string into item block and returns the number of bytes     *
+ *          written                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_snapshot_write_str(char *ptr, const char *str)
+{
+	size_t	len = strlen(str) + 1;
+
+	memcpy(ptr, str, len);
+
+	return len;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serializes item and its cached values into snapshot item block    *
+ *                                                                            *
+ * Parameters: item       - [IN] the item                                     *
+ *             values_num - [IN] the number of cached item values             *
+ *             block      - [OUT] the item block                              *
+ *             size       - [IN] the item block size                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_snapshot_write_item(const zbx_vc_item_t *item, int values_num, char *block, size_t size)
+{
+	zbx_vc_snapshot_item_t	*header = (zbx_vc_snapshot_item_t *)block;
+	zbx_history_record_t	*records = (zbx_history_record_t *)(block + sizeof(zbx_vc_snapshot_item_t));
+	zbx_vc_snapshot_log_t	*logs = (zbx_vc_snapshot_log_t *)(records + values_num);
+	const zbx_vc_chunk_t	*chunk;
+	size_t			offset;
+	int			i, index = 0;
+
+	memset(block, 0, size);
+
+	header->itemid = item->itemid;
+	header->size = size;
+	header->values_num = values_num;
+	header->active_range = item->active_range;
+	header->daily_range = item->daily_range;
+	header->db_cached_from = item->db_cached_from;
+	header->value_type = item->value_type;
+	header->status = item->status;
+	header->range_sync_hour = item->range_sync_hour;
+
+	if (ITEM_VALUE_TYPE_LOG == item->value_type)
+		offset = (size_t)((char *)(logs + values_num) - block);
+	else
+		offset = (size_t)((char *)logs - block);
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		for (i = chunk->first_value; i <= chunk->last_value; i++, index++)
+		{
+			const zbx_history_record_t	*value = &chunk->slots[i];
+			zbx_history_record_t		*record = &records[index];
+			zbx_vc_snapshot_log_t		*log;
+
+			record->timestamp = value->timestamp;
+
+			switch (item->value_type)
+			{
+				case ITEM_VALUE_TYPE_STR:
+				case ITEM_VALUE_TYPE_TEXT:
+					record->value.ui64 = offset;
+					offset += vc_snapshot_write_str(block + offset, value->value.str);
+					break;
+				case ITEM_VALUE_TYPE_LOG:
+					log = &logs[index];
+					record->value.ui64 = (zbx_uint64_t)((char *)log - block);
+
+					log->timestamp = value->value.log->timestamp;
+					log->logeventid = value->value.log->logeventid;
+					log->severity = value->value.log->severity;
+
+					if (NULL != value->value.log->source)
+					{
+						log->source = offset;
+						offset += vc_snapshot_write_str(block + offset, value->value.log->source);
+					}
+
+					log->value = offset;
+					offset += vc_snapshot_write_str(block + offset, value->value.log->value);
+					break;
+				default:
+					record->value = value->value;
+			}
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: saves value cache contents into snapshot file                     *
+ *                                                                            *
+ * Parameters: path  - [IN] the snapshot file path                            *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot was saved                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The snapshot is valid only if all history values were flushed    *
+ *           to database before saving it and no values were added to         *
+ *           database afterwards, so it must be saved during shutdown after   *
+ *           history cache has been synced. The snapshot is written to a      *
+ *           temporary file which is renamed to the snapshot file only after  *
+ *           it has been fully written.                                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_save_snapshot(const char *path, char **error)
+{
+	zbx_vc_snapshot_header_t	header;
+	zbx_hashset_iter_t		iter;
+	zbx_vc_item_t			*item;
+	FILE				*f;
+	char				*tmp_path, *block = NULL;
+	size_t				block_alloc = 0;
+	int				ret = FAIL, write_ok = SUCCEED;
+
+	if (NULL == vc_cache)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() path:%s", __func__, path);
+
+	tmp_path = zbx_dsprintf(NULL, "%s.tmp", path);
+
+	if (NULL == (f = fopen(tmp_path, "w")))
+	{
+		*error = zbx_dsprintf(*error, "cannot create file \"%s\": %s", tmp_path, zbx_strerror(errno));
+		goto out;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ZBX_VC_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = ZBX_VC_SNAPSHOT_VERSION;
+	header.record_size = (zbx_uint32_t)sizeof(zbx_history_record_t);
+	header.byte_order = ZBX_VC_SNAPSHOT_BYTE_ORDER;
+	header.size = sizeof(header);
+	header.created = (int)time(NULL);
+
+	if (1 != fwrite(&header, sizeof(header), 1, f))
+		write_ok = FAIL;
+
+	RDLOCK_CACHE;
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	while (SUCCEED == write_ok && NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		size_t	size;
+		int	values_num;
+
+		switch (item->value_type)
+		{
+			case ITEM_VALUE_TYPE_FLOAT:
+			case ITEM_VALUE_TYPE_UINT64:
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+			case ITEM_VALUE_TYPE_LOG:
+				break;
+			default:
+				continue;
+		}
+
+		size = vc_snapshot_item_size(item, &values_num);
+
+		if (size > block_alloc)
+		{
+			block_alloc = size;
+			block = (char *)zbx_realloc(block, block_alloc);
+		}
+
+		vc_snapshot_write_item(item, values_num, block, size);
+
+		if (1 != fwrite(block, size, 1, f))
+			write_ok = FAIL;
+
+		header.size += size;
+		header.items_num++;
+	}
+
+	UNLOCK_CACHE;
+
+	zbx_free(block);
+
+	if (SUCCEED == write_ok && (0 != fseek(f, 0, SEEK_SET) || 1 != fwrite(&header, sizeof(header), 1, f)))
+		write_ok = FAIL;
+
+	if (0 != fclose(f))
+		write_ok = FAIL;
+
+	if (SUCCEED != write_ok)
+	{
+		*error = zbx_dsprintf(*error, "cannot write file \"%s\": %s", tmp_path, zbx_strerror(errno));
+		unlink(tmp_path);
+		goto out;
+	}
+
+	if (0 != rename(tmp_path, path))
+	{
+		*error = zbx_dsprintf(*error, "cannot rename file \"%s\" to \"%s\": %s", tmp_path, path,
+				zbx_strerror(errno));
+		unlink(tmp_path);
+		goto out;
+	}
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "saved %d items to value cache snapshot \"%s\"", header.items_num, path);
+
+	ret = SUCCEED;
+out:
+	zbx_free(tmp_path);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets string from snapshot item block                              *
+ *                                                                            *
+ * Parameters: block  - [IN] the item block                                   *
+ *             size   - [IN] the item block size                              *
+ *             offset - [IN] the string offset from item block start          *
+ *             str    - [OUT] the string                                      *
+ *                                                                            *
+ * Return value: SUCCEED - the string was found inside item block             *
+ *               FAIL    - the offset is out of item block bounds or string   *
+ *                         is not terminated                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_get_str(char *block, zbx_uint64_t size, zbx_uint64_t offset, char **str)
+{
+	if (sizeof(zbx_vc_snapshot_item_t) > offset || size <= offset ||
+			NULL == memchr(block + offset, '\0', (size_t)(size - offset)))
+	{
+		return FAIL;
+	}
+
+	*str = block + offset;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads item and its values from snapshot item block into cache     *
+ *                                                                            *
+ * Parameters: snapshot_item - [IN] the item block                            *
+ *             items         - [IN] the configured items (itemid, value type  *
+ *                                  pairs) sorted by itemid                   *
+ *             now           - [IN] the current time                          *
+ *                                                                            *
+ * Return value: SUCCEED - the item was loaded                                *
+ *               FAIL    - the item was skipped - it's not configured         *
+ *                         anymore, was already cached, its data is damaged   *
+ *                         or there is not enough space in cache              *
+ *                                                                            *
+ * Comments: String values are not copied from the block, instead the value   *
+ *           offsets are replaced with pointers in the privately mapped block.*
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_load_item(zbx_vc_snapshot_item_t *snapshot_item, const zbx_vector_uint64_pair_t *items,
+		int now)
+{
+	char			*block = (char *)snapshot_item;
+	zbx_history_record_t	*records = (zbx_history_record_t *)(block + sizeof(zbx_vc_snapshot_item_t));
+	zbx_log_value_t		*logs = NULL;
+	zbx_uint64_pair_t	pair = {.first = snapshot_item->itemid};
+	zbx_vc_item_t		item_local, *item;
+	int			i, index, ret = FAIL;
+
+	if (FAIL == (index = zbx_vector_uint64_pair_bsearch(items, pair, ZBX_DEFAULT_UINT64_COMPARE_FUNC)) ||
+			items->values[index].second != snapshot_item->value_type)
+	{
+		return FAIL;
+	}
+
+	if (0 > snapshot_item->values_num || (snapshot_item->size - sizeof(zbx_vc_snapshot_item_t)) /
+			sizeof(zbx_history_record_t) < (zbx_uint64_t)snapshot_item->values_num)
+	{
+		return FAIL;
+	}
+
+	if (NULL != zbx_hashset_search(&vc_cache->items, &snapshot_item->itemid))
+		return FAIL;
+
+	switch (snapshot_item->value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+		case ITEM_VALUE_TYPE_UINT64:
+			break;
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			for (i = 0; i < snapshot_item->values_num; i++)
+			{
+				if (SUCCEED != vc_snapshot_get_str(block, snapshot_item->size, records[i].value.ui64,
+						&records[i].value.str))
+				{
+					goto out;
+				}
+			}
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			logs = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t) *
+					(size_t)MAX(snapshot_item->values_num, 1));
+
+			for (i = 0; i < snapshot_item->values_num; i++)
+			{
+				const zbx_vc_snapshot_log_t	*log;
+				zbx_uint64_t			offset = records[i].value.ui64;
+
+				if (sizeof(zbx_vc_snapshot_item_t) > offset || 0 != offset % 8 ||
+						snapshot_item->size - sizeof(zbx_vc_snapshot_log_t) < offset)
+				{
+					goto out;
+				}
+
+				log = (const zbx_vc_snapshot_log_t *)(block + offset);
+
+				logs[i].timestamp = log->timestamp;
+				logs[i].logeventid = log->logeventid;
+				logs[i].severity = log->severity;
+				logs[i].source = NULL;
+
+				if (0 != log->source && SUCCEED != vc_snapshot_get_str(block, snapshot_item->size,
+						log->source, &logs[i].source))
+				{
+					goto out;
+				}
+
+				if (SUCCEED != vc_snapshot_get_str(block, snapshot_item->size, log->value,
+						&logs[i].value))
+				{
+					goto out;
+				}
+
+				records[i].value.log = &logs[i];
+			}
+			break;
+		default:
+			goto out;
+	}
+
+	/* values are added to cache at tail, so they must be sorted in ascending order */
+	for (i = 1; i < snapshot_item->values_num; i++)
+	{
+		if (0 > zbx_timespec_compare(&records[i].timestamp, &records[i - 1].timestamp))
+			goto out;
+	}
+
+	memset(&item_local, 0, sizeof(item_local));
+	item_local.itemid = snapshot_item->itemid;
+	item_local.value_type = snapshot_item->value_type;
+	item_local.status = snapshot_item->status;
+	item_local.range_sync_hour = snapshot_item->range_sync_hour;
+	item_local.active_range = snapshot_item->active_range;
+	item_local.daily_range = snapshot_item->daily_range;
+	item_local.db_cached_from = snapshot_item->db_cached_from;
+	item_local.last_accessed = now;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local))))
+		goto out;
+
+	if (0 != snapshot_item->values_num &&
+			FAIL == vch_item_add_values_at_tail(item, records, snapshot_item->values_num))
+	{
+		vc_remove_item(item);
+		goto out;
+	}
+
+	ret = SUCCEED;
+out:
+	zbx_free(logs);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads value cache contents from snapshot file                     *
+ *                                                                            *
+ * Parameters: path  - [IN] the snapshot file path                            *
+ *             items - [IN] the configured items (itemid, value type pairs)   *
+ *                          sorted by itemid                                  *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot was loaded or did not exist           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Only items still existing in configuration with the same value   *
+ *           type are loaded. The snapshot file is removed before loading, so *
+ *           it's used only for the first start after it was saved and a      *
+ *           server crash later cannot load outdated values.                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_load_snapshot(const char *path, const zbx_vector_uint64_pair_t *items, char **error)
+{
+	zbx_vc_snapshot_header_t	*header;
+	struct stat			st;
+	char				*data = MAP_FAILED;
+	zbx_uint64_t			offset;
+	int				fd, i, ret = FAIL, loaded = 0, now;
+
+	if (NULL == vc_cache)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() path:%s", __func__, path);
+
+	if (-1 == (fd = open(path, O_RDONLY)))
+	{
+		if (ENOENT == errno)
+		{
+			ret = SUCCEED;
+			goto out;
+		}
+
+		*error = zbx_dsprintf(*error, "cannot open file \"%s\": %s", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	if (0 != fstat(fd, &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot stat file \"%s\": %s", path, zbx_strerror(errno));
+		goto close;
+	}
+
+	if (sizeof(zbx_vc_snapshot_header_t) > (size_t)st.st_size)
+	{
+		*error = zbx_dsprintf(*error, "invalid file \"%s\" size", path);
+		unlink(path);
+		goto close;
+	}
+
+	if (MAP_FAILED == (data = (char *)mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)))
+	{
+		*error = zbx_dsprintf(*error, "cannot map file \"%s\": %s", path, zbx_strerror(errno));
+		goto close;
+	}
+
+	if (0 != unlink(path))
+	{
+		*error = zbx_dsprintf(*error, "cannot remove file \"%s\": %s", path, zbx_strerror(errno));
+		goto close;
+	}
+
+	header = (zbx_vc_snapshot_header_t *)data;
+
+	if (0 != memcmp(header->magic, ZBX_VC_SNAPSHOT_MAGIC, sizeof(header->magic)) ||
+			ZBX_VC_SNAPSHOT_VERSION != header->version ||
+			sizeof(zbx_history_record_t) != header->record_size ||
+			ZBX_VC_SNAPSHOT_BYTE_ORDER != header->byte_order ||
+			(zbx_uint64_t)st.st_size != header->size)
+	{
+		*error = zbx_dsprintf(*error, "file \"%s\" is not a compatible value cache snapshot", path);
+		goto close;
+	}
+
+	now = (int)time(NULL);
+	offset = sizeof(zbx_vc_snapshot_header_t);
+
+	WRLOCK_CACHE;
+
+	for (i = 0; i < header->items_num && ZBX_VC_MODE_NORMAL == vc_cache->mode; i++)
+	{
+		zbx_vc_snapshot_item_t	*snapshot_item = (zbx_vc_snapshot_item_t *)(data + offset);
+
+		if (header->size - offset < sizeof(zbx_vc_snapshot_item_t) ||
+				sizeof(zbx_vc_snapshot_item_t) > snapshot_item->size ||
+				header->size - offset < snapshot_item->size || 0 != snapshot_item->size % 8)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "value cache snapshot \"%s\" is damaged", path);
+			break;
+		}
+
+		if (SUCCEED == vc_snapshot_load_item(snapshot_item, items, now))
+			loaded++;
+
+		offset += snapshot_item->size;
+	}
+
+	UNLOCK_CACHE;
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "loaded %d of %d items from value cache snapshot \"%s\" saved at %s %s",
+			loaded, header->items_num, path, zbx_date2str(header->created, NULL),
+			zbx_time2str(header->created, NULL));
+
+	ret = SUCCEED;
+close:
+	if (MAP_FAILED != data)
+		munmap(data, (size_t)st.st_size);
+
+	close(fd);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
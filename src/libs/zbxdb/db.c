@@ -65,22 +65,23 @@ struct zbx_db_result
 #endif
 };
 
-static int		txn_level = 0;	/* transaction level, nested transactions are not supported */
-static int		txn_error = ZBX_DB_OK;	/* failed transaction */
-static int		txn_end_error = ZBX_DB_OK;	/* transaction result */
+/* connection state is kept per thread, so that threads can use their own database connections */
+static ZBX_THREAD_LOCAL int	txn_level = 0;	/* transaction level, nested transactions are not supported */
+static ZBX_THREAD_LOCAL int	txn_error = ZBX_DB_OK;	/* failed transaction */
+static ZBX_THREAD_LOCAL int	txn_end_error = ZBX_DB_OK;	/* transaction result */
 
-static char		*last_db_strerror = NULL;	/* last database error message */
+static ZBX_THREAD_LOCAL char	*last_db_strerror = NULL;	/* last database error message */
 
 static int		config_log_slow_queries;
 
 static int		db_auto_increment;
 
 #if defined(HAVE_MYSQL)
-static MYSQL			*conn = NULL;
-static int			mysql_err_cnt = 0;
+static ZBX_THREAD_LOCAL MYSQL	*conn = NULL;
+static ZBX_THREAD_LOCAL int	mysql_err_cnt = 0;
 static zbx_uint32_t		ZBX_MYSQL_SVERSION = ZBX_DBVERSION_UNDEFINED;
 static int			ZBX_MARIADB_SFORK = OFF;
-static int			txn_begin = 0;	/* transaction begin statement is executed */
+static ZBX_THREAD_LOCAL int	txn_begin = 0;	/* transaction begin statement is executed */
 #elif defined(HAVE_ORACLE)
 #include "zbxalgo.h"
 
@@ -108,12 +109,19 @@ static ub4	OCI_DBserver_status(void);
 #define ZBX_PG_UNIQUE_VIOLATION	"23505"
 #define ZBX_PG_DEADLOCK		"40P01"
 
-static PGconn			*conn = NULL;
+static ZBX_THREAD_LOCAL PGconn	*conn = NULL;
 static unsigned int		ZBX_PG_BYTEAOID = 0;
 static int			ZBX_TSDB_VERSION = -1;
 static zbx_uint32_t		ZBX_PG_SVERSION = ZBX_DBVERSION_UNDEFINED;
 char				ZBX_PG_ESCAPE_BACKSLASH = 1;
 static int 			ZBX_TIMESCALE_COMPRESSION_AVAILABLE = OFF;
+#	ifdef LIBPQ_HAS_PIPELINING
+/* maximum number of statements sent in pipeline mode before reading their results */
+#		define ZBX_PG_PIPELINE_STATEMENTS_MAX	1000
+static ZBX_THREAD_LOCAL int	txn_pipeline = 0;	/* transaction statements are sent in pipeline mode */
+static ZBX_THREAD_LOCAL zbx_vector_str_t	pipeline_sql;	/* statements waiting for results */
+static ZBX_THREAD_LOCAL int	pipeline_sql_init = 0;
+#	endif
 #elif defined(HAVE_SQLITE3)
 static sqlite3			*conn = NULL;
 static zbx_mutex_t		sqlite_access = ZBX_MUTEX_NULL;
@@ -124,7 +132,7 @@ static void	OCI_DBclean_result_handle(zbx_db_result_t result);
 static void	OCI_DBclean_result(zbx_db_result_t result);
 #endif
 
-static zbx_err_codes_t last_db_errcode;
+static ZBX_THREAD_LOCAL zbx_err_codes_t	last_db_errcode;
 
 static void	zbx_db_errlog(zbx_err_codes_t zbx_errno, int db_errno, const char *db_error, const char *context)
 {
@@ -397,6 +405,221 @@ static int	is_recoverable_postgresql_error(const PGconn *pg_conn, const PGresult
 
 	return FAIL;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: logs failed statement execution result                           *
+ *                                                                            *
+ * Parameters: result - [IN] failed statement result                          *
+ *             sql    - [IN] executed statement                               *
+ *                                                                            *
+ * Return value: ZBX_DB_DOWN - recoverable error, reconnect is required       *
+ *               ZBX_DB_FAIL - otherwise                                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_postgresql_execute_error(const PGresult *result, const char *sql)
+{
+	zbx_err_codes_t	errcode;
+	char		*error = NULL;
+
+	zbx_postgresql_error(&error, result);
+
+	if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
+		errcode = ERR_Z3008;
+	else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
+		errcode = ERR_Z3009;
+	else
+		errcode = ERR_Z3005;
+
+	zbx_db_errlog(errcode, 0, error, sql);
+	zbx_free(error);
+
+	return SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL;
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds end of the first statement in multiple statement sql        *
+ *                                                                            *
+ * Return value: pointer to the terminating ';' or '\0' character             *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*zbx_db_statement_end(const char *sql)
+{
+	char	quote = '\0';
+
+	for (; '\0' != *sql; sql++)
+	{
+		if ('\0' != quote)
+		{
+			if ('\\' == *sql && '\'' == quote && 1 == ZBX_PG_ESCAPE_BACKSLASH && '\0' != sql[1])
+				sql++;
+			else if (quote == *sql)
+				quote = '\0';
+
+			continue;
+		}
+
+		if ('\'' == *sql || '"' == *sql)
+			quote = *sql;
+		else if (';' == *sql)
+			break;
+	}
+
+	return sql;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads results of the statements sent in pipeline mode             *
+ *                                                                            *
+ * Return value: ZBX_DB_OK   - all statements were executed successfully      *
+ *               ZBX_DB_FAIL - a statement failed                             *
+ *               ZBX_DB_DOWN - database connection was lost                   *
+ *                                                                            *
+ * Comments: After a failed statement the following statements are skipped    *
+ *           by server and the transaction must be rolled back.               *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pipeline_sync(void)
+{
+	int		ret = ZBX_DB_OK, index = 0;
+	PGresult	*result;
+
+	if (1 != PQpipelineSync(conn))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), "pipeline sync");
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	while (index <= pipeline_sql.values_num)
+	{
+		if (NULL == (result = PQgetResult(conn)))
+		{
+			/* results of each statement are terminated by NULL */
+			if (CONNECTION_OK != PQstatus(conn))
+			{
+				if (ZBX_DB_OK == ret)
+					zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), "pipeline sync");
+
+				ret = ZBX_DB_DOWN;
+				break;
+			}
+
+			index++;
+			continue;
+		}
+
+		switch (PQresultStatus(result))
+		{
+			case PGRES_PIPELINE_SYNC:
+				index = pipeline_sql.values_num + 1;
+				break;
+			case PGRES_COMMAND_OK:
+			case PGRES_TUPLES_OK:
+			case PGRES_PIPELINE_ABORTED:
+				break;
+			default:
+				if (ZBX_DB_OK == ret)
+				{
+					ret = zbx_postgresql_execute_error(result, index < pipeline_sql.values_num ?
+							pipeline_sql.values[index] : "pipeline sync");
+				}
+		}
+
+		PQclear(result);
+	}
+out:
+	zbx_vector_str_clear_ext(&pipeline_sql, zbx_str_free);
+
+	if (ZBX_DB_OK != ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "pipelined query failed, setting transaction as failed");
+		txn_error = ret;
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads results of the statements sent in pipeline mode and leaves  *
+ *          pipeline mode, so the connection can be used synchronously        *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pipeline_flush(void)
+{
+	int	ret;
+
+	if (NULL == conn || PQ_PIPELINE_OFF == PQpipelineStatus(conn))
+		return ZBX_DB_OK;
+
+	/* all results are read unless connection was lost */
+	if (ZBX_DB_DOWN != (ret = zbx_db_pipeline_sync()))
+		PQexitPipelineMode(conn);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends statements without waiting for their results                *
+ *                                                                            *
+ * Parameters: sql - [IN] one or more statements separated by ';'             *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL or ZBX_DB_DOWN                        *
+ *                                                                            *
+ * Comments: Extended query protocol used in pipeline mode allows only single *
+ *           statement per query, so multiple statements are split.           *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pipeline_execute(const char *sql)
+{
+	const char	*end;
+	char		*statement;
+
+	if (PQ_PIPELINE_OFF == PQpipelineStatus(conn) && 1 != PQenterPipelineMode(conn))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		return CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+	}
+
+	for (; '\0' != *sql; sql = ('\0' != *end ? end + 1 : end))
+	{
+		end = zbx_db_statement_end(sql);
+		statement = zbx_dsprintf(NULL, "%.*s", (int)(end - sql), sql);
+		zbx_lrtrim(statement, ZBX_WHITESPACE);
+
+		if ('\0' == *statement)
+		{
+			zbx_free(statement);
+			continue;
+		}
+
+		if (1 != PQsendQueryParams(conn, statement, 0, NULL, NULL, NULL, NULL, 0))
+		{
+			zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), statement);
+			zbx_free(statement);
+			return CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN;
+		}
+
+		zbx_vector_str_append(&pipeline_sql, statement);
+
+		/* limit the number of unread results to avoid blocking on full socket buffers */
+		if (ZBX_PG_PIPELINE_STATEMENTS_MAX <= pipeline_sql.values_num)
+		{
+			int	ret;
+
+			if (ZBX_DB_OK != (ret = zbx_db_pipeline_sync()))
+				return ret;
+		}
+	}
+
+	return ZBX_DB_OK;
+}
+#endif	/* LIBPQ_HAS_PIPELINING */
 #endif
 
 /******************************************************************************
@@ -1022,6 +1245,12 @@ void	zbx_db_close_basic(void)
 		PQfinish(conn);
 		conn = NULL;
 	}
+#	ifdef LIBPQ_HAS_PIPELINING
+	txn_pipeline = 0;
+
+	if (0 != pipeline_sql_init)
+		zbx_vector_str_clear_ext(&pipeline_sql, zbx_str_free);
+#	endif
 #elif defined(HAVE_SQLITE3)
 	if (NULL != conn)
 	{
@@ -1067,6 +1296,49 @@ int	zbx_db_begin_basic(void)
 	return rc;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start transaction with statements sent in pipeline mode           *
+ *                                                                            *
+ * Comments: The statements executed within the transaction do not wait for   *
+ *           results and return 0 affected rows, their errors are reported    *
+ *           when the transaction is committed. Selects read pending results  *
+ *           before executing.                                                *
+ *           Starts normal transaction if pipeline mode is not supported.     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_begin_pipeline_basic(void)
+{
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	int	rc;
+
+	if (txn_level > 0)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "ERROR: nested transaction detected. Please report it to Zabbix Team.");
+		assert(0);
+	}
+
+	if (0 == pipeline_sql_init)
+	{
+		zbx_vector_str_create(&pipeline_sql);
+		pipeline_sql_init = 1;
+	}
+
+	txn_level++;
+	txn_pipeline = 1;
+
+	if (ZBX_DB_DOWN == (rc = zbx_db_execute_basic("begin;")))
+	{
+		txn_level--;
+		txn_pipeline = 0;
+	}
+
+	return rc;
+#else
+	return zbx_db_begin_basic();
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: commit transaction                                                *
@@ -1097,6 +1369,17 @@ int	zbx_db_commit_basic(void)
 #elif defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL) || defined(HAVE_SQLITE3)
 	rc = zbx_db_execute_basic("commit;");
 #endif
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	if (0 != txn_pipeline)
+	{
+		/* the commit is sent in pipeline mode, its result is read with the results of other statements */
+		if (ZBX_DB_OK <= rc)
+			rc = zbx_db_pipeline_flush();
+
+		if (ZBX_DB_OK <= rc)
+			txn_pipeline = 0;
+	}
+#endif
 
 	if (ZBX_DB_OK > rc) { /* commit failed */
 		txn_error = rc;
@@ -1134,6 +1417,20 @@ int	zbx_db_rollback_basic(void)
 		assert(0);
 	}
 
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	if (0 != txn_pipeline)
+	{
+		/* pending results must be read before leaving pipeline mode, errors are already known or */
+		/* irrelevant as the transaction is rolled back anyway */
+		if (NULL != conn && PQ_PIPELINE_OFF != PQpipelineStatus(conn))
+		{
+			if (ZBX_DB_DOWN != zbx_db_pipeline_sync())
+				PQexitPipelineMode(conn);
+		}
+
+		txn_pipeline = 0;
+	}
+#endif
 	last_txn_error = txn_error;
 
 	/* allow rollback of failed transaction */
@@ -1489,7 +1786,6 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 	sword		err = OCI_SUCCESS;
 #elif defined(HAVE_POSTGRESQL)
 	PGresult	*result;
-	char		*error = NULL;
 #elif defined(HAVE_SQLITE3)
 	int		err;
 	char		*error = NULL;
@@ -1513,6 +1809,13 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 
 	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s]", txn_level, sql);
 
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	if (0 != txn_pipeline)
+	{
+		ret = zbx_db_pipeline_execute(sql);
+		goto out;
+	}
+#endif
 #if defined(HAVE_MYSQL)
 	if (NULL == conn)
 	{
@@ -1586,23 +1889,7 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
 	}
 	else if (PGRES_COMMAND_OK != PQresultStatus(result))
-	{
-		zbx_err_codes_t	errcode;
-
-		zbx_postgresql_error(&error, result);
-
-		if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
-			errcode = ERR_Z3008;
-		else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
-			errcode = ERR_Z3009;
-		else
-			errcode = ERR_Z3005;
-
-		zbx_db_errlog(errcode, 0, error, sql);
-		zbx_free(error);
-
-		ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
-	}
+		ret = zbx_postgresql_execute_error(result, sql);
 
 	if (ZBX_DB_OK == ret)
 		ret = atoi(PQcmdTuples(result));
@@ -1643,7 +1930,9 @@ lbl_exec:
 	if (0 == txn_level)
 		zbx_mutex_unlock(sqlite_access);
 #endif	/* HAVE_SQLITE3 */
-
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+out:
+#endif
 	if (0 != config_log_slow_queries)
 	{
 		sec = zbx_time() - sec;
@@ -1662,6 +1951,114 @@ clean:
 	return ret;
 }
 
+#ifdef HAVE_POSTGRESQL
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute copy from stdin statement                                 *
+ *                                                                            *
+ * Parameters: sql      - [IN] copy ... from stdin statement                  *
+ *             data     - [IN] data to copy in the statement format           *
+ *             data_len - [IN] data length in bytes                           *
+ *                                                                            *
+ * Return value: number of copied rows, ZBX_DB_FAIL or ZBX_DB_DOWN            *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_copy_basic(const char *sql, const char *data, size_t data_len)
+{
+#define ZBX_PG_COPY_CHUNK_SIZE	(ZBX_MEBIBYTE)
+	int		ret = ZBX_DB_OK;
+	double		sec = 0;
+	size_t		offset, size;
+	PGresult	*result;
+
+	if (0 != config_log_slow_queries)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+#ifdef LIBPQ_HAS_PIPELINING
+	/* copy is not allowed in pipeline mode, the pipelined statements must be completed first */
+	if (0 != txn_pipeline && ZBX_DB_OK != (ret = zbx_db_pipeline_flush()))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] after failed pipelined statements",
+				txn_level, sql);
+		goto out;
+	}
+#endif
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level,
+				sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] data:" ZBX_FS_SIZE_T " bytes", txn_level, sql,
+			(zbx_fs_size_t)data_len);
+
+	if (NULL == (result = PQexec(conn, sql)))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	if (PGRES_COPY_IN != PQresultStatus(result))
+	{
+		ret = zbx_postgresql_execute_error(result, sql);
+		PQclear(result);
+		goto out;
+	}
+
+	PQclear(result);
+
+	for (offset = 0; offset < data_len; offset += size)
+	{
+		if (ZBX_PG_COPY_CHUNK_SIZE < (size = data_len - offset))
+			size = ZBX_PG_COPY_CHUNK_SIZE;
+
+		if (1 != PQputCopyData(conn, data + offset, (int)size))
+			break;
+	}
+
+	/* on failure abort the copy to receive the error result from server */
+	if (1 != PQputCopyEnd(conn, offset < data_len ? PQerrorMessage(conn) : NULL))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+	}
+
+	/* the copy result must be consumed even if the copy was not finished successfully */
+	while (NULL != (result = PQgetResult(conn)))
+	{
+		if (ZBX_DB_OK == ret)
+		{
+			if (PGRES_COMMAND_OK != PQresultStatus(result))
+				ret = zbx_postgresql_execute_error(result, sql);
+			else
+				ret = atoi(PQcmdTuples(result));
+		}
+
+		PQclear(result);
+	}
+out:
+	if (0 != config_log_slow_queries)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)config_log_slow_queries / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+#undef ZBX_PG_COPY_CHUNK_SIZE
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute a select statement                                        *
@@ -1691,6 +2088,15 @@ zbx_db_result_t	zbx_db_vselect(const char *fmt, va_list args)
 
 	sql = zbx_dvsprintf(sql, fmt, args);
 
+#if defined(HAVE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+	/* select must see the changes made by pipelined statements, failure of a pipelined */
+	/* statement marks the transaction as failed and the select is ignored below        */
+	if (0 != txn_pipeline && ZBX_DB_DOWN == zbx_db_pipeline_flush())
+	{
+		result = (zbx_db_result_t)ZBX_DB_DOWN;
+		goto clean;
+	}
+#endif
 	if (ZBX_DB_OK != txn_error)
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
@@ -65,7 +65,7 @@
 ZBX_PTR_VECTOR_IMPL(db_event, zbx_db_event *)
 ZBX_PTR_VECTOR_IMPL(events_ptr, zbx_event_t *)
 
-static int	connection_failure;
+static ZBX_THREAD_LOCAL int	connection_failure;
 
 static const zbx_config_dbhigh_t	*zbx_cfg_dbhigh = NULL;
 
@@ -115,6 +115,11 @@ int	zbx_db_validate_config_features(unsigned char program_type, const zbx_config
 			"MySQL library version that support configuration of TLSv1.3 ciphersuites"));
 #endif
 
+#if !defined(HAVE_POSTGRESQL)
+	err |= (FAIL == check_cfg_feature_int("DBHistoryCopy", config_dbhigh->config_db_history_copy,
+			"PostgreSQL database support"));
+#endif
+
 	return 0 != err ? FAIL : SUCCEED;
 }
 
@@ -304,6 +309,21 @@ void	zbx_db_begin(void)
 	DBtxn_operation(zbx_db_begin_basic);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: start a transaction with pipelined statements                     *
+ *                                                                            *
+ * Comments: The statements don't wait for their results, so only errors are  *
+ *           reported (by commit) and affected row count is always 0.         *
+ *           Use it only for transactions that don't check affected rows.     *
+ *           Falls back to normal transaction if pipelining is not supported. *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_begin_pipeline(void)
+{
+	DBtxn_operation(zbx_db_begin_pipeline_basic);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: commit a transaction                                              *
@@ -2547,7 +2567,7 @@ out:
 #endif
 }
 
-#ifdef HAVE_ORACLE
+#if defined(HAVE_ORACLE) || defined(HAVE_POSTGRESQL)
 /******************************************************************************
  *                                                                            *
  * Purpose: format bulk operation (insert, update) value list                 *
@@ -2682,6 +2702,7 @@ void	zbx_db_insert_prepare_dyn(zbx_db_insert_t *self, const zbx_db_table_t *tabl
 
 	self->autoincrement = -1;
 	self->lastid = 0;
+	self->copy = 0;
 
 	zbx_vector_ptr_create(&self->fields);
 	zbx_vector_ptr_create(&self->rows);
@@ -2784,7 +2805,9 @@ void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, zbx_db_value_t **values
 #ifdef HAVE_ORACLE
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_OFF);
 #else
-				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_ON);
+				/* copied values are transferred as is and must not be escaped */
+				row[i].str = DBdyn_escape_field_len(field, value->str,
+						0 == self->copy ? ESCAPE_SEQUENCE_ON : ESCAPE_SEQUENCE_OFF);
 #endif
 				break;
 			case ZBX_TYPE_INT:
@@ -2903,6 +2926,236 @@ static void	decode_and_escape_binary_value_for_sql(char **sql_insert_data)
 }
 #endif
 
+#ifdef HAVE_POSTGRESQL
+/* PostgreSQL binary copy format signature, followed by 32-bit flags and header extension length fields */
+#define ZBX_PG_COPY_SIGNATURE		"PGCOPY\n\377\r\n"
+#define ZBX_PG_COPY_SIGNATURE_LEN	11
+
+#define ZBX_PG_NUMERIC_BASE		10000
+#define ZBX_PG_NUMERIC_DIGITS_MAX	5
+
+static char	*db_copy_reserve(char **data, size_t *data_alloc, size_t *data_offset, size_t size)
+{
+	char	*ptr;
+
+	if (*data_offset + size > *data_alloc)
+	{
+		while (*data_offset + size > *data_alloc)
+			*data_alloc *= 2;
+
+		*data = (char *)zbx_realloc(*data, *data_alloc);
+	}
+
+	ptr = *data + *data_offset;
+	*data_offset += size;
+
+	return ptr;
+}
+
+static void	db_copy_add_uint16(char **data, size_t *data_alloc, size_t *data_offset, unsigned short value)
+{
+	unsigned char	*ptr = (unsigned char *)db_copy_reserve(data, data_alloc, data_offset, sizeof(value));
+
+	ptr[0] = (unsigned char)(value >> 8);
+	ptr[1] = (unsigned char)value;
+}
+
+static void	db_copy_add_uint32(char **data, size_t *data_alloc, size_t *data_offset, zbx_uint32_t value)
+{
+	unsigned char	*ptr = (unsigned char *)db_copy_reserve(data, data_alloc, data_offset, sizeof(value));
+
+	ptr[0] = (unsigned char)(value >> 24);
+	ptr[1] = (unsigned char)(value >> 16);
+	ptr[2] = (unsigned char)(value >> 8);
+	ptr[3] = (unsigned char)value;
+}
+
+static void	db_copy_add_uint64(char **data, size_t *data_alloc, size_t *data_offset, zbx_uint64_t value)
+{
+	db_copy_add_uint32(data, data_alloc, data_offset, (zbx_uint32_t)(value >> 32));
+	db_copy_add_uint32(data, data_alloc, data_offset, (zbx_uint32_t)value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds unsigned 64-bit value in numeric binary format - number of   *
+ *          base 10000 digits, weight of the first digit, sign, display scale *
+ *          and the digits starting with the most significant one            *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_add_numeric(char **data, size_t *data_alloc, size_t *data_offset, zbx_uint64_t value)
+{
+	unsigned short	digits[ZBX_PG_NUMERIC_DIGITS_MAX];
+	int		digits_num = 0, first = 0, i;
+
+	for (; 0 != value; value /= ZBX_PG_NUMERIC_BASE)
+		digits[digits_num++] = (unsigned short)(value % ZBX_PG_NUMERIC_BASE);
+
+	/* trailing zero digits are covered by the weight */
+	while (first < digits_num && 0 == digits[first])
+		first++;
+
+	db_copy_add_uint32(data, data_alloc, data_offset, (zbx_uint32_t)(4 + digits_num - first) * 2);
+	db_copy_add_uint16(data, data_alloc, data_offset, (unsigned short)(digits_num - first));
+	db_copy_add_uint16(data, data_alloc, data_offset, (unsigned short)(0 == digits_num ? 0 : digits_num - 1));
+	db_copy_add_uint16(data, data_alloc, data_offset, 0);
+	db_copy_add_uint16(data, data_alloc, data_offset, 0);
+
+	for (i = digits_num - 1; i >= first; i--)
+		db_copy_add_uint16(data, data_alloc, data_offset, digits[i]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: encodes bulk insert rows in PostgreSQL binary copy format         *
+ *                                                                            *
+ * Parameters: self        - [IN] the bulk insert data                        *
+ *             data        - [IN/OUT] the encoded data                        *
+ *             data_alloc  - [IN/OUT] the encoded data buffer size            *
+ *             data_offset - [IN/OUT] the encoded data length                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_insert_encode_copy(const zbx_db_insert_t *self, char **data, size_t *data_alloc,
+		size_t *data_offset)
+{
+	memcpy(db_copy_reserve(data, data_alloc, data_offset, ZBX_PG_COPY_SIGNATURE_LEN), ZBX_PG_COPY_SIGNATURE,
+			ZBX_PG_COPY_SIGNATURE_LEN);
+	db_copy_add_uint32(data, data_alloc, data_offset, 0);
+	db_copy_add_uint32(data, data_alloc, data_offset, 0);
+
+	for (int i = 0; i < self->rows.values_num; i++)
+	{
+		const zbx_db_value_t	*values = (const zbx_db_value_t *)self->rows.values[i];
+
+		db_copy_add_uint16(data, data_alloc, data_offset, (unsigned short)self->fields.values_num);
+
+		for (int j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_field_t	*field = (const zbx_db_field_t *)self->fields.values[j];
+			const zbx_db_value_t	*value = &values[j];
+			zbx_uint64_t		dbl_bits;
+			size_t			len;
+
+			switch (field->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_SHORTTEXT:
+				case ZBX_TYPE_LONGTEXT:
+				case ZBX_TYPE_CUID:
+					len = strlen(value->str);
+					db_copy_add_uint32(data, data_alloc, data_offset, (zbx_uint32_t)len);
+					memcpy(db_copy_reserve(data, data_alloc, data_offset, len), value->str, len);
+					break;
+				case ZBX_TYPE_INT:
+					db_copy_add_uint32(data, data_alloc, data_offset, sizeof(zbx_uint32_t));
+					db_copy_add_uint32(data, data_alloc, data_offset, (zbx_uint32_t)value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					memcpy(&dbl_bits, &value->dbl, sizeof(dbl_bits));
+					db_copy_add_uint32(data, data_alloc, data_offset, sizeof(zbx_uint64_t));
+					db_copy_add_uint64(data, data_alloc, data_offset, dbl_bits);
+					break;
+				case ZBX_TYPE_UINT:
+					db_copy_add_numeric(data, data_alloc, data_offset, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					/* zero identifier is inserted as null, see zbx_db_sql_id_ins() */
+					if (0 == value->ui64)
+					{
+						db_copy_add_uint32(data, data_alloc, data_offset, (zbx_uint32_t)-1);
+						break;
+					}
+
+					db_copy_add_uint32(data, data_alloc, data_offset, sizeof(zbx_uint64_t));
+					db_copy_add_uint64(data, data_alloc, data_offset, value->ui64);
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	/* file trailer */
+	db_copy_add_uint16(data, data_alloc, data_offset, (unsigned short)-1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes the prepared database bulk insert operation with binary  *
+ *          copy from stdin statement                                         *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: SUCCEED if the operation completed successfully or           *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_execute_copy(const zbx_db_insert_t *self)
+{
+	char	*sql = NULL, *data;
+	size_t	sql_alloc = 0, sql_offset = 0, data_alloc = 16 * ZBX_KIBIBYTE, data_offset = 0;
+	int	rc;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "copy %s (", self->table->table);
+
+	for (int i = 0; i < self->fields.values_num; i++)
+	{
+		const zbx_db_field_t	*field = (const zbx_db_field_t *)self->fields.values[i];
+
+		if (0 != i)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, field->name);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") from stdin (format binary)");
+
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_TRACE))
+	{
+		for (int i = 0; i < self->rows.values_num; i++)
+		{
+			char	*str;
+
+			str = zbx_db_format_values((zbx_db_field_t **)self->fields.values,
+					(const zbx_db_value_t *)self->rows.values[i], self->fields.values_num);
+			zabbix_log(LOG_LEVEL_TRACE, "copy [txnlev:%d] [%s]", zbx_db_txn_level(),
+					ZBX_NULL2EMPTY_STR(str));
+			zbx_free(str);
+		}
+	}
+
+	data = (char *)zbx_malloc(NULL, data_alloc);
+	db_insert_encode_copy(self, &data, &data_alloc, &data_offset);
+
+	rc = zbx_db_copy_basic(sql, data, data_offset);
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		zbx_db_close();
+		zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_copy_basic(sql, data, data_offset)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	zbx_free(data);
+	zbx_free(sql);
+
+	return ZBX_DB_OK <= rc ? SUCCEED : FAIL;
+}
+
+#undef ZBX_PG_COPY_SIGNATURE
+#undef ZBX_PG_COPY_SIGNATURE_LEN
+#undef ZBX_PG_NUMERIC_BASE
+#undef ZBX_PG_NUMERIC_DIGITS_MAX
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: executes the prepared database bulk insert operation              *
@@ -2955,6 +3208,11 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 		self->autoincrement = -1;
 	}
 
+#ifdef HAVE_POSTGRESQL
+	if (0 != self->copy)
+		return db_insert_execute_copy(self);
+#endif
+
 #ifndef HAVE_ORACLE
 	sql = (char *)zbx_malloc(NULL, sql_alloc);
 #endif
@@ -3216,6 +3474,55 @@ void	zbx_db_insert_autoincrement(zbx_db_insert_t *self, const char *field_name)
 	exit(EXIT_FAILURE);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: inserts rows with binary COPY protocol when it is enabled in      *
+ *          configuration and supported by database and target fields         *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Comments: Must be called before adding values, otherwise it's ignored.     *
+ *           The insert statements are used when copy cannot be used.         *
+ *           Unsigned fields are encoded as numeric, so the copy must not be  *
+ *           used for tables with serial fields.                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_insert_use_copy(zbx_db_insert_t *self)
+{
+#ifdef HAVE_POSTGRESQL
+	if (NULL == zbx_cfg_dbhigh || 0 == zbx_cfg_dbhigh->config_db_history_copy || 0 != self->rows.values_num)
+		return;
+
+	for (int i = 0; i < self->fields.values_num; i++)
+	{
+		const zbx_db_field_t	*field = (const zbx_db_field_t *)self->fields.values[i];
+
+		switch (field->type)
+		{
+			case ZBX_TYPE_CHAR:
+			case ZBX_TYPE_TEXT:
+			case ZBX_TYPE_SHORTTEXT:
+			case ZBX_TYPE_LONGTEXT:
+			case ZBX_TYPE_CUID:
+				if (0 != (field->flags & ZBX_UPPER))
+					return;
+				break;
+			case ZBX_TYPE_INT:
+			case ZBX_TYPE_FLOAT:
+			case ZBX_TYPE_UINT:
+			case ZBX_TYPE_ID:
+				break;
+			default:
+				return;
+		}
+	}
+
+	self->copy = 1;
+#else
+	ZBX_UNUSED(self);
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: return the last id assigned by autoincrement                      *
@@ -31,6 +31,7 @@
 #include "zbxdbhigh.h"
 #include "zbxstr.h"
 #include "zbxthreads.h"
+#include "zbxexpression.h"
 
 static sigset_t			orig_mask;
 
@@ -107,7 +108,7 @@ ZBX_THREAD_ENTRY(zbx_dbsyncer_thread, args)
 				triggers_num;
 	double			sec, total_sec = 0.0;
 	time_t			last_stat_time;
-	char			*stats = NULL;
+	char			*stats = NULL, *error = NULL;
 	const char		*process_name;
 	size_t			stats_alloc = 0, stats_offset = 0;
 	const zbx_thread_info_t	*info = &((zbx_thread_args_t *)args)->info;
@@ -149,6 +150,12 @@ ZBX_THREAD_ENTRY(zbx_dbsyncer_thread, args)
 	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_EVENTS))
 		problems_export = zbx_problems_export_init(get_problems_export, "history-syncer", process_num);
 
+	if (SUCCEED != zbx_trigger_pool_init(dbsyncer_args->config_trigger_threads, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot start trigger evaluation threads: %s", error);
+		zbx_free(error);
+	}
+
 	for (;;)
 	{
 		sec = zbx_time();
@@ -230,6 +237,8 @@ ZBX_THREAD_ENTRY(zbx_dbsyncer_thread, args)
 
 	zbx_log_sync_history_cache_progress();
 
+	zbx_trigger_pool_destroy();
+
 	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_HISTORY))
 		zbx_export_deinit(history_export);
 
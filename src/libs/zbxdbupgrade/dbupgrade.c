@@ -1408,6 +1408,99 @@ int	DBcreate_changelog_update_trigger(const char *table_name, const char *field_
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates changelog update trigger registering only updates of      *
+ *          the specified fields                                              *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             field_name - [IN] primary key field                            *
+ *             fields     - [IN] comma separated list of tracked fields       *
+ *                                                                            *
+ * Comments: Used for tables with frequently updated runtime fields, so       *
+ *           their updates are not registered in changelog.                   *
+ *                                                                            *
+ ******************************************************************************/
+int	DBcreate_changelog_update_fields_trigger(const char *table_name, const char *field_name, const char *fields)
+{
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset = 0;
+	int	table_type, ret = FAIL;
+
+	if (FAIL == (table_type = DBget_changelog_table_by_name(table_name)))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return FAIL;
+	}
+
+#ifdef HAVE_ORACLE
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"create trigger %s_update after update of %s on %s\n"
+				"for each row\n"
+				"begin\n"
+					"insert into changelog (object,objectid,operation,clock)\n"
+						"values (%d,:old.%s,%d,(cast(sys_extract_utc(systimestamp) as date)"
+						"-date'1970-01-01')*86400);\n"
+				"end;", table_name, fields, table_name, table_type, field_name, ZBX_CHANGELOG_OP_UPDATE);
+#elif HAVE_MYSQL
+	const char	*field, *end;
+
+	/* MySQL does not support column list in update trigger, the values are compared instead */
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"create trigger %s_update after update on %s\n"
+				"for each row\n"
+					"insert into changelog (object,objectid,operation,clock)\n"
+						"select %d,old.%s,%d,unix_timestamp() from dual where",
+				table_name, table_name, table_type, field_name, ZBX_CHANGELOG_OP_UPDATE);
+
+	for (field = fields; NULL != field; field = (NULL != end ? end + 1 : NULL))
+	{
+		int	len;
+
+		if (NULL != (end = strchr(field, ',')))
+			len = (int)(end - field);
+		else
+			len = (int)strlen(field);
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "%s old.%.*s<>new.%.*s", field == fields ? "" : " or",
+				len, field, len, field);
+	}
+#elif HAVE_POSTGRESQL
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"create or replace function changelog_%s_update() returns trigger as $$\n"
+			"begin\n"
+				"insert into changelog (object,objectid,operation,clock)\n"
+					"values (%d,old.%s,%d,cast(extract(epoch from now()) as int));\n"
+				"return new;\n"
+			"end;\n"
+			"$$ language plpgsql;\n"
+			"create trigger %s_update after update of %s on %s\n"
+				"for each row\n"
+					"execute procedure changelog_%s_update();",
+				table_name, table_type, field_name, ZBX_CHANGELOG_OP_UPDATE, table_name, fields, table_name,
+				table_name);
+#endif
+
+	if (ZBX_DB_OK <= zbx_db_execute("%s", sql))
+		ret = SUCCEED;
+
+	zbx_free(sql);
+
+	return ret;
+}
+
+int	DBdrop_changelog_update_trigger(const char *table_name)
+{
+#ifdef HAVE_POSTGRESQL
+	if (ZBX_DB_OK > zbx_db_execute("drop trigger %s_update on %s", table_name, table_name))
+		return FAIL;
+#else
+	if (ZBX_DB_OK > zbx_db_execute("drop trigger %s_update", table_name))
+		return FAIL;
+#endif
+	return SUCCEED;
+}
+
 int	DBcreate_changelog_delete_trigger(const char *table_name, const char *field_name)
 {
 	char	*sql = NULL;
@@ -84,6 +84,8 @@ int	DBcreate_serial_trigger(const char *table_name, const char *field_name);
 
 int	DBcreate_changelog_insert_trigger(const char *table_name, const char *field_name);
 int	DBcreate_changelog_update_trigger(const char *table_name, const char *field_name);
+int	DBcreate_changelog_update_fields_trigger(const char *table_name, const char *field_name, const char *fields);
+int	DBdrop_changelog_update_trigger(const char *table_name);
 int	DBcreate_changelog_delete_trigger(const char *table_name, const char *field_name);
 
 int	zbx_dbupgrade_attach_trigger_with_function_on_insert(const char *table_name,
@@ -3249,6 +3249,227 @@ out:
 
 	return ret;
 }
+
+static int	DBpatch_6050211(void)
+{
+	return DBcreate_changelog_insert_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_6050212(void)
+{
+	return DBcreate_changelog_update_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_6050213(void)
+{
+	return DBcreate_changelog_delete_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_6050214(void)
+{
+	return DBcreate_changelog_insert_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_6050215(void)
+{
+	return DBcreate_changelog_update_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_6050216(void)
+{
+	return DBcreate_changelog_delete_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_6050217(void)
+{
+	return DBcreate_changelog_insert_trigger("interface", "interfaceid");
+}
+
+static int	DBpatch_6050218(void)
+{
+	return DBcreate_changelog_update_trigger("interface", "interfaceid");
+}
+
+static int	DBpatch_6050219(void)
+{
+	return DBcreate_changelog_delete_trigger("interface", "interfaceid");
+}
+
+static int	DBpatch_6050220(void)
+{
+	return DBcreate_changelog_insert_trigger("interface_snmp", "interfaceid");
+}
+
+static int	DBpatch_6050221(void)
+{
+	return DBcreate_changelog_update_trigger("interface_snmp", "interfaceid");
+}
+
+static int	DBpatch_6050222(void)
+{
+	return DBcreate_changelog_delete_trigger("interface_snmp", "interfaceid");
+}
+
+static int	DBpatch_6050223(void)
+{
+	return DBcreate_changelog_insert_trigger("hosts_templates", "hosttemplateid");
+}
+
+static int	DBpatch_6050224(void)
+{
+	return DBcreate_changelog_update_trigger("hosts_templates", "hosttemplateid");
+}
+
+static int	DBpatch_6050225(void)
+{
+	return DBcreate_changelog_delete_trigger("hosts_templates", "hosttemplateid");
+}
+
+static int	DBpatch_6050226(void)
+{
+	return DBcreate_changelog_insert_trigger("hstgrp", "groupid");
+}
+
+static int	DBpatch_6050227(void)
+{
+	return DBcreate_changelog_update_trigger("hstgrp", "groupid");
+}
+
+static int	DBpatch_6050228(void)
+{
+	return DBcreate_changelog_delete_trigger("hstgrp", "groupid");
+}
+
+static int	DBpatch_6050229(void)
+{
+	return DBcreate_changelog_insert_trigger("hosts_groups", "hostgroupid");
+}
+
+static int	DBpatch_6050230(void)
+{
+	return DBcreate_changelog_update_trigger("hosts_groups", "hostgroupid");
+}
+
+static int	DBpatch_6050231(void)
+{
+	return DBcreate_changelog_delete_trigger("hosts_groups", "hostgroupid");
+}
+
+static int	DBpatch_6050232(void)
+{
+	return DBcreate_changelog_insert_trigger("actions", "actionid");
+}
+
+static int	DBpatch_6050233(void)
+{
+	return DBcreate_changelog_update_trigger("actions", "actionid");
+}
+
+static int	DBpatch_6050234(void)
+{
+	return DBcreate_changelog_delete_trigger("actions", "actionid");
+}
+
+static int	DBpatch_6050235(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenances", "maintenanceid");
+}
+
+static int	DBpatch_6050236(void)
+{
+	return DBcreate_changelog_update_trigger("maintenances", "maintenanceid");
+}
+
+static int	DBpatch_6050237(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenances", "maintenanceid");
+}
+
+static int	DBpatch_6050238(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenance_tag", "maintenancetagid");
+}
+
+static int	DBpatch_6050239(void)
+{
+	return DBcreate_changelog_update_trigger("maintenance_tag", "maintenancetagid");
+}
+
+static int	DBpatch_6050240(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenance_tag", "maintenancetagid");
+}
+
+static int	DBpatch_6050241(void)
+{
+	return DBcreate_changelog_insert_trigger("timeperiods", "timeperiodid");
+}
+
+static int	DBpatch_6050242(void)
+{
+	return DBcreate_changelog_update_trigger("timeperiods", "timeperiodid");
+}
+
+static int	DBpatch_6050243(void)
+{
+	return DBcreate_changelog_delete_trigger("timeperiods", "timeperiodid");
+}
+
+static int	DBpatch_6050244(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenances_windows", "maintenance_timeperiodid");
+}
+
+static int	DBpatch_6050245(void)
+{
+	return DBcreate_changelog_update_trigger("maintenances_windows", "maintenance_timeperiodid");
+}
+
+static int	DBpatch_6050246(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenances_windows", "maintenance_timeperiodid");
+}
+
+static int	DBpatch_6050247(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenances_groups", "maintenance_groupid");
+}
+
+static int	DBpatch_6050248(void)
+{
+	return DBcreate_changelog_update_trigger("maintenances_groups", "maintenance_groupid");
+}
+
+static int	DBpatch_6050249(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenances_groups", "maintenance_groupid");
+}
+
+static int	DBpatch_6050250(void)
+{
+	return DBcreate_changelog_insert_trigger("maintenances_hosts", "maintenance_hostid");
+}
+
+static int	DBpatch_6050251(void)
+{
+	return DBcreate_changelog_update_trigger("maintenances_hosts", "maintenance_hostid");
+}
+
+static int	DBpatch_6050252(void)
+{
+	return DBcreate_changelog_delete_trigger("maintenances_hosts", "maintenance_hostid");
+}
+
+static int	DBpatch_6050253(void)
+{
+	return DBdrop_changelog_update_trigger("interface");
+}
+
+static int	DBpatch_6050254(void)
+{
+	/* availability fields are updated by pollers and are not synchronized through changelog */
+	return DBcreate_changelog_update_fields_trigger("interface", "interfaceid", "hostid,main,type,useip,ip,dns,port");
+}
 #endif
 
 DBPATCH_START(6050)
@@ -3464,5 +3685,49 @@ DBPATCH_ADD(6050207, 0, 1)
 DBPATCH_ADD(6050208, 0, 1)
 DBPATCH_ADD(6050209, 0, 1)
 DBPATCH_ADD(6050210, 0, 1)
+DBPATCH_ADD(6050211, 0, 1)
+DBPATCH_ADD(6050212, 0, 1)
+DBPATCH_ADD(6050213, 0, 1)
+DBPATCH_ADD(6050214, 0, 1)
+DBPATCH_ADD(6050215, 0, 1)
+DBPATCH_ADD(6050216, 0, 1)
+DBPATCH_ADD(6050217, 0, 1)
+DBPATCH_ADD(6050218, 0, 1)
+DBPATCH_ADD(6050219, 0, 1)
+DBPATCH_ADD(6050220, 0, 1)
+DBPATCH_ADD(6050221, 0, 1)
+DBPATCH_ADD(6050222, 0, 1)
+DBPATCH_ADD(6050223, 0, 1)
+DBPATCH_ADD(6050224, 0, 1)
+DBPATCH_ADD(6050225, 0, 1)
+DBPATCH_ADD(6050226, 0, 1)
+DBPATCH_ADD(6050227, 0, 1)
+DBPATCH_ADD(6050228, 0, 1)
+DBPATCH_ADD(6050229, 0, 1)
+DBPATCH_ADD(6050230, 0, 1)
+DBPATCH_ADD(6050231, 0, 1)
+DBPATCH_ADD(6050232, 0, 1)
+DBPATCH_ADD(6050233, 0, 1)
+DBPATCH_ADD(6050234, 0, 1)
+DBPATCH_ADD(6050235, 0, 1)
+DBPATCH_ADD(6050236, 0, 1)
+DBPATCH_ADD(6050237, 0, 1)
+DBPATCH_ADD(6050238, 0, 1)
+DBPATCH_ADD(6050239, 0, 1)
+DBPATCH_ADD(6050240, 0, 1)
+DBPATCH_ADD(6050241, 0, 1)
+DBPATCH_ADD(6050242, 0, 1)
+DBPATCH_ADD(6050243, 0, 1)
+DBPATCH_ADD(6050244, 0, 1)
+DBPATCH_ADD(6050245, 0, 1)
+DBPATCH_ADD(6050246, 0, 1)
+DBPATCH_ADD(6050247, 0, 1)
+DBPATCH_ADD(6050248, 0, 1)
+DBPATCH_ADD(6050249, 0, 1)
+DBPATCH_ADD(6050250, 0, 1)
+DBPATCH_ADD(6050251, 0, 1)
+DBPATCH_ADD(6050252, 0, 1)
+DBPATCH_ADD(6050253, 0, 1)
+DBPATCH_ADD(6050254, 0, 1)
 
 DBPATCH_END()
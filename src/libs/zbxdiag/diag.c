@@ -36,9 +36,15 @@
 #define ZBX_DIAG_HISTORYCACHE_VALUES		0x00000002
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_DATA	0x00000004
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX	0x00000008
+#define ZBX_DIAG_HISTORYCACHE_SHARDS		0x00000010
+#define ZBX_DIAG_HISTORYCACHE_RING		0x00000020
+#define ZBX_DIAG_HISTORYCACHE_TRIGGERS		0x00000040
 
 #define ZBX_DIAG_HISTORYCACHE_SIMPLE	(ZBX_DIAG_HISTORYCACHE_ITEMS | \
-					ZBX_DIAG_HISTORYCACHE_VALUES)
+					ZBX_DIAG_HISTORYCACHE_VALUES | \
+					ZBX_DIAG_HISTORYCACHE_SHARDS | \
+					ZBX_DIAG_HISTORYCACHE_RING | \
+					ZBX_DIAG_HISTORYCACHE_TRIGGERS)
 
 #define ZBX_DIAG_HISTORYCACHE_MEMORY	(ZBX_DIAG_HISTORYCACHE_MEMORY_DATA | \
 					ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX)
@@ -267,6 +273,9 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 					{"memory", ZBX_DIAG_HISTORYCACHE_MEMORY},
 					{"memory.data", ZBX_DIAG_HISTORYCACHE_MEMORY_DATA},
 					{"memory.index", ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX},
+					{"shards", ZBX_DIAG_HISTORYCACHE_SHARDS},
+					{"ring", ZBX_DIAG_HISTORYCACHE_RING},
+					{"triggers", ZBX_DIAG_HISTORYCACHE_TRIGGERS},
 					{NULL, 0}
 					};
 
@@ -280,10 +289,23 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 
 		if (0 != (fields & ZBX_DIAG_HISTORYCACHE_SIMPLE))
 		{
-			zbx_uint64_t	values_num, items_num;
+			zbx_uint64_t			values_num, items_num;
+			zbx_vector_hc_shard_stats_t	shards;
+			zbx_hc_ring_stats_t		ring;
+			zbx_hc_trigger_stats_t		triggers;
+			int				ring_enabled = FAIL;
+
+			zbx_vector_hc_shard_stats_create(&shards);
 
 			time1 = zbx_time();
-			zbx_hc_get_diag_stats(&items_num, &values_num);
+			zbx_hc_get_diag_stats(&items_num, &values_num,
+					0 != (fields & ZBX_DIAG_HISTORYCACHE_SHARDS) ? &shards : NULL);
+
+			if (0 != (fields & ZBX_DIAG_HISTORYCACHE_RING))
+				ring_enabled = zbx_hc_get_ring_stats(&ring);
+
+			if (0 != (fields & ZBX_DIAG_HISTORYCACHE_TRIGGERS))
+				zbx_hc_get_trigger_stats(&triggers);
 			time2 = zbx_time();
 			time_total += time2 - time1;
 
@@ -291,6 +313,49 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 				zbx_json_adduint64(json, "items", items_num);
 			if (0 != (fields & ZBX_DIAG_HISTORYCACHE_VALUES))
 				zbx_json_adduint64(json, "values", values_num);
+
+			if (0 != (fields & ZBX_DIAG_HISTORYCACHE_SHARDS))
+			{
+				zbx_json_addarray(json, "shards");
+
+				for (i = 0; i < shards.values_num; i++)
+				{
+					zbx_json_addobject(json, NULL);
+					zbx_json_adduint64(json, "items", shards.values[i].items_num);
+					zbx_json_adduint64(json, "values", shards.values[i].values_num);
+					zbx_json_adduint64(json, "locks", shards.values[i].locks_num);
+					zbx_json_adduint64(json, "contended", shards.values[i].locks_contended);
+					zbx_json_close(json);
+				}
+
+				zbx_json_close(json);
+			}
+
+			if (SUCCEED == ring_enabled)
+			{
+				zbx_json_addobject(json, "ring");
+				zbx_json_adduint64(json, "size", ring.size);
+				zbx_json_adduint64(json, "values", ring.values_num);
+				zbx_json_adduint64(json, "pushed", ring.pushed_num);
+				zbx_json_adduint64(json, "drained", ring.drained_num);
+				zbx_json_adduint64(json, "full", ring.full_num);
+				zbx_json_adduint64(json, "waits", ring.waits_num);
+				zbx_json_close(json);
+			}
+
+			if (0 != (fields & ZBX_DIAG_HISTORYCACHE_TRIGGERS))
+			{
+				zbx_json_addobject(json, "triggers");
+				zbx_json_adduint64(json, "batches", triggers.batches_num);
+				zbx_json_adduint64(json, "evaluated", triggers.triggers_num);
+				zbx_json_adduint64(json, "parallel_batches", triggers.parallel_batches_num);
+				zbx_json_adduint64(json, "parallel_evaluated", triggers.parallel_triggers_num);
+				zbx_json_addfloat(json, "time", triggers.time_total);
+				zbx_json_addfloat(json, "time_max", triggers.time_max);
+				zbx_json_close(json);
+			}
+
+			zbx_vector_hc_shard_stats_destroy(&shards);
 		}
 
 		if (0 != (fields & ZBX_DIAG_HISTORYCACHE_MEMORY))
@@ -412,29 +477,39 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 {
 	int		i;
 #ifdef HAVE_VMINFO_T_UPDATES
-	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
+	const char	*names[ZBX_MUTEX_CACHE_SHARD] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_CACHE_RING"};
 #else
-	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
+	const char	*names[ZBX_MUTEX_CACHE_SHARD] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_CACHE_RING"};
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
-	for (i = 0; i < ZBX_MUTEX_COUNT; i++)
+	for (i = 0; i < ZBX_MUTEX_CACHE_SHARD; i++)
 	{
 		zbx_json_addobject(json, NULL);
 		zbx_json_addhex(json, names[i], (zbx_uint64_t)zbx_mutex_addr_get(i));
 		zbx_json_close(json);
 	}
 
+	for (; i < ZBX_MUTEX_COUNT; i++)
+	{
+		char	name[32];
+
+		zbx_snprintf(name, sizeof(name), "ZBX_MUTEX_CACHE_SHARD_%d", i - ZBX_MUTEX_CACHE_SHARD + 1);
+		zbx_json_addobject(json, NULL);
+		zbx_json_addhex(json, name, (zbx_uint64_t)zbx_mutex_addr_get(i));
+		zbx_json_close(json);
+	}
+
 	zbx_json_addobject(json, NULL);
 	zbx_json_addhex(json, "ZBX_RWLOCK_CONFIG", (zbx_uint64_t)zbx_rwlock_addr_get(ZBX_RWLOCK_CONFIG));
 	zbx_json_close(json);
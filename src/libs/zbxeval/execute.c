@@ -435,6 +435,31 @@ int	 eval_suffixed_number_parse(const char *value, char *suffix)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes numeric constant token value from expression              *
+ *                                                                            *
+ * Parameters: ctx   - [IN] evaluation context                                *
+ *             token - [IN] numeric constant token                            *
+ *             value - [OUT] decoded value                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	eval_decode_num_token(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		zbx_variant_t *value)
+{
+	zbx_uint64_t	ui64;
+
+	if (SUCCEED == zbx_is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1, &ui64))
+	{
+		zbx_variant_set_ui64(value, ui64);
+	}
+	else
+	{
+		zbx_variant_set_dbl(value, atof(ctx->expression + token->loc.l) *
+				suffix2factor(ctx->expression[token->loc.r]));
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: pushes value in output stack                                      *
@@ -459,18 +484,7 @@ static int	eval_execute_push_value(const zbx_eval_context_t *ctx, const zbx_eval
 	{
 		if (ZBX_EVAL_TOKEN_VAR_NUM == token->type)
 		{
-			zbx_uint64_t	ui64;
-
-			if (SUCCEED == zbx_is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1,
-					&ui64))
-			{
-				zbx_variant_set_ui64(&value, ui64);
-			}
-			else
-			{
-				zbx_variant_set_dbl(&value, atof(ctx->expression + token->loc.l) *
-						suffix2factor(ctx->expression[token->loc.r]));
-			}
+			eval_decode_num_token(ctx, token, &value);
 		}
 		else
 		{
@@ -1065,6 +1079,21 @@ static int	eval_execute_function_length(const zbx_eval_context_t *ctx, const zbx
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: converts time to local time in thread safe way                    *
+ *                                                                            *
+ * Comments: Unlike localtime() the localtime_r() function is not required to *
+ *           apply time zone changes, so tzset() is called explicitly.        *
+ *                                                                            *
+ ******************************************************************************/
+static struct tm	*eval_localtime(const time_t *now, struct tm *tm)
+{
+	tzset();
+
+	return localtime_r(now, tm);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluates date() function                                         *
@@ -1082,7 +1111,7 @@ static int	eval_execute_function_date(const zbx_eval_context_t *ctx, const zbx_e
 		zbx_vector_var_t *output, char **error)
 {
 	zbx_variant_t	value;
-	struct tm	*tm;
+	struct tm	tm_local, *tm;
 	time_t		now;
 
 	if (0 != token->opt)
@@ -1093,7 +1122,7 @@ static int	eval_execute_function_date(const zbx_eval_context_t *ctx, const zbx_e
 	}
 
 	now = ctx->ts.sec;
-	if (NULL == (tm = localtime(&now)))
+	if (NULL == (tm = eval_localtime(&now, &tm_local)))
 	{
 		*error = zbx_dsprintf(*error, "cannot convert time for function at \"%s\": %s",
 				ctx->expression + token->loc.l, zbx_strerror(errno));
@@ -1123,7 +1152,7 @@ static int	eval_execute_function_time(const zbx_eval_context_t *ctx, const zbx_e
 		zbx_vector_var_t *output, char **error)
 {
 	zbx_variant_t	value;
-	struct tm	*tm;
+	struct tm	tm_local, *tm;
 	time_t		now;
 
 	if (0 != token->opt)
@@ -1134,7 +1163,7 @@ static int	eval_execute_function_time(const zbx_eval_context_t *ctx, const zbx_e
 	}
 
 	now = ctx->ts.sec;
-	if (NULL == (tm = localtime(&now)))
+	if (NULL == (tm = eval_localtime(&now, &tm_local)))
 	{
 		*error = zbx_dsprintf(*error, "cannot convert time for function at \"%s\": %s",
 				ctx->expression + token->loc.l, zbx_strerror(errno));
@@ -1192,7 +1221,7 @@ static int	eval_execute_function_dayofweek(const zbx_eval_context_t *ctx, const
 		zbx_vector_var_t *output, char **error)
 {
 	zbx_variant_t	value;
-	struct tm	*tm;
+	struct tm	tm_local, *tm;
 	time_t		now;
 
 	if (0 != token->opt)
@@ -1203,7 +1232,7 @@ static int	eval_execute_function_dayofweek(const zbx_eval_context_t *ctx, const
 	}
 
 	now = ctx->ts.sec;
-	if (NULL == (tm = localtime(&now)))
+	if (NULL == (tm = eval_localtime(&now, &tm_local)))
 	{
 		*error = zbx_dsprintf(*error, "cannot convert time for function at \"%s\": %s",
 				ctx->expression + token->loc.l, zbx_strerror(errno));
@@ -1232,7 +1261,7 @@ static int	eval_execute_function_dayofmonth(const zbx_eval_context_t *ctx, const
 		zbx_vector_var_t *output, char **error)
 {
 	zbx_variant_t	value;
-	struct tm	*tm;
+	struct tm	tm_local, *tm;
 	time_t		now;
 
 	if (0 != token->opt)
@@ -1243,7 +1272,7 @@ static int	eval_execute_function_dayofmonth(const zbx_eval_context_t *ctx, const
 	}
 
 	now = ctx->ts.sec;
-	if (NULL == (tm = localtime(&now)))
+	if (NULL == (tm = eval_localtime(&now, &tm_local)))
 	{
 		*error = zbx_dsprintf(*error, "cannot convert time for function at \"%s\": %s",
 				ctx->expression + token->loc.l, zbx_strerror(errno));
@@ -3396,3 +3425,140 @@ int	zbx_eval_execute_ext(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, zbx_
 
 	return eval_execute(ctx, value, error);
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets value of decoded numeric constant token                      *
+ *                                                                            *
+ * Parameters: token - [IN] token to check                                    *
+ *             value - [OUT] constant value                                   *
+ *                                                                            *
+ * Return value: SUCCEED - token is decoded numeric constant                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_get_const_dbl(const zbx_eval_token_t *token, double *value)
+{
+	if (ZBX_EVAL_TOKEN_VAR_NUM != token->type)
+		return FAIL;
+
+	switch (token->value.type)
+	{
+		case ZBX_VARIANT_UI64:
+			*value = (double)token->value.data.ui64;
+			return SUCCEED;
+		case ZBX_VARIANT_DBL:
+			*value = token->value.data.dbl;
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates arithmetic operator with constant operands             *
+ *                                                                            *
+ * Parameters: type  - [IN] operator token type                               *
+ *             left  - [IN] left operand                                      *
+ *             right - [IN] right operand (ignored for unary operators)       *
+ *             value - [OUT] calculated value                                 *
+ *                                                                            *
+ * Return value: SUCCEED - operator was calculated                            *
+ *               FAIL    - operator cannot be folded or the calculation would *
+ *                         fail during execution                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_fold_op(zbx_token_type_t type, double left, double right, double *value)
+{
+	switch (type)
+	{
+		case ZBX_EVAL_TOKEN_OP_MINUS:
+			*value = -left;
+			break;
+		case ZBX_EVAL_TOKEN_OP_ADD:
+			*value = left + right;
+			break;
+		case ZBX_EVAL_TOKEN_OP_SUB:
+			*value = left - right;
+			break;
+		case ZBX_EVAL_TOKEN_OP_MUL:
+			*value = left * right;
+			break;
+		case ZBX_EVAL_TOKEN_OP_DIV:
+			/* leave division by zero for execution to report the error */
+			if (SUCCEED == zbx_double_compare(right, 0))
+				return FAIL;
+			*value = left / right;
+			break;
+		default:
+			return FAIL;
+	}
+
+	if (FP_ZERO != fpclassify(*value) && FP_NORMAL != fpclassify(*value))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares parsed expression for repeated execution                 *
+ *                                                                            *
+ * Parameters: ctx - [IN/OUT] evaluation context                              *
+ *                                                                            *
+ * Comments: Numeric constants are decoded once instead of being parsed from  *
+ *           expression text during every execution and arithmetic operators  *
+ *           with constant operands are replaced by their results.            *
+ *           Operations that would fail (division by zero, NaN or Infinity    *
+ *           result) are left as is, so execution reports the same errors.    *
+ *           The folded constants are composed by value, so this function     *
+ *           must be used only for contexts prepared for execution.           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_eval_fold_constants(zbx_eval_context_t *ctx)
+{
+	int	i, j;
+	double	left, right, value;
+
+	for (i = 0, j = 0; i < ctx->stack.values_num; i++)
+	{
+		zbx_eval_token_t	*token = &ctx->stack.values[i], *out;
+
+		if (ZBX_EVAL_TOKEN_VAR_NUM == token->type && ZBX_VARIANT_NONE == token->value.type)
+		{
+			eval_decode_num_token(ctx, token, &token->value);
+		}
+		else if (ZBX_EVAL_TOKEN_OP_MINUS == token->type && 1 <= j)
+		{
+			out = &ctx->stack.values[j - 1];
+
+			if (SUCCEED == eval_get_const_dbl(out, &left) &&
+					SUCCEED == eval_fold_op(token->type, left, 0, &value))
+			{
+				zbx_variant_set_dbl(&out->value, value);
+				out->loc.l = token->loc.l;
+				continue;
+			}
+		}
+		else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2) && 2 <= j)
+		{
+			out = &ctx->stack.values[j - 2];
+
+			if (SUCCEED == eval_get_const_dbl(out, &left) && SUCCEED == eval_get_const_dbl(out + 1, &right) &&
+					SUCCEED == eval_fold_op(token->type, left, right, &value))
+			{
+				zbx_variant_set_dbl(&out->value, value);
+				out->loc.r = out[1].loc.r;
+				j--;
+				continue;
+			}
+		}
+
+		if (i != j)
+			ctx->stack.values[j] = *token;
+		j++;
+	}
+
+	ctx->stack.values_num = j;
+}
@@ -1083,6 +1083,7 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 	zbx_vector_history_record_t	values;
 	zbx_timespec_t			ts_end = *ts;
 	zbx_eval_count_pattern_data_t	pdata;
+	zbx_history_value_t		result;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() params:%s", __func__, ZBX_NULL2EMPTY_STR(parameters));
 
@@ -1137,6 +1138,19 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	/* plain count of time based window values is maintained by value cache */
+	if (0 != seconds && OP_ANY == pdata.op && COUNT_ALL == unique &&
+			SUCCEED == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_FUNCTION_COUNT, seconds,
+			&ts_end, &result, &count))
+	{
+		if (count > limit)
+			count = limit;
+
+		zbx_variant_set_dbl(value, count);
+		ret = SUCCEED;
+		goto clean;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1265,6 +1279,14 @@ static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	if (0 != seconds && SUCCEED == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_FUNCTION_SUM,
+			seconds, &ts_end, &result, &i))
+	{
+		zbx_history_value2variant(&result, item->value_type, value);
+		ret = SUCCEED;
+		goto out;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1296,6 +1318,47 @@ out:
 	return ret;
 }
 
+typedef struct
+{
+	double	value;
+	int	values_num;
+}
+evaluate_avg_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache callback to calculate running average of float values *
+ *                                                                            *
+ * Comments: The values are processed starting with the newest one, the same  *
+ *           order as returned by zbx_vc_get_values().                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	evaluate_avg_add_dbl_values(const zbx_history_record_t *values, int values_num, void *data)
+{
+	evaluate_avg_t	*avg = (evaluate_avg_t *)data;
+
+	for (int i = values_num - 1; 0 <= i; i--)
+	{
+		avg->values_num++;
+		avg->value += values[i].value.dbl / avg->values_num - avg->value / avg->values_num;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache callback to sum unsigned integer values               *
+ *                                                                            *
+ ******************************************************************************/
+static void	evaluate_avg_add_ui64_values(const zbx_history_record_t *values, int values_num, void *data)
+{
+	evaluate_avg_t	*avg = (evaluate_avg_t *)data;
+
+	for (int i = values_num - 1; 0 <= i; i--)
+		avg->value += (double)values[i].value.ui64;
+
+	avg->values_num += values_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate function 'avg' for the item.                             *
@@ -1314,15 +1377,15 @@ out:
 static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, ret = FAIL, i, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
+	zbx_value_type_t	arg1_type;
+	zbx_timespec_t		ts_end = *ts;
+	zbx_vc_values_func_t	values_func;
+	evaluate_avg_t		avg = {0};
+	zbx_history_value_t	result;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1356,29 +1419,32 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (0 != seconds && SUCCEED == zbx_vc_get_aggregate(item->itemid, item->value_type, ZBX_VC_FUNCTION_AVG,
+			seconds, &ts_end, &result, &avg.values_num))
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto out;
+		avg.value = result.dbl;
 	}
-
-	if (0 < values.values_num)
+	else
 	{
-		double	avg = 0;
-
 		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += values.values[i].value.dbl / (i + 1) - avg / (i + 1);
-		}
+			values_func = evaluate_avg_add_dbl_values;
 		else
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += (double)values.values[i].value.ui64;
+			values_func = evaluate_avg_add_ui64_values;
 
-			avg = avg / values.values_num;
+		if (FAIL == zbx_vc_iterate_values(item->itemid, item->value_type, seconds, nvalues, &ts_end,
+				values_func, &avg))
+		{
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto out;
 		}
-		zbx_variant_set_dbl(value, avg);
+
+		if (ITEM_VALUE_TYPE_UINT64 == item->value_type && 0 < avg.values_num)
+			avg.value = avg.value / avg.values_num;
+	}
+
+	if (0 < avg.values_num)
+	{
+		zbx_variant_set_dbl(value, avg.value);
 
 		ret = SUCCEED;
 	}
@@ -1388,8 +1454,6 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1432,17 +1496,49 @@ static int	evaluate_LAST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *ite
 #define EVALUATE_MIN	0
 #define EVALUATE_MAX	1
 
-#define LOOP_FIND_MIN_OR_MAX(type, mode_op)							\
-	do											\
-	{											\
-		for (i = 1; i < values.values_num; i++)							\
+typedef struct
+{
+	zbx_history_value_t	value;
+	int			values_num;
+	int			min_or_max;
+}
+evaluate_min_or_max_t;
+
+#define FIND_MIN_OR_MAX(type)										\
+	do												\
+	{												\
+		evaluate_min_or_max_t	*result = (evaluate_min_or_max_t *)data;				\
+													\
+		for (int i = values_num - 1; 0 <= i; i--, result->values_num++)				\
 		{											\
-			if (values.values[i].value.type mode_op values.values[index].value.type)	\
-				index = i;								\
+			if (0 == result->values_num ||							\
+					(EVALUATE_MIN == result->min_or_max ?				\
+					values[i].value.type < result->value.type :			\
+					values[i].value.type > result->value.type))			\
+			{										\
+				result->value.type = values[i].value.type;				\
+			}										\
 		}											\
 	}												\
 	while(0)
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: value cache callbacks to find minimum or maximum value            *
+ *                                                                            *
+ ******************************************************************************/
+static void	evaluate_min_or_max_dbl_values(const zbx_history_record_t *values, int values_num, void *data)
+{
+	FIND_MIN_OR_MAX(dbl);
+}
+
+static void	evaluate_min_or_max_ui64_values(const zbx_history_record_t *values, int values_num, void *data)
+{
+	FIND_MIN_OR_MAX(ui64);
+}
+
+#undef FIND_MIN_OR_MAX
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate function 'min' or 'max' for the item.                    *
@@ -1462,15 +1558,14 @@ static int	evaluate_LAST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *ite
 static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error, int min_or_max)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
+	zbx_value_type_t	arg1_type;
+	zbx_timespec_t		ts_end = *ts;
+	zbx_vc_values_func_t	values_func;
+	evaluate_min_or_max_t	result = {.min_or_max = min_or_max};
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1504,40 +1599,26 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (0 == seconds || SUCCEED != zbx_vc_get_aggregate(item->itemid, item->value_type,
+			EVALUATE_MIN == min_or_max ? ZBX_VC_FUNCTION_MIN : ZBX_VC_FUNCTION_MAX, seconds, &ts_end,
+			&result.value, &result.values_num))
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto out;
-	}
-
-	if (0 < values.values_num)
-	{
-		int	index = 0;
-
 		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, >);
-			}
-		}
+			values_func = evaluate_min_or_max_ui64_values;
 		else
+			values_func = evaluate_min_or_max_dbl_values;
+
+		if (FAIL == zbx_vc_iterate_values(item->itemid, item->value_type, seconds, nvalues, &ts_end,
+				values_func, &result))
 		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, >);
-			}
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto out;
 		}
+	}
 
-		zbx_history_value2variant(&values.values[index].value, item->value_type, value);
+	if (0 < result.values_num)
+	{
+		zbx_history_value2variant(&result.value, item->value_type, value);
 		ret = SUCCEED;
 	}
 	else
@@ -1546,8 +1627,6 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
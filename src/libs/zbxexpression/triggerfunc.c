@@ -19,6 +19,7 @@
 
 #include "evalfunc.h"
 #include "expression.h"
+#include "triggerpool.h"
 
 #include "zbxdbhigh.h"
 #include "zbxcacheconfig.h"
@@ -727,6 +728,68 @@ static int	dc_item_compare_by_itemid(const void *d1, const void *d2)
 	return 0;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates new trigger value based on its recovery mode and       *
+ *          expression evaluation                                             *
+ *                                                                            *
+ * Comments: Triggers are evaluated independently of each other, so this      *
+ *           function can be called from trigger evaluation pool threads.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	evaluate_trigger(zbx_dc_trigger_t *tr)
+{
+	double	expr_result;
+
+	if (NULL != tr->new_error)
+		return;
+
+	if (SUCCEED != evaluate_expression(tr->eval_ctx, &tr->timespec, &expr_result, &tr->new_error))
+		return;
+
+	/* trigger expression evaluates to true, set PROBLEM value */
+	if (SUCCEED != zbx_double_compare(expr_result, 0.0))
+	{
+		if (0 == (tr->flags & ZBX_DC_TRIGGER_PROBLEM_EXPRESSION))
+		{
+			/* trigger value should remain unchanged and no PROBLEM events should be generated if */
+			/* problem expression evaluates to true, but trigger recalculation was initiated by a */
+			/* time-based function or a new value of an item in recovery expression */
+			tr->new_value = TRIGGER_VALUE_NONE;
+		}
+		else
+			tr->new_value = TRIGGER_VALUE_PROBLEM;
+
+		return;
+	}
+
+	/* otherwise try to recover trigger by setting OK value */
+	if (TRIGGER_VALUE_PROBLEM == tr->value && TRIGGER_RECOVERY_MODE_NONE != tr->recovery_mode)
+	{
+		if (TRIGGER_RECOVERY_MODE_EXPRESSION == tr->recovery_mode)
+		{
+			tr->new_value = TRIGGER_VALUE_OK;
+			return;
+		}
+
+		/* processing recovery expression mode */
+		if (SUCCEED != evaluate_expression(tr->eval_ctx_r, &tr->timespec, &expr_result, &tr->new_error))
+		{
+			tr->new_value = TRIGGER_VALUE_UNKNOWN;
+			return;
+		}
+
+		if (SUCCEED != zbx_double_compare(expr_result, 0.0))
+		{
+			tr->new_value = TRIGGER_VALUE_OK;
+			return;
+		}
+	}
+
+	/* no changes, keep the old value */
+	tr->new_value = TRIGGER_VALUE_NONE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate trigger expressions.                                     *
@@ -734,15 +797,16 @@ static int	dc_item_compare_by_itemid(const void *d1, const void *d2)
  * Parameters: triggers - [IN] vector of zbx_dc_trigger_t pointers, sorted by *
  *                             triggerids                                     *
  *                                                                            *
+ * Return value: number of threads used to evaluate the expressions           *
+ *                                                                            *
  ******************************************************************************/
-void	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vector_uint64_t *history_itemids,
+int	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vector_uint64_t *history_itemids,
 		const zbx_history_sync_item_t *history_items, const int *history_errcodes)
 {
 	zbx_db_event		event;
 	zbx_dc_trigger_t	*tr;
 	zbx_history_sync_item_t	*items = NULL;
-	int			i, *items_err, items_num = 0;
-	double			expr_result;
+	int			i, *items_err, items_num = 0, threads_num;
 	zbx_dc_um_handle_t	*um_handle;
 	zbx_vector_uint64_t	hostids;
 
@@ -812,57 +876,12 @@ void	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vecto
 	}
 
 	/* calculate new trigger values based on their recovery modes and expression evaluations */
-	for (i = 0; i < triggers->values_num; i++)
+	if (FAIL == (threads_num = trigger_pool_evaluate(triggers, evaluate_trigger)))
 	{
-		tr = triggers->values[i];
-
-		if (NULL != tr->new_error)
-			continue;
-
-		if (SUCCEED != evaluate_expression(tr->eval_ctx, &tr->timespec, &expr_result, &tr->new_error))
-			continue;
-
-		/* trigger expression evaluates to true, set PROBLEM value */
-		if (SUCCEED != zbx_double_compare(expr_result, 0.0))
-		{
-			if (0 == (tr->flags & ZBX_DC_TRIGGER_PROBLEM_EXPRESSION))
-			{
-				/* trigger value should remain unchanged and no PROBLEM events should be generated if */
-				/* problem expression evaluates to true, but trigger recalculation was initiated by a */
-				/* time-based function or a new value of an item in recovery expression */
-				tr->new_value = TRIGGER_VALUE_NONE;
-			}
-			else
-				tr->new_value = TRIGGER_VALUE_PROBLEM;
-
-			continue;
-		}
-
-		/* otherwise try to recover trigger by setting OK value */
-		if (TRIGGER_VALUE_PROBLEM == tr->value && TRIGGER_RECOVERY_MODE_NONE != tr->recovery_mode)
-		{
-			if (TRIGGER_RECOVERY_MODE_EXPRESSION == tr->recovery_mode)
-			{
-				tr->new_value = TRIGGER_VALUE_OK;
-				continue;
-			}
-
-			/* processing recovery expression mode */
-			if (SUCCEED != evaluate_expression(tr->eval_ctx_r, &tr->timespec, &expr_result, &tr->new_error))
-			{
-				tr->new_value = TRIGGER_VALUE_UNKNOWN;
-				continue;
-			}
-
-			if (SUCCEED != zbx_double_compare(expr_result, 0.0))
-			{
-				tr->new_value = TRIGGER_VALUE_OK;
-				continue;
-			}
-		}
+		for (i = 0; i < triggers->values_num; i++)
+			evaluate_trigger(triggers->values[i]);
 
-		/* no changes, keep the old value */
-		tr->new_value = TRIGGER_VALUE_NONE;
+		threads_num = 1;
 	}
 
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
@@ -878,6 +897,8 @@ void	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vecto
 			}
 		}
 
-		zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+		zabbix_log(LOG_LEVEL_DEBUG, "End of %s() threads:%d", __func__, threads_num);
 	}
+
+	return threads_num;
 }
@@ -0,0 +1,322 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "triggerpool.h"
+
+#include "zbxexpression.h"
+#include "zbxcommon.h"
+#include "zbxregexp.h"
+#include "zbxself.h"
+#include "zbxthreads.h"
+
+/* number of triggers a thread takes from the batch at once */
+#define TRIGGER_POOL_CHUNK_SIZE		32
+
+/* batches smaller than this are evaluated by the calling process */
+#define TRIGGER_POOL_BATCH_MIN		(TRIGGER_POOL_CHUNK_SIZE * 2)
+
+typedef struct
+{
+	pthread_t		thread;
+	int			id;
+	zbx_log_component_t	logger;
+}
+zbx_trigger_pool_thread_t;
+
+typedef struct
+{
+	pthread_mutex_t			lock;
+
+	/* signals threads that new batch is available or the pool is stopping */
+	pthread_cond_t			event;
+
+	/* signals the caller that the batch has been evaluated */
+	pthread_cond_t			done;
+
+	zbx_vector_dc_trigger_t		*triggers;
+	zbx_trigger_eval_func_t		eval_func;
+	zbx_uint64_t			batchid;
+	int				next;
+	int				evaluated;
+	int				participants;
+	int				stop;
+
+	zbx_trigger_pool_thread_t	*threads;
+	int				threads_num;
+}
+zbx_trigger_pool_t;
+
+static zbx_trigger_pool_t	*trigger_pool = NULL;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates next chunk of the current batch                         *
+ *                                                                            *
+ * Parameters: pool    - [IN] the trigger pool                                *
+ *             batchid - [IN/OUT] the last batch the thread took part in      *
+ *                                                                            *
+ * Return value: SUCCEED - a chunk was evaluated                              *
+ *               FAIL    - there are no triggers left to evaluate             *
+ *                                                                            *
+ * Comments: This function must be called with pool locked. The lock is      *
+ *           released while triggers are being evaluated.                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	trigger_pool_evaluate_chunk(zbx_trigger_pool_t *pool, zbx_uint64_t *batchid)
+{
+	zbx_vector_dc_trigger_t	*triggers = pool->triggers;
+	zbx_trigger_eval_func_t	eval_func = pool->eval_func;
+	int			i, start, end;
+
+	if (NULL == triggers || pool->next >= triggers->values_num)
+		return FAIL;
+
+	if (*batchid != pool->batchid)
+	{
+		*batchid = pool->batchid;
+		pool->participants++;
+	}
+
+	start = pool->next;
+	end = MIN(start + TRIGGER_POOL_CHUNK_SIZE, triggers->values_num);
+	pool->next = end;
+
+	pthread_mutex_unlock(&pool->lock);
+
+	for (i = start; i < end; i++)
+		eval_func(triggers->values[i]);
+
+	pthread_mutex_lock(&pool->lock);
+
+	pool->evaluated += end - start;
+
+	if (pool->evaluated == triggers->values_num)
+		pthread_cond_signal(&pool->done);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: trigger evaluation thread entry                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	*trigger_pool_thread_entry(void *args)
+{
+	zbx_trigger_pool_thread_t	*thread = (zbx_trigger_pool_thread_t *)args;
+	char				component[MAX_ID_LEN + 1];
+	sigset_t			mask;
+	zbx_uint64_t			batchid = 0;
+	int				err;
+
+	zbx_snprintf(component, sizeof(component), "%d", thread->id);
+	zbx_set_log_component(component, &thread->logger);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "trigger evaluation thread #%d started", thread->id);
+
+	zbx_init_regexp_env();
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGUSR1);
+	sigaddset(&mask, SIGUSR2);
+	sigaddset(&mask, SIGHUP);
+	sigaddset(&mask, SIGQUIT);
+	sigaddset(&mask, SIGINT);
+
+	if (0 != (err = pthread_sigmask(SIG_BLOCK, &mask, NULL)))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot block signals: %s", zbx_strerror(err));
+
+	pthread_mutex_lock(&trigger_pool->lock);
+
+	while (0 == trigger_pool->stop)
+	{
+		if (SUCCEED != trigger_pool_evaluate_chunk(trigger_pool, &batchid))
+			pthread_cond_wait(&trigger_pool->event, &trigger_pool->lock);
+	}
+
+	pthread_mutex_unlock(&trigger_pool->lock);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "trigger evaluation thread #%d stopped", thread->id);
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts trigger evaluation threads                                 *
+ *                                                                            *
+ * Parameters: threads_num - [IN] number of threads to start                  *
+ *             error       - [OUT] the error message                          *
+ *                                                                            *
+ * Return value: SUCCEED - the pool was started or no threads were requested  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The calling process takes part in evaluation, so with N threads  *
+ *           a batch is evaluated by N + 1 threads.                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_trigger_pool_init(int threads_num, char **error)
+{
+	int		i, err;
+	pthread_attr_t	attr;
+
+	if (0 >= threads_num)
+		return SUCCEED;
+
+	trigger_pool = (zbx_trigger_pool_t *)zbx_malloc(NULL, sizeof(zbx_trigger_pool_t));
+	memset(trigger_pool, 0, sizeof(zbx_trigger_pool_t));
+
+	if (0 != (err = pthread_mutex_init(&trigger_pool->lock, NULL)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot initialize trigger pool mutex: %s", zbx_strerror(err));
+		zbx_free(trigger_pool);
+		return FAIL;
+	}
+
+	if (0 != (err = pthread_cond_init(&trigger_pool->event, NULL)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot initialize trigger pool conditional variable: %s",
+				zbx_strerror(err));
+		pthread_mutex_destroy(&trigger_pool->lock);
+		zbx_free(trigger_pool);
+		return FAIL;
+	}
+
+	if (0 != (err = pthread_cond_init(&trigger_pool->done, NULL)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot initialize trigger pool conditional variable: %s",
+				zbx_strerror(err));
+		pthread_cond_destroy(&trigger_pool->event);
+		pthread_mutex_destroy(&trigger_pool->lock);
+		zbx_free(trigger_pool);
+		return FAIL;
+	}
+
+	trigger_pool->threads = (zbx_trigger_pool_thread_t *)zbx_malloc(NULL,
+			sizeof(zbx_trigger_pool_thread_t) * (size_t)threads_num);
+	memset(trigger_pool->threads, 0, sizeof(zbx_trigger_pool_thread_t) * (size_t)threads_num);
+
+	zbx_pthread_init_attr(&attr);
+
+	for (i = 0; i < threads_num; i++)
+	{
+		trigger_pool->threads[i].id = i + 1;
+
+		if (0 != (err = pthread_create(&trigger_pool->threads[i].thread, &attr, trigger_pool_thread_entry,
+				(void *)&trigger_pool->threads[i])))
+		{
+			*error = zbx_dsprintf(NULL, "cannot create thread: %s", zbx_strerror(err));
+			break;
+		}
+
+		trigger_pool->threads_num++;
+	}
+
+	pthread_attr_destroy(&attr);
+
+	if (trigger_pool->threads_num != threads_num)
+	{
+		zbx_trigger_pool_destroy();
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stops trigger evaluation threads and frees the pool               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_trigger_pool_destroy(void)
+{
+	int	i;
+
+	if (NULL == trigger_pool)
+		return;
+
+	pthread_mutex_lock(&trigger_pool->lock);
+	trigger_pool->stop = 1;
+	pthread_cond_broadcast(&trigger_pool->event);
+	pthread_mutex_unlock(&trigger_pool->lock);
+
+	for (i = 0; i < trigger_pool->threads_num; i++)
+	{
+		void	*retval;
+
+		pthread_join(trigger_pool->threads[i].thread, &retval);
+	}
+
+	pthread_cond_destroy(&trigger_pool->done);
+	pthread_cond_destroy(&trigger_pool->event);
+	pthread_mutex_destroy(&trigger_pool->lock);
+
+	zbx_free(trigger_pool->threads);
+	zbx_free(trigger_pool);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates triggers with pool threads                              *
+ *                                                                            *
+ * Parameters: triggers  - [IN] the triggers to evaluate                      *
+ *             eval_func - [IN] the function evaluating single trigger        *
+ *                                                                            *
+ * Return value: number of threads used to evaluate the triggers or FAIL if   *
+ *               the pool is not running or the batch is too small, in which  *
+ *               case the triggers must be evaluated by the caller            *
+ *                                                                            *
+ * Comments: The triggers are split into chunks which are taken by the pool   *
+ *           threads and the caller in trigger order. The eval_func must only *
+ *           modify the trigger it was called for.                            *
+ *                                                                            *
+ ******************************************************************************/
+int	trigger_pool_evaluate(zbx_vector_dc_trigger_t *triggers, zbx_trigger_eval_func_t eval_func)
+{
+	int		threads_num;
+	zbx_uint64_t	batchid = 0;
+
+	if (NULL == trigger_pool || TRIGGER_POOL_BATCH_MIN > triggers->values_num)
+		return FAIL;
+
+	pthread_mutex_lock(&trigger_pool->lock);
+
+	trigger_pool->triggers = triggers;
+	trigger_pool->eval_func = eval_func;
+	trigger_pool->batchid++;
+	trigger_pool->next = 0;
+	trigger_pool->evaluated = 0;
+	trigger_pool->participants = 0;
+
+	pthread_cond_broadcast(&trigger_pool->event);
+
+	while (SUCCEED == trigger_pool_evaluate_chunk(trigger_pool, &batchid))
+		;
+
+	while (trigger_pool->evaluated != triggers->values_num)
+		pthread_cond_wait(&trigger_pool->done, &trigger_pool->lock);
+
+	trigger_pool->triggers = NULL;
+	threads_num = trigger_pool->participants;
+
+	pthread_mutex_unlock(&trigger_pool->lock);
+
+	return threads_num;
+}
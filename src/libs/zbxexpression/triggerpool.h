@@ -0,0 +1,29 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_TRIGGERPOOL_H
+#define ZABBIX_TRIGGERPOOL_H
+
+#include "zbxcacheconfig.h"
+
+typedef void	(*zbx_trigger_eval_func_t)(zbx_dc_trigger_t *trigger);
+
+int	trigger_pool_evaluate(zbx_vector_dc_trigger_t *triggers, zbx_trigger_eval_func_t eval_func);
+
+#endif
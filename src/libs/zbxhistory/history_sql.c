@@ -161,7 +161,9 @@ static int	sql_writer_flush(void)
 
 	do
 	{
-		zbx_db_begin();
+		/* inserts of all value types are sent without waiting for each other, except */
+		/* copy inserts - copy leaves pipeline mode and waits for the previous results */
+		zbx_db_begin_pipeline();
 
 		for (i = 0; i < writer.dbinserts.values_num; i++)
 		{
@@ -197,6 +199,7 @@ static void	add_history_dbl(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -216,6 +219,7 @@ static void	add_history_uint(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_uint", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -235,6 +239,7 @@ static void	add_history_str(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_str", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -254,6 +259,7 @@ static void	add_history_text(const zbx_vector_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_text", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -274,6 +280,7 @@ static void	add_history_log(const zbx_vector_ptr_t *history)
 
 	zbx_db_insert_prepare(db_insert, "history_log", "itemid", "clock", "ns", "timestamp", "source", "severity",
 			"value", "logeventid", (char *)NULL);
+	zbx_db_insert_use_copy(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -1,3 +1,5 @@
+#define _GNU_SOURCE	/* required for memfd_create() in sys/mman.h */
+
 #include "zbxcommon.h"
 
 #ifdef HAVE_IPCSERVICE
@@ -7,6 +9,9 @@
 #	include <event2/thread.h>
 #endif
 
+#include <sys/mman.h>
+#include <sched.h>
+
 #include "zbxipcservice.h"
 #include "zbxalgo.h"
 #include "zbxstr.h"
@@ -25,6 +30,70 @@ static size_t	ipc_path_root_len = 0;
 #define ZBX_IPC_ASYNC_SOCKET_STATE_TIMEOUT	1
 #define ZBX_IPC_ASYNC_SOCKET_STATE_ERROR	2
 
+#if defined(HAVE_ATOMIC_BUILTINS) && defined(HAVE_FUNCTION_MEMFD_CREATE)
+#	define ZBX_IPC_RING_SUPPORTED
+#	define ipc_ring_load(ptr)		__atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#	define ipc_ring_store(ptr, value)	__atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#	define ipc_ring_fence()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+/* rings are not created on such platforms, the fallbacks only keep the code compilable */
+#	define ipc_ring_load(ptr)		(*(ptr))
+#	define ipc_ring_store(ptr, value)	(*(ptr) = (value))
+#	define ipc_ring_fence()
+#endif
+
+/* reserved message code, sent by client with ring file descriptor attached right after connecting */
+#define ZBX_IPC_RING_OPEN		0xffffffff
+
+/* the number of processor yields and the interval to check for free ring space when the ring is full */
+#define ZBX_IPC_RING_YIELD_COUNT	100
+#define ZBX_IPC_RING_RETRY_MSEC		1
+#define ZBX_IPC_RING_RETRY_USEC		100
+
+#define ZBX_IPC_RING_CACHELINE_SIZE	64
+
+/* the maximum number of buffers passed to a single writev() call when sending queued messages */
+#define ZBX_IPC_CLIENT_TX_IOV_MAX	64
+
+/* the size of buffer used to read and parse client socket data in place */
+#define ZBX_IPC_CLIENT_RX_BUFFER_SIZE	(64 * ZBX_KIBIBYTE)
+
+/* Shared memory ring header, mapped by both client and service. The ring data follows the header. */
+/* Head and tail are free running byte counters, their difference is the number of unread bytes.   */
+typedef struct
+{
+	zbx_uint32_t	head;
+	unsigned char	pad1[ZBX_IPC_RING_CACHELINE_SIZE - sizeof(zbx_uint32_t)];
+	zbx_uint32_t	tail;
+	unsigned char	pad2[ZBX_IPC_RING_CACHELINE_SIZE - sizeof(zbx_uint32_t)];
+	zbx_uint32_t	size;
+	unsigned char	pad3[ZBX_IPC_RING_CACHELINE_SIZE - sizeof(zbx_uint32_t)];
+}
+zbx_ipc_ring_header_t;
+
+/* Shared memory ring, used to pass messages from client to service. The socket is used only */
+/* to wake up service when client writes data to empty ring and to detect disconnection.     */
+struct zbx_ipc_ring
+{
+	zbx_ipc_ring_header_t	*header;
+	unsigned char		*data;
+	zbx_uint32_t		size;
+
+	/* the local head (client) or tail (service) position */
+	zbx_uint32_t		position;
+
+	/* the last head position published by client */
+	zbx_uint32_t		published;
+
+	size_t			mem_size;
+};
+
+/* the shared memory ring size for new client connections, 0 - rings are not used */
+static zbx_uint32_t	ipc_ring_size = 0;
+
+/* the client socket read buffer, the data is parsed right after reading so it can be shared by all clients */
+static ZBX_THREAD_LOCAL unsigned char	*ipc_client_rx_buffer = NULL;
+
 /* IPC client, providing nonblocking connections through socket */
 struct zbx_ipc_client
 {
@@ -46,6 +115,14 @@ struct zbx_ipc_client
 	zbx_uint64_t		id;
 	unsigned char		state;
 
+	/* set until the first data is received from client, as it might be ring handshake */
+	unsigned char		rx_handshake;
+
+	/* shared memory ring for incoming data, NULL if data is read from socket */
+	zbx_ipc_ring_t		*rx_ring;
+
+	zbx_ipc_client_stats_t	stats;
+
 	void			*userdata;
 
 	zbx_uint32_t		refcount;
@@ -190,6 +267,44 @@ static int	ipc_write_data(int fd, const unsigned char *data, zbx_uint32_t size,
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes multiple buffers to a socket with a single system call     *
+ *                                                                            *
+ * Parameters: fd        - [IN] the socket file descriptor                    *
+ *             iov       - [IN] the buffers to write                          *
+ *             iov_num   - [IN] the number of buffers                         *
+ *             size_sent - [OUT] the actual size written to socket            *
+ *                                                                            *
+ * Return value: SUCCEED - no socket errors were detected. Either the data or *
+ *                         a part of it was written to socket or a write to   *
+ *                         non-blocking socket would block                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_writev_data(int fd, const struct iovec *iov, int iov_num, size_t *size_sent)
+{
+	ssize_t	n;
+
+	*size_sent = 0;
+
+	while (-1 == (n = writev(fd, iov, iov_num)))
+	{
+		if (EINTR == errno)
+			continue;
+
+		if (EWOULDBLOCK == errno || EAGAIN == errno)
+			return SUCCEED;
+
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write to IPC socket: %s", strerror(errno));
+		return FAIL;
+	}
+
+	*size_sent = (size_t)n;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: reads data from a socket                                          *
@@ -273,6 +388,377 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: maps shared memory ring                                           *
+ *                                                                            *
+ * Parameters: fd       - [IN] the ring memory file descriptor                *
+ *             mem_size - [IN] the ring memory size (including header)        *
+ *                                                                            *
+ * Return value: The mapped ring or NULL on error.                            *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_ipc_ring_t	*ipc_ring_map(int fd, size_t mem_size)
+{
+	zbx_ipc_ring_t	*ring;
+	void		*addr;
+
+	if (MAP_FAILED == (addr = mmap(NULL, mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot map IPC ring: %s", zbx_strerror(errno));
+		return NULL;
+	}
+
+	ring = (zbx_ipc_ring_t *)zbx_malloc(NULL, sizeof(zbx_ipc_ring_t));
+	memset(ring, 0, sizeof(zbx_ipc_ring_t));
+
+	ring->header = (zbx_ipc_ring_header_t *)addr;
+	ring->data = (unsigned char *)addr + sizeof(zbx_ipc_ring_header_t);
+	ring->mem_size = mem_size;
+
+	return ring;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unmaps shared memory ring and frees its resources                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_ring_free(zbx_ipc_ring_t *ring)
+{
+	munmap((void *)ring->header, ring->mem_size);
+	zbx_free(ring);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates shared memory ring on client side                         *
+ *                                                                            *
+ * Parameters: fd - [OUT] the ring memory file descriptor to pass to service  *
+ *                                                                            *
+ * Return value: The created ring or NULL on error.                           *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_ipc_ring_t	*ipc_ring_create(int *fd)
+{
+#ifdef ZBX_IPC_RING_SUPPORTED
+	zbx_ipc_ring_t	*ring;
+	size_t		mem_size = sizeof(zbx_ipc_ring_header_t) + ipc_ring_size;
+
+	if (-1 == (*fd = memfd_create("zabbix_ipc_ring", MFD_CLOEXEC)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create IPC ring: %s", zbx_strerror(errno));
+		return NULL;
+	}
+
+	if (0 != ftruncate(*fd, (off_t)mem_size))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot allocate IPC ring: %s", zbx_strerror(errno));
+		close(*fd);
+		return NULL;
+	}
+
+	if (NULL == (ring = ipc_ring_map(*fd, mem_size)))
+	{
+		close(*fd);
+		return NULL;
+	}
+
+	ring->header->head = 0;
+	ring->header->tail = 0;
+	ring->header->size = ipc_ring_size;
+	ring->size = ipc_ring_size;
+
+	return ring;
+#else
+	ZBX_UNUSED(fd);
+
+	return NULL;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: attaches to shared memory ring created by client                  *
+ *                                                                            *
+ * Parameters: fd - [IN] the ring memory file descriptor received from client *
+ *                                                                            *
+ * Return value: The attached ring or NULL on error.                          *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_ipc_ring_t	*ipc_ring_attach(int fd)
+{
+	zbx_ipc_ring_t	*ring;
+	struct stat	st;
+
+	if (0 != fstat(fd, &st))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot obtain IPC ring size: %s", zbx_strerror(errno));
+		return NULL;
+	}
+
+	if ((off_t)sizeof(zbx_ipc_ring_header_t) >= st.st_size)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "invalid IPC ring memory size " ZBX_FS_I64, (zbx_int64_t)st.st_size);
+		return NULL;
+	}
+
+	if (NULL == (ring = ipc_ring_map(fd, (size_t)st.st_size)))
+		return NULL;
+
+	ring->size = ring->header->size;
+
+	if (0 == ring->size || 0 != (ring->size & (ring->size - 1)) ||
+			sizeof(zbx_ipc_ring_header_t) + ring->size > ring->mem_size)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "invalid IPC ring size %u", ring->size);
+		ipc_ring_free(ring);
+		return NULL;
+	}
+
+	ring->position = ipc_ring_load(&ring->header->tail);
+
+	return ring;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies data into free ring space without publishing it            *
+ *                                                                            *
+ * Parameters: ring - [IN] the ring                                           *
+ *             data - [IN] the data                                           *
+ *             size - [IN] the data size                                      *
+ *                                                                            *
+ * Return value: The number of bytes copied.                                  *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	ipc_ring_write(zbx_ipc_ring_t *ring, const unsigned char *data, zbx_uint32_t size)
+{
+	zbx_uint32_t	free_size, offset, chunk, written = 0;
+
+	free_size = ring->size - (ring->position - ipc_ring_load(&ring->header->tail));
+
+	if (size > free_size)
+		size = free_size;
+
+	while (written != size)
+	{
+		offset = ring->position & (ring->size - 1);
+		chunk = MIN(size - written, ring->size - offset);
+		memcpy(ring->data + offset, data + written, chunk);
+		ring->position += chunk;
+		written += chunk;
+	}
+
+	return written;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies as much of IPC message as fits into ring                   *
+ *                                                                            *
+ * Parameters: ring   - [IN] the ring                                         *
+ *             header - [IN] the message header                               *
+ *             data   - [IN] the message data                                 *
+ *             offset - [IN] the number of message bytes (including header)   *
+ *                           already written                                  *
+ *                                                                            *
+ * Return value: The number of message bytes written after this call.         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	ipc_ring_write_message(zbx_ipc_ring_t *ring, const zbx_uint32_t *header,
+		const unsigned char *data, zbx_uint32_t offset)
+{
+	if (ZBX_IPC_HEADER_SIZE > offset)
+	{
+		offset += ipc_ring_write(ring, (const unsigned char *)header + offset, ZBX_IPC_HEADER_SIZE - offset);
+
+		if (ZBX_IPC_HEADER_SIZE > offset)
+			return offset;
+	}
+
+	return offset + ipc_ring_write(ring, data + offset - ZBX_IPC_HEADER_SIZE,
+			header[ZBX_IPC_MESSAGE_SIZE] + ZBX_IPC_HEADER_SIZE - offset);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: makes data written to ring visible to service and wakes up        *
+ *          service if it has drained the ring                                *
+ *                                                                            *
+ * Parameters: csocket - [IN] the IPC socket                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the data was published                             *
+ *               FAIL    - failed to wake up service                          *
+ *                                                                            *
+ * Comments: Service is woken up only when the ring was empty, so consecutive *
+ *           messages written while service is processing the ring are        *
+ *           delivered without socket writes.                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_socket_publish_ring(zbx_ipc_socket_t *csocket)
+{
+	zbx_ipc_ring_t	*ring = csocket->tx_ring;
+	zbx_uint32_t	published = ring->published, size_sent;
+	unsigned char	signal = 0;
+
+	if (published == ring->position)
+		return SUCCEED;
+
+	ipc_ring_store(&ring->header->head, ring->position);
+	ring->published = ring->position;
+
+	/* pairs with the fence in ipc_client_read_ring() - either service sees the new head */
+	/* or client sees that the ring was drained and service must be woken up             */
+	ipc_ring_fence();
+
+	if (published != ipc_ring_load(&ring->header->tail))
+		return SUCCEED;
+
+	/* wakeup signal not being sent because of full socket buffer means that there are pending signals */
+	return ipc_write_data(csocket->fd, &signal, 1, &size_sent);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for service to free ring space                              *
+ *                                                                            *
+ * Parameters: csocket - [IN] the IPC socket                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the wait interval passed                           *
+ *               FAIL    - the connection was closed                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_socket_wait_ring(const zbx_ipc_socket_t *csocket)
+{
+	zbx_ipc_ring_t	*ring = csocket->tx_ring;
+	zbx_uint32_t	tail;
+	struct pollfd	pd;
+	int		i;
+
+	tail = ipc_ring_load(&ring->header->tail);
+
+	/* service usually frees ring space quickly, yield processor before sleeping */
+	for (i = 0; i < ZBX_IPC_RING_YIELD_COUNT; i++)
+	{
+		sched_yield();
+
+		if (tail != ipc_ring_load(&ring->header->tail))
+			return SUCCEED;
+	}
+
+	pd.fd = csocket->fd;
+	pd.events = 0;
+	pd.revents = 0;
+
+	if (-1 == poll(&pd, 1, ZBX_IPC_RING_RETRY_MSEC) && EINTR != errno)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot wait for IPC ring space: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (0 != (pd.revents & (POLLHUP | POLLERR | POLLNVAL)))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes IPC message to ring, waiting for free space if necessary   *
+ *                                                                            *
+ * Parameters: csocket - [IN] the IPC socket                                  *
+ *             code    - [IN] the message code                                *
+ *             data    - [IN] the data                                        *
+ *             size    - [IN] the data size                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the message was written                            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_socket_write_ring_message(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const unsigned char *data,
+		zbx_uint32_t size)
+{
+	zbx_uint32_t	header[2], offset = 0;
+
+	header[ZBX_IPC_MESSAGE_CODE] = code;
+	header[ZBX_IPC_MESSAGE_SIZE] = size;
+
+	while (1)
+	{
+		offset = ipc_ring_write_message(csocket->tx_ring, header, data, offset);
+
+		if (SUCCEED != ipc_socket_publish_ring(csocket))
+			return FAIL;
+
+		if (ZBX_IPC_HEADER_SIZE + size == offset)
+			return SUCCEED;
+
+		if (SUCCEED != ipc_socket_wait_ring(csocket))
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates shared memory ring and passes it to service               *
+ *                                                                            *
+ * Parameters: csocket - [IN] the connected IPC socket                        *
+ *                                                                            *
+ * Comments: On failure the socket is left to transfer data directly.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_socket_open_ring(zbx_ipc_socket_t *csocket)
+{
+	zbx_uint32_t	header[2] = {ZBX_IPC_RING_OPEN, 0};
+	zbx_ipc_ring_t	*ring;
+	struct msghdr	msg;
+	struct iovec	iov;
+	struct cmsghdr	*cmsg;
+	union
+	{
+		struct cmsghdr	align;
+		char		buf[CMSG_SPACE(sizeof(int))];
+	}
+	control;
+	ssize_t		n;
+	int		fd;
+
+	if (NULL == (ring = ipc_ring_create(&fd)))
+		return;
+
+	iov.iov_base = header;
+	iov.iov_len = sizeof(header);
+
+	memset(&msg, 0, sizeof(msg));
+	memset(&control, 0, sizeof(control));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+	while (-1 == (n = sendmsg(csocket->fd, &msg, 0)) && EINTR == errno)
+		;
+
+	close(fd);
+
+	if ((ssize_t)sizeof(header) != n)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot pass IPC ring to service: %s",
+				-1 == n ? zbx_strerror(errno) : "partial write");
+		ipc_ring_free(ring);
+		return;
+	}
+
+	csocket->tx_ring = ring;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: writes IPC message to socket                                      *
@@ -302,6 +788,12 @@ static int	ipc_socket_write_message(zbx_ipc_socket_t *csocket, zbx_uint32_t code
 	buffer[0] = code;
 	buffer[1] = size;
 
+	if (NULL != csocket->tx_ring)
+	{
+		*tx_size = ipc_ring_write_message(csocket->tx_ring, buffer, data, 0);
+		return ipc_socket_publish_ring(csocket);
+	}
+
 	if (ZBX_IPC_SOCKET_BUFFER_SIZE - ZBX_IPC_HEADER_SIZE >= size)
 	{
 		if (0 != size)
@@ -457,216 +949,552 @@ static int	ipc_socket_read_message(zbx_ipc_socket_t *csocket, zbx_uint32_t *head
 			}
 		}
 
-		if (FAIL == ipc_read_data(csocket->fd, csocket->rx_buffer, ZBX_IPC_SOCKET_BUFFER_SIZE, &read_size))
-			goto out;
+		if (FAIL == ipc_read_data(csocket->fd, csocket->rx_buffer, ZBX_IPC_SOCKET_BUFFER_SIZE, &read_size))
+			goto out;
+
+		/* it's possible that nothing will be read on non-blocking sockets, return success */
+		if (0 == read_size)
+		{
+			ret = SUCCEED;
+			goto out;
+		}
+
+		csocket->rx_buffer_bytes = read_size;
+
+		ret = ipc_read_buffer(header, data, *rx_bytes, csocket->rx_buffer, csocket->rx_buffer_bytes,
+				&read_size);
+
+		csocket->rx_buffer_offset += read_size;
+		*rx_bytes += read_size;
+	}
+out:
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees client's libevent event                                     *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_free_events(zbx_ipc_client_t *client)
+{
+	if (NULL != client->rx_event)
+	{
+		event_free(client->rx_event);
+		client->rx_event = NULL;
+	}
+
+	if (NULL != client->tx_event)
+	{
+		event_free(client->tx_event);
+		client->tx_event = NULL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees IPC service client                                          *
+ *                                                                            *
+ * Parameters: client - [IN] the client to free                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_free(zbx_ipc_client_t *client)
+{
+	zbx_ipc_message_t	*message;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "IPC client " ZBX_FS_UI64 " received messages:" ZBX_FS_UI64 " reads:" ZBX_FS_UI64
+			" sent messages:" ZBX_FS_UI64 " writes:" ZBX_FS_UI64, client->id, client->stats.rx_messages,
+			client->stats.rx_reads, client->stats.tx_messages, client->stats.tx_writes);
+
+	ipc_client_free_events(client);
+	zbx_ipc_socket_close(&client->csocket);
+
+	if (NULL != client->rx_ring)
+		ipc_ring_free(client->rx_ring);
+
+	while (NULL != (message = (zbx_ipc_message_t *)zbx_queue_ptr_pop(&client->rx_queue)))
+		zbx_ipc_message_free(message);
+
+	zbx_queue_ptr_destroy(&client->rx_queue);
+	zbx_free(client->rx_data);
+
+	while (NULL != (message = (zbx_ipc_message_t *)zbx_queue_ptr_pop(&client->tx_queue)))
+		zbx_ipc_message_free(message);
+
+	zbx_queue_ptr_destroy(&client->tx_queue);
+	zbx_free(client->tx_data);
+
+	ipc_client_free_events(client);
+
+	zbx_free(client);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds message to received messages queue                           *
+ *                                                                            *
+ * Parameters: client - [IN] the client to read                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_push_rx_message(zbx_ipc_client_t *client)
+{
+	zbx_ipc_message_t	*message;
+
+	message = (zbx_ipc_message_t *)zbx_malloc(NULL, sizeof(zbx_ipc_message_t));
+	message->code = client->rx_header[ZBX_IPC_MESSAGE_CODE];
+	message->size = client->rx_header[ZBX_IPC_MESSAGE_SIZE];
+	message->data = client->rx_data;
+	zbx_queue_ptr_push(&client->rx_queue, message);
+
+	client->rx_data = NULL;
+	client->rx_bytes = 0;
+	client->stats.rx_messages++;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses data received from IPC service client and adds completed   *
+ *          messages to received messages queue                               *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *             data   - [IN] the received data                                *
+ *             size   - [IN] the received data size                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_parse_data(zbx_ipc_client_t *client, const unsigned char *data, zbx_uint32_t size)
+{
+	zbx_uint32_t	read_size;
+
+	while (0 != size)
+	{
+		if (SUCCEED == ipc_read_buffer(client->rx_header, &client->rx_data, client->rx_bytes, data, size,
+				&read_size))
+		{
+			ipc_client_push_rx_message(client);
+		}
+		else
+			client->rx_bytes += read_size;
+
+		data += read_size;
+		size -= read_size;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares to send the next message in send queue                   *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_pop_tx_message(zbx_ipc_client_t *client)
+{
+	zbx_ipc_message_t	*message;
+
+	zbx_free(client->tx_data);
+	client->tx_bytes = 0;
+
+	if (NULL == (message = (zbx_ipc_message_t *)zbx_queue_ptr_pop(&client->tx_queue)))
+		return;
+
+	client->tx_bytes = ZBX_IPC_HEADER_SIZE + message->size;
+	client->tx_header[ZBX_IPC_MESSAGE_CODE] = message->code;
+	client->tx_header[ZBX_IPC_MESSAGE_SIZE] = message->size;
+	client->tx_data = message->data;
+	zbx_free(message);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads the first data from IPC service client, attaching shared    *
+ *          memory ring if client has passed one                              *
+ *                                                                            *
+ * Parameters: client - [IN] the client to read                               *
+ *                                                                            *
+ * Return value:  FAIL - read error/connection was closed or the passed ring  *
+ *                       cannot be attached                                   *
+ *                                                                            *
+ * Comments: Ring file descriptor can be received only with recvmsg(), so the *
+ *           first data is read into socket buffer with it. If there was no   *
+ *           ring handshake the read data is parsed as usual.                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_client_read_handshake(zbx_ipc_client_t *client)
+{
+	zbx_ipc_socket_t	*csocket = &client->csocket;
+	zbx_uint32_t		header[2];
+	struct msghdr		msg;
+	struct iovec		iov;
+	struct cmsghdr		*cmsg;
+	union
+	{
+		struct cmsghdr	align;
+		char		buf[CMSG_SPACE(sizeof(int))];
+	}
+	control;
+	ssize_t			n;
+	int			fd = -1;
+
+	iov.iov_base = csocket->rx_buffer;
+	iov.iov_len = ZBX_IPC_SOCKET_BUFFER_SIZE;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	while (-1 == (n = recvmsg(csocket->fd, &msg, 0)))
+	{
+		if (EINTR == errno)
+			continue;
+
+		if (EWOULDBLOCK == errno || EAGAIN == errno)
+			return SUCCEED;
+
+		return FAIL;
+	}
+
+	if (0 == n)
+		return FAIL;
 
-		/* it's possible that nothing will be read on non-blocking sockets, return success */
-		if (0 == read_size)
+	client->rx_handshake = 0;
+	client->stats.rx_reads++;
+
+	if (NULL != (cmsg = CMSG_FIRSTHDR(&msg)) && SOL_SOCKET == cmsg->cmsg_level && SCM_RIGHTS == cmsg->cmsg_type &&
+			CMSG_LEN(sizeof(int)) <= cmsg->cmsg_len)
+	{
+		memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+	}
+
+	if (-1 != fd)
+	{
+		memcpy(header, csocket->rx_buffer, MIN(sizeof(header), (size_t)n));
+
+		if (ZBX_IPC_HEADER_SIZE <= n && ZBX_IPC_RING_OPEN == header[ZBX_IPC_MESSAGE_CODE] &&
+				0 == header[ZBX_IPC_MESSAGE_SIZE])
 		{
-			ret = SUCCEED;
-			goto out;
+			client->rx_ring = ipc_ring_attach(fd);
+			close(fd);
+
+			/* the rest of socket data are wakeup signals */
+			return NULL != client->rx_ring ? SUCCEED : FAIL;
 		}
 
-		csocket->rx_buffer_bytes = read_size;
+		close(fd);
+	}
 
-		ret = ipc_read_buffer(header, data, *rx_bytes, csocket->rx_buffer, csocket->rx_buffer_bytes,
-				&read_size);
+	ipc_client_parse_data(client, csocket->rx_buffer, (zbx_uint32_t)n);
 
-		csocket->rx_buffer_offset += read_size;
-		*rx_bytes += read_size;
-	}
-out:
-	return ret;
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees client's libevent event                                     *
+ * Purpose: reads data from IPC service client shared memory ring             *
  *                                                                            *
- * Parameters: client - [IN] the client                                       *
+ * Parameters: client - [IN] the client to read                               *
+ *                                                                            *
+ * Return value:  FAIL - connection was closed                                *
+ *                                                                            *
+ * Comments: The socket is drained of wakeup signals before reading ring, so  *
+ *           data written to ring before client closed the connection are     *
+ *           still read.                                                      *
  *                                                                            *
  ******************************************************************************/
-static void	ipc_client_free_events(zbx_ipc_client_t *client)
+static int	ipc_client_read_ring(zbx_ipc_client_t *client)
 {
-	if (NULL != client->rx_event)
+	zbx_ipc_ring_t	*ring = client->rx_ring;
+	zbx_uint32_t	head, offset, size, read_size;
+	int		ret = SUCCEED;
+
+	do
 	{
-		event_free(client->rx_event);
-		client->rx_event = NULL;
+		if (FAIL == ipc_read_data(client->csocket.fd, client->csocket.rx_buffer, ZBX_IPC_SOCKET_BUFFER_SIZE,
+				&read_size))
+		{
+			ret = FAIL;
+			break;
+		}
 	}
+	while (0 != read_size);
 
-	if (NULL != client->tx_event)
+	while (ring->position != (head = ipc_ring_load(&ring->header->head)))
 	{
-		event_free(client->tx_event);
-		client->tx_event = NULL;
+		while (ring->position != head)
+		{
+			offset = ring->position & (ring->size - 1);
+			size = MIN(head - ring->position, ring->size - offset);
+
+			ipc_client_parse_data(client, ring->data + offset, size);
+
+			ring->position += size;
+			ipc_ring_store(&ring->header->tail, ring->position);
+		}
+
+		/* pairs with the fence in ipc_socket_publish_ring() */
+		ipc_ring_fence();
+	}
+
+	if (FAIL == ret)
+	{
+		zbx_free(client->rx_data);
+		client->rx_bytes = 0;
 	}
+
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees IPC service client                                          *
+ * Purpose: reads data from IPC service client socket                         *
  *                                                                            *
- * Parameters: client - [IN] the client to free                               *
+ * Parameters: client - [IN] the client to read                               *
+ *                                                                            *
+ * Return value:  FAIL - read error/connection was closed                     *
+ *                                                                            *
+ * Comments: The socket data is read in large chunks and parsed in place, so  *
+ *           a single read can return many small messages. Long message data  *
+ *           are read directly into message buffer.                           *
  *                                                                            *
  ******************************************************************************/
-static void	ipc_client_free(zbx_ipc_client_t *client)
+static int	ipc_client_read_socket(zbx_ipc_client_t *client)
 {
-	zbx_ipc_message_t	*message;
+	zbx_uint32_t	offset, data_size, read_size;
 
-	ipc_client_free_events(client);
-	zbx_ipc_socket_close(&client->csocket);
+	if (NULL == ipc_client_rx_buffer)
+		ipc_client_rx_buffer = (unsigned char *)zbx_malloc(NULL, ZBX_IPC_CLIENT_RX_BUFFER_SIZE);
 
-	while (NULL != (message = (zbx_ipc_message_t *)zbx_queue_ptr_pop(&client->rx_queue)))
-		zbx_ipc_message_free(message);
+	while (1)
+	{
+		if (ZBX_IPC_HEADER_SIZE < client->rx_bytes)
+		{
+			offset = client->rx_bytes - ZBX_IPC_HEADER_SIZE;
+			data_size = client->rx_header[ZBX_IPC_MESSAGE_SIZE] - offset;
 
-	zbx_queue_ptr_destroy(&client->rx_queue);
-	zbx_free(client->rx_data);
+			if (ZBX_IPC_CLIENT_RX_BUFFER_SIZE * 0.75 < data_size)
+			{
+				if (FAIL == ipc_read_data(client->csocket.fd, client->rx_data + offset, data_size,
+						&read_size))
+				{
+					break;
+				}
 
-	while (NULL != (message = (zbx_ipc_message_t *)zbx_queue_ptr_pop(&client->tx_queue)))
-		zbx_ipc_message_free(message);
+				if (0 == read_size)
+					return SUCCEED;
 
-	zbx_queue_ptr_destroy(&client->tx_queue);
-	zbx_free(client->tx_data);
+				client->stats.rx_reads++;
+				client->rx_bytes += read_size;
 
-	ipc_client_free_events(client);
+				if (read_size != data_size)
+					return SUCCEED;
 
-	zbx_free(client);
-}
+				ipc_client_push_rx_message(client);
+				continue;
+			}
+		}
 
-/******************************************************************************
- *                                                                            *
- * Purpose: adds message to received messages queue                           *
- *                                                                            *
- * Parameters: client - [IN] the client to read                               *
- *                                                                            *
- ******************************************************************************/
-static void	ipc_client_push_rx_message(zbx_ipc_client_t *client)
-{
-	zbx_ipc_message_t	*message;
+		if (FAIL == ipc_read_data(client->csocket.fd, ipc_client_rx_buffer, ZBX_IPC_CLIENT_RX_BUFFER_SIZE,
+				&read_size))
+		{
+			break;
+		}
 
-	message = (zbx_ipc_message_t *)zbx_malloc(NULL, sizeof(zbx_ipc_message_t));
-	message->code = client->rx_header[ZBX_IPC_MESSAGE_CODE];
-	message->size = client->rx_header[ZBX_IPC_MESSAGE_SIZE];
-	message->data = client->rx_data;
-	zbx_queue_ptr_push(&client->rx_queue, message);
+		if (0 == read_size)
+			return SUCCEED;
 
-	client->rx_data = NULL;
+		client->stats.rx_reads++;
+		ipc_client_parse_data(client, ipc_client_rx_buffer, read_size);
+
+		/* short read means that the socket has been drained */
+		if (ZBX_IPC_CLIENT_RX_BUFFER_SIZE != read_size)
+			return SUCCEED;
+	}
+
+	zbx_free(client->rx_data);
 	client->rx_bytes = 0;
+
+	return FAIL;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: prepares to send the next message in send queue                   *
+ * Purpose: reads data from IPC service client                                *
  *                                                                            *
- * Parameters: client - [IN] the client                                       *
+ * Parameters: client - [IN] the client to read                               *
+ *                                                                            *
+ * Return value:  FAIL - read error/connection was closed                     *
+ *                                                                            *
+ * Comments: This function reads data from socket or shared memory ring,      *
+ *           parses it and adds parsed messages to received messages queue.   *
  *                                                                            *
  ******************************************************************************/
-static void	ipc_client_pop_tx_message(zbx_ipc_client_t *client)
+static int	ipc_client_read(zbx_ipc_client_t *client)
 {
-	zbx_ipc_message_t	*message;
+	if (0 != client->rx_handshake)
+	{
+		if (SUCCEED != ipc_client_read_handshake(client))
+			return FAIL;
 
-	zbx_free(client->tx_data);
-	client->tx_bytes = 0;
+		if (0 != client->rx_handshake)
+			return SUCCEED;
+	}
 
-	if (NULL == (message = (zbx_ipc_message_t *)zbx_queue_ptr_pop(&client->tx_queue)))
-		return;
+	if (NULL != client->rx_ring)
+		return ipc_client_read_ring(client);
 
-	client->tx_bytes = ZBX_IPC_HEADER_SIZE + message->size;
-	client->tx_header[ZBX_IPC_MESSAGE_CODE] = message->code;
-	client->tx_header[ZBX_IPC_MESSAGE_SIZE] = message->size;
-	client->tx_data = message->data;
-	zbx_free(message);
+	return ipc_client_read_socket(client);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: reads data from IPC service client                                *
+ * Purpose: writes queued messages to shared memory ring                      *
  *                                                                            *
- * Parameters: client - [IN] the client to read                               *
+ * Parameters: client - [IN] the client                                       *
  *                                                                            *
- * Return value:  FAIL - read error/connection was closed                     *
+ * Return value: SUCCEED - the data was sent successfully                     *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
- * Comments: This function reads data from socket, parses it and adds         *
- *           parsed messages to received messages queue.                      *
+ * Comments: As many queued messages as fit in the ring are written before    *
+ *           publishing them with a single service wakeup.                    *
  *                                                                            *
  ******************************************************************************/
-static int	ipc_client_read(zbx_ipc_client_t *client)
+static int	ipc_client_write_ring(zbx_ipc_client_t *client)
 {
-	int	rc;
+	zbx_uint32_t	message_size, offset;
 
-	do
+	while (0 != client->tx_bytes)
 	{
-		if (FAIL == ipc_socket_read_message(&client->csocket, client->rx_header, &client->rx_data,
-				&client->rx_bytes))
-		{
-			zbx_free(client->rx_data);
-			client->rx_bytes = 0;
-			return FAIL;
-		}
+		message_size = client->tx_header[ZBX_IPC_MESSAGE_SIZE] + ZBX_IPC_HEADER_SIZE;
+		offset = ipc_ring_write_message(client->csocket.tx_ring, client->tx_header, client->tx_data,
+				message_size - client->tx_bytes);
+		client->tx_bytes = message_size - offset;
 
-		if (SUCCEED == (rc = ipc_message_is_completed(client->rx_header, client->rx_bytes)))
-			ipc_client_push_rx_message(client);
-	}
+		if (0 != client->tx_bytes)
+			break;
 
-	while (SUCCEED == rc);
+		client->stats.tx_messages++;
+		ipc_client_pop_tx_message(client);
+	}
 
-	return SUCCEED;
+	return ipc_socket_publish_ring(&client->csocket);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: writes queued data to IPC service client                          *
+ * Purpose: writes queued data to IPC service client socket                   *
  *                                                                            *
  * Parameters: client - [IN] the client                                       *
  *                                                                            *
  * Return value: SUCCEED - the data was sent successfully                     *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The rest of the current message and the following queued         *
+ *           messages are written with a single writev() call. The queued     *
+ *           messages are removed from queue only after they have been sent.  *
+ *                                                                            *
  ******************************************************************************/
-static int	ipc_client_write(zbx_ipc_client_t *client)
+static int	ipc_client_write_socket(zbx_ipc_client_t *client)
 {
-	zbx_uint32_t	data_size, write_size;
-
-	data_size = client->tx_header[ZBX_IPC_MESSAGE_SIZE];
+	struct iovec		iov[ZBX_IPC_CLIENT_TX_IOV_MAX];
+	zbx_uint32_t		headers[ZBX_IPC_CLIENT_TX_IOV_MAX][2], data_size, header_size;
+	zbx_ipc_message_t	*message;
+	zbx_queue_ptr_t		*queue = &client->tx_queue;
+	size_t			size, write_size, left_size;
+	int			iov_num, messages_num, pos;
 
-	if (data_size < client->tx_bytes)
+	while (0 != client->tx_bytes)
 	{
-		zbx_uint32_t	size, offset;
+		iov_num = 0;
+		data_size = client->tx_header[ZBX_IPC_MESSAGE_SIZE];
+
+		if (data_size < client->tx_bytes)
+		{
+			header_size = client->tx_bytes - data_size;
+			iov[iov_num].iov_base = (unsigned char *)client->tx_header + ZBX_IPC_HEADER_SIZE - header_size;
+			iov[iov_num++].iov_len = header_size;
+
+			if (0 != data_size)
+			{
+				iov[iov_num].iov_base = client->tx_data;
+				iov[iov_num++].iov_len = data_size;
+			}
+		}
+		else
+		{
+			iov[iov_num].iov_base = client->tx_data + data_size - client->tx_bytes;
+			iov[iov_num++].iov_len = client->tx_bytes;
+		}
 
-		size = client->tx_bytes - data_size;
-		offset = ZBX_IPC_HEADER_SIZE - size;
+		size = client->tx_bytes;
 
-		if (SUCCEED != ipc_write_data(client->csocket.fd, (unsigned char *)client->tx_header + offset, size,
-				&write_size))
+		for (pos = queue->tail_pos, messages_num = 0; pos != queue->head_pos &&
+				ZBX_IPC_CLIENT_TX_IOV_MAX - 2 >= iov_num; messages_num++)
 		{
-			return FAIL;
+			message = (zbx_ipc_message_t *)queue->values[pos];
+
+			headers[messages_num][ZBX_IPC_MESSAGE_CODE] = message->code;
+			headers[messages_num][ZBX_IPC_MESSAGE_SIZE] = message->size;
+			iov[iov_num].iov_base = headers[messages_num];
+			iov[iov_num++].iov_len = ZBX_IPC_HEADER_SIZE;
+
+			if (0 != message->size)
+			{
+				iov[iov_num].iov_base = message->data;
+				iov[iov_num++].iov_len = message->size;
+			}
+
+			size += ZBX_IPC_HEADER_SIZE + message->size;
+
+			if (++pos == queue->alloc_num)
+				pos = 0;
 		}
 
-		client->tx_bytes -= write_size;
+		if (SUCCEED != ipc_writev_data(client->csocket.fd, iov, iov_num, &write_size))
+			return FAIL;
 
-		if (data_size < client->tx_bytes)
-			return SUCCEED;
-	}
+		if (0 == write_size)
+			break;
 
-	while (0 < client->tx_bytes)
-	{
-		if (SUCCEED != ipc_write_data(client->csocket.fd, client->tx_data + data_size - client->tx_bytes,
-				client->tx_bytes, &write_size))
+		client->stats.tx_writes++;
+
+		for (left_size = write_size; 0 != client->tx_bytes && client->tx_bytes <= left_size;)
 		{
-			return FAIL;
+			left_size -= client->tx_bytes;
+			client->stats.tx_messages++;
+			ipc_client_pop_tx_message(client);
 		}
 
-		if (0 == write_size)
-			return SUCCEED;
+		client->tx_bytes -= (zbx_uint32_t)left_size;
 
-		client->tx_bytes -= write_size;
+		/* the socket buffer is full, wait for the next write event */
+		if (size != write_size)
+			break;
 	}
 
-	if (0 == client->tx_bytes)
-		ipc_client_pop_tx_message(client);
-
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes queued data to IPC service client                          *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *                                                                            *
+ * Return value: SUCCEED - the data was sent successfully                     *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_client_write(zbx_ipc_client_t *client)
+{
+	if (NULL != client->csocket.tx_ring)
+		return ipc_client_write_ring(client);
+
+	return ipc_client_write_socket(client);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: gets the next client with messages/closed socket from recv queue  *
@@ -746,6 +1574,7 @@ static void	ipc_service_add_client(zbx_ipc_service_t *service, int fd)
 	client->csocket.rx_buffer_offset = 0;
 	client->id = next_clientid++;
 	client->state = ZBX_IPC_CLIENT_STATE_NONE;
+	client->rx_handshake = 1;
 	client->refcount = 1;
 
 	zbx_queue_ptr_create(&client->rx_queue);
@@ -1094,6 +1923,8 @@ int	zbx_ipc_socket_open(zbx_ipc_socket_t *csocket, const char *service_name, int
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	csocket->tx_ring = NULL;
+
 	if (NULL == (socket_path = ipc_make_path(service_name, error)))
 		goto out;
 
@@ -1125,6 +1956,9 @@ int	zbx_ipc_socket_open(zbx_ipc_socket_t *csocket, const char *service_name, int
 	csocket->rx_buffer_bytes = 0;
 	csocket->rx_buffer_offset = 0;
 
+	if (0 != ipc_ring_size)
+		ipc_socket_open_ring(csocket);
+
 	ret = SUCCEED;
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
@@ -1148,6 +1982,12 @@ void	zbx_ipc_socket_close(zbx_ipc_socket_t *csocket)
 		csocket->fd = -1;
 	}
 
+	if (NULL != csocket->tx_ring)
+	{
+		ipc_ring_free(csocket->tx_ring);
+		csocket->tx_ring = NULL;
+	}
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -1171,7 +2011,11 @@ int	zbx_ipc_socket_write(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const uns
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (SUCCEED == ipc_socket_write_message(csocket, code, data, size, &size_sent) &&
+	if (NULL != csocket->tx_ring)
+	{
+		ret = ipc_socket_write_ring_message(csocket, code, data, size);
+	}
+	else if (SUCCEED == ipc_socket_write_message(csocket, code, data, size, &size_sent) &&
 			size_sent == size + ZBX_IPC_HEADER_SIZE)
 	{
 		ret = SUCCEED;
@@ -1674,17 +2518,47 @@ int	zbx_ipc_client_send(zbx_ipc_client_t *client, zbx_uint32_t code, const unsig
 		goto out;
 	}
 
-	if (FAIL == ipc_socket_write_message(&client->csocket, code, data, size, &tx_size))
-		goto out;
+	if (NULL != client->csocket.tx_ring)
+	{
+		if (FAIL == ipc_socket_write_message(&client->csocket, code, data, size, &tx_size))
+			goto out;
+	}
+	else
+	{
+		zbx_uint32_t	header[2] = {code, size};
+		struct iovec	iov[2] = {{header, ZBX_IPC_HEADER_SIZE}, {(void *)data, size}};
+		size_t		write_size;
+
+		if (FAIL == ipc_writev_data(client->csocket.fd, iov, 0 != size ? 2 : 1, &write_size))
+			goto out;
 
-	if (tx_size != ZBX_IPC_HEADER_SIZE + size)
+		if (0 != write_size)
+			client->stats.tx_writes++;
+
+		tx_size = (zbx_uint32_t)write_size;
+	}
+
+	if (tx_size == ZBX_IPC_HEADER_SIZE + size)
+	{
+		client->stats.tx_messages++;
+	}
+	else
 	{
 		client->tx_header[ZBX_IPC_MESSAGE_CODE] = code;
 		client->tx_header[ZBX_IPC_MESSAGE_SIZE] = size;
 		client->tx_data = (unsigned char *)zbx_malloc(NULL, size);
 		memcpy(client->tx_data, data, size);
 		client->tx_bytes = ZBX_IPC_HEADER_SIZE + size - tx_size;
-		event_add(client->tx_event, NULL);
+
+		if (NULL != client->csocket.tx_ring)
+		{
+			/* there are no socket events for free ring space, retry writing on timer */
+			struct timeval	tv = {0, ZBX_IPC_RING_RETRY_USEC};
+
+			event_add(client->tx_event, &tv);
+		}
+		else
+			event_add(client->tx_event, NULL);
 	}
 
 	ret = SUCCEED;
@@ -1751,6 +2625,19 @@ void	*zbx_ipc_client_get_userdata(zbx_ipc_client_t *client)
 	return client->userdata;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets IPC client traffic counters                                  *
+ *                                                                            *
+ * Parameters: client - [IN] the IPC client                                   *
+ *             stats  - [OUT] the message and system call counters            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_client_get_stats(const zbx_ipc_client_t *client, zbx_ipc_client_stats_t *stats)
+{
+	*stats = client->stats;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: opens asynchronous socket to IPC service client                   *
@@ -1796,8 +2683,18 @@ int	zbx_ipc_async_socket_open(zbx_ipc_async_socket_t *asocket, const char *servi
 	asocket->ev_timer = event_new(asocket->ev, -1, 0, ipc_async_socket_timer_cb, asocket);
 	asocket->client->rx_event = event_new(asocket->ev, asocket->client->csocket.fd, EV_READ | EV_PERSIST,
 			ipc_async_socket_read_event_cb, (void *)asocket);
-	asocket->client->tx_event = event_new(asocket->ev, asocket->client->csocket.fd, EV_WRITE | EV_PERSIST,
-			ipc_async_socket_write_event_cb, (void *)asocket);
+
+	if (NULL != asocket->client->csocket.tx_ring)
+	{
+		asocket->client->tx_event = event_new(asocket->ev, -1, EV_PERSIST, ipc_async_socket_write_event_cb,
+				(void *)asocket);
+	}
+	else
+	{
+		asocket->client->tx_event = event_new(asocket->ev, asocket->client->csocket.fd, EV_WRITE | EV_PERSIST,
+				ipc_async_socket_write_event_cb, (void *)asocket);
+	}
+
 	event_add(asocket->client->rx_event, NULL);
 
 	asocket->state = ZBX_IPC_ASYNC_SOCKET_STATE_NONE;
@@ -2120,4 +3017,33 @@ void	zbx_init_library_ipcservice(unsigned char program_type)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets shared memory ring size for IPC sockets opened afterwards    *
+ *                                                                            *
+ * Parameters: size - [IN] the ring size in bytes, 0 - do not use rings       *
+ *                                                                            *
+ * Comments: The size is rounded down to a power of two and limited to        *
+ *           ZBX_IPC_RING_SIZE_MIN - ZBX_IPC_RING_SIZE_MAX range. When rings  *
+ *           are used the client to service messages are passed through       *
+ *           shared memory and the socket is used for wakeups and responses.  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_set_ring_size(zbx_uint64_t size)
+{
+	if (0 == size)
+	{
+		ipc_ring_size = 0;
+		return;
+	}
+#ifdef ZBX_IPC_RING_SUPPORTED
+	ipc_ring_size = ZBX_IPC_RING_SIZE_MIN;
+
+	while (ZBX_IPC_RING_SIZE_MAX > ipc_ring_size && (zbx_uint64_t)ipc_ring_size * 2 <= size)
+		ipc_ring_size *= 2;
+#else
+	zabbix_log(LOG_LEVEL_WARNING, "shared memory IPC rings are not supported on this platform");
+#endif
+}
+
 #endif
@@ -21,6 +21,7 @@
 
 #include "zbxjson.h"
 #include "json_parser.h"
+#include "json_index.h"
 #include "jsonpath.h"
 
 /******************************************************************************
@@ -592,6 +593,28 @@ static const char	*__zbx_json_rbracket(const char *p)
 	return NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locate the closing bracket, using structural index of the parsed  *
+ *          buffer when available                                             *
+ *                                                                            *
+ * Return value: position of the right bracket                                *
+ *               NULL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*json_rbracket(const struct zbx_json_parse *jp, const char *p)
+{
+	const char	*end;
+
+	if (SUCCEED == json_index_usable(jp->index, jp) && jp->start <= p && p <= jp->end &&
+			NULL != (end = json_index_rbracket(jp->index, p)))
+	{
+		return end;
+	}
+
+	return __zbx_json_rbracket(p);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: open json buffer and check for brackets                           *
@@ -613,6 +636,7 @@ int	zbx_json_open(const char *buffer, struct zbx_json_parse *jp)
 
 	jp->start = buffer;
 	jp->end = NULL;
+	jp->index = NULL;
 
 	if (0 == (len = zbx_json_validate(jp->start, &error)))
 	{
@@ -630,6 +654,7 @@ int	zbx_json_open(const char *buffer, struct zbx_json_parse *jp)
 	}
 
 	jp->end = jp->start + len - 1;
+	jp->index = json_index_create(jp->start, jp->end);
 
 	return SUCCEED;
 }
@@ -659,6 +684,9 @@ const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 		return p;
 	}
 
+	if (SUCCEED == json_index_usable(jp->index, jp))
+		return json_index_next(jp->index, jp, p);
+
 	while (p <= jp->end)
 	{
 		switch (*p)
@@ -1136,6 +1164,7 @@ int	zbx_json_brackets_open(const char *p, struct zbx_json_parse *jp)
 	SKIP_WHITESPACE(p);
 
 	jp->start = p;
+	jp->index = NULL;
 
 	return SUCCEED;
 }
@@ -1153,8 +1182,14 @@ int	zbx_json_brackets_by_name(const struct zbx_json_parse *jp, const char *name,
 	if (NULL == (p = zbx_json_pair_by_name(jp, name)))
 		return FAIL;
 
-	if (FAIL == zbx_json_brackets_open(p, out))
+	if (NULL == (out->end = json_rbracket(jp, p)))
+	{
+		zbx_set_json_strerror("cannot open JSON object or array \"%.64s\"", p);
 		return FAIL;
+	}
+
+	out->start = p;
+	out->index = jp->index;
 
 	return SUCCEED;
 }
@@ -1254,7 +1289,7 @@ int	zbx_json_open_path(const struct zbx_json_parse *jp, const char *path, struct
 
 		object.start = p;
 
-		if (NULL == (object.end = __zbx_json_rbracket(p)))
+		if (NULL == (object.end = json_rbracket(jp, p)))
 			object.end = p + json_parse_value(p, NULL, 0, NULL) - 1;
 	}
 
@@ -0,0 +1,620 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "json_index.h"
+#include "json.h"
+
+#include "zbxcommon.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#	define JSON_INDEX_X86
+#	include <immintrin.h>
+#endif
+
+#define JSON_INDEX_BLOCK_SIZE	64
+#define JSON_INDEX_SLOTS_NUM	4
+#define JSON_INDEX_NONE		0xffffffff
+
+/* character class masks of a 64 byte block, bit N corresponds to byte N */
+typedef struct
+{
+	zbx_uint64_t	quote;
+	zbx_uint64_t	backslash;
+	zbx_uint64_t	structural;
+}
+json_index_block_t;
+
+typedef void	(*json_index_classify_func_t)(const unsigned char *data, json_index_block_t *block);
+
+/* the indexes are kept per thread and reused in round robin order, so a parsed */
+/* object stays navigable by index until several other large buffers are opened */
+static ZBX_THREAD_LOCAL zbx_json_index_t	json_index_slots[JSON_INDEX_SLOTS_NUM];
+static ZBX_THREAD_LOCAL int			json_index_slot_next;
+
+/* the structural character following the last located element, iterating with */
+/* zbx_json_next() continues from it without searching                          */
+static ZBX_THREAD_LOCAL const zbx_json_index_t	*json_index_hint_index;
+static ZBX_THREAD_LOCAL zbx_uint32_t		json_index_hint;
+
+/* the time to check if index memory can be released, 0 if indexes hold no memory */
+static ZBX_THREAD_LOCAL time_t	json_index_expire;
+
+/* set when any index was used since the last expiration check */
+static ZBX_THREAD_LOCAL int	json_index_used;
+
+static int	json_index_impl = ZBX_JSON_INDEX_IMPL_AUTO;
+
+static int	json_index_ctz(zbx_uint64_t value)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(value);
+#else
+	int	n = 0;
+
+	while (0 == (value & 1))
+	{
+		value >>= 1;
+		n++;
+	}
+
+	return n;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: classify 64 byte block characters byte by byte                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	json_index_classify_scalar(const unsigned char *data, json_index_block_t *block)
+{
+	int	i;
+
+	block->quote = 0;
+	block->backslash = 0;
+	block->structural = 0;
+
+	for (i = 0; i < JSON_INDEX_BLOCK_SIZE; i++)
+	{
+		zbx_uint64_t	bit = (zbx_uint64_t)1 << i;
+
+		switch (data[i])
+		{
+			case '"':
+				block->quote |= bit;
+				break;
+			case '\\':
+				block->backslash |= bit;
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ',':
+				block->structural |= bit;
+				break;
+		}
+	}
+}
+
+#if defined(JSON_INDEX_X86)
+
+/* '[' and ']' differ from '{' and '}' only by 0x20 bit, so both bracket kinds */
+/* are matched by comparing characters with the 0x20 bit set                   */
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: classify 64 byte block characters with SSE2 instructions          *
+ *                                                                            *
+ ******************************************************************************/
+__attribute__((target("sse2")))
+static void	json_index_classify_sse2(const unsigned char *data, json_index_block_t *block)
+{
+	const __m128i	quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\'), comma = _mm_set1_epi8(','),
+			lbrace = _mm_set1_epi8('{'), rbrace = _mm_set1_epi8('}'), lower = _mm_set1_epi8(0x20);
+	int		i;
+
+	block->quote = 0;
+	block->backslash = 0;
+	block->structural = 0;
+
+	for (i = 0; i < JSON_INDEX_BLOCK_SIZE; i += 16)
+	{
+		__m128i	chunk, folded, structural;
+
+		chunk = _mm_loadu_si128((const __m128i *)(data + i));
+		folded = _mm_or_si128(chunk, lower);
+		structural = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, lbrace), _mm_cmpeq_epi8(folded, rbrace)),
+				_mm_cmpeq_epi8(chunk, comma));
+
+		block->quote |= (zbx_uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)) << i;
+		block->backslash |= (zbx_uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)) << i;
+		block->structural |= (zbx_uint64_t)(unsigned int)_mm_movemask_epi8(structural) << i;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: classify 64 byte block characters with AVX2 instructions          *
+ *                                                                            *
+ ******************************************************************************/
+__attribute__((target("avx2")))
+static void	json_index_classify_avx2(const unsigned char *data, json_index_block_t *block)
+{
+	const __m256i	quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\'),
+			comma = _mm256_set1_epi8(','), lbrace = _mm256_set1_epi8('{'), rbrace = _mm256_set1_epi8('}'),
+			lower = _mm256_set1_epi8(0x20);
+	int		i;
+
+	block->quote = 0;
+	block->backslash = 0;
+	block->structural = 0;
+
+	for (i = 0; i < JSON_INDEX_BLOCK_SIZE; i += 32)
+	{
+		__m256i	chunk, folded, structural;
+
+		chunk = _mm256_loadu_si256((const __m256i *)(data + i));
+		folded = _mm256_or_si256(chunk, lower);
+		structural = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, lbrace),
+				_mm256_cmpeq_epi8(folded, rbrace)), _mm256_cmpeq_epi8(chunk, comma));
+
+		block->quote |= (zbx_uint64_t)(zbx_uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)) << i;
+		block->backslash |= (zbx_uint64_t)(zbx_uint32_t)_mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(chunk, backslash)) << i;
+		block->structural |= (zbx_uint64_t)(zbx_uint32_t)_mm256_movemask_epi8(structural) << i;
+	}
+}
+
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the best available block classification implementation        *
+ *                                                                            *
+ ******************************************************************************/
+static json_index_classify_func_t	json_index_get_classify_func(void)
+{
+	switch (json_index_get_impl())
+	{
+#if defined(JSON_INDEX_X86)
+		case ZBX_JSON_INDEX_IMPL_AVX2:
+			return json_index_classify_avx2;
+		case ZBX_JSON_INDEX_IMPL_SSE2:
+			return json_index_classify_sse2;
+#endif
+		default:
+			return json_index_classify_scalar;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: force block classification implementation                         *
+ *                                                                            *
+ * Parameters: impl - [IN] ZBX_JSON_INDEX_IMPL_* implementation,              *
+ *                         ZBX_JSON_INDEX_IMPL_AUTO to detect automatically   *
+ *                                                                            *
+ * Return value: SUCCEED - the implementation is supported by the CPU         *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Used by tests and benchmarks to compare the implementations.     *
+ *                                                                            *
+ ******************************************************************************/
+int	json_index_set_impl(int impl)
+{
+	switch (impl)
+	{
+		case ZBX_JSON_INDEX_IMPL_AUTO:
+		case ZBX_JSON_INDEX_IMPL_SCALAR:
+			break;
+#if defined(JSON_INDEX_X86)
+		case ZBX_JSON_INDEX_IMPL_SSE2:
+			if (0 == __builtin_cpu_supports("sse2"))
+				return FAIL;
+			break;
+		case ZBX_JSON_INDEX_IMPL_AVX2:
+			if (0 == __builtin_cpu_supports("avx2"))
+				return FAIL;
+			break;
+#endif
+		default:
+			return FAIL;
+	}
+
+	json_index_impl = impl;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get block classification implementation in use                    *
+ *                                                                            *
+ ******************************************************************************/
+int	json_index_get_impl(void)
+{
+	if (ZBX_JSON_INDEX_IMPL_AUTO != json_index_impl)
+		return json_index_impl;
+#if defined(JSON_INDEX_X86)
+	if (0 != __builtin_cpu_supports("avx2"))
+		return ZBX_JSON_INDEX_IMPL_AVX2;
+
+	if (0 != __builtin_cpu_supports("sse2"))
+		return ZBX_JSON_INDEX_IMPL_SSE2;
+#endif
+	return ZBX_JSON_INDEX_IMPL_SCALAR;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get mask of characters escaped by backslashes                     *
+ *                                                                            *
+ * Parameters: backslash - [IN] backslash mask of the block                   *
+ *             carry     - [IN/OUT] 1 if the first block character is escaped *
+ *                                  by the last backslash of previous block   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	json_index_escaped(zbx_uint64_t backslash, zbx_uint64_t *carry)
+{
+	zbx_uint64_t	escaped = *carry;
+
+	*carry = 0;
+
+	while (0 != backslash)
+	{
+		int	n = json_index_ctz(backslash);
+
+		backslash &= backslash - 1;
+
+		if (0 != (escaped & ((zbx_uint64_t)1 << n)))
+			continue;
+
+		if (JSON_INDEX_BLOCK_SIZE - 1 == n)
+			*carry = 1;
+		else
+			escaped |= (zbx_uint64_t)1 << (n + 1);
+	}
+
+	return escaped;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get mask of characters between quotes                             *
+ *                                                                            *
+ * Parameters: quote - [IN] mask of unescaped quotes                          *
+ *             carry - [IN/OUT] all bits set if block starts inside a string  *
+ *                                                                            *
+ * Comments: The opening quotes are included in mask, closing quotes are not. *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	json_index_in_string(zbx_uint64_t quote, zbx_uint64_t *carry)
+{
+	quote ^= quote << 1;
+	quote ^= quote << 2;
+	quote ^= quote << 4;
+	quote ^= quote << 8;
+	quote ^= quote << 16;
+	quote ^= quote << 32;
+	quote ^= *carry;
+
+	*carry = (0 != (quote >> (JSON_INDEX_BLOCK_SIZE - 1)) ? ~(zbx_uint64_t)0 : 0);
+
+	return quote;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: build structural index of JSON buffer                             *
+ *                                                                            *
+ * Parameters: index - [OUT] the index                                        *
+ *             start - [IN] the buffer start                                  *
+ *             end   - [IN] the last buffer character                         *
+ *                                                                            *
+ * Return value: SUCCEED - the index was built                                *
+ *               FAIL    - the buffer brackets are not balanced               *
+ *                                                                            *
+ ******************************************************************************/
+static int	json_index_build(zbx_json_index_t *index, const char *start, const char *end)
+{
+	json_index_classify_func_t	classify;
+	json_index_block_t		block;
+	zbx_uint64_t			escaped_carry = 0, string_carry = 0;
+	zbx_uint32_t			i, top = JSON_INDEX_NONE;
+	size_t				offset, len = (size_t)(end - start) + 1;
+	unsigned char			tail[JSON_INDEX_BLOCK_SIZE];
+
+	classify = json_index_get_classify_func();
+
+	index->start = start;
+	index->end = end;
+	index->num = 0;
+
+	/* do not keep memory of much larger buffer indexed in the same slot before */
+	if (index->alloc > (len / 16 + JSON_INDEX_BLOCK_SIZE) * 2)
+	{
+		zbx_free(index->pos);
+		zbx_free(index->match);
+		index->alloc = 0;
+	}
+
+	for (offset = 0; offset < len; offset += JSON_INDEX_BLOCK_SIZE)
+	{
+		const unsigned char	*data = (const unsigned char *)start + offset;
+		zbx_uint64_t		structural;
+
+		if (JSON_INDEX_BLOCK_SIZE > len - offset)
+		{
+			memset(tail, ' ', sizeof(tail));
+			memcpy(tail, data, len - offset);
+			data = tail;
+		}
+
+		classify(data, &block);
+
+		structural = block.structural & ~json_index_in_string(
+				block.quote & ~json_index_escaped(block.backslash, &escaped_carry), &string_carry);
+
+		if (index->num + JSON_INDEX_BLOCK_SIZE > index->alloc)
+		{
+			/* start with estimated structural character density to avoid reallocations */
+			index->alloc = MAX(index->alloc * 3 / 2, (zbx_uint32_t)(len / 16)) + JSON_INDEX_BLOCK_SIZE;
+			index->pos = (zbx_uint32_t *)zbx_realloc(index->pos, index->alloc * sizeof(zbx_uint32_t));
+			index->match = (zbx_uint32_t *)zbx_realloc(index->match, index->alloc * sizeof(zbx_uint32_t));
+		}
+
+		/* pair brackets while the block is cached, open brackets keep the enclosing one */
+		while (0 != structural)
+		{
+			zbx_uint32_t	pos = (zbx_uint32_t)offset + (zbx_uint32_t)json_index_ctz(structural), parent;
+
+			structural &= structural - 1;
+			i = index->num++;
+			index->pos[i] = pos;
+
+			switch (start[pos])
+			{
+				case '{':
+				case '[':
+					index->match[i] = top;
+					top = i;
+					break;
+				case '}':
+				case ']':
+					if (JSON_INDEX_NONE == top || start[index->pos[top]] + 2 != start[pos])
+						return FAIL;
+
+					parent = index->match[top];
+					index->match[top] = i;
+					index->match[i] = top;
+					top = parent;
+					break;
+				default:
+					index->match[i] = JSON_INDEX_NONE;
+			}
+		}
+	}
+
+	if (JSON_INDEX_NONE != top)
+		return FAIL;
+
+	/* release memory left from indexing much larger buffers */
+	if (index->alloc > index->num * 4 && index->alloc > JSON_INDEX_BLOCK_SIZE * 1024)
+	{
+		index->alloc = index->num + JSON_INDEX_BLOCK_SIZE;
+		index->pos = (zbx_uint32_t *)zbx_realloc(index->pos, index->alloc * sizeof(zbx_uint32_t));
+		index->match = (zbx_uint32_t *)zbx_realloc(index->match, index->alloc * sizeof(zbx_uint32_t));
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: release memory of index slots if they were not used for a while   *
+ *                                                                            *
+ * Comments: The indexes cannot tell when the indexed buffers are freed, so   *
+ *           memory is released after indexes were not used for               *
+ *           ZBX_JSON_INDEX_TTL seconds. Released slots are not usable, so    *
+ *           parsed objects referring to them fall back to plain scanning.    *
+ *                                                                            *
+ ******************************************************************************/
+static void	json_index_release_unused(void)
+{
+	time_t	now;
+
+	if (0 == json_index_expire || (now = time(NULL)) < json_index_expire)
+		return;
+
+	if (0 != json_index_used)
+	{
+		json_index_used = 0;
+		json_index_expire = now + ZBX_JSON_INDEX_TTL;
+
+		return;
+	}
+
+	for (int i = 0; i < JSON_INDEX_SLOTS_NUM; i++)
+	{
+		zbx_json_index_t	*index = &json_index_slots[i];
+
+		zbx_free(index->pos);
+		zbx_free(index->match);
+		index->start = NULL;
+		index->end = NULL;
+		index->num = 0;
+		index->alloc = 0;
+	}
+
+	json_index_hint_index = NULL;
+	json_index_expire = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create structural index of validated JSON buffer                  *
+ *                                                                            *
+ * Parameters: start - [IN] the buffer start                                  *
+ *             end   - [IN] the last buffer character                         *
+ *                                                                            *
+ * Return value: the index or NULL if the buffer should not be indexed        *
+ *                                                                            *
+ * Comments: The index is stored in thread local slot which is reused after   *
+ *           JSON_INDEX_SLOTS_NUM other buffers are indexed. Memory of unused *
+ *           slots is released when opening the next buffers.                 *
+ *                                                                            *
+ ******************************************************************************/
+const zbx_json_index_t	*json_index_create(const char *start, const char *end)
+{
+	zbx_json_index_t	*index;
+	size_t			len = (size_t)(end - start) + 1;
+
+	json_index_release_unused();
+
+	if (ZBX_JSON_INDEX_MIN_SIZE > len || JSON_INDEX_NONE <= len)
+		return NULL;
+
+	index = &json_index_slots[json_index_slot_next];
+	json_index_slot_next = (json_index_slot_next + 1) % JSON_INDEX_SLOTS_NUM;
+
+	if (0 == json_index_expire)
+		json_index_expire = time(NULL) + ZBX_JSON_INDEX_TTL;
+
+	if (SUCCEED != json_index_build(index, start, end))
+	{
+		index->start = NULL;
+		index->end = NULL;
+
+		return NULL;
+	}
+
+	json_index_used = 1;
+
+	return index;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if index can be used to navigate the parsed object          *
+ *                                                                            *
+ * Comments: The index slot is valid only in the thread that created it and   *
+ *           until it is reused for another buffer or released.               *
+ *                                                                            *
+ ******************************************************************************/
+int	json_index_usable(const zbx_json_index_t *index, const struct zbx_json_parse *jp)
+{
+	if (NULL == index || index < json_index_slots || index >= json_index_slots + JSON_INDEX_SLOTS_NUM)
+		return FAIL;
+
+	if (jp->start < index->start || jp->end > index->end)
+		return FAIL;
+
+	json_index_used = 1;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find the first structural character at or after the offset        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	json_index_search(const zbx_json_index_t *index, zbx_uint32_t offset)
+{
+	zbx_uint32_t	lo = 0, hi = index->num;
+
+	if (index == json_index_hint_index && json_index_hint <= index->num &&
+			(0 == json_index_hint || index->pos[json_index_hint - 1] < offset) &&
+			(index->num == json_index_hint || index->pos[json_index_hint] >= offset))
+	{
+		return json_index_hint;
+	}
+
+	while (lo < hi)
+	{
+		zbx_uint32_t	mid = lo + (hi - lo) / 2;
+
+		if (index->pos[mid] < offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locate next pair or element using structural index                *
+ *                                                                            *
+ * Comments: See zbx_json_next(), nested objects and arrays are skipped by    *
+ *           jumping to their closing brackets.                               *
+ *                                                                            *
+ ******************************************************************************/
+const char	*json_index_next(const zbx_json_index_t *index, const struct zbx_json_parse *jp, const char *p)
+{
+	zbx_uint32_t	i, end = (zbx_uint32_t)(jp->end - index->start);
+
+	for (i = json_index_search(index, (zbx_uint32_t)(p - index->start)); i < index->num && index->pos[i] <= end;)
+	{
+		switch (index->start[index->pos[i]])
+		{
+			case '{':
+			case '[':
+				i = index->match[i] + 1;
+				break;
+			case ',':
+				json_index_hint_index = index;
+				json_index_hint = i + 1;
+
+				p = index->start + index->pos[i] + 1;
+				SKIP_WHITESPACE(p);
+				return p;
+			default:
+				return NULL;
+		}
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locate the closing bracket using structural index                 *
+ *                                                                            *
+ * Parameters: index - [IN] the index                                         *
+ *             p     - [IN] the opening bracket                               *
+ *                                                                            *
+ * Return value: position of the right bracket                                *
+ *               NULL - the position is not an indexed opening bracket        *
+ *                                                                            *
+ ******************************************************************************/
+const char	*json_index_rbracket(const zbx_json_index_t *index, const char *p)
+{
+	zbx_uint32_t	i, offset = (zbx_uint32_t)(p - index->start);
+
+	if ('{' != *p && '[' != *p)
+		return NULL;
+
+	if ((i = json_index_search(index, offset)) == index->num || index->pos[i] != offset)
+		return NULL;
+
+	return index->start + index->pos[index->match[i]];
+}
@@ -0,0 +1,60 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_JSON_INDEX_H
+#define ZABBIX_JSON_INDEX_H
+
+#include "zbxjson.h"
+
+/* buffers smaller than this are navigated by plain scanning */
+#define ZBX_JSON_INDEX_MIN_SIZE		(64 * ZBX_KIBIBYTE)
+
+/* index memory is released when indexes were not used for this number of seconds */
+#define ZBX_JSON_INDEX_TTL		SEC_PER_MIN
+
+#define ZBX_JSON_INDEX_IMPL_AUTO	0
+#define ZBX_JSON_INDEX_IMPL_SCALAR	1
+#define ZBX_JSON_INDEX_IMPL_SSE2	2
+#define ZBX_JSON_INDEX_IMPL_AVX2	3
+
+/* structural index of a validated JSON buffer */
+struct zbx_json_index
+{
+	const char	*start;		/* first indexed byte */
+	const char	*end;		/* last indexed byte */
+
+	/* offsets of structural characters '{', '}', '[', ']' and ',' outside strings */
+	zbx_uint32_t	*pos;
+
+	/* index of the matching bracket for brackets, unused for commas */
+	zbx_uint32_t	*match;
+
+	zbx_uint32_t	num;
+	zbx_uint32_t	alloc;
+};
+
+const zbx_json_index_t	*json_index_create(const char *start, const char *end);
+int	json_index_usable(const zbx_json_index_t *index, const struct zbx_json_parse *jp);
+const char	*json_index_next(const zbx_json_index_t *index, const struct zbx_json_parse *jp, const char *p);
+const char	*json_index_rbracket(const zbx_json_index_t *index, const char *p);
+
+int	json_index_set_impl(int impl);
+int	json_index_get_impl(void);
+
+#endif
@@ -2872,30 +2872,64 @@ static void	jsonpath_ctx_clear(zbx_jsonpath_context_t *ctx)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: perform jsonpath query on the specified json object               *
+ * Purpose: apply jsonpath functions to the matched objects and format the    *
+ *          query result                                                      *
  *                                                                            *
- * Parameters: obj    - [IN] json object                                  *
- *             index  - [IN] jsonpath index (optional)                        *
- *             path   - [IN] jsonpath                                         *
+ * Parameters: ctx    - [IN] jsonpath query context with matched objects      *
  *             output - [OUT] output value                                    *
  *                                                                            *
+ * Return value: SUCCEED - the result was formatted successfully              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsonpath_query_result(zbx_jsonpath_context_t *ctx, char **output)
+{
+	zbx_vector_jsonobj_ref_t	out;
+	int				ret, definite_path = ctx->path->definite, path_depth;
+
+	zbx_vector_jsonobj_ref_create(&out);
+
+	path_depth = ctx->path->segments_num;
+	while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == ctx->path->segments[path_depth - 1].type)
+		path_depth--;
+
+	if (path_depth < ctx->path->segments_num)
+	{
+		if (SUCCEED == (ret = jsonpath_apply_functions(ctx, path_depth, &definite_path, &out)))
+			ret = jsonpath_format_query_result(&out, definite_path, output);
+	}
+	else
+		ret = jsonpath_format_query_result(&ctx->objects, definite_path, output);
+
+	jsonobj_clear_ref_vector(&out);
+	zbx_vector_jsonobj_ref_destroy(&out);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform compiled jsonpath query on the specified json object      *
+ *                                                                            *
+ * Parameters: obj      - [IN] json object                                    *
+ *             index    - [IN] jsonpath index (optional)                      *
+ *             jsonpath - [IN] compiled jsonpath                              *
+ *             output   - [OUT] output value                                  *
+ *                                                                            *
  * Return value: SUCCEED - the query was performed successfully (empty result *
  *                         being counted as successful query)                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output)
+int	zbx_jsonobj_query_path(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, zbx_jsonpath_t *jsonpath,
+		char **output)
 {
 	zbx_jsonpath_context_t	ctx;
-	zbx_jsonpath_t		jsonpath;
 	int			ret = SUCCEED;
 
-	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
-		return FAIL;
-
 	ctx.found = 0;
 	ctx.root = obj;
-	ctx.path = &jsonpath;
+	ctx.path = jsonpath;
 	zbx_vector_jsonobj_ref_create(&ctx.objects);
 	ctx.index = index;
 
@@ -2912,29 +2946,37 @@ int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const
 	}
 
 	if (SUCCEED == ret)
-	{
-		zbx_vector_jsonobj_ref_t	out;
-		int				definite_path = jsonpath.definite, path_depth;
+		ret = jsonpath_query_result(&ctx, output);
 
-		zbx_vector_jsonobj_ref_create(&out);
+	jsonpath_ctx_clear(&ctx);
 
-		path_depth = jsonpath.segments_num;
-		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath.segments[path_depth - 1].type)
-			path_depth--;
+	return ret;
+}
 
-		if (path_depth < jsonpath.segments_num)
-		{
-			if (SUCCEED == (ret = jsonpath_apply_functions(&ctx, path_depth, &definite_path, &out)))
-				ret = jsonpath_format_query_result(&out, definite_path, output);
-		}
-		else
-			ret = jsonpath_format_query_result(&ctx.objects, definite_path, output);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform jsonpath query on the specified json object               *
+ *                                                                            *
+ * Parameters: obj    - [IN] json object                                      *
+ *             index  - [IN] jsonpath index (optional)                        *
+ *             path   - [IN] jsonpath                                         *
+ *             output - [OUT] output value                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output)
+{
+	zbx_jsonpath_t	jsonpath;
+	int		ret;
 
-		jsonobj_clear_ref_vector(&out);
-		zbx_vector_jsonobj_ref_destroy(&out);
-	}
+	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
+		return FAIL;
+
+	ret = zbx_jsonobj_query_path(obj, index, &jsonpath, output);
 
-	jsonpath_ctx_clear(&ctx);
 	zbx_jsonpath_clear(&jsonpath);
 
 	return ret;
@@ -2945,6 +2987,254 @@ int	zbx_jsonobj_query(zbx_jsonobj_t *obj, const char *path, char **output)
 	return zbx_jsonobj_query_ext(obj, NULL, path, output);
 }
 
+/* multiple jsonpath query support */
+
+typedef struct
+{
+	zbx_jsonpath_query_t		*query;
+	const zbx_jsonpath_segment_t	*segment;	/* the segment being resolved at current depth */
+}
+zbx_jsonpath_query_ref_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if jsonpath segment selects single child element by name    *
+ *          or index, so it can be resolved by direct lookup                  *
+ *                                                                            *
+ * Parameters: jsonpath   - [IN] compiled jsonpath                            *
+ *             path_depth - [IN] the jsonpath segment to check                *
+ *                                                                            *
+ * Return value: SUCCEED - the segment selects single child element           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsonpath_segment_is_definite(const zbx_jsonpath_t *jsonpath, int path_depth)
+{
+	const zbx_jsonpath_segment_t	*segment;
+
+	if (path_depth >= jsonpath->segments_num)
+		return FAIL;
+
+	segment = &jsonpath->segments[path_depth];
+
+	if (ZBX_JSONPATH_SEGMENT_MATCH_LIST != segment->type || 0 != segment->detached)
+		return FAIL;
+
+	if (NULL == segment->data.list.values || NULL != segment->data.list.values->next)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+static int	jsonpath_query_ref_compare(const void *d1, const void *d2)
+{
+	const zbx_jsonpath_query_ref_t	*ref1 = (const zbx_jsonpath_query_ref_t *)d1;
+	const zbx_jsonpath_query_ref_t	*ref2 = (const zbx_jsonpath_query_ref_t *)d2;
+	const zbx_jsonpath_list_t	*list1 = &ref1->segment->data.list, *list2 = &ref2->segment->data.list;
+	int				index1, index2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(list1->type, list2->type);
+
+	if (ZBX_JSONPATH_LIST_NAME == list1->type)
+		return strcmp(list1->values->data, list2->values->data);
+
+	memcpy(&index1, list1->values->data, sizeof(index1));
+	memcpy(&index2, list2->values->data, sizeof(index2));
+
+	ZBX_RETURN_IF_NOT_EQUAL(index1, index2);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get child element selected by single name or index segment        *
+ *                                                                            *
+ * Parameters: obj     - [IN] the parent json object                          *
+ *             segment - [IN] the jsonpath segment                            *
+ *             buf     - [OUT] buffer for array element name                  *
+ *             size    - [IN] the buffer size                                 *
+ *             name    - [OUT] the child element name                         *
+ *                                                                            *
+ * Return value: The child element or NULL if the segment did not match.      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_jsonobj_t	*jsonpath_get_child(zbx_jsonobj_t *obj, const zbx_jsonpath_segment_t *segment, char *buf,
+		size_t size, const char **name)
+{
+	zbx_jsonpath_list_node_t	*node = segment->data.list.values;
+
+	if (ZBX_JSON_TYPE_OBJECT == obj->type && ZBX_JSONPATH_LIST_NAME == segment->data.list.type)
+	{
+		zbx_jsonobj_el_t	el_local, *el;
+
+		el_local.name = node->data;
+		if (NULL == (el = (zbx_jsonobj_el_t *)zbx_hashset_search(&obj->data.object, &el_local)))
+			return NULL;
+
+		*name = el->name;
+
+		return &el->value;
+	}
+
+	if (ZBX_JSON_TYPE_ARRAY == obj->type && ZBX_JSONPATH_LIST_INDEX == segment->data.list.type)
+	{
+		int	index;
+
+		memcpy(&index, node->data, sizeof(index));
+
+		if (0 > index)
+			index += obj->data.array.values_num;
+
+		if (0 > index || index >= obj->data.array.values_num)
+			return NULL;
+
+		zbx_snprintf(buf, size, "%d", index);
+		*name = buf;
+
+		return obj->data.array.values[index];
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform the rest of jsonpath query starting with object matched   *
+ *          by the previous jsonpath segments                                 *
+ *                                                                            *
+ * Parameters: root       - [IN] the root json object                         *
+ *             index      - [IN] jsonpath index (optional)                    *
+ *             name       - [IN] name or index of the matched object          *
+ *             obj        - [IN] the matched object                           *
+ *             path_depth - [IN] the jsonpath segment to match next           *
+ *             query      - [IN/OUT] the query                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	jsonpath_query_rest(zbx_jsonobj_t *root, zbx_jsonpath_index_t *index, const char *name,
+		zbx_jsonobj_t *obj, int path_depth, zbx_jsonpath_query_t *query)
+{
+	zbx_jsonpath_context_t	ctx;
+	int			ret;
+
+	ctx.found = 0;
+	ctx.root = root;
+	ctx.path = query->path;
+	zbx_vector_jsonobj_ref_create(&ctx.objects);
+	ctx.index = index;
+
+	if (0 == path_depth)
+		ret = jsonpath_query_contents(&ctx, obj, 0);
+	else
+		ret = jsonpath_query_next_segment(&ctx, name, obj, path_depth - 1);
+
+	if (SUCCEED == ret)
+		ret = jsonpath_query_result(&ctx, &query->output);
+
+	if (SUCCEED != ret)
+	{
+		zbx_free(query->output);
+		query->error = zbx_strdup(NULL, zbx_json_strerror());
+	}
+
+	jsonpath_ctx_clear(&ctx);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform multiple jsonpath queries on json object                  *
+ *                                                                            *
+ * Parameters: root       - [IN] the root json object                         *
+ *             index      - [IN] jsonpath index (optional)                    *
+ *             name       - [IN] name or index of the current object          *
+ *             obj        - [IN] the current object                           *
+ *             path_depth - [IN] the jsonpath segment to match                *
+ *             refs       - [IN/OUT] the queries matched up to path_depth     *
+ *             refs_num   - [IN] the number of queries                        *
+ *                                                                            *
+ * Comments: Queries sharing the same leading name/index segments resolve     *
+ *           them once and continue together, the rest of queries are         *
+ *           processed separately from the object where they diverge.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	jsonpath_query_paths(zbx_jsonobj_t *root, zbx_jsonpath_index_t *index, const char *name,
+		zbx_jsonobj_t *obj, int path_depth, zbx_jsonpath_query_ref_t *refs, int refs_num)
+{
+	int	i, j, definite_num = 0;
+
+	for (i = 0; i < refs_num; i++)
+	{
+		if (SUCCEED == jsonpath_segment_is_definite(refs[i].query->path, path_depth))
+		{
+			refs[i].segment = &refs[i].query->path->segments[path_depth];
+			refs[definite_num++] = refs[i];
+		}
+		else
+			jsonpath_query_rest(root, index, name, obj, path_depth, refs[i].query);
+	}
+
+	if (1 < definite_num)
+		qsort(refs, (size_t)definite_num, sizeof(zbx_jsonpath_query_ref_t), jsonpath_query_ref_compare);
+
+	for (i = 0; i < definite_num; i = j)
+	{
+		zbx_jsonobj_t	*child;
+		const char	*child_name;
+		char		buf[MAX_ID_LEN + 1];
+
+		for (j = i + 1; j < definite_num && 0 == jsonpath_query_ref_compare(&refs[i], &refs[j]); j++)
+			;
+
+		if (NULL != (child = jsonpath_get_child(obj, refs[i].segment, buf, sizeof(buf), &child_name)))
+		{
+			jsonpath_query_paths(root, index, child_name, child, path_depth + 1, refs + i, j - i);
+			continue;
+		}
+
+		/* no matching child - let the regular query produce the empty result */
+		for (; i < j; i++)
+			jsonpath_query_rest(root, index, name, obj, path_depth, refs[i].query);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform multiple compiled jsonpath queries on the specified json  *
+ *          object with a single document traversal                           *
+ *                                                                            *
+ * Parameters: obj         - [IN] json object                                 *
+ *             index       - [IN] jsonpath index (optional)                   *
+ *             queries     - [IN/OUT] the queries                             *
+ *             queries_num - [IN] the number of queries                       *
+ *                                                                            *
+ * Comments: The query output is set to NULL if nothing matched the path and  *
+ *           the error is set if the query failed.                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_jsonobj_query_paths(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, zbx_jsonpath_query_t *queries,
+		int queries_num)
+{
+	zbx_jsonpath_query_ref_t	*refs;
+	int				i;
+
+	if (0 == queries_num)
+		return;
+
+	refs = (zbx_jsonpath_query_ref_t *)zbx_malloc(NULL, sizeof(zbx_jsonpath_query_ref_t) * (size_t)queries_num);
+
+	for (i = 0; i < queries_num; i++)
+	{
+		queries[i].output = NULL;
+		queries[i].error = NULL;
+		refs[i].query = &queries[i];
+		refs[i].segment = NULL;
+	}
+
+	jsonpath_query_paths(obj, index, "", obj, 0, refs, queries_num);
+
+	zbx_free(refs);
+}
+
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
 /* jsonobject index hashset support */
 
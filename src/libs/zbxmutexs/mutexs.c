@@ -530,6 +530,65 @@ void	__zbx_mutex_unlock(const char *filename, int line, zbx_mutex_t mutex)
 #endif
 }
 
+#ifndef _WINDOWS
+/******************************************************************************
+ *                                                                            *
+ * Purpose: tries to lock the mutex without waiting                           *
+ *                                                                            *
+ * Parameters: filename - [IN] source filename (for tracking)                 *
+ *             line     - [IN] source filename line number (for tracking)     *
+ *             mutex    - [IN] handle of mutex                                *
+ *                                                                            *
+ * Return value: SUCCEED - the mutex was locked                               *
+ *               FAIL    - the mutex is already locked by other process       *
+ *                                                                            *
+ ******************************************************************************/
+int	__zbx_mutex_trylock(const char *filename, int line, zbx_mutex_t mutex)
+{
+#ifndef	HAVE_PTHREAD_PROCESS_SHARED
+	struct sembuf	sem_lock;
+#else
+	int		err;
+#endif
+
+	if (ZBX_MUTEX_NULL == mutex)
+		return SUCCEED;
+
+#ifdef	HAVE_PTHREAD_PROCESS_SHARED
+	if (0 != locks_disabled)
+		return SUCCEED;
+
+	if (0 == (err = pthread_mutex_trylock(mutex)))
+		return SUCCEED;
+
+	if (EBUSY != err)
+	{
+		zbx_error("[file:'%s',line:%d] lock failed: %s", filename, line, zbx_strerror(err));
+		exit(EXIT_FAILURE);
+	}
+#else
+	sem_lock.sem_num = mutex;
+	sem_lock.sem_op = -1;
+	sem_lock.sem_flg = SEM_UNDO | IPC_NOWAIT;
+
+	while (-1 == semop(ZBX_SEM_LIST_ID, &sem_lock, 1))
+	{
+		if (EAGAIN == errno)
+			return FAIL;
+
+		if (EINTR != errno)
+		{
+			zbx_error("[file:'%s',line:%d] lock failed: %s", filename, line, zbx_strerror(errno));
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	return SUCCEED;
+#endif
+	return FAIL;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Destroy the mutex                                                 *
@@ -631,9 +631,9 @@ int	item_preproc_2dec(zbx_variant_t *value, int op_type, char **errmsg)
 int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errmsg)
 {
 	char		*pattern, *output, *new_value = NULL;
-	char		*regex_error = NULL;
-	zbx_regexp_t	*regex = NULL;
-	int		ret = FAIL;
+	char			*regex_error = NULL;
+	const zbx_regexp_t	*regex;
+	int			ret = FAIL;
 
 	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
@@ -648,7 +648,8 @@ int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errm
 
 	*output++ = '\0';
 
-	if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &regex_error))	/* PCRE_MULTILINE is not used here */
+	/* PCRE_MULTILINE is not used here */
+	if (FAIL == zbx_regexp_compile_cached_ext(pattern, &regex, 0, &regex_error))
 	{
 		*errmsg = zbx_dsprintf(*errmsg, "invalid regular expression: %s", regex_error);
 		zbx_free(regex_error);
@@ -666,9 +667,6 @@ int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errm
 
 	ret = SUCCEED;
 out:
-	if (NULL != regex)
-		zbx_regexp_free(regex);
-
 	zbx_free(pattern);
 
 	return ret;
@@ -768,11 +766,11 @@ out:
  ******************************************************************************/
 int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params, char **error)
 {
-	zbx_variant_t	value_str;
-	int		ret = FAIL;
-	zbx_regexp_t	*regex;
-	char		*errptr = NULL;
-	char		*errmsg;
+	zbx_variant_t		value_str;
+	int			ret = FAIL;
+	const zbx_regexp_t	*regex;
+	char			*errptr = NULL;
+	char			*errmsg;
 
 	zbx_variant_copy(&value_str, value);
 
@@ -782,7 +780,7 @@ int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params,
 		goto out;
 	}
 
-	if (FAIL == zbx_regexp_compile(params, &regex, &errptr))
+	if (FAIL == zbx_regexp_compile_cached(params, &regex, &errptr))
 	{
 		errmsg = zbx_dsprintf(NULL, "invalid regular expression pattern: %s", errptr);
 		zbx_free(errptr);
@@ -793,8 +791,6 @@ int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params,
 		errmsg = zbx_strdup(NULL, "value does not match regular expression");
 	else
 		ret = SUCCEED;
-
-	zbx_regexp_free(regex);
 out:
 	zbx_variant_clear(&value_str);
 
@@ -823,11 +819,11 @@ out:
  ******************************************************************************/
 int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *params, char **error)
 {
-	zbx_variant_t	value_str;
-	int		ret = FAIL;
-	zbx_regexp_t	*regex;
-	char		*errptr = NULL;
-	char		*errmsg;
+	zbx_variant_t		value_str;
+	int			ret = FAIL;
+	const zbx_regexp_t	*regex;
+	char			*errptr = NULL;
+	char			*errmsg;
 
 	zbx_variant_copy(&value_str, value);
 
@@ -837,7 +833,7 @@ int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *para
 		goto out;
 	}
 
-	if (FAIL == zbx_regexp_compile(params, &regex, &errptr))
+	if (FAIL == zbx_regexp_compile_cached(params, &regex, &errptr))
 	{
 		errmsg = zbx_dsprintf(NULL, "invalid regular expression pattern: %s", errptr);
 		zbx_free(errptr);
@@ -850,8 +846,6 @@ int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *para
 	}
 	else
 		ret = SUCCEED;
-
-	zbx_regexp_free(regex);
 out:
 	zbx_variant_clear(&value_str);
 
@@ -1103,8 +1097,8 @@ int	item_preproc_check_error_regex(const zbx_variant_t *value, const char *param
 #define ZBX_PP_MATCH_TYPE_ANY		-1
 	zbx_variant_t	value_str;
 	int		ret = SUCCEED, match_type = ZBX_PP_MATCH_TYPE_ANY;
-	char		*pattern = NULL, *newline, *out = NULL, *errptr = NULL;
-	zbx_regexp_t	*regex;
+	char			*pattern = NULL, *newline, *out = NULL, *errptr = NULL;
+	const zbx_regexp_t	*regex;
 
 	zbx_variant_copy(&value_str, value);
 
@@ -1120,7 +1114,7 @@ int	item_preproc_check_error_regex(const zbx_variant_t *value, const char *param
 
 	if (ZBX_PP_MATCH_TYPE_MATCHES == match_type)
 	{
-		if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &errptr))
+		if (FAIL == zbx_regexp_compile_cached_ext(pattern, &regex, 0, &errptr))
 		{
 			*error = zbx_dsprintf(*error, "invalid regular expression: %s", errptr);
 			zbx_free(errptr);
@@ -1143,7 +1137,7 @@ int	item_preproc_check_error_regex(const zbx_variant_t *value, const char *param
 	{
 		int	res;
 
-		if (FAIL == zbx_regexp_compile(pattern, &regex, &errptr))
+		if (FAIL == zbx_regexp_compile_cached(pattern, &regex, &errptr))
 		{
 			*error = zbx_dsprintf(*error, "invalid regular expression: %s", errptr);
 			zbx_free(errptr);
@@ -1163,8 +1157,6 @@ int	item_preproc_check_error_regex(const zbx_variant_t *value, const char *param
 			ret = FAIL;
 		}
 	}
-
-	zbx_regexp_free(regex);
 out:
 	zbx_free(pattern);
 	zbx_variant_clear(&value_str);
@@ -0,0 +1,597 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "pp_batch.h"
+
+#include "zbxserialize.h"
+#include "zbx_item_constants.h"
+#include "module.h"
+
+#define PP_BATCH_HEADER_SIZE	((2 + ZBX_PP_BATCH_COLUMNS_NUM) * sizeof(zbx_uint32_t))
+
+/* value meta column: value type, item flags, variant type and field mask */
+#define PP_BATCH_META_SIZE	4
+
+#define PP_BATCH_FIELD_TS	0x01
+#define PP_BATCH_FIELD_META	0x02
+#define PP_BATCH_FIELD_LOG	0x04
+
+/* maximum size of 64 bit integer encoded with 7 bits per byte */
+#define PP_BATCH_VARINT_MAX	10
+
+typedef struct
+{
+	const zbx_pp_batch_column_t	*column;
+	const char			*str;
+	zbx_uint32_t			offset;
+	zbx_uint32_t			len;
+	zbx_uint32_t			index;
+}
+zbx_pp_batch_string_t;
+
+static const char	*pp_batch_string_get(const zbx_pp_batch_string_t *string)
+{
+	if (NULL != string->str)
+		return string->str;
+
+	return (const char *)string->column->data + string->offset;
+}
+
+static zbx_hash_t	pp_batch_string_hash(const void *data)
+{
+	const zbx_pp_batch_string_t	*string = (const zbx_pp_batch_string_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(pp_batch_string_get(string), string->len, ZBX_DEFAULT_HASH_SEED);
+}
+
+static int	pp_batch_string_compare(const void *d1, const void *d2)
+{
+	const zbx_pp_batch_string_t	*s1 = (const zbx_pp_batch_string_t *)d1;
+	const zbx_pp_batch_string_t	*s2 = (const zbx_pp_batch_string_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s1->len, s2->len);
+
+	return memcmp(pp_batch_string_get(s1), pp_batch_string_get(s2), s1->len);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serializes 64 bit unsigned integer using 7 bits per byte          *
+ *                                                                            *
+ * Parameters: ptr   - [OUT] output buffer, must have PP_BATCH_VARINT_MAX     *
+ *                           bytes available                                  *
+ *             value - [IN] value to serialize                                *
+ *                                                                            *
+ * Return value: The number of bytes written to the buffer.                   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	pp_batch_serialize_varint(unsigned char *ptr, zbx_uint64_t value)
+{
+	zbx_uint32_t	len = 0;
+
+	while (0x7f < value)
+	{
+		ptr[len++] = (unsigned char)(0x80 | (value & 0x7f));
+		value >>= 7;
+	}
+
+	ptr[len++] = (unsigned char)value;
+
+	return len;
+}
+
+static zbx_uint32_t	pp_batch_deserialize_varint(const unsigned char *ptr, zbx_uint64_t *value)
+{
+	zbx_uint32_t	len = 0, shift = 0;
+
+	*value = 0;
+
+	do
+	{
+		*value |= (zbx_uint64_t)(ptr[len] & 0x7f) << shift;
+		shift += 7;
+	}
+	while (0 != (ptr[len++] & 0x80) && PP_BATCH_VARINT_MAX > len);
+
+	return len;
+}
+
+/* maps signed deltas to unsigned values, so small negative deltas stay small */
+static zbx_uint64_t	pp_batch_zigzag_encode(zbx_uint64_t value, zbx_uint64_t prev)
+{
+	zbx_uint64_t	delta = value - prev;
+
+	return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+static zbx_uint64_t	pp_batch_zigzag_decode(zbx_uint64_t encoded, zbx_uint64_t prev)
+{
+	return prev + ((encoded >> 1) ^ (0 - (encoded & 1)));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reserves space at the end of column                               *
+ *                                                                            *
+ * Parameters: column - [IN/OUT]                                              *
+ *             size   - [IN] number of bytes to reserve                       *
+ *                                                                            *
+ * Return value: pointer to the reserved space                                *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned char	*pp_batch_column_reserve(zbx_pp_batch_column_t *column, size_t size)
+{
+	if (column->data_offset + size > column->data_alloc)
+	{
+		while (column->data_offset + size > column->data_alloc)
+			column->data_alloc = (0 == column->data_alloc ? 256 : column->data_alloc * 2);
+
+		column->data = (unsigned char *)zbx_realloc(column->data, column->data_alloc);
+	}
+
+	return column->data + column->data_offset;
+}
+
+static void	pp_batch_column_add(zbx_pp_batch_column_t *column, const void *data, size_t size)
+{
+	memcpy(pp_batch_column_reserve(column, size), data, size);
+	column->data_offset += size;
+}
+
+static void	pp_batch_column_add_varint(zbx_pp_batch_column_t *column, zbx_uint64_t value)
+{
+	column->data_offset += pp_batch_serialize_varint(pp_batch_column_reserve(column, PP_BATCH_VARINT_MAX), value);
+}
+
+static void	pp_batch_column_add_uint31(zbx_pp_batch_column_t *column, zbx_uint32_t value)
+{
+	column->data_offset += zbx_serialize_uint31_compact(pp_batch_column_reserve(column, 6), value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds string reference to batch, storing the string in string      *
+ *          table if it was not added before                                  *
+ *                                                                            *
+ * Parameters: batch - [IN/OUT]                                               *
+ *             str   - [IN] string to add, can be NULL                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_batch_add_string(zbx_pp_batch_t *batch, const char *str)
+{
+	zbx_pp_batch_column_t	*strings = &batch->columns[ZBX_PP_BATCH_COLUMN_STRINGS];
+	zbx_pp_batch_string_t	local, *string;
+
+	/* reference 0 is reserved for NULL strings */
+	if (NULL == str)
+	{
+		pp_batch_column_add_uint31(&batch->columns[ZBX_PP_BATCH_COLUMN_REFS], 0);
+		return;
+	}
+
+	local.column = strings;
+	local.str = str;
+	local.len = (zbx_uint32_t)strlen(str);
+
+	if (NULL == (string = (zbx_pp_batch_string_t *)zbx_hashset_search(&batch->strings, &local)))
+	{
+		local.index = (zbx_uint32_t)batch->strings.num_data;
+
+		pp_batch_column_add_uint31(strings, local.len);
+		local.offset = (zbx_uint32_t)strings->data_offset;
+		pp_batch_column_add(strings, str, local.len + 1);
+		local.str = NULL;
+
+		string = (zbx_pp_batch_string_t *)zbx_hashset_insert(&batch->strings, &local, sizeof(local));
+	}
+
+	pp_batch_column_add_uint31(&batch->columns[ZBX_PP_BATCH_COLUMN_REFS], string->index + 1);
+}
+
+void	pp_batch_init(zbx_pp_batch_t *batch)
+{
+	memset(batch, 0, sizeof(zbx_pp_batch_t));
+	zbx_hashset_create(&batch->strings, 0, pp_batch_string_hash, pp_batch_string_compare);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes all values from batch, keeping allocated buffers          *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_batch_clear(zbx_pp_batch_t *batch)
+{
+	for (int i = 0; i < ZBX_PP_BATCH_COLUMNS_NUM; i++)
+		batch->columns[i].data_offset = 0;
+
+	zbx_hashset_clear(&batch->strings);
+	batch->values_num = 0;
+	batch->itemid = 0;
+	batch->hostid = 0;
+	batch->sec = 0;
+}
+
+void	pp_batch_destroy(zbx_pp_batch_t *batch)
+{
+	for (int i = 0; i < ZBX_PP_BATCH_COLUMNS_NUM; i++)
+		zbx_free(batch->columns[i].data);
+
+	zbx_hashset_destroy(&batch->strings);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item value to batch                                          *
+ *                                                                            *
+ * Parameters: batch - [IN/OUT]                                               *
+ *             value - [IN] item value                                        *
+ *                                                                            *
+ * Return value: SUCCEED - value was added                                    *
+ *               FAIL    - value has strings larger than                      *
+ *                         ZBX_PP_BATCH_STRING_MAX and must be sent in row    *
+ *                         based format                                       *
+ *                                                                            *
+ * Comments: Value is converted to the form used by preprocessing manager     *
+ *           here, so the manager does not need to allocate agent results.    *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_batch_add_value(zbx_pp_batch_t *batch, const zbx_preproc_item_value_t *value)
+{
+	unsigned char		meta[PP_BATCH_META_SIZE], var_type = ZBX_VARIANT_NONE, mask = 0;
+	const char		*str = NULL;
+	const AGENT_RESULT	*result = value->result;
+	zbx_pp_batch_column_t	*num = &batch->columns[ZBX_PP_BATCH_COLUMN_NUM];
+
+	if (ITEM_STATE_NOTSUPPORTED == value->state)
+	{
+		var_type = ZBX_VARIANT_ERR;
+
+		if (NULL != value->error)
+			str = value->error;
+		else if (NULL != result && ZBX_ISSET_MSG(result))
+			str = result->msg;
+		else
+			str = "Unknown error.";
+
+		result = NULL;
+	}
+	else if (NULL != result)
+	{
+		if (ZBX_ISSET_LOG(result))
+		{
+			var_type = ZBX_VARIANT_STR;
+			str = result->log->value;
+			mask |= PP_BATCH_FIELD_LOG;
+
+			if (NULL != result->log->source && ZBX_PP_BATCH_STRING_MAX < strlen(result->log->source))
+				return FAIL;
+		}
+		else if (ZBX_ISSET_UI64(result))
+			var_type = ZBX_VARIANT_UI64;
+		else if (ZBX_ISSET_DBL(result))
+			var_type = ZBX_VARIANT_DBL;
+		else if (ZBX_ISSET_STR(result))
+		{
+			var_type = ZBX_VARIANT_STR;
+			str = result->str;
+		}
+		else if (ZBX_ISSET_TEXT(result))
+		{
+			var_type = ZBX_VARIANT_STR;
+			str = result->text;
+		}
+
+		if (ZBX_ISSET_META(result))
+			mask |= PP_BATCH_FIELD_META;
+	}
+
+	if (NULL != str && ZBX_PP_BATCH_STRING_MAX < strlen(str))
+		return FAIL;
+
+	if (NULL != value->ts)
+		mask |= PP_BATCH_FIELD_TS;
+
+	meta[0] = value->item_value_type;
+	meta[1] = value->item_flags;
+	meta[2] = var_type;
+	meta[3] = mask;
+	pp_batch_column_add(&batch->columns[ZBX_PP_BATCH_COLUMN_META], meta, sizeof(meta));
+
+	pp_batch_column_add_varint(&batch->columns[ZBX_PP_BATCH_COLUMN_IDS],
+			pp_batch_zigzag_encode(value->itemid, batch->itemid));
+	pp_batch_column_add_varint(&batch->columns[ZBX_PP_BATCH_COLUMN_IDS],
+			pp_batch_zigzag_encode(value->hostid, batch->hostid));
+	batch->itemid = value->itemid;
+	batch->hostid = value->hostid;
+
+	if (NULL != value->ts)
+	{
+		pp_batch_column_add_varint(&batch->columns[ZBX_PP_BATCH_COLUMN_TS],
+				pp_batch_zigzag_encode((zbx_uint64_t)value->ts->sec, (zbx_uint64_t)batch->sec));
+		pp_batch_column_add_uint31(&batch->columns[ZBX_PP_BATCH_COLUMN_TS], (zbx_uint32_t)value->ts->ns);
+		batch->sec = value->ts->sec;
+	}
+
+	switch (var_type)
+	{
+		case ZBX_VARIANT_UI64:
+			pp_batch_column_add(num, &result->ui64, sizeof(result->ui64));
+			break;
+		case ZBX_VARIANT_DBL:
+			pp_batch_column_add(num, &result->dbl, sizeof(result->dbl));
+			break;
+		case ZBX_VARIANT_STR:
+		case ZBX_VARIANT_ERR:
+			pp_batch_add_string(batch, str);
+			break;
+	}
+
+	if (0 != (mask & PP_BATCH_FIELD_META))
+	{
+		pp_batch_column_add_varint(num, result->lastlogsize);
+		pp_batch_column_add(num, &result->mtime, sizeof(result->mtime));
+	}
+
+	if (0 != (mask & PP_BATCH_FIELD_LOG))
+	{
+		pp_batch_column_add(num, &result->log->timestamp, sizeof(result->log->timestamp));
+		pp_batch_column_add(num, &result->log->severity, sizeof(result->log->severity));
+		pp_batch_column_add(num, &result->log->logeventid, sizeof(result->log->logeventid));
+		pp_batch_add_string(batch, result->log->source);
+	}
+
+	batch->values_num++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: packs batch into a single buffer that can be used in IPC          *
+ *                                                                            *
+ * Parameters: batch      - [IN]                                              *
+ *             data       - [IN/OUT] output buffer, reused between calls      *
+ *             data_alloc - [IN/OUT] output buffer size                       *
+ *                                                                            *
+ * Return value: size of packed data                                          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	pp_batch_pack(const zbx_pp_batch_t *batch, unsigned char **data, size_t *data_alloc)
+{
+	zbx_uint32_t	header[2 + ZBX_PP_BATCH_COLUMNS_NUM];
+	size_t		size = PP_BATCH_HEADER_SIZE;
+	unsigned char	*ptr;
+
+	header[0] = batch->values_num;
+	header[1] = (zbx_uint32_t)batch->strings.num_data;
+
+	for (int i = 0; i < ZBX_PP_BATCH_COLUMNS_NUM; i++)
+	{
+		header[2 + i] = (zbx_uint32_t)batch->columns[i].data_offset;
+		size += batch->columns[i].data_offset;
+	}
+
+	if (size > *data_alloc)
+	{
+		*data_alloc = size;
+		*data = (unsigned char *)zbx_realloc(*data, size);
+	}
+
+	memcpy(*data, header, PP_BATCH_HEADER_SIZE);
+	ptr = *data + PP_BATCH_HEADER_SIZE;
+
+	for (int i = 0; i < ZBX_PP_BATCH_COLUMNS_NUM; i++)
+	{
+		if (0 != batch->columns[i].data_offset)
+			memcpy(ptr, batch->columns[i].data, batch->columns[i].data_offset);
+		ptr += batch->columns[i].data_offset;
+	}
+
+	return (zbx_uint32_t)size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares batch reader for packed batch                            *
+ *                                                                            *
+ * Parameters: reader - [OUT]                                                 *
+ *             data   - [IN] packed batch, must stay valid while reading      *
+ *             size   - [IN] packed batch size                                *
+ *                                                                            *
+ * Return value: SUCCEED - reader was initialized                             *
+ *               FAIL    - invalid batch data                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_batch_reader_init(zbx_pp_batch_reader_t *reader, const unsigned char *data, zbx_uint32_t size)
+{
+	zbx_uint32_t		header[2 + ZBX_PP_BATCH_COLUMNS_NUM], len;
+	zbx_uint64_t		total = PP_BATCH_HEADER_SIZE;
+	const unsigned char	*ptr, *end;
+
+	memset(reader, 0, sizeof(zbx_pp_batch_reader_t));
+
+	if (PP_BATCH_HEADER_SIZE > size)
+		return FAIL;
+
+	memcpy(header, data, PP_BATCH_HEADER_SIZE);
+	ptr = data + PP_BATCH_HEADER_SIZE;
+
+	for (int i = 0; i < ZBX_PP_BATCH_COLUMNS_NUM; i++)
+	{
+		reader->columns[i] = ptr + (total - PP_BATCH_HEADER_SIZE);
+		total += header[2 + i];
+	}
+
+	if (total != size)
+		return FAIL;
+
+	reader->values_num = header[0];
+	reader->strings_num = header[1];
+
+	if (0 != reader->strings_num)
+	{
+		ptr = reader->columns[ZBX_PP_BATCH_COLUMN_STRINGS];
+		end = data + size;
+
+		reader->strings = (const char **)zbx_malloc(NULL, sizeof(char *) * reader->strings_num);
+
+		for (zbx_uint32_t i = 0; i < reader->strings_num; i++)
+		{
+			if (ptr >= end)
+				goto fail;
+
+			ptr += zbx_deserialize_uint31_compact(ptr, &len);
+
+			if (ptr + len >= end || '\0' != ptr[len])
+				goto fail;
+
+			reader->strings[i] = (const char *)ptr;
+			ptr += len + 1;
+		}
+	}
+
+	return SUCCEED;
+fail:
+	zbx_free(reader->strings);
+
+	return FAIL;
+}
+
+static char	*pp_batch_reader_get_string(zbx_pp_batch_reader_t *reader)
+{
+	zbx_uint32_t	ref;
+
+	reader->columns[ZBX_PP_BATCH_COLUMN_REFS] += zbx_deserialize_uint31_compact(
+			reader->columns[ZBX_PP_BATCH_COLUMN_REFS], &ref);
+
+	if (0 == ref || ref > reader->strings_num)
+		return NULL;
+
+	return zbx_strdup(NULL, reader->strings[ref - 1]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads next value from batch                                       *
+ *                                                                            *
+ * Parameters: reader - [IN/OUT]                                              *
+ *             value  - [OUT] unpacked value                                  *
+ *                                                                            *
+ * Return value: SUCCEED - value was read                                     *
+ *               FAIL    - no more values                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_batch_reader_next(zbx_pp_batch_reader_t *reader, zbx_pp_batch_value_t *value)
+{
+	const unsigned char	*meta;
+	const unsigned char	**num = &reader->columns[ZBX_PP_BATCH_COLUMN_NUM];
+	zbx_uint64_t		encoded, ui64;
+	zbx_uint32_t		ns;
+	double			dbl;
+	char			*str;
+
+	if (reader->values_read == reader->values_num)
+		return FAIL;
+
+	meta = reader->columns[ZBX_PP_BATCH_COLUMN_META];
+	reader->columns[ZBX_PP_BATCH_COLUMN_META] += PP_BATCH_META_SIZE;
+
+	value->value_type = meta[0];
+	value->flags = meta[1];
+
+	reader->columns[ZBX_PP_BATCH_COLUMN_IDS] += pp_batch_deserialize_varint(reader->columns[ZBX_PP_BATCH_COLUMN_IDS],
+			&encoded);
+	reader->itemid = value->itemid = pp_batch_zigzag_decode(encoded, reader->itemid);
+	reader->columns[ZBX_PP_BATCH_COLUMN_IDS] += pp_batch_deserialize_varint(reader->columns[ZBX_PP_BATCH_COLUMN_IDS],
+			&encoded);
+	reader->hostid = value->hostid = pp_batch_zigzag_decode(encoded, reader->hostid);
+
+	if (0 != (meta[3] & PP_BATCH_FIELD_TS))
+	{
+		reader->columns[ZBX_PP_BATCH_COLUMN_TS] += pp_batch_deserialize_varint(
+				reader->columns[ZBX_PP_BATCH_COLUMN_TS], &encoded);
+		reader->sec = value->ts.sec = (int)pp_batch_zigzag_decode(encoded, (zbx_uint64_t)reader->sec);
+		reader->columns[ZBX_PP_BATCH_COLUMN_TS] += zbx_deserialize_uint31_compact(
+				reader->columns[ZBX_PP_BATCH_COLUMN_TS], &ns);
+		value->ts.ns = (int)ns;
+	}
+	else
+	{
+		value->ts.sec = 0;
+		value->ts.ns = 0;
+	}
+
+	switch (meta[2])
+	{
+		case ZBX_VARIANT_UI64:
+			memcpy(&ui64, *num, sizeof(zbx_uint64_t));
+			*num += sizeof(zbx_uint64_t);
+			zbx_variant_set_ui64(&value->value, ui64);
+			break;
+		case ZBX_VARIANT_DBL:
+			memcpy(&dbl, *num, sizeof(double));
+			*num += sizeof(double);
+			zbx_variant_set_dbl(&value->value, dbl);
+			break;
+		case ZBX_VARIANT_STR:
+			if (NULL == (str = pp_batch_reader_get_string(reader)))
+				str = zbx_strdup(NULL, "");
+			zbx_variant_set_str(&value->value, str);
+			break;
+		case ZBX_VARIANT_ERR:
+			if (NULL == (str = pp_batch_reader_get_string(reader)))
+				str = zbx_strdup(NULL, "Unknown error.");
+			zbx_variant_set_error(&value->value, str);
+			break;
+		default:
+			zbx_variant_set_none(&value->value);
+	}
+
+	value->value_opt.flags = ZBX_PP_VALUE_OPT_NONE;
+	value->value_opt.source = NULL;
+
+	if (0 != (meta[3] & PP_BATCH_FIELD_META))
+	{
+		*num += pp_batch_deserialize_varint(*num, &value->value_opt.lastlogsize);
+		memcpy(&value->value_opt.mtime, *num, sizeof(int));
+		*num += sizeof(int);
+		value->value_opt.flags |= ZBX_PP_VALUE_OPT_META;
+	}
+
+	if (0 != (meta[3] & PP_BATCH_FIELD_LOG))
+	{
+		memcpy(&value->value_opt.timestamp, *num, sizeof(int));
+		*num += sizeof(int);
+		memcpy(&value->value_opt.severity, *num, sizeof(int));
+		*num += sizeof(int);
+		memcpy(&value->value_opt.logeventid, *num, sizeof(int));
+		*num += sizeof(int);
+		value->value_opt.source = pp_batch_reader_get_string(reader);
+		value->value_opt.flags |= ZBX_PP_VALUE_OPT_LOG;
+	}
+
+	reader->values_read++;
+
+	return SUCCEED;
+}
+
+void	pp_batch_reader_clear(zbx_pp_batch_reader_t *reader)
+{
+	zbx_free(reader->strings);
+}
@@ -0,0 +1,99 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_PP_BATCH_H
+#define ZABBIX_PP_BATCH_H
+
+#include "pp_protocol.h"
+
+#include "zbxalgo.h"
+#include "zbxvariant.h"
+#include "zbxtime.h"
+
+/* Columnar value batch format sent by preprocessing manager clients.        */
+/* The message starts with a header of value count, string count and sizes  */
+/* of the following columns. Item and host identifiers are delta encoded,   */
+/* strings are stored once in a string table and referenced by index.      */
+#define ZBX_PP_BATCH_COLUMN_META	0
+#define ZBX_PP_BATCH_COLUMN_IDS		1
+#define ZBX_PP_BATCH_COLUMN_TS		2
+#define ZBX_PP_BATCH_COLUMN_NUM		3
+#define ZBX_PP_BATCH_COLUMN_REFS	4
+#define ZBX_PP_BATCH_COLUMN_STRINGS	5
+#define ZBX_PP_BATCH_COLUMNS_NUM	6
+
+/* values having larger strings are sent in row based format */
+#define ZBX_PP_BATCH_STRING_MAX		ZBX_MEBIBYTE
+
+typedef struct
+{
+	unsigned char	*data;
+	size_t		data_alloc;
+	size_t		data_offset;
+}
+zbx_pp_batch_column_t;
+
+typedef struct
+{
+	zbx_pp_batch_column_t	columns[ZBX_PP_BATCH_COLUMNS_NUM];
+	zbx_hashset_t		strings;
+	zbx_uint32_t		values_num;
+	zbx_uint64_t		itemid;
+	zbx_uint64_t		hostid;
+	int			sec;
+}
+zbx_pp_batch_t;
+
+typedef struct
+{
+	const unsigned char	*columns[ZBX_PP_BATCH_COLUMNS_NUM];
+	const char		**strings;
+	zbx_uint32_t		strings_num;
+	zbx_uint32_t		values_num;
+	zbx_uint32_t		values_read;
+	zbx_uint64_t		itemid;
+	zbx_uint64_t		hostid;
+	int			sec;
+}
+zbx_pp_batch_reader_t;
+
+/* unpacked batch value, the value and optional data strings are owned by the caller */
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	zbx_uint64_t		hostid;
+	unsigned char		value_type;
+	unsigned char		flags;
+	zbx_variant_t		value;
+	zbx_timespec_t		ts;
+	zbx_pp_value_opt_t	value_opt;
+}
+zbx_pp_batch_value_t;
+
+void	pp_batch_init(zbx_pp_batch_t *batch);
+void	pp_batch_clear(zbx_pp_batch_t *batch);
+void	pp_batch_destroy(zbx_pp_batch_t *batch);
+int	pp_batch_add_value(zbx_pp_batch_t *batch, const zbx_preproc_item_value_t *value);
+zbx_uint32_t	pp_batch_pack(const zbx_pp_batch_t *batch, unsigned char **data, size_t *data_alloc);
+
+int	pp_batch_reader_init(zbx_pp_batch_reader_t *reader, const unsigned char *data, zbx_uint32_t size);
+int	pp_batch_reader_next(zbx_pp_batch_reader_t *reader, zbx_pp_batch_value_t *value);
+void	pp_batch_reader_clear(zbx_pp_batch_reader_t *reader);
+
+#endif
@@ -62,6 +62,29 @@ zbx_pp_cache_t	*pp_cache_create(const zbx_pp_item_preproc_t *preproc, const zbx_
 	return cache;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free jsonpath preprocessing cache data                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_cache_jsonpath_clear(zbx_pp_cache_jsonpath_t *jsonpath)
+{
+	zbx_hashset_iter_t		iter;
+	zbx_pp_cache_jsonpath_result_t	*result;
+
+	zbx_hashset_iter_reset(&jsonpath->results, &iter);
+	while (NULL != (result = (zbx_pp_cache_jsonpath_result_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_free(result->path);
+		zbx_free(result->output);
+		zbx_free(result->error);
+	}
+
+	zbx_hashset_destroy(&jsonpath->results);
+	zbx_jsonobj_clear(&jsonpath->obj);
+	zbx_jsonpath_index_free(jsonpath->index);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: free preprocessing cache                                          *
@@ -76,8 +99,7 @@ static void	pp_cache_free(zbx_pp_cache_t *cache)
 		switch (cache->type)
 		{
 			case ZBX_PREPROC_JSONPATH:
-				zbx_jsonobj_clear(&((zbx_pp_cache_jsonpath_t *)cache->data)->obj);
-				zbx_jsonpath_index_free(((zbx_pp_cache_jsonpath_t *)cache->data)->index);
+				pp_cache_jsonpath_clear((zbx_pp_cache_jsonpath_t *)cache->data);
 				break;
 			case ZBX_PREPROC_PROMETHEUS_PATTERN:
 				zbx_prometheus_clear((zbx_prometheus_t *)cache->data);
@@ -23,10 +23,19 @@
 #include "zbxpreproc.h"
 #include "zbxvariant.h"
 
+typedef struct
+{
+	char	*path;
+	char	*output;
+	char	*error;
+}
+zbx_pp_cache_jsonpath_result_t;
+
 typedef struct
 {
 	zbx_jsonobj_t		obj;
 	zbx_jsonpath_index_t	*index;
+	zbx_hashset_t		results;	/* dependent item query results by path */
 }
 zbx_pp_cache_jsonpath_t;
 
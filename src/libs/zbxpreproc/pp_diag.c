@@ -47,6 +47,34 @@ static void	diag_add_preproc_sequences(struct zbx_json *json, const char *field,
 	zbx_json_close(json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add preprocessing worker statistics to json data                  *
+ *                                                                            *
+ * Parameters: json    - [IN/OUT] the json to update                          *
+ *             field   - [IN] the field name                                  *
+ *             workers - [IN] worker task and regexp cache statistics         *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_add_preproc_workers(struct zbx_json *json, const char *field,
+		const zbx_vector_pp_worker_stats_t *workers)
+{
+	zbx_json_addarray(json, field);
+
+	for (int i = 0; i < workers->values_num; i++)
+	{
+		zbx_json_addobject(json, NULL);
+		zbx_json_addint64(json, "worker", i + 1);
+		zbx_json_adduint64(json, "steals", workers->values[i].steals_num);
+		zbx_json_adduint64(json, "idle", workers->values[i].idle_num);
+		zbx_json_adduint64(json, "regexp cache hits", workers->values[i].regexp_hits);
+		zbx_json_adduint64(json, "regexp cache misses", workers->values[i].regexp_misses);
+		zbx_json_close(json);
+	}
+
+	zbx_json_close(json);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add requested preprocessing diagnostic information to json data   *
@@ -78,12 +106,16 @@ int	zbx_diag_add_preproc_info(const struct zbx_json_parse *jp, struct zbx_json *
 
 		if (0 != (fields & ZBX_DIAG_PREPROC_SIMPLE))
 		{
-			zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num;
+			zbx_uint64_t			preproc_num, pending_num, finished_num, sequences_num;
+			zbx_vector_pp_worker_stats_t	workers;
+
+			zbx_vector_pp_worker_stats_create(&workers);
 
 			time1 = zbx_time();
 			if (FAIL == (ret = zbx_preprocessor_get_diag_stats(&preproc_num, &pending_num, &finished_num,
-					&sequences_num, error)))
+					&sequences_num, &workers, error)))
 			{
+				zbx_vector_pp_worker_stats_destroy(&workers);
 				goto out;
 			}
 
@@ -96,7 +128,10 @@ int	zbx_diag_add_preproc_info(const struct zbx_json_parse *jp, struct zbx_json *
 				zbx_json_adduint64(json, "pending tasks", pending_num);
 				zbx_json_adduint64(json, "finished tasks", finished_num);
 				zbx_json_adduint64(json, "task sequences", sequences_num);
+				diag_add_preproc_workers(json, "workers", &workers);
 			}
+
+			zbx_vector_pp_worker_stats_destroy(&workers);
 		}
 
 		if (0 != tops.values_num)
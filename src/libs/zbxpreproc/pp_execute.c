@@ -37,6 +37,139 @@
 #	endif
 #endif
 
+/* the maximum number of compiled jsonpaths cached by worker */
+#define PP_JSONPATH_CACHE_SIZE	1000
+
+struct zbx_pp_jsonpath
+{
+	char			*path;
+	zbx_jsonpath_t		jsonpath;
+	char			*error;		/* set if the path compilation failed */
+
+	zbx_pp_jsonpath_t	*prev;
+	zbx_pp_jsonpath_t	*next;
+};
+
+static void	pp_jsonpath_clear(void *d)
+{
+	zbx_pp_jsonpath_t	*jsonpath = (zbx_pp_jsonpath_t *)d;
+
+	zbx_free(jsonpath->path);
+
+	if (NULL == jsonpath->error)
+		zbx_jsonpath_clear(&jsonpath->jsonpath);
+	else
+		zbx_free(jsonpath->error);
+}
+
+static void	pp_context_jsonpath_unlink(zbx_pp_context_t *ctx, zbx_pp_jsonpath_t *jsonpath)
+{
+	if (NULL != jsonpath->prev)
+		jsonpath->prev->next = jsonpath->next;
+	else
+		ctx->jsonpaths_head = jsonpath->next;
+
+	if (NULL != jsonpath->next)
+		jsonpath->next->prev = jsonpath->prev;
+	else
+		ctx->jsonpaths_tail = jsonpath->prev;
+}
+
+static void	pp_context_jsonpath_link(zbx_pp_context_t *ctx, zbx_pp_jsonpath_t *jsonpath)
+{
+	jsonpath->prev = NULL;
+
+	if (NULL != (jsonpath->next = ctx->jsonpaths_head))
+		jsonpath->next->prev = jsonpath;
+	else
+		ctx->jsonpaths_tail = jsonpath;
+
+	ctx->jsonpaths_head = jsonpath;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled jsonpath from worker cache, compiling it if needed   *
+ *                                                                            *
+ * Parameters: ctx   - [IN] worker specific execution context                 *
+ *             path  - [IN] jsonpath                                          *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: The compiled jsonpath or NULL if the path is invalid.        *
+ *                                                                            *
+ * Comments: Step parameters change together with item configuration          *
+ *           revision, so the cache is keyed by the (macro expanded) path     *
+ *           itself and least recently used paths are dropped when the cache  *
+ *           is full.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_jsonpath_t	*pp_context_get_jsonpath(zbx_pp_context_t *ctx, const char *path, char **error)
+{
+	zbx_pp_jsonpath_t	*jsonpath, jsonpath_local;
+
+	jsonpath_local.path = (char *)path;
+
+	if (NULL != (jsonpath = (zbx_pp_jsonpath_t *)zbx_hashset_search(&ctx->jsonpaths, &jsonpath_local)))
+	{
+		if (jsonpath != ctx->jsonpaths_head)
+		{
+			pp_context_jsonpath_unlink(ctx, jsonpath);
+			pp_context_jsonpath_link(ctx, jsonpath);
+		}
+	}
+	else
+	{
+		if (PP_JSONPATH_CACHE_SIZE <= ctx->jsonpaths.num_data)
+		{
+			jsonpath = ctx->jsonpaths_tail;
+			pp_context_jsonpath_unlink(ctx, jsonpath);
+			zbx_hashset_remove_direct(&ctx->jsonpaths, jsonpath);
+		}
+
+		jsonpath_local.path = zbx_strdup(NULL, path);
+		jsonpath_local.error = NULL;
+
+		if (SUCCEED != zbx_jsonpath_compile(path, &jsonpath_local.jsonpath))
+			jsonpath_local.error = zbx_strdup(NULL, zbx_json_strerror());
+
+		jsonpath = (zbx_pp_jsonpath_t *)zbx_hashset_insert(&ctx->jsonpaths, &jsonpath_local,
+				sizeof(jsonpath_local));
+		pp_context_jsonpath_link(ctx, jsonpath);
+	}
+
+	if (NULL != jsonpath->error)
+	{
+		*error = zbx_strdup(*error, jsonpath->error);
+		return NULL;
+	}
+
+	return &jsonpath->jsonpath;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: expand user and function macros in step parameters                *
+ *                                                                            *
+ * Parameters: um_handle - [IN] shared user macro cache handle                *
+ *             hostid    - [IN]                                               *
+ *             step_type - [IN] preprocessing step type                       *
+ *             params    - [IN/OUT] step parameters                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_expand_params(zbx_dc_um_shared_handle_t *um_handle, zbx_uint64_t hostid, int step_type,
+		char **params)
+{
+	char		*error = NULL;
+	unsigned char	env = ZBX_PREPROC_SCRIPT == step_type ? ZBX_MACRO_ENV_SECURE : ZBX_MACRO_ENV_NONSECURE;
+
+	if (SUCCEED != zbx_dc_expand_user_and_func_macros_from_cache(um_handle->um_cache, params, &hostid, 1, env,
+			&error))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot resolve user macros: %s", error);
+		zbx_free(error);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute 'multiply by' step                                        *
@@ -236,7 +369,8 @@ static int	pp_execute_regsub(zbx_variant_t *value, const char *params)
  *                                                                            *
  * Purpose: execute jsonpath query                                            *
  *                                                                            *
- * Parameters: cache  - [IN] preprocessing cache                              *
+ * Parameters: ctx    - [IN] worker specific execution context                *
+ *             cache  - [IN] preprocessing cache                              *
  *             value  - [IN/OUT] value to process                             *
  *             params - [IN] step parameters                                  *
  *             errmsg - [OUT]                                                 *
@@ -245,10 +379,11 @@ static int	pp_execute_regsub(zbx_variant_t *value, const char *params)
  *               FAIL    - otherwise.                                         *
  *                                                                            *
  ******************************************************************************/
-static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params,
-		char **errmsg)
+static int	pp_excute_jsonpath_query(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_variant_t *value,
+		const char *params, char **errmsg)
 {
-	char	*data = NULL;
+	char		*data = NULL;
+	zbx_jsonpath_t	*jsonpath;
 
 	if (NULL == cache || ZBX_PREPROC_JSONPATH != cache->type)
 	{
@@ -263,7 +398,13 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 			return FAIL;
 		}
 
-		if (FAIL == zbx_jsonobj_query(&obj, params, &data))
+		if (NULL == (jsonpath = pp_context_get_jsonpath(ctx, params, errmsg)))
+		{
+			zbx_jsonobj_clear(&obj);
+			return FAIL;
+		}
+
+		if (FAIL == zbx_jsonobj_query_path(&obj, NULL, jsonpath, &data))
 		{
 			zbx_jsonobj_clear(&obj);
 			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
@@ -274,7 +415,8 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 	}
 	else
 	{
-		zbx_pp_cache_jsonpath_t	*index;
+		zbx_pp_cache_jsonpath_t		*index;
+		zbx_pp_cache_jsonpath_result_t	*result, result_local;
 
 		if (NULL != cache->error)
 		{
@@ -305,13 +447,37 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 				return FAIL;
 			}
 
+			zbx_hashset_create(&index->results, 0, ZBX_DEFAULT_STRING_PTR_HASH_FUNC,
+					ZBX_DEFAULT_STR_COMPARE_FUNC);
+
 			cache->data = (void *)index;
 		}
 
-		if (FAIL == zbx_jsonobj_query_ext(&index->obj, index->index, params, &data))
+		result_local.path = (char *)params;
+
+		/* use the result queried together with other dependent items if possible */
+		if (NULL != (result = (zbx_pp_cache_jsonpath_result_t *)zbx_hashset_search(&index->results,
+				&result_local)))
 		{
-			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
-			return FAIL;
+			if (NULL != result->error)
+			{
+				*errmsg = zbx_strdup(*errmsg, result->error);
+				return FAIL;
+			}
+
+			if (NULL != result->output)
+				data = zbx_strdup(NULL, result->output);
+		}
+		else
+		{
+			if (NULL == (jsonpath = pp_context_get_jsonpath(ctx, params, errmsg)))
+				return FAIL;
+
+			if (FAIL == zbx_jsonobj_query_path(&index->obj, index->index, jsonpath, &data))
+			{
+				*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+				return FAIL;
+			}
 		}
 	}
 
@@ -331,7 +497,8 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
  *                                                                            *
  * Purpose: execute 'jsonpath' step                                           *
  *                                                                            *
- * Parameters: cache  - [IN] preprocessing cache                              *
+ * Parameters: ctx    - [IN] worker specific execution context                *
+ *             cache  - [IN] preprocessing cache                              *
  *             value  - [IN/OUT] value to process                             *
  *             params - [IN] step parameters                                  *
  *                                                                            *
@@ -339,11 +506,12 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_execute_jsonpath(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params)
+static int	pp_execute_jsonpath(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_variant_t *value,
+		const char *params)
 {
 	char	*errmsg = NULL;
 
-	if (SUCCEED == pp_excute_jsonpath_query(cache, value, params, &errmsg))
+	if (SUCCEED == pp_excute_jsonpath_query(ctx, cache, value, params, &errmsg))
 		return SUCCEED;
 
 	zbx_variant_clear(value);
@@ -355,6 +523,77 @@ static int	pp_execute_jsonpath(zbx_pp_cache_t *cache, zbx_variant_t *value, cons
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: query first step jsonpaths of dependent items from the cached     *
+ *          json document in a single traversal                               *
+ *                                                                            *
+ * Parameters: ctx       - [IN] worker specific execution context             *
+ *             cache     - [IN] preprocessing cache                           *
+ *             um_handle - [IN] shared user macro cache handle                *
+ *             hostid    - [IN]                                               *
+ *             paths     - [IN] jsonpaths to query                            *
+ *                                                                            *
+ * Comments: The results are stored in preprocessing cache and used when      *
+ *           dependent items execute their first jsonpath step. This must be  *
+ *           done before the cache is shared with dependent item tasks.       *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_execute_jsonpaths(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shared_handle_t *um_handle,
+		zbx_uint64_t hostid, const zbx_vector_str_t *paths)
+{
+	zbx_pp_cache_jsonpath_t		*index;
+	zbx_pp_cache_jsonpath_result_t	**results;
+	zbx_jsonpath_query_t		*queries;
+	int				queries_num = 0;
+
+	if (NULL == cache || ZBX_PREPROC_JSONPATH != cache->type || NULL == cache->data)
+		return;
+
+	index = (zbx_pp_cache_jsonpath_t *)cache->data;
+	queries = (zbx_jsonpath_query_t *)zbx_malloc(NULL, sizeof(zbx_jsonpath_query_t) * (size_t)paths->values_num);
+	results = (zbx_pp_cache_jsonpath_result_t **)zbx_malloc(NULL,
+			sizeof(zbx_pp_cache_jsonpath_result_t *) * (size_t)paths->values_num);
+
+	/* compiled paths are borrowed from worker cache, so limit their number to keep them cached */
+	for (int i = 0; i < paths->values_num && i < PP_JSONPATH_CACHE_SIZE; i++)
+	{
+		zbx_pp_cache_jsonpath_result_t	result_local;
+		char				*error = NULL;
+
+		result_local.path = zbx_strdup(NULL, paths->values[i]);
+
+		if (NULL != um_handle)
+			pp_expand_params(um_handle, hostid, ZBX_PREPROC_JSONPATH, &result_local.path);
+
+		/* invalid paths are left for dependent items to report */
+		if (NULL != zbx_hashset_search(&index->results, &result_local) ||
+				NULL == (queries[queries_num].path = pp_context_get_jsonpath(ctx, result_local.path,
+				&error)))
+		{
+			zbx_free(error);
+			zbx_free(result_local.path);
+			continue;
+		}
+
+		result_local.output = NULL;
+		result_local.error = NULL;
+		results[queries_num++] = (zbx_pp_cache_jsonpath_result_t *)zbx_hashset_insert(&index->results,
+				&result_local, sizeof(result_local));
+	}
+
+	zbx_jsonobj_query_paths(&index->obj, index->index, queries, queries_num);
+
+	for (int i = 0; i < queries_num; i++)
+	{
+		results[i]->output = queries[i].output;
+		results[i]->error = queries[i].error;
+	}
+
+	zbx_free(results);
+	zbx_free(queries);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: return 'to dec' step descriptions for error messages              *
@@ -1061,17 +1300,7 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 	params = zbx_strdup(NULL, step->params);
 
 	if (NULL != um_handle)
-	{
-		char		*error = NULL;
-		unsigned char	env = ZBX_PREPROC_SCRIPT == step->type ? ZBX_MACRO_ENV_SECURE : ZBX_MACRO_ENV_NONSECURE;
-
-		if (SUCCEED != zbx_dc_expand_user_and_func_macros_from_cache(um_handle->um_cache, &params, &hostid, 1,
-				env, &error))
-		{
-			zabbix_log(LOG_LEVEL_DEBUG, "cannot resolve user macros: %s", error);
-			zbx_free(error);
-		}
-	}
+		pp_expand_params(um_handle, hostid, step->type, &params);
 
 	switch (step->type)
 	{
@@ -1099,7 +1328,7 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 			ret = pp_execute_xpath(value, params);
 			goto out;
 		case ZBX_PREPROC_JSONPATH:
-			ret = pp_execute_jsonpath(cache, value, params);
+			ret = pp_execute_jsonpath(ctx, cache, value, params);
 			goto out;
 		case ZBX_PREPROC_VALIDATE_RANGE:
 			ret = pp_validate_range(value_type, value, params);
@@ -1314,12 +1543,18 @@ out:
 void	pp_context_init(zbx_pp_context_t *ctx)
 {
 	memset(ctx, 0, sizeof(zbx_pp_context_t));
+
+	zbx_hashset_create_ext(&ctx->jsonpaths, 0, ZBX_DEFAULT_STRING_PTR_HASH_FUNC, ZBX_DEFAULT_STR_COMPARE_FUNC,
+			pp_jsonpath_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
 }
 
 void	pp_context_destroy(zbx_pp_context_t *ctx)
 {
 	if (0 != ctx->es_initialized)
 		zbx_es_destroy(&ctx->es_engine);
+
+	zbx_hashset_destroy(&ctx->jsonpaths);
 }
 
 zbx_es_t	*pp_context_es_engine(zbx_pp_context_t *ctx)
@@ -27,10 +27,17 @@
 #include "zbxvariant.h"
 #include "zbxcacheconfig.h"
 
+typedef struct zbx_pp_jsonpath zbx_pp_jsonpath_t;
+
 typedef struct
 {
-	int		es_initialized;
-	zbx_es_t	es_engine;
+	int			es_initialized;
+	zbx_es_t		es_engine;
+
+	/* compiled jsonpaths by path, limited to the most recently used ones */
+	zbx_hashset_t		jsonpaths;
+	zbx_pp_jsonpath_t	*jsonpaths_head;
+	zbx_pp_jsonpath_t	*jsonpaths_tail;
 }
 zbx_pp_context_t;
 
@@ -48,4 +55,7 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 		zbx_pp_step_t *step, zbx_variant_t *history_value, zbx_timespec_t *history_ts,
 		const char *config_source_ip);
 
+void	pp_execute_jsonpaths(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shared_handle_t *um_handle,
+		zbx_uint64_t hostid, const zbx_vector_str_t *paths);
+
 #endif
@@ -31,6 +31,7 @@
 #include "zbxcachehistory.h"
 #include "zbxprof.h"
 #include "pp_protocol.h"
+#include "pp_batch.h"
 #include "zbx_item_constants.h"
 #include "zbxnix.h"
 #include "zbxvariant.h"
@@ -142,7 +143,7 @@ static zbx_pp_manager_t	*zbx_pp_manager_create(int workers_num, zbx_pp_notify_cb
 	manager = (zbx_pp_manager_t *)zbx_malloc(NULL, sizeof(zbx_pp_manager_t));
 	memset(manager, 0, sizeof(zbx_pp_manager_t));
 
-	if (SUCCEED != pp_task_queue_init(&manager->queue, error))
+	if (SUCCEED != pp_task_queue_init(&manager->queue, workers_num, error))
 		goto out;
 
 	manager->timekeeper = zbx_timekeeper_create(workers_num, NULL);
@@ -355,6 +356,36 @@ static zbx_pp_item_t	*pp_manager_get_cacheable_dependent_item(zbx_pp_manager_t *
 	return NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get first step jsonpaths of dependent items                       *
+ *                                                                            *
+ * Parameters: manager        - [IN]                                          *
+ *             preproc        - [IN] master item preprocessing data           *
+ *             exclude_itemid - [IN] dependent itemid to exclude              *
+ *             paths          - [OUT] jsonpaths                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_manager_get_dependent_jsonpaths(zbx_pp_manager_t *manager, const zbx_pp_item_preproc_t *preproc,
+		zbx_uint64_t exclude_itemid, zbx_vector_str_t *paths)
+{
+	zbx_pp_item_t	*item;
+
+	for (int i = 0; i < preproc->dep_itemids_num; i++)
+	{
+		if (preproc->dep_itemids[i] == exclude_itemid)
+			continue;
+
+		if (NULL == (item = (zbx_pp_item_t *)zbx_hashset_search(&manager->items, &preproc->dep_itemids[i])))
+			continue;
+
+		if (0 == item->preproc->steps_num || ZBX_PREPROC_JSONPATH != item->preproc->steps[0].type)
+			continue;
+
+		zbx_vector_str_append(paths, zbx_strdup(NULL, item->preproc->steps[0].params));
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: create and queue tasks for dependent items                        *
@@ -450,6 +481,10 @@ static void	pp_manager_queue_value_task_result(zbx_pp_manager_t *manager, zbx_pp
 		d_dep->cache = pp_cache_create(item->preproc, &d->result);
 		zbx_variant_set_none(&value);
 
+		/* query jsonpaths of all dependent items while traversing the parsed value */
+		if (ZBX_PREPROC_JSONPATH == d_dep->cache->type)
+			pp_manager_get_dependent_jsonpaths(manager, d->preproc, item->itemid, &d_dep->paths);
+
 		d_dep->primary = pp_task_value_create(item->itemid, item->preproc, d->um_handle, &value, d->ts,
 				NULL, d_dep->cache);
 
@@ -583,9 +618,7 @@ static void	zbx_pp_manager_process_finished(zbx_pp_manager_t *manager, zbx_vecto
 		zbx_vector_pp_task_ptr_append(tasks, task);
 	}
 
-	*pending_num = manager->queue.pending_num;
-	*finished_num = manager->queue.finished_num;
-	*processing_num = manager->queue.processing_num;
+	pp_task_queue_get_stats(&manager->queue, pending_num, processing_num, finished_num);
 
 	pp_task_queue_unlock(&manager->queue);
 	zbx_prof_end();
@@ -657,9 +690,10 @@ zbx_hashset_t  *zbx_pp_manager_items(zbx_pp_manager_t *manager)
 static void	zbx_pp_manager_get_diag_stats(zbx_pp_manager_t *manager, zbx_uint64_t *preproc_num,
 		zbx_uint64_t *pending_num, zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num)
 {
+	zbx_uint64_t	processing_num;
+
 	*preproc_num = (zbx_uint64_t)manager->items.num_data;
-	*pending_num = manager->queue.pending_num;
-	*finished_num = manager->queue.finished_num;
+	pp_task_queue_get_stats(&manager->queue, pending_num, &processing_num, finished_num);
 	*sequences_num = (zbx_uint64_t)manager->queue.sequences.num_data;
 }
 
@@ -678,10 +712,20 @@ static void	zbx_pp_manager_get_sequence_stats(zbx_pp_manager_t *manager,
  *                                                                            *
  * Purpose: get worker usage statistics                                       *
  *                                                                            *
+ * Parameters: manager      - [IN]                                            *
+ *             worker_usage - [OUT] worker busy time usage (optional)         *
+ *             worker_stats - [OUT] worker task and regexp cache statistics   *
+ *                                  (optional)                                *
+ *                                                                            *
  ******************************************************************************/
-static void	zbx_pp_manager_get_worker_usage(zbx_pp_manager_t *manager, zbx_vector_dbl_t *worker_usage)
+static void	zbx_pp_manager_get_worker_usage(zbx_pp_manager_t *manager, zbx_vector_dbl_t *worker_usage,
+		zbx_vector_pp_worker_stats_t *worker_stats)
 {
-	(void)zbx_timekeeper_get_usage(manager->timekeeper, worker_usage);
+	if (NULL != worker_usage)
+		(void)zbx_timekeeper_get_usage(manager->timekeeper, worker_usage);
+
+	if (NULL != worker_stats)
+		pp_task_queue_get_worker_stats(&manager->queue, worker_stats);
 }
 
 /******************************************************************************
@@ -842,6 +886,38 @@ static void	preprocessing_flush_value(zbx_pp_manager_t *manager, zbx_uint64_t it
 	flush_value_func_cb(manager, itemid, value_type, flags, value, ts, value_opt);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates preprocessing task for received value or flushes the      *
+ *          value directly if the item has no preprocessing                   *
+ *                                                                            *
+ * Parameters: manager    - [IN] preprocessing manager                        *
+ *             itemid     - [IN] item identifier                              *
+ *             value_type - [IN] item value type                              *
+ *             flags      - [IN] item flags                                   *
+ *             var        - [IN] item value                                   *
+ *             ts         - [IN] value timestamp                              *
+ *             var_opt    - [IN] optional value data                          *
+ *             tasks      - [OUT] created tasks                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_add_value(zbx_pp_manager_t *manager, zbx_uint64_t itemid, unsigned char value_type,
+		unsigned char flags, zbx_variant_t *var, zbx_timespec_t ts, zbx_pp_value_opt_t *var_opt,
+		zbx_vector_pp_task_ptr_t *tasks)
+{
+	zbx_pp_task_t	*task;
+
+	if (NULL == (task = zbx_pp_manager_create_task(manager, itemid, var, ts, var_opt)))
+	{
+		preprocessing_flush_value(manager, itemid, value_type, flags, var, ts, var_opt);
+
+		zbx_variant_clear(var);
+		zbx_pp_value_opt_clear(var_opt);
+	}
+	else
+		zbx_vector_pp_task_ptr_append(tasks, task);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: handle new preprocessing request                                  *
@@ -871,22 +947,11 @@ static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_
 		zbx_variant_t		var;
 		zbx_pp_value_opt_t	var_opt;
 		zbx_timespec_t		ts;
-		zbx_pp_task_t		*task;
 
 		offset += zbx_preprocessor_unpack_value(&value, message->data + offset);
 		preproc_item_value_extract_data(&value, &var, &ts, &var_opt);
-
-		if (NULL == (task = zbx_pp_manager_create_task(manager, value.itemid, &var, ts, &var_opt)))
-		{
-			preprocessing_flush_value(manager, value.itemid, value.item_value_type, value.item_flags,
-					&var, ts, &var_opt);
-
-			zbx_variant_clear(&var);
-			zbx_pp_value_opt_clear(&var_opt);
-		}
-		else
-			zbx_vector_pp_task_ptr_append(&tasks, task);
-
+		preprocessor_add_value(manager, value.itemid, value.item_value_type, value.item_flags, &var, ts,
+				&var_opt, &tasks);
 		preproc_item_value_clear(&value);
 	}
 
@@ -901,6 +966,54 @@ static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_
 	return queued_num;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: handle new preprocessing request in columnar batch format         *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             message - [IN] packed preprocessing request                    *
+ *                                                                            *
+ *  Return value: The number of requests queued for preprocessing             *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	preprocessor_add_batch_request(zbx_pp_manager_t *manager, zbx_ipc_message_t *message)
+{
+	zbx_pp_batch_reader_t		reader;
+	zbx_pp_batch_value_t		value;
+	zbx_uint64_t			queued_num = 0;
+	zbx_vector_pp_task_ptr_t	tasks;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (SUCCEED != pp_batch_reader_init(&reader, message->data, message->size))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		goto out;
+	}
+
+	zbx_vector_pp_task_ptr_create(&tasks);
+	zbx_vector_pp_task_ptr_reserve(&tasks, reader.values_num);
+
+	preprocessor_sync_configuration(manager);
+
+	while (SUCCEED == pp_batch_reader_next(&reader, &value))
+	{
+		preprocessor_add_value(manager, value.itemid, value.value_type, value.flags, &value.value, value.ts,
+				&value.value_opt, &tasks);
+	}
+
+	if (0 != tasks.values_num)
+		zbx_pp_manager_queue_value_preproc(manager, &tasks);
+
+	queued_num = tasks.values_num;
+	zbx_vector_pp_task_ptr_destroy(&tasks);
+	pp_batch_reader_clear(&reader);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() values:" ZBX_FS_UI64, __func__, queued_num);
+
+	return queued_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: handle new preprocessing test request                             *
@@ -929,7 +1042,9 @@ static void	preprocessor_add_test_request(zbx_pp_manager_t *manager, zbx_ipc_cli
 
 static void	preprocessor_reply_queue_size(zbx_pp_manager_t *manager, zbx_ipc_client_t *client)
 {
-	zbx_uint64_t	pending_num = manager->queue.pending_num;
+	zbx_uint64_t	pending_num, processing_num, finished_num;
+
+	pp_task_queue_get_stats(&manager->queue, &pending_num, &processing_num, &finished_num);
 
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_QUEUE, (unsigned char *)&pending_num, sizeof(pending_num));
 }
@@ -1016,16 +1131,22 @@ static void	preprocessor_flush_tasks(zbx_pp_manager_t *manager, zbx_vector_pp_ta
  ******************************************************************************/
 static void	preprocessor_reply_diag_info(zbx_pp_manager_t *manager, zbx_ipc_client_t *client)
 {
-	zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num;
-	unsigned char	*data;
-	zbx_uint32_t	data_len;
+	zbx_uint64_t			preproc_num, pending_num, finished_num, sequences_num;
+	zbx_vector_pp_worker_stats_t	workers;
+	unsigned char			*data;
+	zbx_uint32_t			data_len;
+
+	zbx_vector_pp_worker_stats_create(&workers);
 
 	zbx_pp_manager_get_diag_stats(manager, &preproc_num, &pending_num, &finished_num, &sequences_num);
-	data_len = zbx_preprocessor_pack_diag_stats(&data, preproc_num, pending_num, finished_num, sequences_num);
+	zbx_pp_manager_get_worker_usage(manager, NULL, &workers);
+	data_len = zbx_preprocessor_pack_diag_stats(&data, preproc_num, pending_num, finished_num, sequences_num,
+			&workers);
 
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_DIAG_STATS_RESULT, data, data_len);
 
 	zbx_free(data);
+	zbx_vector_pp_worker_stats_destroy(&workers);
 }
 
 static int	preprocessor_compare_sequence_stats(const void *d1, const void *d2)
@@ -1090,7 +1211,7 @@ static void	preprocessor_reply_usage_stats(zbx_pp_manager_t *manager, int worker
 	zbx_uint32_t		data_len;
 
 	zbx_vector_dbl_create(&usage);
-	zbx_pp_manager_get_worker_usage(manager, &usage);
+	zbx_pp_manager_get_worker_usage(manager, &usage, NULL);
 
 	data_len = zbx_preprocessor_pack_usage_stats(&data, &usage, workers_num);
 
@@ -1260,6 +1381,9 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 				case ZBX_IPC_PREPROCESSOR_REQUEST:
 					queued_num += preprocessor_add_request(manager, message);
 					break;
+				case ZBX_IPC_PREPROCESSOR_REQUEST_BATCH:
+					queued_num += preprocessor_add_batch_request(manager, message);
+					break;
 				case ZBX_IPC_PREPROCESSOR_QUEUE:
 					preprocessor_reply_queue_size(manager, client);
 					break;
@@ -18,6 +18,7 @@
 **/
 
 #include "pp_protocol.h"
+#include "pp_batch.h"
 #include "zbxpreproc.h"
 
 #include "zbxserialize.h"
@@ -33,7 +34,10 @@
 		(zbx_packed_field_t){(value), (size), (0 == (size) ? PACKED_FIELD_STRING : PACKED_FIELD_RAW)}
 
 static zbx_ipc_message_t	cached_message;
-static int			cached_values;
+static zbx_pp_batch_t		cached_batch;
+static int			cached_batch_init = FAIL;
+static unsigned char		*batch_data;
+static size_t			batch_data_alloc;
 
 ZBX_PTR_VECTOR_IMPL(ipcmsg, zbx_ipc_message_t *)
 
@@ -482,10 +486,12 @@ zbx_uint32_t	zbx_preprocessor_pack_test_result(unsigned char **data, const zbx_p
  *                               preprocessed                                 *
  *             finished_num  - [IN] number of values being preprocessed       *
  *             sequences_num - [IN] number of registered task sequences       *
+ *             workers       - [IN] worker task and regexp cache statistics   *
  *                                                                            *
  ******************************************************************************/
 zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t preproc_num,
-		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num)
+		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num,
+		const zbx_vector_pp_worker_stats_t *workers)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len = 0;
@@ -494,6 +500,8 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
 	zbx_serialize_prepare_value(data_len, pending_num);
 	zbx_serialize_prepare_value(data_len, finished_num);
 	zbx_serialize_prepare_value(data_len, sequences_num);
+	zbx_serialize_prepare_value(data_len, workers->values_num);
+	data_len += (zbx_uint32_t)((size_t)workers->values_num * (sizeof(zbx_uint64_t) * 4));
 
 	*data = (unsigned char *)zbx_malloc(NULL, data_len);
 
@@ -501,7 +509,16 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
 	ptr += zbx_serialize_value(ptr, preproc_num);
 	ptr += zbx_serialize_value(ptr, pending_num);
 	ptr += zbx_serialize_value(ptr, finished_num);
-	(void)zbx_serialize_value(ptr, sequences_num);
+	ptr += zbx_serialize_value(ptr, sequences_num);
+	ptr += zbx_serialize_value(ptr, workers->values_num);
+
+	for (int i = 0; i < workers->values_num; i++)
+	{
+		ptr += zbx_serialize_value(ptr, workers->values[i].steals_num);
+		ptr += zbx_serialize_value(ptr, workers->values[i].idle_num);
+		ptr += zbx_serialize_value(ptr, workers->values[i].regexp_hits);
+		ptr += zbx_serialize_value(ptr, workers->values[i].regexp_misses);
+	}
 
 	return data_len;
 }
@@ -704,18 +721,35 @@ void	zbx_preprocessor_unpack_test_result(zbx_vector_pp_result_ptr_t *results, zb
  *                               preprocessed                                 *
  *             finished_num  - [OUT] number of values being preprocessed      *
  *             sequences_num - [OUT] number of registered task sequences      *
+ *             workers       - [OUT] worker task and regexp cache statistics  *
  *             data          - [OUT] data buffer                              *
  *                                                                            *
  ******************************************************************************/
 void	zbx_preprocessor_unpack_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
-		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, const unsigned char *data)
+		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_vector_pp_worker_stats_t *workers,
+		const unsigned char *data)
 {
 	const unsigned char	*offset = data;
+	int			workers_num;
 
 	offset += zbx_deserialize_value(offset, preproc_num);
 	offset += zbx_deserialize_value(offset, pending_num);
 	offset += zbx_deserialize_value(offset, finished_num);
-	(void)zbx_deserialize_value(offset, sequences_num);
+	offset += zbx_deserialize_value(offset, sequences_num);
+	offset += zbx_deserialize_value(offset, &workers_num);
+
+	zbx_vector_pp_worker_stats_reserve(workers, (size_t)workers_num);
+
+	for (int i = 0; i < workers_num; i++)
+	{
+		zbx_pp_worker_stats_t	stat;
+
+		offset += zbx_deserialize_value(offset, &stat.steals_num);
+		offset += zbx_deserialize_value(offset, &stat.idle_num);
+		offset += zbx_deserialize_value(offset, &stat.regexp_hits);
+		offset += zbx_deserialize_value(offset, &stat.regexp_misses);
+		zbx_vector_pp_worker_stats_append(workers, stat);
+	}
 }
 
 /******************************************************************************
@@ -885,13 +919,22 @@ void	zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigne
 		}
 	}
 
-	if (0 == preprocessor_pack_value(&cached_message, &value))
+	if (FAIL == cached_batch_init)
 	{
+		pp_batch_init(&cached_batch);
+		cached_batch_init = SUCCEED;
+	}
+
+	if (SUCCEED != pp_batch_add_value(&cached_batch, &value))
+	{
+		/* send value with large strings in row based format right after */
+		/* the already batched values to keep the value order            */
 		zbx_preprocessor_flush();
 		preprocessor_pack_value(&cached_message, &value);
+		zbx_preprocessor_flush();
 	}
 
-	if (ZBX_PREPROCESSING_BATCH_SIZE < ++cached_values)
+	if (ZBX_PREPROCESSING_BATCH_SIZE < cached_batch.values_num)
 		zbx_preprocessor_flush();
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -904,13 +947,21 @@ void	zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigne
  ******************************************************************************/
 void	zbx_preprocessor_flush(void)
 {
+	if (SUCCEED == cached_batch_init && 0 != cached_batch.values_num)
+	{
+		zbx_uint32_t	size;
+
+		size = pp_batch_pack(&cached_batch, &batch_data, &batch_data_alloc);
+		preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST_BATCH, batch_data, size, NULL);
+		pp_batch_clear(&cached_batch);
+	}
+
 	if (0 < cached_message.size)
 	{
 		preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, cached_message.data, cached_message.size, NULL);
 
 		zbx_ipc_message_clean(&cached_message);
 		zbx_ipc_message_init(&cached_message);
-		cached_values = 0;
 	}
 }
 
@@ -1061,7 +1112,8 @@ out:
  *                                                                            *
  ******************************************************************************/
 int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
-		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, char **error)
+		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_vector_pp_worker_stats_t *workers,
+		char **error)
 {
 	unsigned char	*result;
 
@@ -1071,7 +1123,7 @@ int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pen
 		return FAIL;
 	}
 
-	zbx_preprocessor_unpack_diag_stats(preproc_num, pending_num, finished_num, sequences_num, result);
+	zbx_preprocessor_unpack_diag_stats(preproc_num, pending_num, finished_num, sequences_num, workers, result);
 	zbx_free(result);
 
 	return SUCCEED;
@@ -26,7 +26,11 @@
 #define PP_TASK_QUEUE_INIT_LOCK		0x01
 #define PP_TASK_QUEUE_INIT_EVENT	0x02
 
+#define PP_WORKER_QUEUE_PENDING		0
+#define PP_WORKER_QUEUE_IMMEDIATE	1
+
 ZBX_PTR_VECTOR_IMPL(pp_sequence_stats_ptr, zbx_pp_sequence_stats_t *)
+ZBX_VECTOR_IMPL(pp_worker_stats, zbx_pp_worker_stats_t)
 
 /* task sequence registry by itemid */
 typedef struct
@@ -40,24 +44,25 @@ zbx_pp_item_task_sequence_t;
  *                                                                            *
  * Purpose: initialize task queue                                             *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
- *             error - [OUT]                                                  *
+ * Parameters: queue       - [IN] task queue                                  *
+ *             workers_num - [IN] number of workers                           *
+ *             error       - [OUT]                                            *
  *                                                                            *
  * Return value: SUCCEED - the task queue was initialized successfully        *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int workers_num, char **error)
 {
 	int	err, ret = FAIL;
 
 	queue->workers_num = 0;
-	queue->pending_num = 0;
-	queue->finished_num = 0;
-	queue->processing_num = 0;
-	zbx_list_create(&queue->pending);
-	zbx_list_create(&queue->immediate);
-	zbx_list_create(&queue->finished);
+	queue->queued_num = 0;
+	queue->push_index = 0;
+	queue->finished_index = 0;
+	queue->worker_queues_num = 0;
+	queue->worker_queues = (zbx_pp_worker_queue_t *)zbx_calloc(NULL, (size_t)workers_num,
+			sizeof(zbx_pp_worker_queue_t));
 
 	zbx_hashset_create(&queue->sequences, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
@@ -75,6 +80,21 @@ int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
 	}
 	queue->init_flags |= PP_TASK_QUEUE_INIT_EVENT;
 
+	for (; queue->worker_queues_num < workers_num; queue->worker_queues_num++)
+	{
+		zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[queue->worker_queues_num];
+
+		if (0 != (err = pthread_mutex_init(&wqueue->lock, NULL)))
+		{
+			*error = zbx_dsprintf(NULL, "cannot initialize worker task queue mutex: %s", zbx_strerror(err));
+			goto out;
+		}
+
+		zbx_list_create(&wqueue->immediate);
+		zbx_list_create(&wqueue->pending);
+		zbx_list_create(&wqueue->finished);
+	}
+
 	ret = SUCCEED;
 out:
 	if (FAIL == ret)
@@ -109,14 +129,24 @@ void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
 	if (0 != (queue->init_flags & PP_TASK_QUEUE_INIT_EVENT))
 		pthread_cond_destroy(&queue->event);
 
-	pp_task_queue_clear_tasks(&queue->pending);
-	zbx_list_destroy(&queue->pending);
+	for (int i = 0; i < queue->worker_queues_num; i++)
+	{
+		zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[i];
+
+		pp_task_queue_clear_tasks(&wqueue->immediate);
+		zbx_list_destroy(&wqueue->immediate);
+
+		pp_task_queue_clear_tasks(&wqueue->pending);
+		zbx_list_destroy(&wqueue->pending);
 
-	pp_task_queue_clear_tasks(&queue->immediate);
-	zbx_list_destroy(&queue->immediate);
+		pp_task_queue_clear_tasks(&wqueue->finished);
+		zbx_list_destroy(&wqueue->finished);
 
-	pp_task_queue_clear_tasks(&queue->finished);
-	zbx_list_destroy(&queue->finished);
+		pthread_mutex_destroy(&wqueue->lock);
+	}
+
+	zbx_free(queue->worker_queues);
+	queue->worker_queues_num = 0;
 
 	zbx_hashset_destroy(&queue->sequences);
 
@@ -127,6 +157,10 @@ void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
  *                                                                            *
  * Purpose: lock task queue                                                   *
  *                                                                            *
+ * Comments: The task queue lock protects task sequences and worker           *
+ *           registration. When both task queue and worker queue locks are    *
+ *           needed the task queue must be locked first.                      *
+ *                                                                            *
  ******************************************************************************/
 void	pp_task_queue_lock(zbx_pp_queue_t *queue)
 {
@@ -163,6 +197,31 @@ void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue)
 	queue->workers_num--;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add task to worker queue                                          *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             task  - [IN] task to add                                       *
+ *             list  - [IN] the target list (PP_WORKER_QUEUE_* defines)       *
+ *                                                                            *
+ * Comments: Tasks are distributed between worker queues in round robin       *
+ *           order. This function is called within task queue lock.           *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_task_queue_push_worker(zbx_pp_queue_t *queue, zbx_pp_task_t *task, int list)
+{
+	zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[queue->push_index];
+
+	if (++queue->push_index == queue->worker_queues_num)
+		queue->push_index = 0;
+
+	pthread_mutex_lock(&wqueue->lock);
+	(void)zbx_list_append(PP_WORKER_QUEUE_IMMEDIATE == list ? &wqueue->immediate : &wqueue->pending, task, NULL);
+	wqueue->tasks_num++;
+	pthread_mutex_unlock(&wqueue->lock);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add task to an existing sequence or create/append to a new one    *
@@ -213,20 +272,20 @@ void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 	{
 		case ZBX_PP_TASK_VALUE_SEQ:
 		case ZBX_PP_TASK_DEPENDENT:
-			queue->pending_num++;
+			queue->queued_num++;
 			if (NULL == (task = pp_task_queue_add_sequence(queue, task)))
 				return;
 			break;
 		case ZBX_PP_TASK_SEQUENCE:
 			/* sequence task is just a container for other tasks - it does not affect statistics, */
-			/* so there is no need to increment queue->pending_num                                */
+			/* so there is no need to increment queue->queued_num                                 */
 			break;
 		default:
-			queue->pending_num++;
+			queue->queued_num++;
 			break;
 	}
 
-	(void)zbx_list_append(&queue->immediate, task, NULL);
+	pp_task_queue_push_worker(queue, task, PP_WORKER_QUEUE_IMMEDIATE);
 }
 
 /******************************************************************************
@@ -252,8 +311,8 @@ void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid)
  ******************************************************************************/
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
-	queue->pending_num++;
-	(void)zbx_list_append(&queue->immediate, task, NULL);
+	queue->queued_num++;
+	pp_task_queue_push_worker(queue, task, PP_WORKER_QUEUE_IMMEDIATE);
 }
 
 /******************************************************************************
@@ -265,78 +324,183 @@ void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
  *                                                                            *
  * Comments: This function is used to push tasks created by new preprocessing *
  *           or testing requests.                                             *
+ *           Tasks requiring sequential processing are added to task          *
+ *           sequences right away, so the values of the same item are         *
+ *           processed in the order they were queued regardless of which      *
+ *           worker picks up the sequence task.                               *
  *                                                                            *
  ******************************************************************************/
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
 	zbx_pp_task_value_t	*d = (zbx_pp_task_value_t *)PP_TASK_DATA(task);
-	queue->pending_num++;
+	queue->queued_num++;
 
 	if (ITEM_TYPE_INTERNAL != d->preproc->type)
 	{
-		(void)zbx_list_append(&queue->pending, task, NULL);
+		if (ZBX_PP_TASK_VALUE_SEQ == task->type && NULL == (task = pp_task_queue_add_sequence(queue, task)))
+			return;
+
+		pp_task_queue_push_worker(queue, task, PP_WORKER_QUEUE_PENDING);
 		return;
 	}
 
 	if (ZBX_PP_TASK_VALUE == task->type)
 	{
-		(void)zbx_list_append(&queue->immediate, task, NULL);
+		pp_task_queue_push_worker(queue, task, PP_WORKER_QUEUE_IMMEDIATE);
 		return;
 	}
 
 	zbx_pp_task_t	*seq_task;
 
 	if (NULL != (seq_task = pp_task_queue_add_sequence(queue, task)))
-		(void)zbx_list_append(&queue->immediate, seq_task, NULL);
+		pp_task_queue_push_worker(queue, seq_task, PP_WORKER_QUEUE_IMMEDIATE);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: pop task from task queue                                          *
+ * Purpose: pop task from worker queue                                        *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
+ * Parameters: wqueue - [IN] worker queue                                     *
  *                                                                            *
- * Return value: The popped task or NULL if there are no tasks to be          *
- *               processed.                                                   *
+ * Return value: The popped task or NULL if worker queue is empty.            *
  *                                                                            *
- * Comments: This function is used by workers to pop tasks for processing.    *
- *           Sequence tasks will be moved to existing tasks sequences or      *
- *           returned if there are no registered sequences for this item.     *
+ * Comments: This function is called within worker queue lock.                *
  *                                                                            *
  ******************************************************************************/
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
+static zbx_pp_task_t	*pp_worker_queue_pop(zbx_pp_worker_queue_t *wqueue)
 {
-	zbx_pp_task_t	*task = NULL;
+	zbx_pp_task_t	*task;
 
-	if (SUCCEED == zbx_list_pop(&queue->immediate, (void **)&task))
+	if (SUCCEED != zbx_list_pop(&wqueue->immediate, (void **)&task) &&
+			SUCCEED != zbx_list_pop(&wqueue->pending, (void **)&task))
 	{
-		/* while sequence tasks do not affect statistics, the first task in sequence */
-		/* does, so the statistics can be updated for all tasks                      */
-		queue->pending_num--;
-		queue->processing_num++;
-
-		return (zbx_pp_task_t *)task;
+		return NULL;
 	}
 
-	while (SUCCEED == zbx_list_pop(&queue->pending, (void **)&task))
+	wqueue->tasks_num--;
+
+	return task;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: steal tasks from other worker queues                              *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             index - [IN] the thief worker queue index                      *
+ *                                                                            *
+ * Return value: The stolen task to process or NULL if no tasks were found.   *
+ *                                                                            *
+ * Comments: Besides the returned task half of the remaining victim queue     *
+ *           tasks are moved to the thief worker queue, so a worker running   *
+ *           out of tasks does not need to come back to the same victim for   *
+ *           every task.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_task_t	*pp_task_queue_steal(zbx_pp_queue_t *queue, int index)
+{
+	zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[index], *victim;
+	zbx_pp_task_t		*task = NULL, *stolen;
+	zbx_list_t		immediate, pending;
+	int			i, steal_num;
+
+	zbx_list_create(&immediate);
+	zbx_list_create(&pending);
+
+	for (i = 1; i < queue->worker_queues_num && NULL == task; i++)
 	{
-		if (ZBX_PP_TASK_VALUE_SEQ == task->type)
+		victim = &queue->worker_queues[(index + i) % queue->worker_queues_num];
+
+		pthread_mutex_lock(&victim->lock);
+
+		if (NULL != (task = pp_worker_queue_pop(victim)))
 		{
-			/* task is being moved from pending to immediate queue */
-			/* while still pending, so statistics are not affected */
-			task = pp_task_queue_add_sequence(queue, task);
+			for (steal_num = victim->tasks_num / 2; 0 < steal_num; steal_num--)
+			{
+				if (SUCCEED != zbx_list_pop(&victim->immediate, (void **)&stolen))
+				{
+					(void)zbx_list_pop(&victim->pending, (void **)&stolen);
+					(void)zbx_list_append(&pending, stolen, NULL);
+				}
+				else
+					(void)zbx_list_append(&immediate, stolen, NULL);
+
+				victim->tasks_num--;
+			}
 		}
 
-		if (NULL != task)
-		{
-			queue->pending_num--;
-			queue->processing_num++;
+		pthread_mutex_unlock(&victim->lock);
+	}
 
-			return task;
-		}
+	if (NULL == task)
+	{
+		zbx_list_destroy(&immediate);
+		zbx_list_destroy(&pending);
+
+		return NULL;
 	}
 
-	return NULL;
+	pthread_mutex_lock(&wqueue->lock);
+
+	while (SUCCEED == zbx_list_pop(&immediate, (void **)&stolen))
+	{
+		(void)zbx_list_append(&wqueue->immediate, stolen, NULL);
+		wqueue->tasks_num++;
+		wqueue->steals_num++;
+	}
+
+	while (SUCCEED == zbx_list_pop(&pending, (void **)&stolen))
+	{
+		(void)zbx_list_append(&wqueue->pending, stolen, NULL);
+		wqueue->tasks_num++;
+		wqueue->steals_num++;
+	}
+
+	wqueue->steals_num++;
+	wqueue->started_num++;
+
+	pthread_mutex_unlock(&wqueue->lock);
+
+	zbx_list_destroy(&immediate);
+	zbx_list_destroy(&pending);
+
+	return task;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pop task from task queue                                          *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             index - [IN] the worker queue index                            *
+ *                                                                            *
+ * Return value: The popped task or NULL if there are no tasks to be          *
+ *               processed.                                                   *
+ *                                                                            *
+ * Comments: This function is used by workers to pop tasks for processing.    *
+ *           Tasks are taken from the worker's own queue first, immediate     *
+ *           tasks before normal ones, and then stolen from other workers.    *
+ *           The task queue lock must not be held when calling this function. *
+ *                                                                            *
+ ******************************************************************************/
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int index)
+{
+	zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[index];
+	zbx_pp_task_t		*task;
+
+	pthread_mutex_lock(&wqueue->lock);
+
+	/* while sequence tasks do not affect statistics, the first task in sequence */
+	/* does, so the statistics can be updated for all tasks                      */
+	if (NULL != (task = pp_worker_queue_pop(wqueue)))
+		wqueue->started_num++;
+
+	pthread_mutex_unlock(&wqueue->lock);
+
+	if (NULL == task)
+		task = pp_task_queue_steal(queue, index);
+
+	return task;
 }
 
 /******************************************************************************
@@ -344,14 +508,18 @@ zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
  * Purpose: push finished task into queue                                     *
  *                                                                            *
  * Parameters: queue - [IN] task queue                                        *
+ *             index - [IN] the worker queue index                            *
  *             task  - [IN] task                                              *
  *                                                                            *
  ******************************************************************************/
-void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
+void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, int index, zbx_pp_task_t *task)
 {
-	queue->finished_num++;
-	queue->processing_num--;
-	(void)zbx_list_append(&queue->finished, task, NULL);
+	zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[index];
+
+	pthread_mutex_lock(&wqueue->lock);
+	wqueue->finished_num++;
+	(void)zbx_list_append(&wqueue->finished, task, NULL);
+	pthread_mutex_unlock(&wqueue->lock);
 }
 
 /******************************************************************************
@@ -362,36 +530,85 @@ void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
  *                                                                            *
  * Return value: The popped task or NULL if there are no finished tasks.      *
  *                                                                            *
+ * Comments: The worker queues are checked in round robin order, continuing   *
+ *           from the queue of the last popped task.                          *
+ *                                                                            *
  ******************************************************************************/
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue)
 {
 	zbx_pp_task_t	*task;
 
-	if (SUCCEED == zbx_list_pop(&queue->finished, (void **)&task))
+	for (int i = 0; i < queue->worker_queues_num; i++)
 	{
-		queue->finished_num--;
-		return task;
+		zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[queue->finished_index];
+		int			ret;
+
+		pthread_mutex_lock(&wqueue->lock);
+
+		if (SUCCEED == (ret = zbx_list_pop(&wqueue->finished, (void **)&task)))
+			wqueue->collected_num++;
+
+		pthread_mutex_unlock(&wqueue->lock);
+
+		if (SUCCEED == ret)
+			return task;
+
+		if (++queue->finished_index == queue->worker_queues_num)
+			queue->finished_index = 0;
 	}
 
 	return NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the number of tasks waiting in worker queues                  *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_task_queue_get_tasks_num(zbx_pp_queue_t *queue)
+{
+	int	tasks_num = 0;
+
+	for (int i = 0; i < queue->worker_queues_num; i++)
+	{
+		pthread_mutex_lock(&queue->worker_queues[i].lock);
+		tasks_num += queue->worker_queues[i].tasks_num;
+		pthread_mutex_unlock(&queue->worker_queues[i].lock);
+	}
+
+	return tasks_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: wait for queue notifications                                      *
  *                                                                            *
  * Parameters: queue - [IN] task queue                                        *
+ *             index - [IN] the worker queue index                            *
  *             error - [IN]                                                   *
  *                                                                            *
  * Return value: SUCCEED - the wait succeeded                                 *
  *               FAIL    - an error has occurred                              *
  *                                                                            *
- * Comments: This function is used by workers to wait for new tasks.          *
+ * Comments: This function is used by workers to wait for new tasks. It is    *
+ *           called within task queue lock and returns without waiting if any *
+ *           worker queue has tasks. After waking up another worker is        *
+ *           notified if there are more tasks queued.                         *
  *                                                                            *
  ******************************************************************************/
-int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error)
+int	pp_task_queue_wait(zbx_pp_queue_t *queue, int index, char **error)
 {
-	int	err;
+	zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[index];
+	int			err;
+
+	if (0 != pp_task_queue_get_tasks_num(queue))
+		return SUCCEED;
+
+	pthread_mutex_lock(&wqueue->lock);
+	wqueue->idle_num++;
+	pthread_mutex_unlock(&wqueue->lock);
 
 	if (0 != (err = pthread_cond_wait(&queue->event, &queue->lock)))
 	{
@@ -399,6 +616,9 @@ int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error)
 		return FAIL;
 	}
 
+	if (1 < pp_task_queue_get_tasks_num(queue))
+		pp_task_queue_notify(queue);
+
 	return SUCCEED;
 }
 
@@ -442,6 +662,87 @@ void	pp_task_queue_notify_all(zbx_pp_queue_t *queue)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get task queue statistics                                         *
+ *                                                                            *
+ * Parameters: queue          - [IN] task queue                               *
+ *             pending_num    - [OUT] tasks waiting to be processed           *
+ *             processing_num - [OUT] tasks being processed                   *
+ *             finished_num   - [OUT] finished tasks not yet returned to      *
+ *                                    manager                                 *
+ *                                                                            *
+ * Comments: This function is called within task queue lock.                  *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_get_stats(zbx_pp_queue_t *queue, zbx_uint64_t *pending_num, zbx_uint64_t *processing_num,
+		zbx_uint64_t *finished_num)
+{
+	zbx_uint64_t	started_num = 0, done_num = 0, collected_num = 0;
+
+	for (int i = 0; i < queue->worker_queues_num; i++)
+	{
+		zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[i];
+
+		pthread_mutex_lock(&wqueue->lock);
+		started_num += wqueue->started_num;
+		done_num += wqueue->finished_num;
+		collected_num += wqueue->collected_num;
+		pthread_mutex_unlock(&wqueue->lock);
+	}
+
+	*pending_num = queue->queued_num - started_num;
+	*processing_num = started_num - done_num;
+	*finished_num = done_num - collected_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get worker task stealing, idle and regular expression cache       *
+ *          statistics                                                        *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             stats - [OUT] statistics by worker                             *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_get_worker_stats(zbx_pp_queue_t *queue, zbx_vector_pp_worker_stats_t *stats)
+{
+	for (int i = 0; i < queue->worker_queues_num; i++)
+	{
+		zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[i];
+		zbx_pp_worker_stats_t	stat;
+
+		pthread_mutex_lock(&wqueue->lock);
+		stat.steals_num = wqueue->steals_num;
+		stat.idle_num = wqueue->idle_num;
+		stat.regexp_hits = wqueue->regexp_hits;
+		stat.regexp_misses = wqueue->regexp_misses;
+		pthread_mutex_unlock(&wqueue->lock);
+
+		zbx_vector_pp_worker_stats_append(stats, stat);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: update worker regular expression cache statistics                 *
+ *                                                                            *
+ * Parameters: queue  - [IN] task queue                                       *
+ *             index  - [IN] the worker queue index                           *
+ *             hits   - [IN] the number of cached regular expressions used    *
+ *             misses - [IN] the number of compiled regular expressions       *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_set_regexp_stats(zbx_pp_queue_t *queue, int index, zbx_uint64_t hits, zbx_uint64_t misses)
+{
+	zbx_pp_worker_queue_t	*wqueue = &queue->worker_queues[index];
+
+	pthread_mutex_lock(&wqueue->lock);
+	wqueue->regexp_hits = hits;
+	wqueue->regexp_misses = misses;
+	pthread_mutex_unlock(&wqueue->lock);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get registered task sequence statistics sorted by number of tasks *
@@ -23,26 +23,55 @@
 #include "zbxpreproc.h"
 #include "zbxalgo.h"
 
+/* Worker task queue. New tasks are distributed between worker queues by manager, */
+/* a worker with empty queue steals tasks from the queues of other workers.        */
 typedef struct
 {
-	zbx_uint32_t	init_flags;
-	int		workers_num;
-	zbx_uint64_t	pending_num;
+	zbx_list_t	immediate;
+	zbx_list_t	pending;
+	zbx_list_t	finished;
+
+	/* the number of tasks in immediate and pending lists */
+	int		tasks_num;
+
+	/* the number of tasks started, finished and returned to manager */
+	zbx_uint64_t	started_num;
 	zbx_uint64_t	finished_num;
-	zbx_uint64_t	processing_num;
+	zbx_uint64_t	collected_num;
 
-	zbx_hashset_t	sequences;
+	/* the number of tasks stolen from other workers and the number of times worker went idle */
+	zbx_uint64_t	steals_num;
+	zbx_uint64_t	idle_num;
 
-	zbx_list_t	pending;
-	zbx_list_t	immediate;
-	zbx_list_t	finished;
+	/* the worker thread regular expression cache statistics */
+	zbx_uint64_t	regexp_hits;
+	zbx_uint64_t	regexp_misses;
 
 	pthread_mutex_t	lock;
-	pthread_cond_t	event;
+}
+zbx_pp_worker_queue_t;
+
+typedef struct
+{
+	zbx_uint32_t		init_flags;
+	int			workers_num;
+
+	/* the number of queued tasks, updated only by manager */
+	zbx_uint64_t		queued_num;
+
+	zbx_hashset_t		sequences;
+
+	zbx_pp_worker_queue_t	*worker_queues;
+	int			worker_queues_num;
+	int			push_index;
+	int			finished_index;
+
+	pthread_mutex_t		lock;
+	pthread_cond_t		event;
 }
 zbx_pp_queue_t;
 
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error);
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int workers_num, char **error);
 void	pp_task_queue_destroy(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_lock(zbx_pp_queue_t *queue);
@@ -51,18 +80,22 @@ void	pp_task_queue_register_worker(zbx_pp_queue_t *queue);
 void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue);
 void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid);
 
-int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error);
+int	pp_task_queue_wait(zbx_pp_queue_t *queue, int index, char **error);
 void	pp_task_queue_notify(zbx_pp_queue_t *queue);
 void	pp_task_queue_notify_all(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue);
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int index);
 void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
-void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
+void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, int index, zbx_pp_task_t *task);
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue);
 
+void	pp_task_queue_get_stats(zbx_pp_queue_t *queue, zbx_uint64_t *pending_num, zbx_uint64_t *processing_num,
+		zbx_uint64_t *finished_num);
 void	pp_task_queue_get_sequence_stats(zbx_pp_queue_t *queue, zbx_vector_pp_sequence_stats_ptr_t *stats);
+void	pp_task_queue_get_worker_stats(zbx_pp_queue_t *queue, zbx_vector_pp_worker_stats_t *stats);
+void	pp_task_queue_set_regexp_stats(zbx_pp_queue_t *queue, int index, zbx_uint64_t hits, zbx_uint64_t misses);
 
 #endif
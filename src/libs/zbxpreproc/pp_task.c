@@ -210,6 +210,7 @@ zbx_pp_task_t	*pp_task_dependent_create(zbx_uint64_t itemid, zbx_pp_item_preproc
 
 	d->primary = NULL;
 	d->cache = NULL;
+	zbx_vector_str_create(&d->paths);
 
 	d->preproc = zbx_pp_item_preproc_copy(preproc);
 
@@ -231,6 +232,8 @@ static void	pp_task_dependent_clear(zbx_pp_task_dependent_t *task)
 	if (NULL != task->primary)
 		pp_task_free(task->primary);
 
+	zbx_vector_str_clear_ext(&task->paths, zbx_str_free);
+	zbx_vector_str_destroy(&task->paths);
 }
 
 /******************************************************************************
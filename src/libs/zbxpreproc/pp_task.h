@@ -65,6 +65,7 @@ typedef struct
 	zbx_pp_item_preproc_t	*preproc;
 	zbx_pp_task_t		*primary;
 	zbx_pp_cache_t		*cache;
+	zbx_vector_str_t	paths;		/* first step jsonpaths of other dependent items */
 }
 zbx_pp_task_dependent_t;
 
@@ -69,6 +69,9 @@ static void	pp_task_process_dependent(zbx_pp_context_t *ctx, zbx_pp_task_t *task
 
 	pp_execute(ctx, d_first->preproc, d->cache, d_first->um_handle, &d_first->value, d_first->ts, config_source_ip,
 			&d_first->result, NULL, NULL);
+
+	if (0 != d->paths.values_num)
+		pp_execute_jsonpaths(ctx, d->cache, d_first->um_handle, d_first->preproc->hostid, &d->paths);
 }
 
 /******************************************************************************
@@ -99,6 +102,30 @@ static	void	pp_task_process_sequence(zbx_pp_context_t *ctx, zbx_pp_task_t *task_
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: publish worker thread regular expression cache statistics         *
+ *                                                                            *
+ * Parameters: worker - [IN] the preprocessing worker                         *
+ *             hits   - [IN/OUT] the last published cache hits                *
+ *             misses - [IN/OUT] the last published cache misses              *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_worker_update_regexp_stats(zbx_pp_worker_t *worker, zbx_uint64_t *hits, zbx_uint64_t *misses)
+{
+	zbx_uint64_t	regexp_hits, regexp_misses;
+
+	zbx_regexp_cache_get_stats(&regexp_hits, &regexp_misses);
+
+	if (regexp_hits == *hits && regexp_misses == *misses)
+		return;
+
+	pp_task_queue_set_regexp_stats(worker->queue, worker->id - 1, regexp_hits, regexp_misses);
+
+	*hits = regexp_hits;
+	*misses = regexp_misses;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: preprocessing worker thread entry                                 *
@@ -112,6 +139,7 @@ static void	*pp_worker_entry(void *args)
 	char			*error = NULL, component[MAX_ID_LEN + 1];
 	sigset_t		mask;
 	int			err;
+	zbx_uint64_t		regexp_hits = 0, regexp_misses = 0;
 
 	zbx_snprintf(component, sizeof(component), "%d", worker->id);
 	zbx_set_log_component(component, &worker->logger);
@@ -140,10 +168,10 @@ static void	*pp_worker_entry(void *args)
 
 	while (0 == worker->stop)
 	{
-		if (NULL != (in = pp_task_queue_pop_new(queue)))
-		{
-			pp_task_queue_unlock(queue);
+		pp_task_queue_unlock(queue);
 
+		while (0 == worker->stop && NULL != (in = pp_task_queue_pop_new(queue, worker->id - 1)))
+		{
 			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
 
 			zabbix_log(LOG_LEVEL_TRACE, "%s() process task type:%u itemid:" ZBX_FS_UI64, __func__,
@@ -168,24 +196,24 @@ static void	*pp_worker_entry(void *args)
 
 			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_IDLE);
 
-			pp_task_queue_lock(queue);
-			pp_task_queue_push_finished(queue, in);
+			pp_worker_update_regexp_stats(worker, &regexp_hits, &regexp_misses);
+			pp_task_queue_push_finished(queue, worker->id - 1, in);
 
 			if (NULL != worker->finished_cb)
 				worker->finished_cb(worker->finished_data);
-
-			continue;
 		}
 
-		if (SUCCEED != pp_task_queue_wait(queue, &error))
+		pp_task_queue_lock(queue);
+
+		if (0 != worker->stop)
+			break;
+
+		if (SUCCEED != pp_task_queue_wait(queue, worker->id - 1, &error))
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
 			zbx_free(error);
 			worker->stop = 1;
 		}
-
-		if (1 < queue->pending_num)
-			pp_task_queue_notify(queue);
 	}
 
 	pp_task_queue_deregister_worker(queue);
@@ -262,43 +262,275 @@ int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp, int flags
 	return regexp_compile(pattern, flags, regexp, err_msg);
 }
 
+/* the maximum number of compiled regular expressions cached by thread */
+#define REGEXP_CACHE_SIZE	256
+
+typedef struct zbx_regexp_cache_entry zbx_regexp_cache_entry_t;
+
+struct zbx_regexp_cache_entry
+{
+	char				*pattern;
+	int				flags;
+	zbx_regexp_t			*regexp;
+	char				*error;		/* set if the pattern compilation failed */
+
+	zbx_regexp_cache_entry_t	*prev;
+	zbx_regexp_cache_entry_t	*next;
+};
+
+typedef struct
+{
+	zbx_hashset_t			entries;
+
+	/* entries ordered by last use, the most recently used first */
+	zbx_regexp_cache_entry_t	*head;
+	zbx_regexp_cache_entry_t	*tail;
+
+	zbx_uint64_t			hits;
+	zbx_uint64_t			misses;
+}
+zbx_regexp_cache_t;
+
+static ZBX_THREAD_LOCAL zbx_regexp_cache_t	*regexp_cache = NULL;
+
+static zbx_hash_t	regexp_cache_entry_hash(const void *d)
+{
+	const zbx_regexp_cache_entry_t	*entry = (const zbx_regexp_cache_entry_t *)d;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(entry->pattern, strlen(entry->pattern), ZBX_DEFAULT_HASH_SEED);
+
+	return ZBX_DEFAULT_HASH_ALGO(&entry->flags, sizeof(entry->flags), hash);
+}
+
+static int	regexp_cache_entry_compare(const void *d1, const void *d2)
+{
+	const zbx_regexp_cache_entry_t	*entry1 = (const zbx_regexp_cache_entry_t *)d1;
+	const zbx_regexp_cache_entry_t	*entry2 = (const zbx_regexp_cache_entry_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(entry1->flags, entry2->flags);
+
+	return strcmp(entry1->pattern, entry2->pattern);
+}
+
+static void	regexp_cache_entry_clear(void *d)
+{
+	zbx_regexp_cache_entry_t	*entry = (zbx_regexp_cache_entry_t *)d;
+
+	zbx_free(entry->pattern);
+
+	if (NULL != entry->regexp)
+		zbx_regexp_free(entry->regexp);
+
+	zbx_free(entry->error);
+}
+
+static void	regexp_cache_unlink(zbx_regexp_cache_entry_t *entry)
+{
+	if (NULL != entry->prev)
+		entry->prev->next = entry->next;
+	else
+		regexp_cache->head = entry->next;
+
+	if (NULL != entry->next)
+		entry->next->prev = entry->prev;
+	else
+		regexp_cache->tail = entry->prev;
+}
+
+static void	regexp_cache_link(zbx_regexp_cache_entry_t *entry)
+{
+	entry->prev = NULL;
+
+	if (NULL != (entry->next = regexp_cache->head))
+		entry->next->prev = entry;
+	else
+		regexp_cache->tail = entry;
+
+	regexp_cache->head = entry;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compile regular expression to machine code if PCRE JIT is         *
+ *          available                                                         *
+ *                                                                            *
+ * Comments: JIT compilation is more expensive than the pattern compilation,  *
+ *           so it is done only for cached regular expressions. Patterns the  *
+ *           JIT cannot handle are executed by the interpreter.               *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_jit_compile(zbx_regexp_t *regexp)
+{
+#if defined(HAVE_PCRE_H) && defined(PCRE_STUDY_JIT_COMPILE)
+	const char		*err_msg_static = NULL;
+	struct pcre_extra	*extra;
+
+	if (NULL != (extra = pcre_study(regexp->pcre_regexp, PCRE_STUDY_JIT_COMPILE, &err_msg_static)))
+	{
+		pcre_free_study(regexp->extra);
+		regexp->extra = extra;
+	}
+#endif
+#ifdef HAVE_PCRE2_H
+	(void)pcre2_jit_compile(regexp->pcre2_regexp, PCRE2_JIT_COMPLETE);
+#endif
+}
+
 /****************************************************************************************************
  *                                                                                                  *
- * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the last used regexp.                 *
+ * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the recently used regexps.            *
+ *                                                                                                  *
+ * Comments: The returned regexp is owned by the thread cache. It stays valid until                 *
+ *           REGEXP_CACHE_SIZE other patterns are prepared by the same thread.                      *
  *                                                                                                  *
  ****************************************************************************************************/
 static int	regexp_prepare(const char *pattern, int flags, zbx_regexp_t **regexp, char **err_msg)
 {
-	static ZBX_THREAD_LOCAL zbx_regexp_t	*curr_regexp = NULL;
-	static ZBX_THREAD_LOCAL char		*curr_pattern = NULL;
-	static ZBX_THREAD_LOCAL int		curr_flags = 0;
-	int					ret = SUCCEED;
+	zbx_regexp_cache_entry_t	*entry, entry_local;
+
+	if (NULL == regexp_cache)
+	{
+		regexp_cache = (zbx_regexp_cache_t *)zbx_malloc(NULL, sizeof(zbx_regexp_cache_t));
+		zbx_hashset_create_ext(&regexp_cache->entries, 0, regexp_cache_entry_hash, regexp_cache_entry_compare,
+				regexp_cache_entry_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+				ZBX_DEFAULT_MEM_FREE_FUNC);
+		regexp_cache->head = NULL;
+		regexp_cache->tail = NULL;
+		regexp_cache->hits = 0;
+		regexp_cache->misses = 0;
+	}
 
-	if (NULL == curr_regexp || 0 != strcmp(curr_pattern, pattern) || curr_flags != flags)
+	entry_local.pattern = (char *)pattern;
+	entry_local.flags = flags;
+
+	if (NULL != (entry = (zbx_regexp_cache_entry_t *)zbx_hashset_search(&regexp_cache->entries, &entry_local)))
 	{
-		if (NULL != curr_regexp)
+		regexp_cache->hits++;
+
+		if (entry != regexp_cache->head)
 		{
-			zbx_regexp_free(curr_regexp);
-			zbx_free(curr_pattern);
+			regexp_cache_unlink(entry);
+			regexp_cache_link(entry);
 		}
+	}
+	else
+	{
+		regexp_cache->misses++;
 
-		curr_regexp = NULL;
-		curr_pattern = NULL;
-		curr_flags = 0;
-
-		if (SUCCEED == regexp_compile(pattern, flags, &curr_regexp, err_msg))
+		if (REGEXP_CACHE_SIZE <= regexp_cache->entries.num_data)
 		{
-			curr_pattern = zbx_strdup(curr_pattern, pattern);
-			curr_flags = flags;
+			entry = regexp_cache->tail;
+			regexp_cache_unlink(entry);
+			zbx_hashset_remove_direct(&regexp_cache->entries, entry);
 		}
-		else
-			ret = FAIL;
+
+		entry_local.regexp = NULL;
+		entry_local.error = NULL;
+
+		if (SUCCEED == regexp_compile(pattern, flags, &entry_local.regexp, &entry_local.error))
+			regexp_jit_compile(entry_local.regexp);
+		else if (NULL == entry_local.error)
+			entry_local.error = zbx_strdup(NULL, "cannot compile regular expression");
+
+		entry_local.pattern = zbx_strdup(NULL, pattern);
+
+		entry = (zbx_regexp_cache_entry_t *)zbx_hashset_insert(&regexp_cache->entries, &entry_local,
+				sizeof(entry_local));
+		regexp_cache_link(entry);
 	}
 
-	*regexp = curr_regexp;
+	if (NULL == entry->regexp)
+	{
+		if (NULL != err_msg)
+			*err_msg = zbx_strdup(*err_msg, entry->error);
+
+		return FAIL;
+	}
+
+	*regexp = entry->regexp;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled regular expression with default options from thread  *
+ *          cache, compiling it if needed                                     *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     pattern   - [IN] regular expression as a text string                   *
+ *     regexp    - [OUT] compiled regular expression, owned by the cache      *
+ *     err_msg   - [OUT] error message if any                                 *
+ *                                                                            *
+ * Return value: SUCCEED or FAIL                                              *
+ *                                                                            *
+ * Comments: Use instead of zbx_regexp_compile() when the same patterns are   *
+ *           matched repeatedly. The regular expression must not be freed, it *
+ *           stays valid until many other patterns are compiled by the same   *
+ *           thread.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_regexp_compile_cached(const char *pattern, const zbx_regexp_t **regexp, char **err_msg)
+{
+	zbx_regexp_t	*cached;
+	int		ret;
+
+#ifdef ZBX_REGEXP_NO_AUTO_CAPTURE
+	ret = regexp_prepare(pattern, ZBX_REGEXP_MULTILINE | ZBX_REGEXP_NO_AUTO_CAPTURE, &cached, err_msg);
+#else
+	ret = regexp_prepare(pattern, ZBX_REGEXP_MULTILINE, &cached, err_msg);
+#endif
+	if (SUCCEED == ret)
+		*regexp = cached;
+
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled regular expression with the specified compilation    *
+ *          parameters from thread cache, compiling it if needed              *
+ *                                                                            *
+ * Comments: See zbx_regexp_compile_cached() and zbx_regexp_compile_ext().    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_regexp_compile_cached_ext(const char *pattern, const zbx_regexp_t **regexp, int flags, char **err_msg)
+{
+	zbx_regexp_t	*cached;
+
+	if (SUCCEED != regexp_prepare(pattern, flags, &cached, err_msg))
+		return FAIL;
+
+	*regexp = cached;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled regular expression cache statistics of the calling   *
+ *          thread                                                            *
+ *                                                                            *
+ * Parameters: hits   - [OUT] the number of patterns found in cache           *
+ *             misses - [OUT] the number of compiled patterns                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_regexp_cache_get_stats(zbx_uint64_t *hits, zbx_uint64_t *misses)
+{
+	if (NULL == regexp_cache)
+	{
+		*hits = 0;
+		*misses = 0;
+		return;
+	}
+
+	*hits = regexp_cache->hits;
+	*misses = regexp_cache->misses;
+}
+
+#undef REGEXP_CACHE_SIZE
+
 /* calculate recursion limit, PCRE man page suggests to reckon on about 500 bytes per recursion */
 /* but to be on the safe side - reckon on 800 bytes and do not set limit higher than 100000 */
 #define REGEXP_RECURSION_STEP	800
@@ -446,14 +678,24 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 #undef MATCHES_BUFF_SIZE
 #endif
 #ifdef HAVE_PCRE2_H
-	int			result, r, i;
-	pcre2_match_data	*match_data = NULL;
-	PCRE2_SIZE		*ovector = NULL;
+	/* match data is reused by the thread, it is reallocated only for larger number of groups */
+	static ZBX_THREAD_LOCAL pcre2_match_data	*match_data = NULL;
+	static ZBX_THREAD_LOCAL int			match_data_size = 0;
+	int						result, r, i;
+	PCRE2_SIZE					*ovector = NULL;
 
 	pcre2_set_match_limit(regexp->match_ctx, 1000000);
 
 	pcre2_set_recursion_limit(regexp->match_ctx, (uint32_t)compute_recursion_limit());
-	match_data = pcre2_match_data_create((uint32_t)count, NULL);
+
+	if (match_data_size < count || NULL == match_data)
+	{
+		if (NULL != match_data)
+			pcre2_match_data_free(match_data);
+
+		match_data_size = MAX(count, ZBX_REGEXP_GROUPS_MAX);
+		match_data = pcre2_match_data_create((uint32_t)match_data_size, NULL);
+	}
 
 	if (NULL == match_data)
 	{
@@ -465,9 +707,17 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 #ifdef PCRE2_MATCH_INVALID_UTF
 		flags |= PCRE2_NO_UTF_CHECK;
 #endif
+		r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0, flags, match_data,
+				regexp->match_ctx);
 
-		if (0 <= (r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0, flags,
-			match_data, regexp->match_ctx)))
+		/* JIT stack is much smaller than the interpreter heap, retry patterns exhausting it without JIT */
+		if (PCRE2_ERROR_JIT_STACKLIMIT == r)
+		{
+			r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0,
+					flags | PCRE2_NO_JIT, match_data, regexp->match_ctx);
+		}
+
+		if (0 <= r)
 		{
 			if (NULL != matches)
 			{
@@ -496,8 +746,6 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 
 			result = FAIL;
 		}
-
-		pcre2_match_data_free(match_data);
 	}
 
 	return result;
@@ -1594,6 +1842,847 @@ out:
 
 	return ret;
 }
+/* Regular expression literals are used to prefilter strings only when the string cannot cause a matching error */
+/* the literal check would hide, which requires PCRE2 support for matching invalid UTF subject strings.        */
+#if defined(HAVE_PCRE_H) || defined(PCRE2_MATCH_INVALID_UTF)
+#	define ZBX_REGEXP_SET_PREFILTER
+#endif
+
+typedef struct
+{
+	char	*data;
+	size_t	len;
+	int	case_sensitive;
+	int	next;		/* next literal ending in the same automaton state or -1 */
+}
+zbx_regexp_set_literal_t;
+
+typedef struct
+{
+	char	*expression;
+	int	type;
+	int	case_sensitive;
+	char	delimiter;
+	int	literal_first;	/* substrings or required regular expression literal */
+	int	literal_num;
+	int	literal_only;	/* regular expression matches when its literal is found */
+	int	validated;	/* regular expression compilation was checked */
+}
+zbx_regexp_set_expression_t;
+
+struct zbx_regexp_set
+{
+	zbx_regexp_set_expression_t	*expressions;
+	int				expressions_num;
+	int				match_all;
+
+	zbx_regexp_set_literal_t	*literals;
+	int				literals_num;
+
+	/* Aho-Corasick automaton over case folded bytes, folded bytes are mapped to classes */
+	/* used by the literals to keep the transition table small                         */
+	unsigned char			classes[256];
+	int				classes_num;
+	int				*trans;
+	int				*output;	/* first literal ending in the state or -1 */
+	int				*dict;		/* closest suffix state with output, 0 if none */
+
+	/* literals found in the current string */
+	unsigned char			*found;
+	int				found_num;
+	int				scanned;
+};
+
+static unsigned char	regexp_fold(unsigned char c)
+{
+	return ('A' <= c && 'Z' >= c) ? (unsigned char)(c + 'a' - 'A') : c;
+}
+
+static int	regexp_is_alnum(unsigned char c)
+{
+	return ('0' <= c && '9' >= c) || ('a' <= c && 'z' >= c) || ('A' <= c && 'Z' >= c);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips character class                                             *
+ *                                                                            *
+ * Parameters: p - [IN] pointer to the opening '['                            *
+ *                                                                            *
+ * Return value: pointer after the closing ']' or NULL if it was not found    *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*regexp_skip_class(const char *p)
+{
+	const char	*end;
+
+	if ('^' == *(++p))
+		p++;
+
+	if (']' == *p)
+		p++;
+
+	while ('\0' != *p)
+	{
+		switch (*p)
+		{
+			case '\\':
+				if ('\0' == *(++p))
+					return NULL;
+				p++;
+				break;
+			case '[':
+				if (':' == p[1] && NULL != (end = strstr(p + 2, ":]")))
+					p = end + 2;
+				else
+					p++;
+				break;
+			case ']':
+				return p + 1;
+			default:
+				p++;
+		}
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips group with nested groups                                    *
+ *                                                                            *
+ * Parameters: p - [IN] pointer to the opening '('                            *
+ *                                                                            *
+ * Return value: pointer after the closing ')' or NULL if it was not found    *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*regexp_skip_group(const char *p)
+{
+	int	depth = 1;
+
+	for (p++; '\0' != *p;)
+	{
+		switch (*p)
+		{
+			case '\\':
+				if ('\0' == *(++p))
+					return NULL;
+				p++;
+				break;
+			case '[':
+				if (NULL == (p = regexp_skip_class(p)))
+					return NULL;
+				break;
+			case '(':
+				depth++;
+				p++;
+				break;
+			case ')':
+				p++;
+				if (0 == --depth)
+					return p;
+				break;
+			default:
+				p++;
+		}
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the longest literal every match of regular expression must  *
+ *          contain                                                           *
+ *                                                                            *
+ * Parameters: pattern        - [IN] regular expression                       *
+ *             case_sensitive - [IN] ZBX_IGNORE_CASE or ZBX_CASE_SENSITIVE    *
+ *             literal        - [OUT] required literal                        *
+ *             whole          - [OUT] 1 if the regular expression consists of *
+ *                                    the literal only, 0 otherwise           *
+ *                                                                            *
+ * Return value: SUCCEED - a non empty literal was found                      *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The parsing is conservative - alternatives, option settings and  *
+ *           anything not understood disable the literal. Groups, classes and *
+ *           escape sequences only terminate the literal being collected.     *
+ *           Caseless literals exclude non ASCII characters and the letters   *
+ *           UTF case folding can pair with non ASCII characters.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_required_literal(const char *pattern, int case_sensitive, char **literal, int *whole)
+{
+	const char	*p = pattern;
+	char		*run, *best;
+	size_t		run_len = 0, best_len = 0, atom_len = 0, len, i;
+	int		ret = FAIL;
+
+	*whole = 0;
+
+	if (NULL != strstr(pattern, "(?") || NULL != strstr(pattern, "(*") || NULL != strstr(pattern, "\\Q"))
+		return FAIL;
+
+	len = strlen(pattern);
+	run = (char *)zbx_malloc(NULL, len + 1);
+	best = (char *)zbx_malloc(NULL, len + 1);
+	*whole = 1;
+
+#define REGEXP_LITERAL_FLUSH()					\
+	do							\
+	{							\
+		if (run_len > best_len)				\
+		{						\
+			memcpy(best, run, run_len);		\
+			best_len = run_len;			\
+		}						\
+		run_len = atom_len = 0;				\
+	}							\
+	while (0)
+
+	while ('\0' != *p)
+	{
+		unsigned char	c = (unsigned char)*p;
+
+		switch (c)
+		{
+			case '\\':
+				c = (unsigned char)p[1];
+
+				if (0x80 > c && 0 == regexp_is_alnum(c))
+				{
+					if ('\0' == c)
+						goto out;
+
+					/* escaped punctuation stands for itself */
+					run[run_len++] = (char)c;
+					atom_len = 1;
+					p += 2;
+					break;
+				}
+
+				/* character types, references and coded characters, skip their arguments */
+				REGEXP_LITERAL_FLUSH();
+				*whole = 0;
+
+				for (p += 2; '\0' != *p && (0 != regexp_is_alnum((unsigned char)*p) ||
+						NULL != strchr("{}<>'+-_", *p)); p++)
+					;
+				break;
+			case '|':
+			case ')':
+				goto out;
+			case '[':
+				REGEXP_LITERAL_FLUSH();
+				*whole = 0;
+
+				if (NULL == (p = regexp_skip_class(p)))
+					goto out;
+				break;
+			case '(':
+				REGEXP_LITERAL_FLUSH();
+				*whole = 0;
+
+				if (NULL == (p = regexp_skip_group(p)))
+					goto out;
+				break;
+			case '.':
+			case '^':
+			case '$':
+				REGEXP_LITERAL_FLUSH();
+				*whole = 0;
+				p++;
+				break;
+			case '*':
+			case '?':
+			case '{':
+				/* the quantified atom is optional */
+				run_len -= atom_len;
+				REGEXP_LITERAL_FLUSH();
+				*whole = 0;
+
+				if ('{' == *p++)
+				{
+					while (('0' <= *p && '9' >= *p) || ',' == *p)
+						p++;
+
+					if ('}' == *p)
+						p++;
+				}
+				break;
+			case '+':
+				/* the quantified atom is present at least once */
+				REGEXP_LITERAL_FLUSH();
+				*whole = 0;
+				p++;
+				break;
+			default:
+				if (0x80 > c)
+				{
+					if (ZBX_CASE_SENSITIVE != case_sensitive && ('k' == regexp_fold(c) ||
+							's' == regexp_fold(c)))
+					{
+						/* Kelvin sign and long s are caseless equivalents in UTF mode */
+						REGEXP_LITERAL_FLUSH();
+						*whole = 0;
+					}
+					else
+					{
+						run[run_len++] = (char)c;
+						atom_len = 1;
+					}
+
+					p++;
+					break;
+				}
+
+				if (0 == (len = zbx_utf8_char_len(p)))
+					goto out;
+
+				for (i = 1; i < len; i++)
+				{
+					if (0x80 != ((unsigned char)p[i] & 0xc0))
+						goto out;
+				}
+
+				if (ZBX_CASE_SENSITIVE != case_sensitive)
+				{
+					REGEXP_LITERAL_FLUSH();
+					*whole = 0;
+				}
+				else
+				{
+					memcpy(run + run_len, p, len);
+					run_len += len;
+					atom_len = len;
+				}
+
+				p += len;
+		}
+	}
+
+	REGEXP_LITERAL_FLUSH();
+
+	if (0 != best_len)
+	{
+		best[best_len] = '\0';
+		*literal = best;
+		best = NULL;
+		ret = SUCCEED;
+	}
+out:
+#undef REGEXP_LITERAL_FLUSH
+	if (SUCCEED != ret)
+		*whole = 0;
+
+	zbx_free(run);
+	zbx_free(best);
+
+	return ret;
+}
+
+static int	regexp_set_add_literal(zbx_regexp_set_t *set, const char *data, size_t len, int case_sensitive)
+{
+	zbx_regexp_set_literal_t	*literal;
+
+	set->literals = (zbx_regexp_set_literal_t *)zbx_realloc(set->literals,
+			sizeof(zbx_regexp_set_literal_t) * (size_t)(set->literals_num + 1));
+
+	literal = &set->literals[set->literals_num];
+	literal->data = (char *)zbx_malloc(NULL, len + 1);
+	memcpy(literal->data, data, len);
+	literal->data[len] = '\0';
+	literal->len = len;
+	literal->case_sensitive = case_sensitive;
+	literal->next = -1;
+
+	return set->literals_num++;
+}
+
+static void	regexp_set_add_expression(zbx_regexp_set_t *set, const char *expression, int type, int case_sensitive,
+		char delimiter)
+{
+	zbx_regexp_set_expression_t	*expr;
+	const char			*s, *c;
+
+	set->expressions = (zbx_regexp_set_expression_t *)zbx_realloc(set->expressions,
+			sizeof(zbx_regexp_set_expression_t) * (size_t)(set->expressions_num + 1));
+
+	expr = &set->expressions[set->expressions_num++];
+	expr->expression = zbx_strdup(NULL, expression);
+	expr->type = type;
+	expr->case_sensitive = case_sensitive;
+	expr->delimiter = delimiter;
+	expr->literal_first = set->literals_num;
+	expr->literal_num = 0;
+	expr->literal_only = 0;
+	expr->validated = 0;
+
+	switch (type)
+	{
+		case EXPRESSION_TYPE_INCLUDED:
+		case EXPRESSION_TYPE_NOT_INCLUDED:
+			regexp_set_add_literal(set, expression, strlen(expression), case_sensitive);
+			expr->literal_num = 1;
+			break;
+		case EXPRESSION_TYPE_ANY_INCLUDED:
+			/* split the same way as regexp_match_ex_substring_list() does */
+			for (s = expression; '\0' != *s; s = c + 1)
+			{
+				if (NULL == (c = strchr(s, delimiter)))
+					c = s + strlen(s);
+
+				regexp_set_add_literal(set, s, (size_t)(c - s), case_sensitive);
+				expr->literal_num++;
+
+				if ('\0' == *c)
+					break;
+			}
+			break;
+#ifdef ZBX_REGEXP_SET_PREFILTER
+		case EXPRESSION_TYPE_TRUE:
+		case EXPRESSION_TYPE_FALSE:
+		{
+			char	*literal;
+
+			if (SUCCEED == regexp_required_literal(expression, case_sensitive, &literal,
+					&expr->literal_only))
+			{
+				regexp_set_add_literal(set, literal, strlen(literal), case_sensitive);
+				expr->literal_num = 1;
+				zbx_free(literal);
+			}
+			break;
+		}
+#endif
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: builds Aho-Corasick automaton of the non empty set literals       *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_set_build_automaton(zbx_regexp_set_t *set)
+{
+	int	i, states_num = 1, *fail, *queue, head = 0, tail = 0;
+	size_t	j, total_len = 0;
+
+	memset(set->classes, 0, sizeof(set->classes));
+	set->classes_num = 1;
+
+	for (i = 0; i < set->literals_num; i++)
+	{
+		const zbx_regexp_set_literal_t	*literal = &set->literals[i];
+
+		for (j = 0; j < literal->len; j++)
+		{
+			unsigned char	c = regexp_fold((unsigned char)literal->data[j]);
+
+			if (0 == set->classes[c])
+				set->classes[c] = (unsigned char)set->classes_num++;
+		}
+
+		total_len += literal->len;
+	}
+
+	for (i = 'A'; i <= 'Z'; i++)
+		set->classes[i] = set->classes[regexp_fold((unsigned char)i)];
+
+	set->trans = (int *)zbx_malloc(NULL, sizeof(int) * (total_len + 1) * (size_t)set->classes_num);
+	set->output = (int *)zbx_malloc(NULL, sizeof(int) * (total_len + 1));
+	set->dict = (int *)zbx_malloc(NULL, sizeof(int) * (total_len + 1));
+	fail = (int *)zbx_malloc(NULL, sizeof(int) * (total_len + 1));
+	queue = (int *)zbx_malloc(NULL, sizeof(int) * (total_len + 1));
+
+	memset(set->trans, -1, sizeof(int) * (size_t)set->classes_num);
+	set->output[0] = -1;
+	set->dict[0] = 0;
+
+	/* build trie */
+	for (i = 0; i < set->literals_num; i++)
+	{
+		zbx_regexp_set_literal_t	*literal = &set->literals[i];
+		int				state = 0, *next;
+
+		if (0 == literal->len)
+			continue;
+
+		for (j = 0; j < literal->len; j++)
+		{
+			next = &set->trans[state * set->classes_num + set->classes[(unsigned char)literal->data[j]]];
+
+			if (-1 == *next)
+			{
+				*next = states_num;
+				memset(&set->trans[states_num * set->classes_num], -1, sizeof(int) *
+						(size_t)set->classes_num);
+				set->output[states_num] = -1;
+				states_num++;
+			}
+
+			state = *next;
+		}
+
+		literal->next = set->output[state];
+		set->output[state] = i;
+	}
+
+	/* breadth first failure links, missing transitions are replaced with failure transitions */
+	for (i = 0; i < set->classes_num; i++)
+	{
+		int	state = set->trans[i];
+
+		if (-1 == state)
+		{
+			set->trans[i] = 0;
+			continue;
+		}
+
+		fail[state] = 0;
+		set->dict[state] = 0;
+		queue[tail++] = state;
+	}
+
+	while (head < tail)
+	{
+		int	state = queue[head++];
+
+		for (i = 0; i < set->classes_num; i++)
+		{
+			int	*next = &set->trans[state * set->classes_num + i], f;
+
+			f = set->trans[fail[state] * set->classes_num + i];
+
+			if (-1 == *next)
+			{
+				*next = f;
+				continue;
+			}
+
+			fail[*next] = f;
+			set->dict[*next] = (-1 != set->output[f] ? f : set->dict[f]);
+			queue[tail++] = *next;
+		}
+	}
+
+	zbx_free(queue);
+	zbx_free(fail);
+
+	set->found = (unsigned char *)zbx_malloc(NULL, (size_t)set->literals_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds which set literals the string contains in single pass       *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_set_scan(zbx_regexp_set_t *set, const char *string)
+{
+	const unsigned char	*p;
+	int			i, state = 0, n, l;
+
+	set->found_num = 0;
+
+	for (i = 0; i < set->literals_num; i++)
+	{
+		if (0 == set->literals[i].len)
+		{
+			set->found[i] = 1;
+			set->found_num++;
+		}
+		else
+			set->found[i] = 0;
+	}
+
+	for (p = (const unsigned char *)string; '\0' != *p && set->found_num != set->literals_num; p++)
+	{
+		state = set->trans[state * set->classes_num + set->classes[*p]];
+
+		for (n = (-1 != set->output[state] ? state : set->dict[state]); 0 != n; n = set->dict[n])
+		{
+			for (l = set->output[n]; -1 != l; l = set->literals[l].next)
+			{
+				const zbx_regexp_set_literal_t	*literal = &set->literals[l];
+
+				if (0 != set->found[l])
+					continue;
+
+				if (ZBX_CASE_SENSITIVE == literal->case_sensitive &&
+						0 != memcmp(p + 1 - literal->len, literal->data, literal->len))
+				{
+					continue;
+				}
+
+				set->found[l] = 1;
+				set->found_num++;
+			}
+		}
+	}
+
+	set->scanned = 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the string contains any literal of expression           *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_set_literal_found(zbx_regexp_set_t *set, const zbx_regexp_set_expression_t *expr,
+		const char *string)
+{
+	int	i;
+
+	if (0 == set->scanned)
+	{
+		if (1 == set->literals_num && ZBX_CASE_SENSITIVE == set->literals[0].case_sensitive)
+			return NULL != strstr(string, set->literals[0].data) ? SUCCEED : FAIL;
+
+		regexp_set_scan(set, string);
+	}
+
+	for (i = expr->literal_first; i < expr->literal_first + expr->literal_num; i++)
+	{
+		if (0 != set->found[i])
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles regular expression or global regular expression into     *
+ *          matcher testing all its expressions in single string scan         *
+ *                                                                            *
+ * Parameters: regexps        - [IN] global regular expression array          *
+ *             pattern        - [IN] regular expression or global regular     *
+ *                                   expression name (@<global regexp name>)  *
+ *             case_sensitive - [IN] ZBX_IGNORE_CASE or ZBX_CASE_SENSITIVE    *
+ *                                   for regular expression pattern           *
+ *                                                                            *
+ * Return value: the matcher, must be freed with zbx_regexp_set_free()        *
+ *                                                                            *
+ * Comments: Substrings and the literals required by regular expressions are  *
+ *           searched with one automaton. Regular expressions are executed    *
+ *           with PCRE only for strings containing their required literal.    *
+ *           Regular expression errors are reported when the expression is    *
+ *           reached, like zbx_regexp_sub_ex2() does.                         *
+ *                                                                            *
+ ******************************************************************************/
+zbx_regexp_set_t	*zbx_regexp_set_create(const zbx_vector_expression_t *regexps, const char *pattern,
+		int case_sensitive)
+{
+	zbx_regexp_set_t	*set;
+	int			i;
+
+	set = (zbx_regexp_set_t *)zbx_malloc(NULL, sizeof(zbx_regexp_set_t));
+	memset(set, 0, sizeof(zbx_regexp_set_t));
+
+	if (NULL == pattern || '\0' == *pattern)
+	{
+		set->match_all = 1;
+	}
+	else if ('@' != *pattern)
+	{
+		regexp_set_add_expression(set, pattern, EXPRESSION_TYPE_TRUE, case_sensitive, '\0');
+	}
+	else
+	{
+		for (i = 0; i < regexps->values_num; i++)
+		{
+			const zbx_expression_t	*regexp = regexps->values[i];
+
+			if (0 == strcmp(regexp->name, pattern + 1))
+			{
+				regexp_set_add_expression(set, regexp->expression, regexp->expression_type,
+						regexp->case_sensitive, regexp->exp_delimiter);
+			}
+		}
+	}
+
+	if (0 != set->literals_num)
+		regexp_set_build_automaton(set);
+
+	return set;
+}
+
+void	zbx_regexp_set_free(zbx_regexp_set_t *set)
+{
+	int	i;
+
+	for (i = 0; i < set->expressions_num; i++)
+		zbx_free(set->expressions[i].expression);
+
+	for (i = 0; i < set->literals_num; i++)
+		zbx_free(set->literals[i].data);
+
+	zbx_free(set->expressions);
+	zbx_free(set->literals);
+	zbx_free(set->trans);
+	zbx_free(set->output);
+	zbx_free(set->dict);
+	zbx_free(set->found);
+	zbx_free(set);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates regular expression of the set                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	regexp_set_match_regexp(zbx_regexp_set_t *set, zbx_regexp_set_expression_t *expr,
+		const char *string, const char *output_template, char **output, char **err_msg)
+{
+	/* the first evaluation reports compilation errors even if the literal is missing */
+	if (0 == expr->validated)
+	{
+		int	ret;
+
+		if (ZBX_REGEXP_COMPILE_FAIL != (ret = regexp_match_ex_regsub2(string, expr->expression,
+				expr->case_sensitive, output_template, output, err_msg)))
+		{
+			expr->validated = 1;
+		}
+
+		return ret;
+	}
+
+	if (0 != expr->literal_num)
+	{
+		if (SUCCEED != regexp_set_literal_found(set, expr, string))
+			return ZBX_REGEXP_NO_MATCH;
+
+		if (0 != expr->literal_only && NULL == output)
+			return ZBX_REGEXP_MATCH;
+	}
+
+	return regexp_match_ex_regsub2(string, expr->expression, expr->case_sensitive, output_template, output,
+			err_msg);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: tests if the string matches the compiled regular expression set   *
+ *          and allocates output variable to store the result if necessary    *
+ *                                                                            *
+ * Parameters: set             - [IN] the regular expression set              *
+ *             string          - [IN] the string to check                     *
+ *             output_template - [IN] the output string template, see         *
+ *                                    zbx_regexp_sub_ex2()                    *
+ *             output          - [OUT] the output value, can be NULL          *
+ *             err_msg         - [OUT] dynamically allocated error message    *
+ *                                                                            *
+ * Return value: the same as zbx_regexp_sub_ex2() returns for the pattern the *
+ *               set was created from                                         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_regexp_set_sub(zbx_regexp_set_t *set, const char *string, const char *output_template, char **output,
+		char **err_msg)
+{
+	int	i, ret = ZBX_REGEXP_NO_MATCH;
+	char	*output_accu = NULL;
+
+	set->scanned = 0;
+
+	if (0 != set->match_all)
+	{
+		ret = ZBX_REGEXP_MATCH;
+		goto out;
+	}
+
+	for (i = 0; i < set->expressions_num; i++)
+	{
+		zbx_regexp_set_expression_t	*expr = &set->expressions[i];
+
+		switch (expr->type)
+		{
+			case EXPRESSION_TYPE_TRUE:
+				if (NULL != output)
+				{
+					char	*output_tmp = NULL;
+
+					if (ZBX_REGEXP_MATCH == (ret = regexp_set_match_regexp(set, expr, string,
+							output_template, &output_tmp, err_msg)))
+					{
+						zbx_free(output_accu);
+						output_accu = output_tmp;
+					}
+				}
+				else
+					ret = regexp_set_match_regexp(set, expr, string, NULL, NULL, err_msg);
+
+				if (ZBX_REGEXP_COMPILE_FAIL == ret || ZBX_REGEXP_RUNTIME_FAIL == ret)
+				{
+					zbx_free(output_accu);
+					return ret;
+				}
+
+				break;
+			case EXPRESSION_TYPE_FALSE:
+				ret = regexp_set_match_regexp(set, expr, string, NULL, NULL, err_msg);
+
+				if (ZBX_REGEXP_MATCH == ret)	/* invert output value */
+				{
+					ret = ZBX_REGEXP_NO_MATCH;
+				}
+				else if (ZBX_REGEXP_NO_MATCH == ret)
+				{
+					ret = ZBX_REGEXP_MATCH;
+				}
+				else
+				{
+					zbx_free(output_accu);
+					return ret;
+				}
+
+				break;
+			case EXPRESSION_TYPE_INCLUDED:
+			case EXPRESSION_TYPE_ANY_INCLUDED:
+				ret = (SUCCEED == regexp_set_literal_found(set, expr, string) ? ZBX_REGEXP_MATCH :
+						ZBX_REGEXP_NO_MATCH);
+				break;
+			case EXPRESSION_TYPE_NOT_INCLUDED:
+				ret = (SUCCEED == regexp_set_literal_found(set, expr, string) ? ZBX_REGEXP_NO_MATCH :
+						ZBX_REGEXP_MATCH);
+				break;
+			default:
+				if (NULL != err_msg)
+				{
+					*err_msg = zbx_dsprintf(*err_msg, "Invalid regular expression type: %d",
+							expr->type);
+				}
+
+				zbx_free(output_accu);
+				THIS_SHOULD_NEVER_HAPPEN;
+
+				return ZBX_REGEXP_COMPILE_FAIL;
+		}
+
+		if (ZBX_REGEXP_NO_MATCH == ret)
+		{
+			zbx_free(output_accu);
+			break;
+		}
+	}
+
+	if (ZBX_REGEXP_MATCH == ret && NULL != output_accu)
+	{
+		*output = output_accu;
+		return ZBX_REGEXP_MATCH;
+	}
+out:
+	if (ZBX_REGEXP_MATCH == ret && NULL != output && NULL == *output)
+		*output = zbx_strdup(NULL, string);
+
+	return ret;
+}
+
+int	zbx_regexp_set_match(zbx_regexp_set_t *set, const char *string)
+{
+	return zbx_regexp_set_sub(set, string, NULL, NULL, NULL);
+}
+
 #undef EXPRESSION_TYPE_INCLUDED
 #undef EXPRESSION_TYPE_ANY_INCLUDED
 #undef EXPRESSION_TYPE_NOT_INCLUDED
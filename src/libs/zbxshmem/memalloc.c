@@ -117,6 +117,74 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
 #define SHMEM_MIN_SIZE		__UINT64_C(128)
 #define SHMEM_MAX_SIZE		__UINT64_C(0x1000000000)	/* 64 GB */
 
+/******************************************************************************
+ *                                                                            *
+ *                     Some information on slab mode                          *
+ *                  -------------------------------------                     *
+ *                                                                            *
+ * (*) in slab mode small allocations (up to SHMEM_MAX_BUCKET_SIZE bytes) are *
+ *     served from runs - chunks of SHMEM_SLAB_RUN_SIZE bytes split into      *
+ *     objects of the same size class (one class per free chunk bucket)       *
+ *                                                                            *
+ *                +- run header -+--- object ---+--- object ---+              *
+ *                |              |              |              |              *
+ *                v              v              v              v              *
+ *                                                                            *
+ *       |--------|--------------|----|---------|----|---------|--...--|----| *
+ *                                                                            *
+ *       ^        ^                   ^                                       *
+ *       |        |                   |                                       *
+ *     chunk      run               user data                                 *
+ *     size                                                                   *
+ *                                                                            *
+ *     each object is preceded by a size field with SHMEM_FLG_USED and        *
+ *     SHMEM_FLG_SLAB bits set and the offset of the field from run start     *
+ *                                                                            *
+ *     when an object is free, the first ZBX_PTR_SIZE bytes of allocatable    *
+ *     memory contain pointer to the next free object of the run              *
+ *                                                                            *
+ * (*) objects of the same size are kept together, so freeing them does not   *
+ *     leave small holes between large chunks, and runs left without used     *
+ *     objects are returned to the chunk allocator                            *
+ *                                                                            *
+ * (*) runs with free objects are stored in doubly-linked lists per size      *
+ *     class, full runs are not linked                                        *
+ *                                                                            *
+ ******************************************************************************/
+
+#define SHMEM_FLG_SLAB		((__UINT64_C(1))<<62)
+
+#define SLAB_OBJECT(ptr)	(0 != ((*(zbx_uint64_t *)((char *)(ptr) - SHMEM_SIZE_FIELD)) & SHMEM_FLG_SLAB))
+#define SLAB_OFFSET(ptr)	((*(zbx_uint64_t *)((char *)(ptr) - SHMEM_SIZE_FIELD)) & \
+					~(SHMEM_FLG_USED | SHMEM_FLG_SLAB))
+
+#define SHMEM_SLAB_RUN_SIZE		(16 * ZBX_KIBIBYTE)
+#define SHMEM_SLAB_CLASS_COUNT		ZBX_SHMEM_BUCKET_COUNT
+
+/* the minimum shared memory size to enable slab mode, so runs do not take up significant part of it */
+#define SHMEM_SLAB_MIN_SIZE		(2 * ZBX_MEBIBYTE)
+
+typedef struct zbx_shmem_slab_run
+{
+	struct zbx_shmem_slab_run	*prev;
+	struct zbx_shmem_slab_run	*next;
+	void				*free_list;
+	zbx_uint32_t			size_class;
+	zbx_uint32_t			used_num;
+}
+zbx_shmem_slab_run_t;
+
+typedef struct
+{
+	zbx_shmem_slab_run_t	*partial;	/* runs having free objects */
+	zbx_uint64_t		runs_num;
+	zbx_uint64_t		used_num;
+	zbx_uint64_t		free_num;
+}
+zbx_shmem_slab_class_t;
+
+static int	shmem_slab_mode = ZBX_SHMEM_SLAB_DISABLED;
+
 /* helper functions */
 
 static void	*ALIGN4(void *ptr)
@@ -523,10 +591,232 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr)
 	}
 }
 
+/* slab functions */
+
+static zbx_uint64_t	mem_slab_class_size(int size_class)
+{
+	return ZBX_SHMEM_MIN_BUCKET_SIZE + 8 * (zbx_uint64_t)size_class;
+}
+
+static zbx_uint32_t	mem_slab_objects_num(int size_class)
+{
+	return (zbx_uint32_t)((SHMEM_SLAB_RUN_SIZE - sizeof(zbx_shmem_slab_run_t)) /
+			(SHMEM_SIZE_FIELD + mem_slab_class_size(size_class)));
+}
+
+static void	mem_slab_link_run(zbx_shmem_slab_class_t *slab, zbx_shmem_slab_run_t *run)
+{
+	if (NULL != slab->partial)
+		slab->partial->prev = run;
+
+	run->prev = NULL;
+	run->next = slab->partial;
+
+	slab->partial = run;
+}
+
+static void	mem_slab_unlink_run(zbx_shmem_slab_class_t *slab, zbx_shmem_slab_run_t *run)
+{
+	if (NULL != run->prev)
+		run->prev->next = run->next;
+	else
+		slab->partial = run->next;
+
+	if (NULL != run->next)
+		run->next->prev = run->prev;
+
+	run->prev = NULL;
+	run->next = NULL;
+}
+
+static void	mem_slab_init(zbx_shmem_info_t *info)
+{
+	void	*chunk;
+
+	if (NULL == (chunk = __mem_malloc(info, sizeof(zbx_shmem_slab_class_t) * SHMEM_SLAB_CLASS_COUNT)))
+	{
+		info->slabs = NULL;
+		return;
+	}
+
+	info->slabs = (void *)((char *)chunk + SHMEM_SIZE_FIELD);
+	memset(info->slabs, 0, sizeof(zbx_shmem_slab_class_t) * SHMEM_SLAB_CLASS_COUNT);
+}
+
+static zbx_shmem_slab_run_t	*mem_slab_create_run(zbx_shmem_info_t *info, int size_class)
+{
+	zbx_shmem_slab_class_t	*slab = &((zbx_shmem_slab_class_t *)info->slabs)[size_class];
+	zbx_shmem_slab_run_t	*run;
+	zbx_uint64_t		stride;
+	zbx_uint32_t		i, objects_num;
+	void			*chunk;
+
+	if (NULL == (chunk = __mem_malloc(info, SHMEM_SLAB_RUN_SIZE)))
+		return NULL;
+
+	run = (zbx_shmem_slab_run_t *)((char *)chunk + SHMEM_SIZE_FIELD);
+	run->size_class = (zbx_uint32_t)size_class;
+	run->used_num = 0;
+	run->free_list = NULL;
+
+	stride = SHMEM_SIZE_FIELD + mem_slab_class_size(size_class);
+	objects_num = mem_slab_objects_num(size_class);
+
+	/* link objects in reverse order, so they are allocated in the order of addresses */
+	for (i = objects_num; 0 < i; i--)
+	{
+		char	*field = (char *)(run + 1) + (i - 1) * stride;
+
+		*(zbx_uint64_t *)field = SHMEM_FLG_USED | SHMEM_FLG_SLAB | (zbx_uint64_t)(field - (char *)run);
+		*(void **)(field + SHMEM_SIZE_FIELD) = run->free_list;
+		run->free_list = field + SHMEM_SIZE_FIELD;
+	}
+
+	slab->runs_num++;
+	slab->free_num += objects_num;
+	mem_slab_link_run(slab, run);
+
+	return run;
+}
+
+static void	*mem_slab_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	int			size_class;
+	zbx_shmem_slab_class_t	*slab;
+	zbx_shmem_slab_run_t	*run;
+	void			*object;
+
+	size_class = mem_bucket_by_size(size);
+	slab = &((zbx_shmem_slab_class_t *)info->slabs)[size_class];
+
+	if (NULL == (run = slab->partial) && NULL == (run = mem_slab_create_run(info, size_class)))
+		return NULL;
+
+	object = run->free_list;
+	run->free_list = *(void **)object;
+	run->used_num++;
+
+	slab->used_num++;
+	slab->free_num--;
+
+	if (NULL == run->free_list)
+		mem_slab_unlink_run(slab, run);
+
+	return object;
+}
+
+static void	mem_slab_free(zbx_shmem_info_t *info, void *ptr)
+{
+	zbx_shmem_slab_run_t	*run;
+	zbx_shmem_slab_class_t	*slab;
+
+	run = (zbx_shmem_slab_run_t *)((char *)ptr - SHMEM_SIZE_FIELD - SLAB_OFFSET(ptr));
+	slab = &((zbx_shmem_slab_class_t *)info->slabs)[run->size_class];
+
+	if (NULL == run->free_list)
+		mem_slab_link_run(slab, run);
+
+	*(void **)ptr = run->free_list;
+	run->free_list = ptr;
+	run->used_num--;
+
+	slab->used_num--;
+	slab->free_num++;
+
+	/* return empty run to chunk allocator unless it is the last run with free objects */
+	if (0 == run->used_num && (NULL != run->prev || NULL != run->next))
+	{
+		mem_slab_unlink_run(slab, run);
+
+		slab->runs_num--;
+		slab->free_num -= mem_slab_objects_num((int)run->size_class);
+
+		__mem_free(info, run);
+	}
+}
+
+/* memory functions dispatching between slabs and chunks */
+
+static void	*mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	void	*chunk;
+
+	if (NULL != info->slabs && SHMEM_MAX_BUCKET_SIZE >= mem_proper_alloc_size(size))
+	{
+		void	*object;
+
+		if (NULL != (object = mem_slab_malloc(info, mem_proper_alloc_size(size))))
+			return object;
+
+		/* no space for a new run, fall back to chunk allocation */
+	}
+
+	if (NULL == (chunk = __mem_malloc(info, size)))
+		return NULL;
+
+	return (void *)((char *)chunk + SHMEM_SIZE_FIELD);
+}
+
+static void	*mem_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size)
+{
+	void	*chunk;
+
+	if (SLAB_OBJECT(old))
+	{
+		zbx_shmem_slab_run_t	*run;
+		zbx_uint64_t		old_size;
+		void			*object;
+
+		run = (zbx_shmem_slab_run_t *)((char *)old - SHMEM_SIZE_FIELD - SLAB_OFFSET(old));
+		old_size = mem_slab_class_size((int)run->size_class);
+
+		if (mem_proper_alloc_size(size) <= old_size)
+			return old;
+
+		if (NULL == (object = mem_malloc(info, size)))
+			return NULL;
+
+		memcpy(object, old, old_size);
+		mem_slab_free(info, old);
+
+		return object;
+	}
+
+	if (NULL == (chunk = __mem_realloc(info, old, size)))
+		return NULL;
+
+	return (void *)((char *)chunk + SHMEM_SIZE_FIELD);
+}
+
+static void	mem_free(zbx_shmem_info_t *info, void *ptr)
+{
+	if (SLAB_OBJECT(ptr))
+		mem_slab_free(info, ptr);
+	else
+		__mem_free(info, ptr);
+}
+
 /* public memory interface */
 
-int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
-		int allow_oom, char **error)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets slab mode for shared memory created afterwards               *
+ *                                                                            *
+ * Parameters: mode - [IN] ZBX_SHMEM_SLAB_ENABLED or ZBX_SHMEM_SLAB_DISABLED  *
+ *                                                                            *
+ * Comments: Slab mode is not used for memory created with                    *
+ *           zbx_shmem_create_min(), as its size is calculated from the       *
+ *           required chunks, and for memory smaller than SHMEM_SLAB_MIN_SIZE.*
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_shmem_set_slab_mode(int mode)
+{
+	shmem_slab_mode = mode;
+}
+
+static int	shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
+		int allow_oom, int slab_mode, char **error)
+
 {
 	int	shm_id, index, ret = FAIL;
 	void	*base;
@@ -613,6 +903,11 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	(*info)->used_size = 0;
 	(*info)->free_size = (*info)->total_size;
 
+	(*info)->slabs = NULL;
+
+	if (ZBX_SHMEM_SLAB_ENABLED == slab_mode && SHMEM_SLAB_MIN_SIZE <= (*info)->total_size)
+		mem_slab_init(*info);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "valid user addresses: [%p, %p] total size: " ZBX_FS_SIZE_T,
 			(void *)((char *)(*info)->lo_bound + SHMEM_SIZE_FIELD),
 			(void *)((char *)(*info)->hi_bound - SHMEM_SIZE_FIELD),
@@ -623,6 +918,12 @@ out:
 	return ret;
 }
 
+int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
+		int allow_oom, char **error)
+{
+	return shmem_create(info, size, descr, param, allow_oom, shmem_slab_mode, error);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: allocate the required shared memory size                          *
@@ -657,7 +958,7 @@ int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char
 	size += 8;
 	size += 2 * SHMEM_SIZE_FIELD;
 
-	return zbx_shmem_create(info, size, descr, param, allow_oom, error);
+	return shmem_create(info, size, descr, param, allow_oom, ZBX_SHMEM_SLAB_DISABLED, error);
 }
 
 void	zbx_shmem_destroy(zbx_shmem_info_t *info)
@@ -667,7 +968,7 @@ void	zbx_shmem_destroy(zbx_shmem_info_t *info)
 
 void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, const void *old, size_t size)
 {
-	void	*chunk;
+	void	*ptr;
 
 	if (NULL != old)
 	{
@@ -683,9 +984,9 @@ void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, con
 		exit(EXIT_FAILURE);
 	}
 
-	chunk = __mem_malloc(info, size);
+	ptr = mem_malloc(info, size);
 
-	if (NULL == chunk)
+	if (NULL == ptr)
 	{
 		if (1 == info->allow_oom)
 			return NULL;
@@ -700,12 +1001,12 @@ void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, con
 		exit(EXIT_FAILURE);
 	}
 
-	return (void *)((char *)chunk + SHMEM_SIZE_FIELD);
+	return ptr;
 }
 
 void	*__zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, void *old, size_t size)
 {
-	void	*chunk;
+	void	*ptr;
 
 	if (0 == size || size > SHMEM_MAX_SIZE)
 	{
@@ -715,11 +1016,11 @@ void	*__zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, vo
 	}
 
 	if (NULL == old)
-		chunk = __mem_malloc(info, size);
+		ptr = mem_malloc(info, size);
 	else
-		chunk = __mem_realloc(info, old, size);
+		ptr = mem_realloc(info, old, size);
 
-	if (NULL == chunk)
+	if (NULL == ptr)
 	{
 		if (1 == info->allow_oom)
 			return NULL;
@@ -734,7 +1035,7 @@ void	*__zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, vo
 		exit(EXIT_FAILURE);
 	}
 
-	return (void *)((char *)chunk + SHMEM_SIZE_FIELD);
+	return ptr;
 }
 
 void	__zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *ptr)
@@ -745,7 +1046,7 @@ void	__zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *
 		exit(EXIT_FAILURE);
 	}
 
-	__mem_free(info, ptr);
+	mem_free(info, ptr);
 }
 
 void	zbx_shmem_clear(zbx_shmem_info_t *info)
@@ -763,6 +1064,9 @@ void	zbx_shmem_clear(zbx_shmem_info_t *info)
 	info->used_size = 0;
 	info->free_size = info->total_size;
 
+	if (NULL != info->slabs)
+		mem_slab_init(info);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -800,6 +1104,22 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 	stats->used_chunks = stats->overhead / (2 * SHMEM_SIZE_FIELD) + 1 - stats->free_chunks;
 	stats->free_size = info->free_size;
 	stats->used_size = info->used_size;
+
+	stats->slab_runs = 0;
+	stats->slab_used_size = 0;
+	stats->slab_free_size = 0;
+
+	if (NULL != info->slabs)
+	{
+		const zbx_shmem_slab_class_t	*slabs = (const zbx_shmem_slab_class_t *)info->slabs;
+
+		for (i = 0; i < SHMEM_SLAB_CLASS_COUNT; i++)
+		{
+			stats->slab_runs += slabs[i].runs_num;
+			stats->slab_used_size += slabs[i].used_num * mem_slab_class_size(i);
+			stats->slab_free_size += slabs[i].free_num * mem_slab_class_size(i);
+		}
+	}
 }
 
 void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
@@ -833,6 +1153,33 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 	zabbix_log(level, "of those, %10llu bytes are used by allocation overhead",
 			(unsigned long long)stats.overhead);
 
+	/* the share of free memory that is not available for allocating the largest free chunk */
+	if (0 != stats.free_size)
+	{
+		zabbix_log(level, "fragmentation: %.2f%% of free memory is outside the largest free chunk",
+				100.0 * (double)(stats.free_size - stats.max_chunk_size) / (double)stats.free_size);
+	}
+
+	if (NULL != info->slabs)
+	{
+		const zbx_shmem_slab_class_t	*slabs = (const zbx_shmem_slab_class_t *)info->slabs;
+
+		for (i = 0; i < SHMEM_SLAB_CLASS_COUNT; i++)
+		{
+			if (0 == slabs[i].runs_num)
+				continue;
+
+			zabbix_log(level, "slab objects of size %3d bytes: %6llu runs %10llu used %10llu free",
+					(int)mem_slab_class_size(i), (unsigned long long)slabs[i].runs_num,
+					(unsigned long long)slabs[i].used_num, (unsigned long long)slabs[i].free_num);
+		}
+
+		zabbix_log(level, "of used chunks, %10llu bytes are in %8llu slab runs: %llu bytes used, %llu bytes"
+				" free", (unsigned long long)stats.slab_runs * SHMEM_SLAB_RUN_SIZE,
+				(unsigned long long)stats.slab_runs, (unsigned long long)stats.slab_used_size,
+				(unsigned long long)stats.slab_free_size);
+	}
+
 	zabbix_log(level, "================================");
 }
 
@@ -1998,6 +1998,7 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 	int				prep_vec_idx = -1;	/* index in 'prep_vec' vector */
 #endif
 	zbx_uint64_t			processed_size;
+	zbx_regexp_set_t		*regexp_set;
 
 #define BUF_SIZE	(256 * ZBX_KIBIBYTE)	/* The longest encodings use 4 bytes for every character. To send */
 						/* up to 64 k characters to Zabbix server a 256 kB buffer might be */
@@ -2012,6 +2013,9 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 
 	zbx_find_cr_lf_szbyte(encoding, &cr, &lf, &szbyte);
 
+	/* all expressions of the pattern are checked in one pass over each record */
+	regexp_set = zbx_regexp_set_create(regexps, pattern, ZBX_CASE_SENSITIVE);
+
 	for (;;)
 	{
 		if (0 >= *p_count || 0 >= *s_count)
@@ -2099,7 +2103,7 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 					processed_size = (size_t)offset + (size_t)nbytes;
 					send_err = FAIL;
 
-					regexp_ret = zbx_regexp_sub_ex2(regexps, value, pattern, ZBX_CASE_SENSITIVE,
+					regexp_ret = zbx_regexp_set_sub(regexp_set, value,
 							(0 == is_count_item) ? output_template : NULL,
 							(0 == is_count_item) ? &item_value : NULL, err_msg);
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
@@ -2236,7 +2240,7 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 					processed_size = (size_t)offset + (size_t)(p_next - buf);
 					send_err = FAIL;
 
-					regexp_ret = zbx_regexp_sub_ex2(regexps, value, pattern, ZBX_CASE_SENSITIVE,
+					regexp_ret = zbx_regexp_set_sub(regexp_set, value,
 							(0 == is_count_item) ? output_template : NULL,
 							(0 == is_count_item) ? &item_value : NULL, err_msg);
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
@@ -2358,6 +2362,8 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 		}
 	}
 out:
+	zbx_regexp_set_free(regexp_set);
+
 	return ret;
 
 #undef BUF_SIZE
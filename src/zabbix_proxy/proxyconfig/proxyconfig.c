@@ -120,7 +120,7 @@ static void	process_configuration_sync(size_t *data_size, zbx_synced_new_config_
 	if (SUCCEED == (ret = zbx_proxyconfig_process(sock.peer, &jp, &error)))
 	{
 		zbx_dc_sync_configuration(ZBX_DBSYNC_UPDATE, *synced, NULL, args->config_vault,
-				args->config_proxyconfig_frequency);
+				args->config_proxyconfig_frequency, 0);
 		*synced = ZBX_SYNCED_NEW_CONFIG_YES;
 
 		if (SUCCEED == zbx_json_brackets_by_name(&jp, ZBX_PROTO_TAG_MACRO_SECRETS, &jp_kvs_paths))
@@ -267,7 +267,7 @@ ZBX_THREAD_ENTRY(proxyconfig_thread, args)
 
 	zbx_setproctitle("%s [syncing configuration]", get_process_type_string(process_type));
 	zbx_dc_sync_configuration(ZBX_DBSYNC_INIT, ZBX_SYNCED_NEW_CONFIG_NO, NULL, proxyconfig_args_in->config_vault,
-			proxyconfig_args_in->config_proxyconfig_frequency);
+			proxyconfig_args_in->config_proxyconfig_frequency, 0);
 
 	zbx_rtc_notify_finished_sync(proxyconfig_args_in->config_timeout, ZBX_RTC_CONFIG_SYNC_NOTIFY, get_process_type_string(process_type), &rtc);
 
@@ -300,7 +300,7 @@ ZBX_THREAD_ENTRY(proxyconfig_thread, args)
 
 				zbx_dc_sync_configuration(ZBX_DBSYNC_UPDATE, synced, NULL,
 						proxyconfig_args_in->config_vault,
-						proxyconfig_args_in->config_proxyconfig_frequency);
+						proxyconfig_args_in->config_proxyconfig_frequency, 0);
 				synced = ZBX_SYNCED_NEW_CONFIG_YES;
 				zbx_dc_update_interfaces_availability();
 
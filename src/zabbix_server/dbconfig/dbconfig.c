@@ -66,7 +66,7 @@ ZBX_THREAD_ENTRY(dbconfig_thread, args)
 	sec = zbx_time();
 	zbx_setproctitle("%s [syncing configuration]", get_process_type_string(process_type));
 	zbx_dc_sync_configuration(ZBX_DBSYNC_INIT, ZBX_SYNCED_NEW_CONFIG_NO, NULL, dbconfig_args_in->config_vault,
-			dbconfig_args_in->proxyconfig_frequency);
+			dbconfig_args_in->proxyconfig_frequency, dbconfig_args_in->config_confsyncer_load_threads);
 	zbx_dc_sync_kvs_paths(NULL, dbconfig_args_in->config_vault, dbconfig_args_in->config_source_ip,
 			dbconfig_args_in->config_ssl_ca_location, dbconfig_args_in->config_ssl_cert_location,
 			dbconfig_args_in->config_ssl_key_location);
@@ -136,7 +136,8 @@ ZBX_THREAD_ENTRY(dbconfig_thread, args)
 
 			revision = zbx_dc_sync_configuration(ZBX_DBSYNC_UPDATE, ZBX_SYNCED_NEW_CONFIG_YES,
 					&deleted_itemids, dbconfig_args_in->config_vault,
-					dbconfig_args_in->proxyconfig_frequency);
+					dbconfig_args_in->proxyconfig_frequency,
+					dbconfig_args_in->config_confsyncer_load_threads);
 			zbx_dc_sync_kvs_paths(NULL, dbconfig_args_in->config_vault, dbconfig_args_in->config_source_ip,
 					dbconfig_args_in->config_ssl_ca_location,
 					dbconfig_args_in->config_ssl_cert_location,
@@ -30,6 +30,7 @@ typedef struct
 	int			proxyconfig_frequency;
 	int			proxydata_frequency;
 	int			config_confsyncer_frequency;
+	int			config_confsyncer_load_threads;
 	const char		*config_source_ip;
 	const char		*config_ssl_ca_location;
 	const char		*config_ssl_cert_location;
@@ -28,9 +28,11 @@
 
 #define ZBX_DIAG_LLD_RULES		0x00000001
 #define ZBX_DIAG_LLD_VALUES		0x00000002
+#define ZBX_DIAG_LLD_SKIPPED		0x00000004
 
 #define ZBX_DIAG_LLD_SIMPLE		(ZBX_DIAG_LLD_RULES | \
-					ZBX_DIAG_LLD_VALUES)
+					ZBX_DIAG_LLD_VALUES | \
+					ZBX_DIAG_LLD_SKIPPED)
 
 #define ZBX_DIAG_ALERTING_ALERTS	0x00000001
 
@@ -262,6 +264,7 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 					{"", ZBX_DIAG_LLD_SIMPLE},
 					{"rules", ZBX_DIAG_LLD_RULES},
 					{"values", ZBX_DIAG_LLD_VALUES},
+					{"skipped", ZBX_DIAG_LLD_SKIPPED},
 					{NULL, 0}
 					};
 
@@ -273,10 +276,10 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 
 		if (0 != (fields & ZBX_DIAG_LLD_SIMPLE))
 		{
-			zbx_uint64_t	values_num, items_num;
+			zbx_uint64_t	values_num, items_num, skipped_num;
 
 			time1 = zbx_time();
-			if (FAIL == (ret = zbx_lld_get_diag_stats(&items_num, &values_num, error)))
+			if (FAIL == (ret = zbx_lld_get_diag_stats(&items_num, &values_num, &skipped_num, error)))
 				goto out;
 			time2 = zbx_time();
 			time_total += time2 - time1;
@@ -285,6 +288,8 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 				zbx_json_addint64(json, "rules", items_num);
 			if (0 != (fields & ZBX_DIAG_LLD_VALUES))
 				zbx_json_addint64(json, "values", values_num);
+			if (0 != (fields & ZBX_DIAG_LLD_SKIPPED))
+				zbx_json_addint64(json, "skipped", skipped_num);
 		}
 
 		if (0 != tops.values_num)
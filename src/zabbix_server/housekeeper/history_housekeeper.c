@@ -0,0 +1,210 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "history_housekeeper.h"
+
+#include "zbxstr.h"
+
+ZBX_PTR_VECTOR_IMPL(hk_delete_queue_ptr, zbx_hk_delete_queue_t *)
+ZBX_PTR_VECTOR_IMPL(hk_partition_ptr, zbx_hk_partition_t *)
+
+void	hk_partition_free(zbx_hk_partition_t *partition)
+{
+	zbx_free(partition->name);
+	zbx_free(partition);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses upper bound of native range partition                      *
+ *                                                                            *
+ * Parameters: bound    - [IN] PostgreSQL partition bound expression or MySQL *
+ *                             partition description                          *
+ *             clock_to - [OUT] the partition upper bound (exclusive) or      *
+ *                              HK_PARTITION_UNBOUNDED                        *
+ *                                                                            *
+ * Return value: SUCCEED - the bound was parsed                               *
+ *               FAIL    - the bound is not a valid timestamp                 *
+ *                                                                            *
+ * Comments: PostgreSQL bound expression has format                           *
+ *           "FOR VALUES FROM (<from>) TO (<to>)" or "DEFAULT", MySQL         *
+ *           partition description contains "values less than" bound or       *
+ *           MAXVALUE.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_partition_parse_bound(const char *bound, int *clock_to)
+{
+	const char	*ptr;
+	char		*end, terminator;
+	long		value;
+
+	if (0 == strcmp(bound, "DEFAULT"))
+	{
+		*clock_to = HK_PARTITION_UNBOUNDED;
+		return SUCCEED;
+	}
+
+	if (NULL != (ptr = strstr(bound, " TO (")))
+	{
+		ptr += ZBX_CONST_STRLEN(" TO (");
+		terminator = ')';
+	}
+	else
+	{
+		ptr = bound;
+		terminator = '\0';
+	}
+
+	if (0 == strncmp(ptr, "MAXVALUE", ZBX_CONST_STRLEN("MAXVALUE")) &&
+			terminator == ptr[ZBX_CONST_STRLEN("MAXVALUE")])
+	{
+		*clock_to = HK_PARTITION_UNBOUNDED;
+		return SUCCEED;
+	}
+
+	/* strtol() accepts leading whitespace and sign */
+	if (0 == isdigit((unsigned char)*ptr))
+		return FAIL;
+
+	errno = 0;
+	value = strtol(ptr, &end, 10);
+
+	if (0 != errno || terminator != *end || INT_MAX < value)
+		return FAIL;
+
+	*clock_to = (int)value;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates ranges of the partitions to be created in advance      *
+ *                                                                            *
+ * Parameters: partitions - [IN] existing partitions                          *
+ *             now        - [IN] current timestamp                            *
+ *             period     - [IN] partitioning period                          *
+ *             precreate  - [IN] number of periods to create in advance       *
+ *             ranges     - [OUT] lower (inclusive) and upper (exclusive)     *
+ *                                bounds of the partitions to create          *
+ *                                                                            *
+ * Comments: New partitions are created after the last bounded partition.     *
+ *           The first created partition ends at the period boundary, so      *
+ *           partitions not aligned to the period are followed by aligned     *
+ *           ones.                                                            *
+ *                                                                            *
+ ******************************************************************************/
+void	hk_partitions_get_create_ranges(const zbx_vector_hk_partition_ptr_t *partitions, int now, int period,
+		int precreate, zbx_vector_uint64_pair_t *ranges)
+{
+	int	clock_from = 0;
+
+	for (int i = 0; i < partitions->values_num; i++)
+	{
+		if (clock_from < partitions->values[i]->clock_to)
+			clock_from = partitions->values[i]->clock_to;
+	}
+
+	if (0 == clock_from)
+		clock_from = now - now % period;
+
+	while (clock_from < now + precreate * period)
+	{
+		zbx_uint64_pair_t	range;
+
+		range.first = (zbx_uint64_t)clock_from;
+		clock_from = clock_from - clock_from % period + period;
+		range.second = (zbx_uint64_t)clock_from;
+
+		zbx_vector_uint64_pair_append(ranges, range);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if all records of partition are expired                    *
+ *                                                                            *
+ * Parameters: partition - [IN]                                               *
+ *             keep_from - [IN] the oldest timestamp of records to keep       *
+ *                                                                            *
+ * Return value: SUCCEED - the partition can be dropped                       *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_partition_is_expired(const zbx_hk_partition_t *partition, int keep_from)
+{
+	if (HK_PARTITION_UNBOUNDED == partition->clock_to || keep_from < partition->clock_to)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compare two delete queue items by their cutoff timestamp and      *
+ *          itemid                                                            *
+ *                                                                            *
+ * Return value: <0 - the first item is less than the second                  *
+ *               >0 - the first item is greater than the second               *
+ *               =0 - the items are the same                                  *
+ *                                                                            *
+ * Comments: this function is used to sort delete queue so that items sharing *
+ *           the same cutoff timestamp can be removed with a single statement *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_delete_queue_compare(const void *d1, const void *d2)
+{
+	zbx_hk_delete_queue_t	*r1 = *(zbx_hk_delete_queue_t **)d1;
+	zbx_hk_delete_queue_t	*r2 = *(zbx_hk_delete_queue_t **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(r1->min_clock, r2->min_clock);
+	ZBX_RETURN_IF_NOT_EQUAL(r1->itemid, r2->itemid);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the next chunk of delete queue items sharing the same        *
+ *          cutoff timestamp                                                  *
+ *                                                                            *
+ * Parameters: queue     - [IN] delete queue sorted by cutoff timestamp       *
+ *             index     - [IN/OUT] index of the first item of the chunk,     *
+ *                                  set to the first item of the next chunk   *
+ *             max_items - [IN] the maximum number of items in chunk          *
+ *             itemids   - [OUT] identifiers of the chunk items               *
+ *                                                                            *
+ * Return value: The cutoff timestamp of the chunk items.                     *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_delete_queue_get_chunk(const zbx_vector_hk_delete_queue_ptr_t *queue, int *index, int max_items,
+		zbx_vector_uint64_t *itemids)
+{
+	int	i = *index, min_clock = queue->values[i]->min_clock;
+
+	for (; i < queue->values_num && min_clock == queue->values[i]->min_clock && max_items > itemids->values_num;
+			i++)
+	{
+		zbx_vector_uint64_append(itemids, queue->values[i]->itemid);
+	}
+
+	*index = i;
+
+	return min_clock;
+}
@@ -0,0 +1,63 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_HISTORY_HOUSEKEEPER_H
+#define ZABBIX_HISTORY_HOUSEKEEPER_H
+
+#include "zbxalgo.h"
+
+/* the partition upper bound is not limited (MAXVALUE or DEFAULT partition) */
+#define HK_PARTITION_UNBOUNDED		-1
+
+/* Delete queue item definition.                                     */
+/* The delete queue item defines an item that should be processed by */
+/* housekeeping procedure (records older than min_clock seconds      */
+/* must be removed from database).                                   */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	int		min_clock;
+}
+zbx_hk_delete_queue_t;
+
+ZBX_PTR_VECTOR_DECL(hk_delete_queue_ptr, zbx_hk_delete_queue_t *)
+
+/* native range partition of history (trends) table */
+typedef struct
+{
+	char	*name;
+
+	/* the partition upper bound (exclusive) or HK_PARTITION_UNBOUNDED */
+	int	clock_to;
+}
+zbx_hk_partition_t;
+
+ZBX_PTR_VECTOR_DECL(hk_partition_ptr, zbx_hk_partition_t *)
+
+void	hk_partition_free(zbx_hk_partition_t *partition);
+int	hk_partition_parse_bound(const char *bound, int *clock_to);
+void	hk_partitions_get_create_ranges(const zbx_vector_hk_partition_ptr_t *partitions, int now, int period,
+		int precreate, zbx_vector_uint64_pair_t *ranges);
+int	hk_partition_is_expired(const zbx_hk_partition_t *partition, int keep_from);
+
+int	hk_delete_queue_compare(const void *d1, const void *d2);
+int	hk_delete_queue_get_chunk(const zbx_vector_hk_delete_queue_ptr_t *queue, int *index, int max_items,
+		zbx_vector_uint64_t *itemids);
+
+#endif
@@ -27,6 +27,7 @@
 #include "zbxnum.h"
 #include "zbxtime.h"
 #include "history_compress.h"
+#include "history_housekeeper.h"
 #include "zbx_rtc_constants.h"
 #include "zbx_host_constants.h"
 #include "zbxalgo.h"
@@ -46,6 +47,15 @@
 #define HK_MIN_CLOCK_UNDEFINED		0
 #define HK_MIN_CLOCK_ALWAYS_RECHECK	-1
 
+/* natively partitioned history tables are split into periods of one day, trends tables into */
+/* periods of one week, and partitions for the next few periods are created in advance        */
+#define HK_PARTITION_PERIOD_HISTORY	SEC_PER_DAY
+#define HK_PARTITION_PERIOD_TRENDS	SEC_PER_WEEK
+#define HK_PARTITION_PRECREATE		3
+
+/* the maximum number of items removed by a single history delete statement */
+#define HK_DELETE_CHUNK_ITEMS		1000
+
 /* trends table offsets in the hk_cleanup_tables[] mapping  */
 #define HK_UPDATE_CACHE_OFFSET_TREND_FLOAT	(ITEM_VALUE_TYPE_BIN + 1)
 #define HK_UPDATE_CACHE_OFFSET_TREND_UINT	(HK_UPDATE_CACHE_OFFSET_TREND_FLOAT + 1)
@@ -104,20 +114,6 @@ typedef struct
 }
 zbx_hk_item_cache_t;
 
-/* Delete queue item definition.                                     */
-/* The delete queue item defines an item that should be processed by */
-/* housekeeping procedure (records older than min_clock seconds      */
-/* must be removed from database).                                   */
-typedef struct
-{
-	zbx_uint64_t	itemid;
-	int		min_clock;
-}
-zbx_hk_delete_queue_t;
-
-ZBX_PTR_VECTOR_DECL(hk_delete_queue_ptr, zbx_hk_delete_queue_t *)
-ZBX_PTR_VECTOR_IMPL(hk_delete_queue_ptr, zbx_hk_delete_queue_t *)
-
 /* this structure is used to remove old records from history (trends) tables */
 typedef struct
 {
@@ -144,9 +140,27 @@ typedef struct
 
 	/* the item delete queue */
 	zbx_vector_hk_delete_queue_ptr_t	delete_queue;
+
+	/* 1 if the target table is natively range partitioned by clock and the expired data */
+	/* is removed by dropping partitions, 0 otherwise                                    */
+	unsigned char				partitioned;
 }
 zbx_hk_history_rule_t;
 
+/* history and trends housekeeping progress */
+typedef struct
+{
+	/* number of removed records */
+	int	deleted;
+
+	/* number of executed delete statements */
+	int	chunks;
+
+	int	partitions_created;
+	int	partitions_dropped;
+}
+zbx_hk_history_stats_t;
+
 static struct zbx_db_version_info_t	*db_version_info;
 
 #if defined(HAVE_POSTGRESQL)
@@ -225,27 +239,6 @@ static int	hk_history_rules_partition_is_table_name_excluded(const char *table_n
 	return FAIL;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: compare two delete queue items by their itemid                    *
- *                                                                            *
- * Return value: <0 - the first item is less than the second                  *
- *               >0 - the first item is greater than the second               *
- *               =0 - the items are the same                                  *
- *                                                                            *
- * Comments: this function is used to sort delete queue by itemids            *
- *                                                                            *
- ******************************************************************************/
-static int	hk_item_update_cache_compare(const void *d1, const void *d2)
-{
-	zbx_hk_delete_queue_t	*r1 = *(zbx_hk_delete_queue_t **)d1;
-	zbx_hk_delete_queue_t	*r2 = *(zbx_hk_delete_queue_t **)d2;
-
-	ZBX_RETURN_IF_NOT_EQUAL(r1->itemid, r2->itemid);
-
-	return 0;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: add item to the delete queue if necessary                         *
@@ -529,7 +522,7 @@ static void	hk_history_delete_queue_prepare_all(zbx_hk_history_rule_t *rules, in
 	/* prepare history item cache (hashset containing itemid:min_clock values) */
 	for (zbx_hk_history_rule_t *rule = rules; NULL != rule->table; rule++)
 	{
-		if (ZBX_HK_MODE_REGULAR == *rule->poption_mode)
+		if (ZBX_HK_MODE_REGULAR == *rule->poption_mode && 0 == rule->partitioned)
 		{
 			if (0 == rule->item_cache.num_slots)
 				hk_history_prepare(rule);
@@ -563,6 +556,62 @@ static void	hk_history_delete_queue_clear(zbx_hk_history_rule_t *rule)
 			(zbx_hk_delete_queue_ptr_free_func_t)zbx_ptr_free);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: delete limited count of rows from table                           *
+ *                                                                            *
+ * Return value: number of deleted rows or less than 0 if an error occurred   *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBdelete_from_table(const char *tablename, const char *filter, int limit)
+{
+	if (0 == limit)
+	{
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+	}
+	else
+	{
+#if defined(HAVE_ORACLE)
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s"
+					" and rownum<=%d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_MYSQL)
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s limit %d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_POSTGRESQL)
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s and ctid = any(array(select ctid from %s"
+					" where %s limit %d))",
+				tablename,
+				filter,
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_SQLITE3)
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+#endif
+	}
+
+	return 0;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: drop appropriate partitions                                       *
@@ -650,16 +699,355 @@ static void 	hk_update_dbversion_status(void)
 }
 #endif
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets native range partitions of history (trends) table            *
+ *                                                                            *
+ * Parameters: table      - [IN] history (trends) table name                  *
+ *             partitions - [OUT] table partitions                            *
+ *                                                                            *
+ * Return value: SUCCEED - the table is range partitioned                     *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Only PostgreSQL declarative partitioning and MySQL RANGE         *
+ *           partitioning by the clock column are supported. Tables           *
+ *           partitioned by other columns or with bounds that are not valid   *
+ *           timestamps are not housekept by partitions.                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_get(const char *table, zbx_vector_hk_partition_ptr_t *partitions)
+{
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+	zbx_db_result_t	result;
+	zbx_db_row_t	row;
+	int		ret = FAIL;
+
+#if defined(HAVE_POSTGRESQL)
+	result = zbx_db_select(
+			"select c.relname,pg_get_expr(c.relpartbound,c.oid)"
+			" from pg_class p"
+				" left join pg_inherits i on i.inhparent=p.oid"
+				" left join pg_class c on c.oid=i.inhrelid"
+			" where p.relname='%s'"
+				" and p.relkind='p'"
+				" and pg_get_partkeydef(p.oid)='RANGE (clock)'"
+				" and pg_table_is_visible(p.oid)",
+			table);
+#else
+	result = zbx_db_select(
+			"select distinct partition_name,partition_description"
+			" from information_schema.partitions"
+			" where table_schema=database()"
+				" and table_name='%s'"
+				" and partition_method='RANGE'"
+				" and trim(both '`' from partition_expression)='clock'",
+			table);
+#endif
+	if (NULL == result)
+		return FAIL;
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_hk_partition_t	*partition;
+		int			clock_to;
+
+		ret = SUCCEED;
+
+		if (SUCCEED == zbx_db_is_null(row[0]))
+			continue;
+
+		if (SUCCEED == zbx_db_is_null(row[1]) || SUCCEED != hk_partition_parse_bound(row[1], &clock_to))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "unsupported bound \"%s\" of partition \"%s\" of table \"%s\"",
+					ZBX_NULL2EMPTY_STR(row[1]), row[0], table);
+			ret = FAIL;
+			break;
+		}
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, row[0]);
+		partition->clock_to = clock_to;
+
+		zbx_vector_hk_partition_ptr_append(partitions, partition);
+	}
+	zbx_db_free_result(result);
+
+	return ret;
+#else
+	ZBX_UNUSED(table);
+	ZBX_UNUSED(partitions);
+
+	return FAIL;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates native range partition of history (trends) table          *
+ *                                                                            *
+ * Parameters: table      - [IN] history (trends) table name                  *
+ *             clock_from - [IN] partition lower bound (inclusive)            *
+ *             clock_to   - [IN] partition upper bound (exclusive)            *
+ *                                                                            *
+ * Return value: SUCCEED - the partition was created                          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_create(const char *table, int clock_from, int clock_to)
+{
+	time_t		from = (time_t)clock_from;
+	struct tm	tm;
+	int		rc;
+
+	gmtime_r(&from, &tm);
+
+#if defined(HAVE_POSTGRESQL)
+	rc = zbx_db_execute("create table %s_p%04d%02d%02d partition of %s for values from (%d) to (%d)", table,
+			tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, table, clock_from, clock_to);
+#elif defined(HAVE_MYSQL)
+	rc = zbx_db_execute("alter table %s add partition (partition p%04d%02d%02d values less than (%d))", table,
+			tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, clock_to);
+#else
+	rc = ZBX_DB_FAIL;
+#endif
+	if (ZBX_DB_OK > rc)
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot create partition of table \"%s\" for period %d-%d", table,
+				clock_from, clock_to);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: drops native range partition of history (trends) table            *
+ *                                                                            *
+ * Parameters: table     - [IN] history (trends) table name                   *
+ *             partition - [IN] partition to drop                             *
+ *                                                                            *
+ * Return value: SUCCEED - the partition was dropped                          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_drop(const char *table, const zbx_hk_partition_t *partition)
+{
+	int	rc;
+
+#if defined(HAVE_POSTGRESQL)
+	rc = zbx_db_execute("drop table %s", partition->name);
+#elif defined(HAVE_MYSQL)
+	rc = zbx_db_execute("alter table %s drop partition %s", table, partition->name);
+#else
+	rc = ZBX_DB_FAIL;
+#endif
+	if (ZBX_DB_OK > rc)
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot drop partition \"%s\" of table \"%s\"", partition->name, table);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: detects which history (trends) tables can be housekept by         *
+ *          dropping native partitions                                        *
+ *                                                                            *
+ * Parameters: rules - [IN/OUT] history housekeeping rules                    *
+ *                                                                            *
+ * Comments: Partitions can be dropped only when item history (trends) period *
+ *           is overridden globally, otherwise the expired records are        *
+ *           removed per item.                                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_partitions_detect(zbx_hk_history_rule_t *rules)
+{
+	zbx_vector_hk_partition_ptr_t	partitions;
+
+	zbx_vector_hk_partition_ptr_create(&partitions);
+
+	for (zbx_hk_history_rule_t *rule = rules; NULL != rule->table; rule++)
+	{
+		unsigned char	partitioned = 0;
+
+		if (ZBX_HK_MODE_REGULAR == *rule->poption_mode && ZBX_HK_OPTION_ENABLED == *rule->poption_global &&
+				SUCCEED == hk_partitions_get(rule->table, &partitions))
+		{
+			partitioned = 1;
+		}
+
+		if (partitioned != rule->partitioned)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "%s housekeeping of natively partitioned table \"%s\"",
+					0 != partitioned ? "enabled" : "disabled", rule->table);
+
+			rule->partitioned = partitioned;
+		}
+
+		zbx_vector_hk_partition_ptr_clear_ext(&partitions, hk_partition_free);
+	}
+
+	zbx_vector_hk_partition_ptr_destroy(&partitions);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates future partitions and drops expired partitions of         *
+ *          natively partitioned history (trends) table                       *
+ *                                                                            *
+ * Parameters: rule  - [IN] history housekeeping rule                         *
+ *             now   - [IN] current timestamp                                 *
+ *             stats - [IN/OUT] housekeeping progress                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_partitions_maintain(const zbx_hk_history_rule_t *rule, int now,
+		zbx_hk_history_stats_t *stats)
+{
+	zbx_vector_hk_partition_ptr_t	partitions;
+	zbx_vector_uint64_pair_t	ranges;
+	int				period, keep_from, history = *rule->poption;
+	unsigned char			create = 1;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:%s now:%d", __func__, rule->table, now);
+
+	zbx_vector_hk_partition_ptr_create(&partitions);
+	zbx_vector_uint64_pair_create(&ranges);
+
+	if (SUCCEED != hk_partitions_get(rule->table, &partitions))
+		goto out;
+
+#if defined(HAVE_MYSQL)
+	for (int i = 0; i < partitions.values_num; i++)
+	{
+		/* partitions cannot be added after MAXVALUE partition without reorganizing it */
+		if (HK_PARTITION_UNBOUNDED == partitions.values[i]->clock_to)
+			create = 0;
+	}
+#endif
+	if (0 != create)
+	{
+		period = (0 == strcmp(rule->history, "trends") ? HK_PARTITION_PERIOD_TRENDS :
+				HK_PARTITION_PERIOD_HISTORY);
+
+		hk_partitions_get_create_ranges(&partitions, now, period, HK_PARTITION_PRECREATE, &ranges);
+
+		for (int i = 0; i < ranges.values_num; i++)
+		{
+			if (SUCCEED != hk_partition_create(rule->table, (int)ranges.values[i].first,
+					(int)ranges.values[i].second))
+			{
+				break;
+			}
+
+			stats->partitions_created++;
+		}
+	}
+
+	if (0 != history && (ZBX_HK_HISTORY_MIN > history || ZBX_HK_PERIOD_MAX < history))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period for table '%s'", rule->table);
+		goto out;
+	}
+
+	keep_from = now - history;
+
+	/* partition can be dropped only when all its records are expired */
+	for (int i = 0; i < partitions.values_num; i++)
+	{
+		zbx_hk_partition_t	*partition = partitions.values[i];
+
+		if (SUCCEED != hk_partition_is_expired(partition, keep_from))
+			continue;
+
+		if (SUCCEED == hk_partition_drop(rule->table, partition))
+			stats->partitions_dropped++;
+	}
+out:
+	zbx_vector_uint64_pair_destroy(&ranges);
+	zbx_vector_hk_partition_ptr_clear_ext(&partitions, hk_partition_free);
+	zbx_vector_hk_partition_ptr_destroy(&partitions);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() created:%d dropped:%d", __func__, stats->partitions_created,
+			stats->partitions_dropped);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes expired records of the items in history housekeeping      *
+ *          delete queue                                                      *
+ *                                                                            *
+ * Parameters: rule                 - [IN] history housekeeping rule          *
+ *             config_max_hk_delete - [IN] maximum number of records removed  *
+ *                                         by single statement, 0 - unlimited *
+ *             process_type         - [IN]                                    *
+ *             stats                - [IN/OUT] housekeeping progress          *
+ *                                                                            *
+ * Comments: Items sharing the same cutoff timestamp are removed together in  *
+ *           chunks of limited number of items and records to keep the        *
+ *           transactions short and avoid per item statement overhead.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_delete_queue_process(zbx_hk_history_rule_t *rule, int config_max_hk_delete,
+		unsigned char process_type, zbx_hk_history_stats_t *stats)
+{
+	zbx_vector_uint64_t	itemids;
+	char			*filter = NULL;
+	size_t			filter_alloc = 0, filter_offset;
+
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_uint64_reserve(&itemids, HK_DELETE_CHUNK_ITEMS);
+
+	zbx_vector_hk_delete_queue_ptr_sort(&rule->delete_queue, hk_delete_queue_compare);
+
+	for (int i = 0; i < rule->delete_queue.values_num;)
+	{
+		int	min_clock, rc;
+
+		min_clock = hk_delete_queue_get_chunk(&rule->delete_queue, &i, HK_DELETE_CHUNK_ITEMS, &itemids);
+
+		filter_offset = 0;
+		zbx_snprintf_alloc(&filter, &filter_alloc, &filter_offset, "clock<%d and", min_clock);
+		zbx_db_add_condition_alloc(&filter, &filter_alloc, &filter_offset, "itemid", itemids.values,
+				itemids.values_num);
+
+		do
+		{
+			if (ZBX_DB_OK > (rc = DBdelete_from_table(rule->table, filter, config_max_hk_delete)))
+				break;
+
+			stats->deleted += rc;
+			stats->chunks++;
+
+			zbx_setproctitle("%s [removing old history and trends: %s, deleted %d records in %d chunks]",
+					get_process_type_string(process_type), rule->table, stats->deleted,
+					stats->chunks);
+		}
+		while (0 != config_max_hk_delete && rc >= config_max_hk_delete);
+
+		zbx_vector_uint64_clear(&itemids);
+	}
+
+	zbx_free(filter);
+	zbx_vector_uint64_destroy(&itemids);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: performs housekeeping for history and trends tables               *
  *                                                                            *
- * Parameters: now - [IN] current timestamp                                   *
+ * Parameters: now                  - [IN] current timestamp                  *
+ *             config_max_hk_delete - [IN] maximum number of records removed  *
+ *                                         by single statement, 0 - unlimited *
+ *             process_type         - [IN]                                    *
+ *             stats                - [OUT] housekeeping progress             *
  *                                                                            *
  ******************************************************************************/
-static int	housekeeping_history_and_trends(int now)
+static void	housekeeping_history_and_trends(int now, int config_max_hk_delete, unsigned char process_type,
+		zbx_hk_history_stats_t *stats)
 {
-	int			deleted = 0;
 	zbx_hk_history_rule_t	*rule;
 #if defined(HAVE_POSTGRESQL)
 	int			ignore_history = 0, ignore_trends = 0;
@@ -667,6 +1055,11 @@ static int	housekeeping_history_and_trends(int now)
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() now:%d", __func__, now);
 
+	memset(stats, 0, sizeof(zbx_hk_history_stats_t));
+
+	/* natively partitioned tables are housekept by dropping partitions instead of delete queues */
+	hk_history_partitions_detect(hk_history_rules);
+
 	/* prepare delete queues for all history housekeeping rules */
 	hk_history_delete_queue_prepare_all(hk_history_rules, now);
 
@@ -682,6 +1075,12 @@ static int	housekeeping_history_and_trends(int now)
 		if (ZBX_HK_MODE_DISABLED == *rule->poption_mode)
 			goto skip;
 
+		if (0 != rule->partitioned)
+		{
+			hk_history_partitions_maintain(rule, now, stats);
+			goto skip;
+		}
+
 		if (SUCCEED == hk_history_rules_partition_is_table_name_excluded(rule->table))
 			goto process_delete_queue_for_housekeeping_rule;
 
@@ -731,25 +1130,14 @@ static int	housekeeping_history_and_trends(int now)
 		}
 #endif
 process_delete_queue_for_housekeeping_rule:
-		zbx_vector_hk_delete_queue_ptr_sort(&rule->delete_queue, hk_item_update_cache_compare);
-
-		for (int i = 0; i < rule->delete_queue.values_num; i++)
-		{
-			zbx_hk_delete_queue_t	*item_record = (zbx_hk_delete_queue_t *)rule->delete_queue.values[i];
-			int	rc = zbx_db_execute("delete from %s where itemid=" ZBX_FS_UI64 " and clock<%d",
-					rule->table, item_record->itemid, item_record->min_clock);
-
-			if (ZBX_DB_OK < rc)
-				deleted += rc;
-		}
+		hk_history_delete_queue_process(rule, config_max_hk_delete, process_type, stats);
 skip:
 		/* clear history rule delete queue so it's ready for the next housekeeping cycle */
 		hk_history_delete_queue_clear(rule);
 	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __func__, deleted);
-
-	return deleted;
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() deleted:%d chunks:%d partitions created:%d dropped:%d", __func__,
+			stats->deleted, stats->chunks, stats->partitions_created, stats->partitions_dropped);
 }
 
 /*******************************************************************************************
@@ -904,62 +1292,6 @@ ret:
 	return deleted;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: delete limited count of rows from table                           *
- *                                                                            *
- * Return value: number of deleted rows or less than 0 if an error occurred   *
- *                                                                            *
- ******************************************************************************/
-static int	DBdelete_from_table(const char *tablename, const char *filter, int limit)
-{
-	if (0 == limit)
-	{
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s",
-				tablename,
-				filter);
-	}
-	else
-	{
-#if defined(HAVE_ORACLE)
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s"
-					" and rownum<=%d",
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_MYSQL)
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s limit %d",
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_POSTGRESQL)
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s and ctid = any(array(select ctid from %s"
-					" where %s limit %d))",
-				tablename,
-				filter,
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_SQLITE3)
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s",
-				tablename,
-				filter);
-#endif
-	}
-
-	return 0;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: perform problem table cleanup                                     *
@@ -1453,9 +1785,10 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 
 	while (ZBX_IS_RUNNING())
 	{
-		zbx_uint32_t	rtc_cmd;
-		unsigned char	*rtc_data;
-		int		now, hk_execute = 0;
+		zbx_uint32_t		rtc_cmd;
+		unsigned char		*rtc_data;
+		int			now, hk_execute = 0;
+		zbx_hk_history_stats_t	hk_stats;
 
 		sec = zbx_time();
 
@@ -1515,7 +1848,9 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		zbx_setproctitle("%s [removing old history and trends]",
 				get_process_type_string(process_type));
 		sec = zbx_time();
-		int	d_history_and_trends = housekeeping_history_and_trends(now);
+		housekeeping_history_and_trends(now, housekeeper_args_in->config_max_housekeeper_delete, process_type,
+				&hk_stats);
+		int	d_history_and_trends = hk_stats.deleted;
 
 		zbx_setproctitle("%s [removing old problems]", get_process_type_string(process_type));
 		int	d_problems = housekeeping_problems(now, housekeeper_args_in->config_housekeeping_frequency);
@@ -1542,10 +1877,11 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		int	d_cleanup = housekeeping_cleanup(housekeeper_args_in->config_housekeeping_frequency);
 		sec = zbx_time() - sec;
 
-		zabbix_log(LOG_LEVEL_WARNING, "%s [deleted %d hist/trends, %d items/triggers, %d events, %d problems,"
-				" %d sessions, %d alarms, %d audit, %d autoreg_host, %d records in " ZBX_FS_DBL
-				" sec, %s]",
-				get_process_type_string(process_type), d_history_and_trends, d_cleanup, d_events,
+		zabbix_log(LOG_LEVEL_WARNING, "%s [deleted %d hist/trends in %d chunks, %d/%d partitions created/dropped,"
+				" %d items/triggers, %d events, %d problems, %d sessions, %d alarms, %d audit,"
+				" %d autoreg_host, %d records in " ZBX_FS_DBL " sec, %s]",
+				get_process_type_string(process_type), d_history_and_trends, hk_stats.chunks,
+				hk_stats.partitions_created, hk_stats.partitions_dropped, d_cleanup, d_events,
 				d_problems, d_sessions, d_services, d_audit, d_autoreg_host, records, sec, sleeptext);
 
 		zbx_config_clean(&cfg);
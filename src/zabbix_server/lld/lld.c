@@ -27,6 +27,9 @@
 #include "zbx_trigger_constants.h"
 #include "zbx_item_constants.h"
 #include "zbxvariant.h"
+#include "zbxdbhigh.h"
+#include "zbxcacheconfig.h"
+#include "lld_fingerprint.h"
 
 /* lld rule filter condition (item_condition table record) */
 typedef struct
@@ -35,6 +38,7 @@ typedef struct
 	char			*macro;
 	char			*regexp;
 	zbx_vector_expression_t	regexps;
+	zbx_regexp_set_t	*regexp_set;
 	unsigned char		op;
 }
 lld_condition_t;
@@ -54,6 +58,9 @@ ZBX_PTR_VECTOR_IMPL(lld_row, zbx_lld_row_t*)
  ******************************************************************************/
 static void	lld_condition_free(lld_condition_t *condition)
 {
+	if (NULL != condition->regexp_set)
+		zbx_regexp_set_free(condition->regexp_set);
+
 	zbx_regexp_clean_expressions(&condition->regexps);
 	zbx_vector_expression_destroy(&condition->regexps);
 
@@ -121,6 +128,7 @@ static int	lld_filter_condition_add(zbx_vector_ptr_t *conditions, const char *id
 	condition->macro = zbx_strdup(NULL, macro);
 	condition->regexp = zbx_strdup(NULL, regexp);
 	condition->op = (unsigned char)atoi(op);
+	condition->regexp_set = NULL;
 
 	zbx_vector_expression_create(&condition->regexps);
 
@@ -143,6 +151,9 @@ static int	lld_filter_condition_add(zbx_vector_ptr_t *conditions, const char *id
 				&condition->regexp, ZBX_MACRO_TYPE_LLD_FILTER, NULL, 0);
 	}
 
+	/* the condition is tested against every discovered row, compile it once */
+	condition->regexp_set = zbx_regexp_set_create(&condition->regexps, condition->regexp, ZBX_CASE_SENSITIVE);
+
 	return SUCCEED;
 }
 
@@ -217,7 +228,7 @@ static int	filter_condition_match(const struct zbx_json_parse *jp_row,
 		}
 		else
 		{
-			switch (zbx_regexp_match_ex(&condition->regexps, value, condition->regexp, ZBX_CASE_SENSITIVE))
+			switch (zbx_regexp_set_match(condition->regexp_set, value))
 			{
 				case ZBX_REGEXP_MATCH:
 					*result = (ZBX_CONDITION_OPERATOR_REGEXP == condition->op ? 1 : 0);
@@ -1065,6 +1076,427 @@ static void	lld_row_free(zbx_lld_row_t *lld_row)
 	zbx_free(lld_row);
 }
 
+/* sets of objects defining discovery rule configuration */
+#define LLD_RULE_SET_RULE		0
+#define LLD_RULE_SET_ITEM		1
+#define LLD_RULE_SET_TRIGGER		2
+#define LLD_RULE_SET_GRAPH		3
+#define LLD_RULE_SET_HOST		4
+#define LLD_RULE_SET_GROUP		5
+#define LLD_RULE_SET_INTERFACE		6
+#define LLD_RULE_SET_OVERRIDE		7
+#define LLD_RULE_SET_OPERATION		8
+#define LLD_RULE_SET_NUM		9
+
+/* discovery rule object set, selected by parent object set */
+typedef struct
+{
+	int		set;
+	const char	*query;
+	const char	*parent_field;
+	int		parent_set;
+}
+lld_rule_set_query_t;
+
+/* table with configuration or discovered objects of discovery rule */
+typedef struct
+{
+	const char	*table;
+	const char	*field;
+	int		set;
+
+	/* the fields included in revision digest, NULL - all table fields */
+	const char	*fields;
+}
+lld_rule_table_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: selects identifiers of the objects defining discovery rule        *
+ *          configuration                                                     *
+ *                                                                            *
+ * Parameters: lld_ruleid - [IN] discovery rule identifier                    *
+ *             sets       - [OUT] object identifier sets                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rule_get_sets(zbx_uint64_t lld_ruleid, zbx_vector_uint64_t *sets)
+{
+	/* parent sets must be selected before child sets */
+	static const lld_rule_set_query_t	queries[] = {
+		{LLD_RULE_SET_ITEM, "select itemid from item_discovery where", "parent_itemid", LLD_RULE_SET_RULE},
+		{LLD_RULE_SET_TRIGGER, "select distinct triggerid from functions where", "itemid", LLD_RULE_SET_ITEM},
+		{LLD_RULE_SET_GRAPH, "select distinct graphid from graphs_items where", "itemid", LLD_RULE_SET_ITEM},
+		{LLD_RULE_SET_HOST, "select hostid from host_discovery where", "parent_itemid", LLD_RULE_SET_RULE},
+		{LLD_RULE_SET_GROUP, "select group_prototypeid from group_prototype where", "hostid",
+				LLD_RULE_SET_HOST},
+		{LLD_RULE_SET_INTERFACE, "select interfaceid from interface where", "hostid", LLD_RULE_SET_HOST},
+		{LLD_RULE_SET_OVERRIDE, "select lld_overrideid from lld_override where", "itemid", LLD_RULE_SET_RULE},
+		{LLD_RULE_SET_OPERATION, "select lld_override_operationid from lld_override_operation where",
+				"lld_overrideid", LLD_RULE_SET_OVERRIDE}
+	};
+
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset;
+
+	zbx_vector_uint64_append(&sets[LLD_RULE_SET_RULE], lld_ruleid);
+
+	for (int i = 0; i < (int)ARRSIZE(queries); i++)
+	{
+		zbx_vector_uint64_t	*parent = &sets[queries[i].parent_set];
+		zbx_db_result_t		result;
+		zbx_db_row_t		row;
+
+		if (0 == parent->values_num)
+			continue;
+
+		sql_offset = 0;
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, queries[i].query);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, queries[i].parent_field, parent->values,
+				parent->values_num);
+
+		result = zbx_db_select("%s", sql);
+
+		while (NULL != (row = zbx_db_fetch(result)))
+		{
+			zbx_uint64_t	id;
+
+			ZBX_STR2UINT64(id, row[0]);
+			zbx_vector_uint64_append(&sets[queries[i].set], id);
+		}
+		zbx_db_free_result(result);
+
+		zbx_vector_uint64_sort(&sets[queries[i].set], ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+
+	zbx_free(sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates configuration revision of discovery rule               *
+ *                                                                            *
+ * Parameters: sets     - [IN] identifiers of the objects defining discovery  *
+ *                             rule configuration                             *
+ *             revision - [IN] revision of the rule configuration in          *
+ *                             configuration cache                            *
+ *                                                                            *
+ * Return value: The configuration revision.                                  *
+ *                                                                            *
+ * Comments: Trigger, graph and host prototypes, filters, overrides and item  *
+ *           prototype details are not stored in configuration cache, so      *
+ *           their records are included in the revision digest. The links to  *
+ *           discovered objects are included too, so objects removed by user  *
+ *           are discovered again. Last check time is excluded as it's        *
+ *           updated by every processing.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	lld_rule_calc_revision(const zbx_vector_uint64_t *sets, zbx_uint64_t revision)
+{
+	static const lld_rule_table_t	tables[] = {
+		{"items", "itemid", LLD_RULE_SET_RULE},
+		{"item_condition", "itemid", LLD_RULE_SET_RULE},
+		{"lld_macro_path", "itemid", LLD_RULE_SET_RULE},
+		{"lld_override", "itemid", LLD_RULE_SET_RULE},
+		{"lld_override_condition", "lld_overrideid", LLD_RULE_SET_OVERRIDE},
+		{"lld_override_operation", "lld_overrideid", LLD_RULE_SET_OVERRIDE},
+		{"lld_override_opstatus", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"lld_override_opdiscover", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"lld_override_opperiod", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"lld_override_ophistory", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"lld_override_optrends", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"lld_override_opseverity", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"lld_override_optag", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"lld_override_optemplate", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"lld_override_opinventory", "lld_override_operationid", LLD_RULE_SET_OPERATION},
+		{"items", "itemid", LLD_RULE_SET_ITEM},
+		{"item_preproc", "itemid", LLD_RULE_SET_ITEM},
+		{"item_tag", "itemid", LLD_RULE_SET_ITEM},
+		{"item_parameter", "itemid", LLD_RULE_SET_ITEM},
+		{"triggers", "triggerid", LLD_RULE_SET_TRIGGER},
+		{"functions", "triggerid", LLD_RULE_SET_TRIGGER},
+		{"trigger_tag", "triggerid", LLD_RULE_SET_TRIGGER},
+		{"trigger_depends", "triggerid_down", LLD_RULE_SET_TRIGGER},
+		{"graphs", "graphid", LLD_RULE_SET_GRAPH},
+		{"graphs_items", "graphid", LLD_RULE_SET_GRAPH},
+		{"hosts", "hostid", LLD_RULE_SET_HOST},
+		{"group_prototype", "hostid", LLD_RULE_SET_HOST},
+		{"hosts_templates", "hostid", LLD_RULE_SET_HOST},
+		{"hostmacro", "hostid", LLD_RULE_SET_HOST},
+		{"interface", "hostid", LLD_RULE_SET_HOST},
+		{"host_tag", "hostid", LLD_RULE_SET_HOST},
+		{"host_inventory", "hostid", LLD_RULE_SET_HOST},
+		{"interface_snmp", "interfaceid", LLD_RULE_SET_INTERFACE},
+		{"item_discovery", "parent_itemid", LLD_RULE_SET_ITEM, "itemid,parent_itemid,key_,ts_delete"},
+		{"trigger_discovery", "parent_triggerid", LLD_RULE_SET_TRIGGER, "triggerid,parent_triggerid,ts_delete"},
+		{"graph_discovery", "parent_graphid", LLD_RULE_SET_GRAPH, "graphid,parent_graphid,ts_delete"},
+		{"host_discovery", "parent_hostid", LLD_RULE_SET_HOST, "hostid,parent_hostid,host,ts_delete"},
+		{"group_discovery", "parent_group_prototypeid", LLD_RULE_SET_GROUP,
+				"groupid,parent_group_prototypeid,name,ts_delete"}
+	};
+
+	md5_state_t	state;
+	md5_byte_t	digest[ZBX_MD5_DIGEST_SIZE];
+	char		*sql = NULL;
+	size_t		sql_alloc = 0, sql_offset;
+
+	zbx_md5_init(&state);
+	zbx_md5_append(&state, (const md5_byte_t *)&revision, sizeof(revision));
+
+	for (int i = 0; i < (int)ARRSIZE(tables); i++)
+	{
+		const zbx_vector_uint64_t	*ids = &sets[tables[i].set];
+		const zbx_db_table_t		*table;
+		zbx_db_result_t			result;
+		zbx_db_row_t			row;
+		int				fields_num;
+
+		if (0 == ids->values_num || NULL == (table = zbx_db_get_table(tables[i].table)))
+			continue;
+
+		sql_offset = 0;
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select ");
+
+		if (NULL != tables[i].fields)
+		{
+			const char	*ptr = tables[i].fields;
+
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ptr);
+
+			for (fields_num = 1; NULL != (ptr = strchr(ptr, ',')); ptr++)
+				fields_num++;
+		}
+		else
+		{
+			for (fields_num = 0; NULL != table->fields[fields_num].name; fields_num++)
+			{
+				if (0 != fields_num)
+					zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+				zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, table->fields[fields_num].name);
+			}
+		}
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " from %s where", table->table);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, tables[i].field, ids->values,
+				ids->values_num);
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " order by %s", table->recid);
+
+		/* table name separates records of different tables in the digest */
+		zbx_md5_append(&state, (const md5_byte_t *)table->table, (int)strlen(table->table) + 1);
+
+		result = zbx_db_select("%s", sql);
+
+		while (NULL != (row = zbx_db_fetch(result)))
+		{
+			for (int j = 0; j < fields_num; j++)
+			{
+				if (SUCCEED == zbx_db_is_null(row[j]))
+					zbx_md5_append(&state, (const md5_byte_t *)"\001", 1);
+				else
+					zbx_md5_append(&state, (const md5_byte_t *)row[j], (int)strlen(row[j]) + 1);
+			}
+		}
+		zbx_db_free_result(result);
+	}
+
+	zbx_free(sql);
+
+	zbx_md5_finish(&state, digest);
+
+	return lld_digest_revision(digest);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts lost objects of discovery rule with expired lifetime       *
+ *                                                                            *
+ * Parameters: sets - [IN] identifiers of the objects defining discovery rule *
+ *                         configuration                                      *
+ *             now  - [IN] current time                                       *
+ *                                                                            *
+ * Return value: The number of lost objects that must be removed.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	lld_rule_get_expired_num(const zbx_vector_uint64_t *sets, int now)
+{
+	static const lld_rule_table_t	tables[] = {
+		{"item_discovery", "parent_itemid", LLD_RULE_SET_ITEM},
+		{"trigger_discovery", "parent_triggerid", LLD_RULE_SET_TRIGGER},
+		{"graph_discovery", "parent_graphid", LLD_RULE_SET_GRAPH},
+		{"host_discovery", "parent_hostid", LLD_RULE_SET_HOST},
+		{"group_discovery", "parent_group_prototypeid", LLD_RULE_SET_GROUP}
+	};
+
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset;
+	int	expired_num = 0;
+
+	for (int i = 0; i < (int)ARRSIZE(tables) && 0 == expired_num; i++)
+	{
+		const zbx_vector_uint64_t	*ids = &sets[tables[i].set];
+		zbx_db_result_t			result;
+
+		if (0 == ids->values_num)
+			continue;
+
+		sql_offset = 0;
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select null from %s where ts_delete<>0"
+				" and ts_delete<%d and", tables[i].table, now);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, tables[i].field, ids->values,
+				ids->values_num);
+
+		result = zbx_db_select_n(sql, 1);
+
+		if (NULL != zbx_db_fetch(result))
+			expired_num++;
+
+		zbx_db_free_result(result);
+	}
+
+	zbx_free(sql);
+
+	return expired_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates last check time of the objects still being discovered by  *
+ *          discovery rule                                                    *
+ *                                                                            *
+ * Parameters: sets - [IN] identifiers of the objects defining discovery rule *
+ *                         configuration                                      *
+ *             now  - [IN] current time                                       *
+ *                                                                            *
+ * Comments: When discovery data is not changed the objects still being       *
+ *           discovered are the ones without scheduled removal.               *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rule_update_lastcheck(const zbx_vector_uint64_t *sets, int now)
+{
+	static const lld_rule_table_t	tables[] = {
+		{"item_discovery", "parent_itemid", LLD_RULE_SET_ITEM},
+		{"trigger_discovery", "parent_triggerid", LLD_RULE_SET_TRIGGER},
+		{"graph_discovery", "parent_graphid", LLD_RULE_SET_GRAPH},
+		{"host_discovery", "parent_hostid", LLD_RULE_SET_HOST},
+		{"group_discovery", "parent_group_prototypeid", LLD_RULE_SET_GROUP}
+	};
+
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset = 0;
+
+	zbx_db_begin();
+	zbx_db_begin_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+	for (int i = 0; i < (int)ARRSIZE(tables); i++)
+	{
+		const zbx_vector_uint64_t	*ids = &sets[tables[i].set];
+
+		if (0 == ids->values_num)
+			continue;
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "update %s set lastcheck=%d where ts_delete=0 and",
+				tables[i].table, now);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, tables[i].field, ids->values,
+				ids->values_num);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\n");
+
+		zbx_db_execute_overflowed_sql(&sql, &sql_alloc, &sql_offset);
+	}
+
+	zbx_db_end_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+	if (16 < sql_offset)	/* in ORACLE always present begin..end; */
+		zbx_db_execute("%s", sql);
+
+	zbx_db_commit();
+
+	zbx_free(sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if discovery rule configuration and discovered objects     *
+ *          were not changed since the last processing of the same data       *
+ *                                                                            *
+ * Parameters: lld_ruleid    - [IN] discovery rule identifier                 *
+ *             last_revision - [IN] configuration revision of the last        *
+ *                                  processing of the same data               *
+ *                                                                            *
+ * Return value: SUCCEED - the processing can be skipped, last check time of  *
+ *                         the discovered objects was updated                 *
+ *               FAIL    - the rule must be processed                         *
+ *                                                                            *
+ ******************************************************************************/
+int	lld_rule_check_unchanged(zbx_uint64_t lld_ruleid, zbx_uint64_t last_revision)
+{
+	zbx_vector_uint64_t	sets[LLD_RULE_SET_NUM];
+	zbx_uint64_t		cache_revision, revision;
+	int			ret = FAIL, now;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() lld_ruleid:" ZBX_FS_UI64 " last_revision:" ZBX_FS_UI64, __func__,
+			lld_ruleid, last_revision);
+
+	/* the revision is calculated only for the data received and processed again */
+	if (LLD_RULE_REVISION_UNKNOWN >= last_revision)
+		goto out;
+
+	if (SUCCEED != zbx_dc_get_lld_rule_revision(lld_ruleid, &cache_revision))
+		goto out;
+
+	for (int i = 0; i < LLD_RULE_SET_NUM; i++)
+		zbx_vector_uint64_create(&sets[i]);
+
+	now = (int)time(NULL);
+
+	lld_rule_get_sets(lld_ruleid, sets);
+	revision = lld_rule_calc_revision(sets, cache_revision);
+
+	if (SUCCEED == (ret = lld_rule_is_unchanged(last_revision, revision, lld_rule_get_expired_num(sets, now))))
+		lld_rule_update_lastcheck(sets, now);
+
+	for (int i = 0; i < LLD_RULE_SET_NUM; i++)
+		zbx_vector_uint64_destroy(&sets[i]);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates configuration revision of processed discovery rule     *
+ *                                                                            *
+ * Parameters: lld_ruleid - [IN] discovery rule identifier                    *
+ *                                                                            *
+ * Return value: The configuration revision covering the rule, its            *
+ *               prototypes, filters, overrides and discovered objects or 0   *
+ *               if the rule is not found in configuration cache.             *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	lld_rule_get_revision(zbx_uint64_t lld_ruleid)
+{
+	zbx_vector_uint64_t	sets[LLD_RULE_SET_NUM];
+	zbx_uint64_t		cache_revision, revision = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() lld_ruleid:" ZBX_FS_UI64, __func__, lld_ruleid);
+
+	if (SUCCEED != zbx_dc_get_lld_rule_revision(lld_ruleid, &cache_revision))
+		goto out;
+
+	for (int i = 0; i < LLD_RULE_SET_NUM; i++)
+		zbx_vector_uint64_create(&sets[i]);
+
+	lld_rule_get_sets(lld_ruleid, sets);
+	revision = lld_rule_calc_revision(sets, cache_revision);
+
+	for (int i = 0; i < LLD_RULE_SET_NUM; i++)
+		zbx_vector_uint64_destroy(&sets[i]);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() revision:" ZBX_FS_UI64, __func__, revision);
+
+	return revision;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add or update items, triggers and graphs for discovery item       *
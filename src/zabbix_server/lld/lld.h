@@ -146,7 +146,6 @@ typedef struct
 	unsigned char		authtype;
 	unsigned char		allow_traps;
 	unsigned char		discover;
-	zbx_vector_lld_row_t	lld_rows;
 	zbx_vector_lld_item_preproc_t	preproc_ops;
 	zbx_vector_item_param_ptr_t	item_params;
 	zbx_vector_db_tag_ptr_t	item_tags;
@@ -326,5 +325,7 @@ void	lld_remove_lost_objects(const char *table, const char *id_name, const zbx_v
 		int lifetime, int lastcheck, delete_ids_f cb, get_object_info_f cb_info);
 
 int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char **error);
+int	lld_rule_check_unchanged(zbx_uint64_t lld_ruleid, zbx_uint64_t last_revision);
+zbx_uint64_t	lld_rule_get_revision(zbx_uint64_t lld_ruleid);
 
 #endif
@@ -0,0 +1,217 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "lld_fingerprint.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates digest of discovery data ignoring whitespace outside   *
+ *          of JSON strings                                                   *
+ *                                                                            *
+ * Parameters: value  - [IN] discovery data                                   *
+ *             error  - [IN] discovery error                                  *
+ *             meta   - [IN] 1 if the value has log meta information          *
+ *             digest - [OUT]                                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the digest was calculated                          *
+ *               FAIL    - the value must always be processed (errors and     *
+ *                         meta information), digest is not calculated        *
+ *                                                                            *
+ ******************************************************************************/
+int	lld_value_digest(const char *value, const char *error, unsigned char meta, md5_byte_t *digest)
+{
+	md5_state_t	state;
+	const char	*ptr, *start;
+	int		quoted = 0;
+
+	if (NULL == value || NULL != error || 0 != meta)
+		return FAIL;
+
+	zbx_md5_init(&state);
+
+	for (ptr = start = value; '\0' != *ptr; ptr++)
+	{
+		if (0 != quoted)
+		{
+			if ('\\' == *ptr && '\0' != ptr[1])
+				ptr++;
+			else if ('"' == *ptr)
+				quoted = 0;
+
+			continue;
+		}
+
+		switch (*ptr)
+		{
+			case '"':
+				quoted = 1;
+				break;
+			case ' ':
+			case '\t':
+			case '\r':
+			case '\n':
+				zbx_md5_append(&state, (const md5_byte_t *)start, (int)(ptr - start));
+				start = ptr + 1;
+				break;
+		}
+	}
+
+	zbx_md5_append(&state, (const md5_byte_t *)start, (int)(ptr - start));
+	zbx_md5_finish(&state, digest);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: converts configuration digest to non-zero revision                *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	lld_digest_revision(const md5_byte_t *digest)
+{
+	zbx_uint64_t	revision = 0;
+
+	for (int i = 0; i < (int)sizeof(revision); i++)
+		revision = (revision << 8) | digest[i];
+
+	/* zero and unknown revisions have special meaning */
+	return LLD_RULE_REVISION_UNKNOWN < revision ? revision : LLD_RULE_REVISION_UNKNOWN + 1;
+}
+
+void	lld_fingerprints_init(zbx_hashset_t *fingerprints)
+{
+	zbx_hashset_create(fingerprints, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns configuration revision of the last processing of the      *
+ *          same discovery data                                               *
+ *                                                                            *
+ * Parameters: fingerprints - [IN] fingerprint index                          *
+ *             itemid       - [IN] discovery rule identifier                  *
+ *             digest       - [IN] digest of the data to be processed or NULL *
+ *                                 if the data must be processed              *
+ *                                                                            *
+ * Return value: The configuration revision or 0 if the data must be          *
+ *               processed.                                                   *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	lld_fingerprint_get_revision(zbx_hashset_t *fingerprints, zbx_uint64_t itemid,
+		const md5_byte_t *digest)
+{
+	zbx_lld_fingerprint_t	*fingerprint;
+
+	if (NULL == digest)
+		return 0;
+
+	if (NULL == (fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_search(fingerprints, &itemid)))
+		return 0;
+
+	if (0 != memcmp(fingerprint->digest, digest, sizeof(fingerprint->digest)))
+		return 0;
+
+	return fingerprint->revision;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates fingerprint of processed (or skipped) discovery data      *
+ *                                                                            *
+ * Parameters: fingerprints - [IN/OUT] fingerprint index                      *
+ *             itemid       - [IN] discovery rule identifier                  *
+ *             digest       - [IN] digest of the processed data or NULL if    *
+ *                                 the data must always be processed          *
+ *             revision     - [IN] configuration revision reported by worker, *
+ *                                 0 if the data was not processed            *
+ *                                 successfully                               *
+ *             now          - [IN] current time                               *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_fingerprint_update(zbx_hashset_t *fingerprints, zbx_uint64_t itemid, const md5_byte_t *digest,
+		zbx_uint64_t revision, time_t now)
+{
+	zbx_lld_fingerprint_t	*fingerprint;
+
+	if (NULL == digest || 0 == revision)
+	{
+		zbx_hashset_remove(fingerprints, &itemid);
+		return;
+	}
+
+	if (NULL == (fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_search(fingerprints, &itemid)))
+	{
+		zbx_lld_fingerprint_t	fingerprint_local = {.itemid = itemid};
+
+		fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_insert(fingerprints, &fingerprint_local,
+				sizeof(fingerprint_local));
+	}
+
+	fingerprint->revision = revision;
+	fingerprint->lastaccess = now;
+	memcpy(fingerprint->digest, digest, sizeof(fingerprint->digest));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes fingerprints of discovery rules that are no longer        *
+ *          receiving data                                                    *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_fingerprints_remove_inactive(zbx_hashset_t *fingerprints, time_t now, int ttl)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_lld_fingerprint_t	*fingerprint;
+
+	zbx_hashset_iter_reset(fingerprints, &iter);
+	while (NULL != (fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (ttl <= now - fingerprint->lastaccess)
+			zbx_hashset_iter_remove(&iter);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if discovery rule processing can be skipped                *
+ *                                                                            *
+ * Parameters: last_revision - [IN] configuration revision of the last        *
+ *                                  processing of the same data, 0 if the     *
+ *                                  data was changed or                       *
+ *                                  LLD_RULE_REVISION_UNKNOWN if revision was *
+ *                                  not calculated                            *
+ *             revision      - [IN] the current configuration revision        *
+ *             expired_num   - [IN] the number of lost objects with expired   *
+ *                                  lifetime                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the data and configuration were not changed and    *
+ *                         there are no lost objects to remove                *
+ *               FAIL    - the rule must be processed                         *
+ *                                                                            *
+ ******************************************************************************/
+int	lld_rule_is_unchanged(zbx_uint64_t last_revision, zbx_uint64_t revision, int expired_num)
+{
+	if (LLD_RULE_REVISION_UNKNOWN >= last_revision || last_revision != revision)
+		return FAIL;
+
+	if (0 != expired_num)
+		return FAIL;
+
+	return SUCCEED;
+}
@@ -0,0 +1,57 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_LLD_FINGERPRINT_H
+#define ZABBIX_LLD_FINGERPRINT_H
+
+#include "zbxalgo.h"
+#include "zbxhash.h"
+
+/* the data was processed successfully, but configuration revision was not calculated, */
+/* because it's calculated only for the data received the second time                 */
+#define LLD_RULE_REVISION_UNKNOWN	1
+
+/* fingerprint of the last successfully processed discovery rule data */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+
+	/* configuration revision the data was processed with */
+	zbx_uint64_t	revision;
+
+	/* the last time the fingerprint was used */
+	time_t		lastaccess;
+
+	md5_byte_t	digest[ZBX_MD5_DIGEST_SIZE];
+}
+zbx_lld_fingerprint_t;
+
+int		lld_value_digest(const char *value, const char *error, unsigned char meta, md5_byte_t *digest);
+zbx_uint64_t	lld_digest_revision(const md5_byte_t *digest);
+
+void		lld_fingerprints_init(zbx_hashset_t *fingerprints);
+zbx_uint64_t	lld_fingerprint_get_revision(zbx_hashset_t *fingerprints, zbx_uint64_t itemid,
+		const md5_byte_t *digest);
+void		lld_fingerprint_update(zbx_hashset_t *fingerprints, zbx_uint64_t itemid, const md5_byte_t *digest,
+		zbx_uint64_t revision, time_t now);
+void		lld_fingerprints_remove_inactive(zbx_hashset_t *fingerprints, time_t now, int ttl);
+
+int		lld_rule_is_unchanged(zbx_uint64_t last_revision, zbx_uint64_t revision, int expired_num);
+
+#endif
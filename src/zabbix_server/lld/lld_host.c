@@ -293,6 +293,22 @@ typedef struct
 }
 zbx_lld_host_t;
 
+/* existing hosts index by technical name */
+typedef struct
+{
+	const char	*host;
+	zbx_lld_host_t	*lld_host;
+	int		position;	/* position in the hosts vector */
+}
+zbx_lld_host_index_t;
+
+typedef struct
+{
+	zbx_hashset_t		hosts;
+	zbx_vector_str_t	host_protos;	/* distinct host prototype names of the indexed hosts */
+}
+zbx_lld_hosts_index_t;
+
 static void	lld_host_free(zbx_lld_host_t *host)
 {
 	zbx_vector_uint64_destroy(&host->new_groupids);
@@ -945,44 +961,118 @@ static void	lld_hosts_validate(zbx_vector_ptr_t *hosts, char **error)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
-static zbx_lld_host_t	*lld_host_make(zbx_vector_ptr_t *hosts, const char *host_proto, const char *name_proto,
-		signed char inventory_mode_proto, unsigned char status_proto, unsigned char discover_proto,
-		zbx_vector_db_tag_ptr_t *tags, const zbx_lld_row_t *lld_row,
-		const zbx_vector_lld_macro_path_t *lld_macros, unsigned char custom_iface, char **error)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: indexes existing hosts by technical name                          *
+ *                                                                            *
+ * Parameters: hosts_index - [OUT]                                            *
+ *             hosts       - [IN] existing hosts of the host prototype        *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_hosts_index_init(zbx_lld_hosts_index_t *hosts_index, const zbx_vector_ptr_t *hosts)
 {
-	char			*buffer = NULL;
-	int			i, host_found = 0;
-	zbx_lld_host_t		*host = NULL;
-	zbx_vector_db_tag_ptr_t	override_tags;
-	zbx_vector_uint64_t	lnk_templateids;
-	zbx_vector_db_tag_ptr_t	new_tags;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	int	i;
 
-	zbx_vector_uint64_create(&lnk_templateids);
-	zbx_vector_db_tag_ptr_create(&new_tags);
+	zbx_hashset_create(&hosts_index->hosts, (size_t)hosts->values_num, ZBX_DEFAULT_STRING_PTR_HASH_FUNC,
+			ZBX_DEFAULT_STR_COMPARE_FUNC);
+	zbx_vector_str_create(&hosts_index->host_protos);
 
 	for (i = 0; i < hosts->values_num; i++)
 	{
-		host = (zbx_lld_host_t *)hosts->values[i];
-
-		if (0 != (host->flags & ZBX_FLAG_LLD_HOST_DISCOVERED))
-			continue;
+		zbx_lld_host_t		*host = (zbx_lld_host_t *)hosts->values[i];
+		zbx_lld_host_index_t	host_index_local = {.host = host->host, .lld_host = host, .position = i};
 
 		if (0 == host->hostid)
 			continue;
 
-		buffer = zbx_strdup(buffer, host->host_proto);
+		zbx_hashset_insert(&hosts_index->hosts, &host_index_local, sizeof(host_index_local));
+
+		if (FAIL == zbx_vector_str_search(&hosts_index->host_protos, host->host_proto,
+				ZBX_DEFAULT_STR_COMPARE_FUNC))
+		{
+			zbx_vector_str_append(&hosts_index->host_protos, host->host_proto);
+		}
+	}
+}
+
+static void	lld_hosts_index_destroy(zbx_lld_hosts_index_t *hosts_index)
+{
+	zbx_hashset_destroy(&hosts_index->hosts);
+	zbx_vector_str_destroy(&hosts_index->host_protos);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds existing host discovered by lld row                         *
+ *                                                                            *
+ * Parameters: hosts_index - [IN] existing hosts index                        *
+ *             lld_row     - [IN] lld data row                                *
+ *             lld_macros  - [IN] use json path to extract from jp_row        *
+ *                                                                            *
+ * Return value: the host or NULL if lld row does not match any of not yet    *
+ *               discovered hosts                                             *
+ *                                                                            *
+ * Comments: The technical name of the row is expanded once for each distinct *
+ *           host prototype name (usually one) and looked up in the index,    *
+ *           instead of expanding it for every existing host. All rows are    *
+ *           still matched against all existing hosts on every run.           *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_lld_host_t	*lld_hosts_index_find(const zbx_lld_hosts_index_t *hosts_index, const zbx_lld_row_t *lld_row,
+		const zbx_vector_lld_macro_path_t *lld_macros)
+{
+	zbx_lld_host_index_t	*host_index, *found = NULL;
+	char			*buffer = NULL;
+	int			i;
+
+	for (i = 0; i < hosts_index->host_protos.values_num; i++)
+	{
+		const char	*host_proto = hosts_index->host_protos.values[i];
+
+		buffer = zbx_strdup(buffer, host_proto);
 		zbx_substitute_lld_macros(&buffer, &lld_row->jp_row, lld_macros, ZBX_MACRO_ANY, NULL, 0);
 		zbx_lrtrim(buffer, ZBX_WHITESPACE);
 
-		if (0 == strcmp(host->host, buffer))
+		if (NULL == (host_index = (zbx_lld_host_index_t *)zbx_hashset_search(&hosts_index->hosts, &buffer)))
+			continue;
+
+		if (0 != (host_index->lld_host->flags & ZBX_FLAG_LLD_HOST_DISCOVERED) ||
+				0 != strcmp(host_index->lld_host->host_proto, host_proto))
 		{
-			host_found = 1;
-			break;
+			continue;
 		}
+
+		/* prefer the first host in the hosts vector */
+		if (NULL == found || host_index->position < found->position)
+			found = host_index;
 	}
 
+	zbx_free(buffer);
+
+	return NULL != found ? found->lld_host : NULL;
+}
+
+static zbx_lld_host_t	*lld_host_make(zbx_vector_ptr_t *hosts, const zbx_lld_hosts_index_t *hosts_index,
+		const char *host_proto, const char *name_proto, signed char inventory_mode_proto,
+		unsigned char status_proto, unsigned char discover_proto, zbx_vector_db_tag_ptr_t *tags,
+		const zbx_lld_row_t *lld_row, const zbx_vector_lld_macro_path_t *lld_macros, unsigned char custom_iface,
+		char **error)
+{
+	char			*buffer = NULL;
+	int			i, host_found = 0;
+	zbx_lld_host_t		*host = NULL;
+	zbx_vector_db_tag_ptr_t	override_tags;
+	zbx_vector_uint64_t	lnk_templateids;
+	zbx_vector_db_tag_ptr_t	new_tags;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	zbx_vector_uint64_create(&lnk_templateids);
+	zbx_vector_db_tag_ptr_create(&new_tags);
+
+	if (NULL != (host = lld_hosts_index_find(hosts_index, lld_row, lld_macros)))
+		host_found = 1;
+
 	zbx_vector_db_tag_ptr_create(&override_tags);
 
 	if (0 == host_found)
@@ -5585,6 +5675,7 @@ void	lld_update_hosts(zbx_uint64_t lld_ruleid, const zbx_vector_lld_row_t *lld_r
 		unsigned char		status, discover, use_custom_interfaces;
 		int			i;
 		zbx_vector_ptr_t	interfaces_custom;
+		zbx_lld_hosts_index_t	hosts_index;
 
 		ZBX_STR2UINT64(parent_hostid, row[0]);
 		host_proto = row[1];
@@ -5615,13 +5706,15 @@ void	lld_update_hosts(zbx_uint64_t lld_ruleid, const zbx_vector_lld_row_t *lld_r
 
 		lld_hostmacros_get(parent_hostid, &masterhostmacros, &hostmacros);
 
+		lld_hosts_index_init(&hosts_index, &hosts);
+
 		for (i = 0; i < lld_rows->values_num; i++)
 		{
 			const zbx_lld_row_t	*lld_row = lld_rows->values[i];
 
-			if (NULL == (host = lld_host_make(&hosts, host_proto, name_proto, inventory_mode_proto,
-					status, discover, &tags, lld_row, lld_macro_paths, use_custom_interfaces,
-					error)))
+			if (NULL == (host = lld_host_make(&hosts, &hosts_index, host_proto, name_proto,
+					inventory_mode_proto, status, discover, &tags, lld_row, lld_macro_paths,
+					use_custom_interfaces, error)))
 			{
 				continue;
 			}
@@ -5629,6 +5722,8 @@ void	lld_update_hosts(zbx_uint64_t lld_ruleid, const zbx_vector_lld_row_t *lld_r
 			lld_groups_make(host, &groups_in, &group_prototypes, &lld_row->jp_row, lld_macro_paths);
 		}
 
+		lld_hosts_index_destroy(&hosts_index);
+
 		zbx_vector_ptr_sort(&hosts, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
 
 		lld_groups_validate(&group_prototypes, &groups, &groups_in, &groups_out, lld_macro_paths, error);
@@ -96,6 +96,16 @@ typedef struct
 }
 zbx_lld_item_index_t;
 
+/* lld rows index by item prototype (parent) id, prototype key and item key expanded from it */
+typedef struct
+{
+	zbx_uint64_t		parent_itemid;
+	const char		*key_proto;
+	char			*key;		/* NULL marks prototype key as indexed */
+	zbx_vector_lld_row_t	lld_rows;
+}
+zbx_lld_row_key_index_t;
+
 /* reference to an item either by its id (existing items) or structure (new items) */
 typedef struct
 {
@@ -126,6 +136,50 @@ static int	lld_item_index_compare_func(const void *d1, const void *d2)
 	return 0;
 }
 
+/* lld rows index hashset support functions */
+static zbx_hash_t	lld_row_key_index_hash_func(const void *data)
+{
+	const zbx_lld_row_key_index_t	*row_index = (const zbx_lld_row_key_index_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_UINT64_HASH_ALGO(&row_index->parent_itemid, sizeof(row_index->parent_itemid),
+			ZBX_DEFAULT_HASH_SEED);
+	hash = ZBX_DEFAULT_STRING_HASH_ALGO(row_index->key_proto, strlen(row_index->key_proto), hash);
+
+	if (NULL != row_index->key)
+		hash = ZBX_DEFAULT_STRING_HASH_ALGO(row_index->key, strlen(row_index->key), hash);
+
+	return hash;
+}
+
+static int	lld_row_key_index_compare_func(const void *d1, const void *d2)
+{
+	const zbx_lld_row_key_index_t	*i1 = (const zbx_lld_row_key_index_t *)d1;
+	const zbx_lld_row_key_index_t	*i2 = (const zbx_lld_row_key_index_t *)d2;
+	int				ret;
+
+	ZBX_RETURN_IF_NOT_EQUAL(i1->parent_itemid, i2->parent_itemid);
+
+	if (0 != (ret = strcmp(i1->key_proto, i2->key_proto)))
+		return ret;
+
+	if (NULL == i1->key || NULL == i2->key)
+	{
+		ZBX_RETURN_IF_NOT_EQUAL(i1->key, i2->key);
+		return 0;
+	}
+
+	return strcmp(i1->key, i2->key);
+}
+
+static void	lld_row_key_index_clean(void *data)
+{
+	zbx_lld_row_key_index_t	*row_index = (zbx_lld_row_key_index_t *)data;
+
+	zbx_free(row_index->key);
+	zbx_vector_lld_row_destroy(&row_index->lld_rows);
+}
+
 /* string pointer hashset (used to check for duplicate item keys) support functions */
 static zbx_hash_t	lld_items_keys_hash_func(const void *data)
 {
@@ -188,8 +242,6 @@ static void	lld_item_prototype_free(zbx_lld_item_prototype_t *item_prototype)
 	zbx_free(item_prototype->ssl_key_file);
 	zbx_free(item_prototype->ssl_key_password);
 
-	zbx_vector_lld_row_destroy(&item_prototype->lld_rows);
-
 	zbx_vector_lld_item_preproc_clear_ext(&item_prototype->preproc_ops, lld_item_preproc_free);
 	zbx_vector_lld_item_preproc_destroy(&item_prototype->preproc_ops);
 
@@ -2331,6 +2383,56 @@ static void	lld_item_update(const zbx_lld_item_prototype_t *item_prototype, cons
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: indexes lld rows by item keys expanded from the prototype key     *
+ *                                                                            *
+ * Parameters: rows_index      - [IN/OUT] lld rows index                      *
+ *             parent_itemid   - [IN] item prototype id                       *
+ *             key_proto       - [IN] item prototype key                      *
+ *             lld_rows        - [IN] lld rows                                *
+ *             lld_macro_paths - [IN] use json path to extract from jp_row    *
+ *                                                                            *
+ * Comments: Each row key is expanded only once instead of expanding keys of  *
+ *           all rows for every existing item.                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rows_index_keys(zbx_hashset_t *rows_index, zbx_uint64_t parent_itemid, const char *key_proto,
+		const zbx_vector_lld_row_t *lld_rows, const zbx_vector_lld_macro_path_t *lld_macro_paths)
+{
+	zbx_lld_row_key_index_t	*row_index, row_index_local = {.parent_itemid = parent_itemid,
+				.key_proto = key_proto};
+	int			i;
+
+	for (i = 0; i < lld_rows->values_num; i++)
+	{
+		row_index_local.key = zbx_strdup(NULL, key_proto);
+
+		if (SUCCEED != zbx_substitute_key_macros(&row_index_local.key, NULL, NULL, &lld_rows->values[i]->jp_row,
+				lld_macro_paths, ZBX_MACRO_TYPE_ITEM_KEY, NULL, 0))
+		{
+			zbx_free(row_index_local.key);
+			continue;
+		}
+
+		if (NULL == (row_index = (zbx_lld_row_key_index_t *)zbx_hashset_search(rows_index, &row_index_local)))
+		{
+			row_index = (zbx_lld_row_key_index_t *)zbx_hashset_insert(rows_index, &row_index_local,
+					sizeof(row_index_local));
+			zbx_vector_lld_row_create(&row_index->lld_rows);
+		}
+		else
+			zbx_free(row_index_local.key);
+
+		zbx_vector_lld_row_append(&row_index->lld_rows, lld_rows->values[i]);
+	}
+
+	row_index_local.key = NULL;
+	row_index = (zbx_lld_row_key_index_t *)zbx_hashset_insert(rows_index, &row_index_local,
+			sizeof(row_index_local));
+	zbx_vector_lld_row_create(&row_index->lld_rows);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: updates existing items and creates new ones based on item,        *
@@ -2345,6 +2447,11 @@ static void	lld_item_update(const zbx_lld_item_prototype_t *item_prototype, cons
  *                                     item by prototype and lld_row.         *
  *             error           - [OUT] error message                          *
  *                                                                            *
+ * Comments: Rows are matched to items through the expanded key index, but    *
+ *           all rows and all existing items of the prototypes are still      *
+ *           matched, compared and saved on every run. Rows are not compared  *
+ *           with the rows of the previous run.                               *
+ *                                                                            *
  ******************************************************************************/
 static void	lld_items_make(const zbx_vector_ptr_t *item_prototypes, zbx_vector_lld_row_t *lld_rows,
 		const zbx_vector_lld_macro_path_t *lld_macro_paths, zbx_vector_lld_item_full_t *items,
@@ -2355,21 +2462,16 @@ static void	lld_items_make(const zbx_vector_ptr_t *item_prototypes, zbx_vector_l
 	zbx_lld_item_full_t		*item;
 	zbx_lld_row_t			*lld_row;
 	zbx_lld_item_index_t		*item_index, item_index_local;
-	char				*buffer = NULL;
+	zbx_hashset_t			rows_index;
+	zbx_lld_row_key_index_t		*row_index, row_index_local;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	/* create the items index */
-	for (i = 0; i < item_prototypes->values_num; i++)
-	{
-		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes->values[i];
+	zbx_hashset_create_ext(&rows_index, 0, lld_row_key_index_hash_func, lld_row_key_index_compare_func,
+			lld_row_key_index_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
 
-		for (j = 0; j < lld_rows->values_num; j++)
-			zbx_vector_lld_row_append(&item_prototype->lld_rows, lld_rows->values[j]);
-	}
-
-	/* Iterate in reverse order because usually the items are created in the same order as     */
-	/* incoming lld rows. Iterating in reverse optimizes lld_row removal from item prototypes. */
+	/* match existing items with lld rows by the item keys expanded from the prototype keys */
 	for (i = items->values_num - 1; i >= 0; i--)
 	{
 		item = items->values[i];
@@ -2383,34 +2485,45 @@ static void	lld_items_make(const zbx_vector_ptr_t *item_prototypes, zbx_vector_l
 
 		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes->values[index];
 
-		for (j = item_prototype->lld_rows.values_num - 1; j >= 0; j--)
+		row_index_local.parent_itemid = item->parent_itemid;
+		row_index_local.key_proto = item->key_proto;
+		row_index_local.key = NULL;
+
+		if (NULL == zbx_hashset_search(&rows_index, &row_index_local))
 		{
-			lld_row = item_prototype->lld_rows.values[j];
+			lld_rows_index_keys(&rows_index, item->parent_itemid, item->key_proto, lld_rows,
+					lld_macro_paths);
+		}
 
-			buffer = zbx_strdup(buffer, item->key_proto);
+		row_index_local.key = item->key;
 
-			if (SUCCEED != zbx_substitute_key_macros(&buffer, NULL, NULL, &lld_row->jp_row, lld_macro_paths,
-					ZBX_MACRO_TYPE_ITEM_KEY, NULL, 0))
-			{
+		if (NULL == (row_index = (zbx_lld_row_key_index_t *)zbx_hashset_search(&rows_index, &row_index_local)))
+			continue;
+
+		item_index_local.parent_itemid = item->parent_itemid;
+
+		for (j = row_index->lld_rows.values_num - 1; j >= 0; j--)
+		{
+			lld_row = row_index->lld_rows.values[j];
+			item_index_local.lld_row = lld_row;
+
+			/* the row is already matched with an item created from another prototype key */
+			if (NULL != zbx_hashset_search(items_index, &item_index_local))
 				continue;
-			}
 
-			if (0 == strcmp(item->key, buffer) &&
-					SUCCEED == lld_validate_item_override_no_discover(&lld_row->overrides,
-					item->name, item_prototype->discover))
+			if (SUCCEED == lld_validate_item_override_no_discover(&lld_row->overrides, item->name,
+					item_prototype->discover))
 			{
-				item_index_local.parent_itemid = item->parent_itemid;
-				item_index_local.lld_row = lld_row;
 				item_index_local.item = item;
 				zbx_hashset_insert(items_index, &item_index_local, sizeof(item_index_local));
 
-				zbx_vector_lld_row_remove_noorder(&item_prototype->lld_rows, j);
+				zbx_vector_lld_row_remove(&row_index->lld_rows, j);
 				break;
 			}
 		}
 	}
 
-	zbx_free(buffer);
+	zbx_hashset_destroy(&rows_index);
 
 	/* update/create discovered items */
 	for (i = 0; i < item_prototypes->values_num; i++)
@@ -4263,7 +4376,6 @@ static void	lld_item_prototypes_get(zbx_uint64_t lld_ruleid, zbx_vector_ptr_t *i
 		ZBX_STR2UCHAR(item_prototype->allow_traps, row[43]);
 		ZBX_STR2UCHAR(item_prototype->discover, row[44]);
 
-		zbx_vector_lld_row_create(&item_prototype->lld_rows);
 		zbx_vector_lld_item_preproc_create(&item_prototype->preproc_ops);
 		zbx_vector_item_param_ptr_create(&item_prototype->item_params);
 		zbx_vector_db_tag_ptr_create(&item_prototype->item_tags);
@@ -25,8 +25,10 @@
 #include "zbxlog.h"
 #include "zbxipcservice.h"
 #include "lld_protocol.h"
+#include "lld_fingerprint.h"
 #include "zbxstr.h"
 #include "zbxtime.h"
+#include "zbxhash.h"
 
 /*
  * The LLD queue is organized as a queue (rule_queue binary heap) of LLD rules,
@@ -41,8 +43,19 @@
  * values in the list the rule is removed from the index (rule_index hashset),
  * otherwise the rule is enqueued back in LLD queue.
  *
+ * After successful processing the digest of discovery data (ignoring whitespace
+ * outside JSON strings) is stored in fingerprint index together with the
+ * configuration revision reported by worker. When the same data is received again
+ * the stored revision is sent to worker, which skips the processing if the
+ * configuration revision has not changed and there are no lost objects to remove.
+ * The configuration revision covers the rule, its host, user macros, regular
+ * expressions and all prototypes, filters and overrides of the rule.
+ *
  */
 
+/* fingerprints of rules not receiving data for this period are removed */
+#define ZBX_LLD_FINGERPRINT_TTL		(SEC_PER_MIN * 30)
+
 typedef struct
 {
 	/* workers vector, created during manager initialization */
@@ -66,6 +79,14 @@ typedef struct
 	/* the number of queued LLD rules */
 	zbx_uint64_t		queued_num;
 
+	/* digests of the last successfully processed discovery data */
+	zbx_hashset_t		fingerprints;
+
+	/* the number of LLD rule runs skipped because of unchanged data and configuration */
+	zbx_uint64_t		skipped_num;
+
+	/* the time of the last expired fingerprint cleanup */
+	time_t			fingerprints_cleaned;
 }
 zbx_lld_manager_t;
 
@@ -73,6 +94,10 @@ typedef struct
 {
 	zbx_ipc_client_t	*client;
 	zbx_lld_rule_t		*rule;
+
+	/* digest of the data being processed, valid if has_digest is set */
+	md5_byte_t		digest[ZBX_MD5_DIGEST_SIZE];
+	unsigned char		has_digest;
 }
 zbx_lld_worker_t;
 
@@ -159,6 +184,9 @@ static void	lld_manager_init(zbx_lld_manager_t *manager, zbx_get_config_forks_f
 
 	zbx_binary_heap_create(&manager->rule_queue, rule_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
 
+	lld_fingerprints_init(&manager->fingerprints);
+	manager->fingerprints_cleaned = time(NULL);
+
 	manager->next_worker_index = 0;
 
 	for (i = 0; i < get_config_forks_cb(ZBX_PROCESS_TYPE_LLDWORKER); i++)
@@ -171,6 +199,7 @@ static void	lld_manager_init(zbx_lld_manager_t *manager, zbx_get_config_forks_f
 	}
 
 	manager->queued_num = 0;
+	manager->skipped_num = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -268,7 +297,7 @@ static void	lld_queue_rule(zbx_lld_manager_t *manager, zbx_lld_rule_t *rule)
  ******************************************************************************/
 static void	lld_queue_request(zbx_lld_manager_t *manager, const zbx_ipc_message_t *message)
 {
-	zbx_uint64_t	hostid;
+	zbx_uint64_t	hostid, revision;
 	zbx_lld_rule_t	*rule;
 	zbx_lld_data_t	*data;
 
@@ -278,7 +307,7 @@ static void	lld_queue_request(zbx_lld_manager_t *manager, const zbx_ipc_message_
 	data->next = NULL;
 
 	zbx_lld_deserialize_item_value(message->data, &data->itemid, &hostid, &data->value, &data->ts, &data->meta,
-			&data->lastlogsize, &data->mtime, &data->error);
+			&data->lastlogsize, &data->mtime, &data->error, &revision);
 
 	if (NULL == (rule = zbx_hashset_search(&manager->rule_index, &hostid)))
 	{
@@ -326,6 +355,33 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns configuration revision of the last processing of the      *
+ *          same discovery data                                               *
+ *                                                                            *
+ * Parameters: manager - [IN]                                                 *
+ *             worker  - [IN/OUT] worker with the data to be processed        *
+ *                                                                            *
+ * Return value: The configuration revision or 0 if the data must be          *
+ *               processed.                                                   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	lld_get_fingerprint_revision(zbx_lld_manager_t *manager, zbx_lld_worker_t *worker)
+{
+	const zbx_lld_data_t	*data = worker->rule->head;
+
+	if (SUCCEED != lld_value_digest(data->value, data->error, data->meta, worker->digest))
+	{
+		worker->has_digest = 0;
+		return 0;
+	}
+
+	worker->has_digest = 1;
+
+	return lld_fingerprint_get_revision(&manager->fingerprints, data->itemid, worker->digest);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: processes next LLD request from queue                             *
@@ -340,14 +396,17 @@ static void	lld_process_next_request(zbx_lld_manager_t *manager, zbx_lld_worker_
 	unsigned char		*buf;
 	zbx_uint32_t		buf_len;
 	zbx_lld_data_t		*data;
+	zbx_uint64_t		revision;
 
 	elem = zbx_binary_heap_find_min(&manager->rule_queue);
 	worker->rule = (zbx_lld_rule_t *)elem->data;
 	zbx_binary_heap_remove_min(&manager->rule_queue);
 
+	revision = lld_get_fingerprint_revision(manager, worker);
+
 	data = worker->rule->head;
 	buf_len = zbx_lld_serialize_item_value(&buf, data->itemid, 0, data->value, &data->ts, data->meta,
-			data->lastlogsize, data->mtime, data->error);
+			data->lastlogsize, data->mtime, data->error, revision);
 	zbx_ipc_client_send(worker->client, ZBX_IPC_LLD_TASK, buf, buf_len);
 	zbx_free(buf);
 }
@@ -375,25 +434,38 @@ static void	lld_process_queue(zbx_lld_manager_t *manager)
  * Purpose: processes LLD worker 'done' response                              *
  *                                                                            *
  * Parameters: manager - [IN]                                                 *
- * Parameters: client  - [IN] worker's IPC client connection                  *
+ *             client  - [IN] worker's IPC client connection                  *
+ *             message - [IN] received message                                *
  *                                                                            *
  ******************************************************************************/
-static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *client)
+static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *client,
+		const zbx_ipc_message_t *message)
 {
 	zbx_lld_worker_t	*worker;
 	zbx_lld_rule_t		*rule;
 	zbx_lld_data_t		*data;
+	zbx_uint64_t		revision;
+	unsigned char		skipped;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	worker = lld_get_worker_by_client(manager, client);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "discovery rule:" ZBX_FS_UI64 " has been processed", worker->rule->head->itemid);
+	zbx_lld_deserialize_result(message->data, &revision, &skipped);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "discovery rule:" ZBX_FS_UI64 " has been %s", worker->rule->head->itemid,
+			0 == skipped ? "processed" : "skipped");
 
 	rule = worker->rule;
 	worker->rule = NULL;
 
 	data = rule->head;
+
+	if (0 != skipped)
+		manager->skipped_num++;
+
+	lld_fingerprint_update(&manager->fingerprints, data->itemid, 0 != worker->has_digest ? worker->digest : NULL,
+			revision, time(NULL));
 	rule->head = rule->head->next;
 
 	if (NULL == rule->head)
@@ -430,7 +502,8 @@ static void	lld_process_diag_stats(zbx_lld_manager_t *manager, zbx_ipc_client_t
 	unsigned char	*data;
 	zbx_uint32_t	data_len;
 
-	data_len = zbx_lld_serialize_diag_stats(&data, manager->rule_index.num_data, manager->queued_num);
+	data_len = zbx_lld_serialize_diag_stats(&data, manager->rule_index.num_data, manager->queued_num,
+			manager->skipped_num);
 	zbx_ipc_client_send(client, ZBX_IPC_LLD_DIAG_STATS_RESULT, data, data_len);
 	zbx_free(data);
 }
@@ -597,7 +670,7 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 					lld_process_queue(&manager);
 					break;
 				case ZBX_IPC_LLD_DONE:
-					lld_process_result(&manager, client);
+					lld_process_result(&manager, client, message);
 					processed_num++;
 					manager.queued_num--;
 					break;
@@ -618,6 +691,12 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 
 		if (NULL != client)
 			zbx_ipc_client_release(client);
+
+		if (ZBX_LLD_FINGERPRINT_TTL < (time_t)sec - manager.fingerprints_cleaned)
+		{
+			lld_fingerprints_remove_inactive(&manager.fingerprints, (time_t)sec, ZBX_LLD_FINGERPRINT_TTL);
+			manager.fingerprints_cleaned = (time_t)sec;
+		}
 	}
 
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
@@ -25,7 +25,7 @@
 
 zbx_uint32_t	zbx_lld_serialize_item_value(unsigned char **data, zbx_uint64_t itemid, zbx_uint64_t hostid,
 		const char *value, const zbx_timespec_t *ts, unsigned char meta, zbx_uint64_t lastlogsize, int mtime,
-		const char *error)
+		const char *error, zbx_uint64_t revision)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len = 0, value_len, error_len;
@@ -35,6 +35,7 @@ zbx_uint32_t	zbx_lld_serialize_item_value(unsigned char **data, zbx_uint64_t ite
 	zbx_serialize_prepare_str(data_len, value);
 	zbx_serialize_prepare_value(data_len, *ts);
 	zbx_serialize_prepare_str(data_len, error);
+	zbx_serialize_prepare_value(data_len, revision);
 
 	zbx_serialize_prepare_value(data_len, meta);
 	if (0 != meta)
@@ -51,6 +52,7 @@ zbx_uint32_t	zbx_lld_serialize_item_value(unsigned char **data, zbx_uint64_t ite
 	ptr += zbx_serialize_str(ptr, value, value_len);
 	ptr += zbx_serialize_value(ptr, *ts);
 	ptr += zbx_serialize_str(ptr, error, error_len);
+	ptr += zbx_serialize_value(ptr, revision);
 	ptr += zbx_serialize_value(ptr, meta);
 	if (0 != meta)
 	{
@@ -63,7 +65,7 @@ zbx_uint32_t	zbx_lld_serialize_item_value(unsigned char **data, zbx_uint64_t ite
 
 void	zbx_lld_deserialize_item_value(const unsigned char *data, zbx_uint64_t *itemid, zbx_uint64_t *hostid,
 		char **value, zbx_timespec_t *ts, unsigned char *meta, zbx_uint64_t *lastlogsize, int *mtime,
-		char **error)
+		char **error, zbx_uint64_t *revision)
 {
 	zbx_uint32_t	value_len, error_len;
 
@@ -72,6 +74,7 @@ void	zbx_lld_deserialize_item_value(const unsigned char *data, zbx_uint64_t *ite
 	data += zbx_deserialize_str(data, value, value_len);
 	data += zbx_deserialize_value(data, ts);
 	data += zbx_deserialize_str(data, error, error_len);
+	data += zbx_deserialize_value(data, revision);
 	data += zbx_deserialize_value(data, meta);
 	if (0 != *meta)
 	{
@@ -80,28 +83,55 @@ void	zbx_lld_deserialize_item_value(const unsigned char *data, zbx_uint64_t *ite
 	}
 }
 
-zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num)
+zbx_uint32_t	zbx_lld_serialize_result(unsigned char **data, zbx_uint64_t revision, unsigned char skipped)
+{
+	unsigned char	*ptr;
+	zbx_uint32_t	data_len = 0;
+
+	zbx_serialize_prepare_value(data_len, revision);
+	zbx_serialize_prepare_value(data_len, skipped);
+
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	ptr = *data;
+	ptr += zbx_serialize_value(ptr, revision);
+	(void)zbx_serialize_value(ptr, skipped);
+
+	return data_len;
+}
+
+void	zbx_lld_deserialize_result(const unsigned char *data, zbx_uint64_t *revision, unsigned char *skipped)
+{
+	data += zbx_deserialize_value(data, revision);
+	(void)zbx_deserialize_value(data, skipped);
+}
+
+zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num,
+		zbx_uint64_t skipped_num)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len = 0;
 
 	zbx_serialize_prepare_value(data_len, items_num);
 	zbx_serialize_prepare_value(data_len, values_num);
+	zbx_serialize_prepare_value(data_len, skipped_num);
 
 	*data = (unsigned char *)zbx_malloc(NULL, data_len);
 
 	ptr = *data;
 	ptr += zbx_serialize_value(ptr, items_num);
-	(void)zbx_serialize_value(ptr, values_num);
+	ptr += zbx_serialize_value(ptr, values_num);
+	(void)zbx_serialize_value(ptr, skipped_num);
 
 	return data_len;
 }
 
 static void	zbx_lld_deserialize_diag_stats(const unsigned char *data, zbx_uint64_t *items_num,
-		zbx_uint64_t *values_num)
+		zbx_uint64_t *values_num, zbx_uint64_t *skipped_num)
 {
 	data += zbx_deserialize_value(data, items_num);
-	(void)zbx_deserialize_value(data, values_num);
+	data += zbx_deserialize_value(data, values_num);
+	(void)zbx_deserialize_value(data, skipped_num);
 }
 
 static zbx_uint32_t	zbx_lld_serialize_top_items_request(unsigned char **data, int limit)
@@ -201,7 +231,7 @@ void	zbx_lld_queue_value(zbx_uint64_t itemid, zbx_uint64_t hostid, const char *v
 		exit(EXIT_FAILURE);
 	}
 
-	data_len = zbx_lld_serialize_item_value(&data, itemid, hostid, value, ts, meta, lastlogsize, mtime, error);
+	data_len = zbx_lld_serialize_item_value(&data, itemid, hostid, value, ts, meta, lastlogsize, mtime, error, 0);
 
 	if (FAIL == zbx_ipc_socket_write(&socket, ZBX_IPC_LLD_REQUEST, data, data_len))
 	{
@@ -295,8 +325,15 @@ out:
  *                                                                            *
  * Purpose: get lld manager diagnostic statistics                             *
  *                                                                            *
+ * Parameters: items_num   - [OUT] the number of queued discovery rules       *
+ *             values_num  - [OUT] the number of queued values                *
+ *             skipped_num - [OUT] the number of discovery rule runs skipped  *
+ *                                 because of unchanged data                  *
+ *             error       - [OUT] the error message                          *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, char **error)
+int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, zbx_uint64_t *skipped_num,
+		char **error)
 {
 	unsigned char	*result;
 
@@ -306,7 +343,7 @@ int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, ch
 		return FAIL;
 	}
 
-	zbx_lld_deserialize_diag_stats(result, items_num, values_num);
+	zbx_lld_deserialize_diag_stats(result, items_num, values_num, skipped_num);
 	zbx_free(result);
 
 	return SUCCEED;
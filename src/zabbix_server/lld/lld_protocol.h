@@ -53,13 +53,18 @@
 
 zbx_uint32_t	zbx_lld_serialize_item_value(unsigned char **data, zbx_uint64_t itemid, zbx_uint64_t hostid,
 		const char *value, const zbx_timespec_t *ts, unsigned char meta, zbx_uint64_t lastlogsize, int mtime,
-		const char *error);
+		const char *error, zbx_uint64_t revision);
 
 void	zbx_lld_deserialize_item_value(const unsigned char *data, zbx_uint64_t *itemid, zbx_uint64_t *hostid,
 		char **value, zbx_timespec_t *ts, unsigned char *meta, zbx_uint64_t *lastlogsize, int *mtime,
-		char **error);
+		char **error, zbx_uint64_t *revision);
+
+zbx_uint32_t	zbx_lld_serialize_result(unsigned char **data, zbx_uint64_t revision, unsigned char skipped);
 
-zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num);
+void	zbx_lld_deserialize_result(const unsigned char *data, zbx_uint64_t *revision, unsigned char *skipped);
+
+zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num,
+		zbx_uint64_t skipped_num);
 
 void	zbx_lld_deserialize_top_items_request(const unsigned char *data, int *limit);
 
@@ -74,7 +79,8 @@ void	zbx_lld_process_agent_result(zbx_uint64_t itemid, zbx_uint64_t hostid, AGEN
 
 int	zbx_lld_get_queue_size(zbx_uint64_t *size, char **error);
 
-int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, char **error);
+int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, zbx_uint64_t *skipped_num,
+		char **error);
 
 int	zbx_lld_get_top_items(int limit, zbx_vector_uint64_pair_t *items, char **error);
 
@@ -19,6 +19,7 @@
 
 #include "lld_worker.h"
 #include "lld.h"
+#include "lld_fingerprint.h"
 
 #include "../events/events.h"
 
@@ -53,12 +54,22 @@ static void	lld_register_worker(zbx_ipc_socket_t *socket)
  * Purpose: processes lld task and updates rule state/error in configuration  *
  *          cache and database                                                *
  *                                                                            *
- * Parameters: message - [IN] message with LLD request                        *
+ * Parameters: message  - [IN] message with LLD request                       *
+ *             revision - [OUT] configuration revision of the rule, its       *
+ *                              prototypes, filters, overrides and discovered *
+ *                              objects after processing the data,            *
+ *                              LLD_RULE_REVISION_UNKNOWN if the data was     *
+ *                              changed since the last processing or 0 if     *
+ *                              processing was not successful                 *
+ *             skipped  - [OUT] 1 if the processing was skipped because data  *
+ *                              and configuration were not changed and there  *
+ *                              were no lost objects to remove since the last *
+ *                              processing, 0 otherwise                       *
  *                                                                            *
  ******************************************************************************/
-static void	lld_process_task(zbx_ipc_message_t *message)
+static void	lld_process_task(zbx_ipc_message_t *message, zbx_uint64_t *revision, unsigned char *skipped)
 {
-	zbx_uint64_t		itemid, hostid, lastlogsize;
+	zbx_uint64_t		itemid, hostid, lastlogsize, last_revision;
 	char			*value, *error;
 	zbx_timespec_t		ts;
 	zbx_item_diff_t		diff;
@@ -68,14 +79,26 @@ static void	lld_process_task(zbx_ipc_message_t *message)
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	*revision = 0;
+	*skipped = 0;
+
 	zbx_lld_deserialize_item_value(message->data, &itemid, &hostid, &value, &ts, &meta, &lastlogsize, &mtime,
-			&error);
+			&error, &last_revision);
 
 	zbx_dc_config_get_items_by_itemids(&item, &itemid, &errcode, 1);
 
 	if (SUCCEED != errcode)
 		goto out;
 
+	if (NULL == error && NULL != value && ITEM_STATE_NORMAL == item.state &&
+			SUCCEED == lld_rule_check_unchanged(itemid, last_revision))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "skipping discovery rule:" ZBX_FS_UI64 " with unchanged data", itemid);
+		*revision = last_revision;
+		*skipped = 1;
+		goto clean;
+	}
+
 	zabbix_log(LOG_LEVEL_DEBUG, "processing discovery rule:" ZBX_FS_UI64, itemid);
 
 	diff.flags = ZBX_FLAGS_ITEM_DIFF_UNSET;
@@ -87,6 +110,17 @@ static void	lld_process_task(zbx_ipc_message_t *message)
 		else
 			state = ITEM_STATE_NOTSUPPORTED;
 
+		/* results with warnings are not remembered to retry failed operations with the same data */
+		if (ITEM_STATE_NORMAL == state && '\0' == *ZBX_NULL2EMPTY_STR(error))
+		{
+			/* revision is calculated only when the same data is received again to avoid */
+			/* the extra database queries for the rules with constantly changing data    */
+			if (0 != last_revision)
+				*revision = lld_rule_get_revision(itemid);
+			else
+				*revision = LLD_RULE_REVISION_UNKNOWN;
+		}
+
 		if (state != item.state)
 		{
 			diff.state = state;
@@ -161,7 +195,7 @@ static void	lld_process_task(zbx_ipc_message_t *message)
 		zbx_vector_ptr_destroy(&diffs);
 		zbx_free(sql);
 	}
-
+clean:
 	zbx_dc_config_clean_items(&item, &errcode, 1);
 out:
 	zbx_free(value);
@@ -176,7 +210,9 @@ ZBX_THREAD_ENTRY(lld_worker_thread, args)
 	zbx_ipc_socket_t	lld_socket;
 	zbx_ipc_message_t	message;
 	double			time_stat, time_idle = 0, time_now, time_read;
-	zbx_uint64_t		processed_num = 0;
+	zbx_uint64_t		processed_num = 0, revision;
+	unsigned char		*data, skipped;
+	zbx_uint32_t		data_len;
 	zbx_thread_info_t	*info = &((zbx_thread_args_t *)args)->info;
 	int			server_num = ((zbx_thread_args_t *)args)->info.server_num;
 	int			process_num = ((zbx_thread_args_t *)args)->info.process_num;
@@ -237,8 +273,10 @@ ZBX_THREAD_ENTRY(lld_worker_thread, args)
 		switch (message.code)
 		{
 			case ZBX_IPC_LLD_TASK:
-				lld_process_task(&message);
-				zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_DONE, NULL, 0);
+				lld_process_task(&message, &revision, &skipped);
+				data_len = zbx_lld_serialize_result(&data, revision, skipped);
+				zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_DONE, data, data_len);
+				zbx_free(data);
 				processed_num++;
 				break;
 		}
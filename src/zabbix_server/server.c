@@ -290,6 +290,7 @@ int	zbx_config_trapper_timeout = 300;
 static int	config_startup_time		= 0;
 static int	config_unavailable_delay	= 60;
 static int	config_histsyncer_frequency	= 1;
+static int	config_histsyncer_trigger_threads	= 0;
 
 static int	zbx_config_listen_port		= ZBX_DEFAULT_SERVER_PORT;
 static char	*zbx_config_listen_ip		= NULL;
@@ -298,6 +299,7 @@ static char	*config_server		= NULL;		/* not used in zabbix_server, required for
 static int	config_housekeeping_frequency	= 1;
 static int	config_max_housekeeper_delete	= 5000;		/* applies for every separate field value */
 static int	config_confsyncer_frequency	= 10;
+static int	config_confsyncer_load_threads	= 0;
 
 static int	config_problemhousekeeping_frequency = 60;
 
@@ -306,11 +308,16 @@ static int	config_vmware_perf_frequency	= 60;
 static int	config_vmware_timeout		= 10;
 
 static zbx_uint64_t	config_conf_cache_size		= 32 * ZBX_MEBIBYTE;
+static int		config_cache_slab_allocator	= ZBX_SHMEM_SLAB_DISABLED;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static int		config_history_cache_shards	= 1;
+static int		config_history_ring_size	= 0;
+static zbx_uint64_t	config_ipc_ring_size		= 0;
 static zbx_uint64_t	config_trends_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trend_func_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_value_cache_size		= 8 * ZBX_MEBIBYTE;
+static char		*config_value_cache_snapshot_file	= NULL;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period		= 45;
@@ -706,6 +713,13 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (NULL != config_value_cache_snapshot_file && NULL != CONFIG_HA_NODE_NAME && '\0' != *CONFIG_HA_NODE_NAME)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"ValueCacheSnapshotFile\" configuration parameter cannot be used in"
+				" high availability cluster mode");
+		err = 1;
+	}
+
 	if (0 != config_trend_func_cache_size && 128 * ZBX_KIBIBYTE > config_trend_func_cache_size)
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "\"TrendFunctionCacheSize\" configuration parameter must be either 0"
@@ -828,6 +842,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			MANDATORY,	MIN,			MAX */
 		{"StartDBSyncers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_HISTSYNCER],		TYPE_INT,
 			PARM_OPT,	1,			100},
+		{"DBSyncerTriggerThreads",	&config_histsyncer_trigger_threads,		TYPE_INT,
+			PARM_OPT,	0,			64},
 		{"StartDiscoverers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_DISCOVERER],		TYPE_INT,
 			PARM_OPT,	0,			1000},
 		{"StartHTTPPollers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_HTTPPOLLER],		TYPE_INT,
@@ -858,16 +874,28 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			1},
 		{"CacheSize",			&config_conf_cache_size,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"CacheSlabAllocator",		&config_cache_slab_allocator,		TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"HistoryCacheSize",		&config_history_cache_size,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistoryCacheShards",		&config_history_cache_shards,		TYPE_INT,
+			PARM_OPT,	1,			ZBX_HC_SHARDS_MAX},
+		{"HistoryRingSize",		&config_history_ring_size,		TYPE_INT,
+			PARM_OPT,	0,			ZBX_HC_RING_SIZE_MAX},
+		{"IPCRingSize",			&config_ipc_ring_size,			TYPE_UINT64,
+			PARM_OPT,	0,			ZBX_IPC_RING_SIZE_MAX},
 		{"TrendCacheSize",		&config_trends_cache_size,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"TrendFunctionCacheSize",	&config_trend_func_cache_size,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&config_value_cache_size,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheSnapshotFile",	&config_value_cache_snapshot_file,	TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"CacheLoadThreads",		&config_confsyncer_load_threads,		TYPE_INT,
+			PARM_OPT,	0,			16},
 		{"CacheUpdateFrequency",	&config_confsyncer_frequency,		TYPE_INT,
 			PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		TYPE_INT,
@@ -938,6 +966,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	1024,			65535},
 		{"AllowUnsupportedDBVersions",	&config_allow_unsupported_db_versions,	TYPE_INT,
 			PARM_OPT,	0,			1},
+		{"DBHistoryCopy",		&(zbx_config_dbhigh->config_db_history_copy),	TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"DBTLSConnect",		&(zbx_config_dbhigh->config_db_tls_connect),	TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"DBTLSCertFile",		&(zbx_config_dbhigh->config_db_tls_cert_file),	TYPE_STRING,
@@ -1124,6 +1154,14 @@ static void	zbx_on_exit(int ret)
 
 		zbx_free_configuration_cache();
 
+		/* history cache has been flushed, so value cache can be saved for the next start */
+		if (NULL != config_value_cache_snapshot_file &&
+				SUCCEED != zbx_vc_save_snapshot(config_value_cache_snapshot_file, &error))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot save value cache snapshot: %s", error);
+			zbx_free(error);
+		}
+
 		/* free history value cache */
 		zbx_vc_destroy();
 
@@ -1419,6 +1457,29 @@ static void	zbx_db_save_server_status(void)
 	zbx_json_free(&json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: load value cache snapshot saved during the last shutdown for      *
+ *          items that still exist in configuration cache                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	server_load_value_cache_snapshot(void)
+{
+	zbx_vector_uint64_pair_t	items;
+	char				*error = NULL;
+
+	zbx_vector_uint64_pair_create(&items);
+	zbx_dc_config_get_item_value_types(&items);
+
+	if (SUCCEED != zbx_vc_load_snapshot(config_value_cache_snapshot_file, &items, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot load value cache snapshot: %s", error);
+		zbx_free(error);
+	}
+
+	zbx_vector_uint64_pair_destroy(&items);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initialize shared resources and start processes                   *
@@ -1472,9 +1533,9 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 	zbx_thread_taskmanager_args	taskmanager_args = {zbx_config_timeout, config_startup_time};
 	zbx_thread_dbconfig_args	dbconfig_args = {&zbx_config_vault, zbx_config_timeout,
 							config_proxyconfig_frequency, config_proxydata_frequency,
-							config_confsyncer_frequency, zbx_config_source_ip,
-							config_ssl_ca_location, config_ssl_cert_location,
-							config_ssl_key_location};
+							config_confsyncer_frequency, config_confsyncer_load_threads,
+							zbx_config_source_ip, config_ssl_ca_location,
+							config_ssl_cert_location, config_ssl_key_location};
 	zbx_thread_alerter_args		alerter_args = {zbx_config_source_ip, config_ssl_ca_location};
 	zbx_thread_pinger_args		pinger_args = {zbx_config_timeout};
 	zbx_thread_pp_manager_args	preproc_man_args = {
@@ -1494,7 +1555,8 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 								zbx_config_dbhigh, zbx_config_source_ip};
 	zbx_thread_lld_manager_args	lld_manager_args = {get_config_forks};
 	zbx_thread_connector_manager_args	connector_manager_args = {get_config_forks};
-	zbx_thread_dbsyncer_args		dbsyncer_args = {&events_cbs, config_histsyncer_frequency};
+	zbx_thread_dbsyncer_args		dbsyncer_args = {&events_cbs, config_histsyncer_frequency,
+							config_histsyncer_trigger_threads};
 	zbx_thread_vmware_args			vmware_args = {zbx_config_source_ip, config_vmware_frequency,
 								config_vmware_perf_frequency, config_vmware_timeout};
 	zbx_thread_timer_args		timer_args = {get_config_forks};
@@ -1505,7 +1567,8 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 								config_service_manager_sync_frequency};
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_server_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, config_history_cache_shards, config_history_ring_size,
+			&config_trends_cache_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -1655,6 +1718,9 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 				zbx_dc_update_maintenances(MAINTENANCE_TIMER_PENDING);
 
 				zbx_db_close();
+
+				if (NULL != config_value_cache_snapshot_file)
+					server_load_value_cache_snapshot();
 				break;
 			case ZBX_PROCESS_TYPE_POLLER:
 				poller_args.poller_type = ZBX_POLLER_TYPE_NORMAL;
@@ -1999,6 +2065,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
+	zbx_ipc_set_ring_size(config_ipc_ring_size);
+
 	if (SUCCEED != zbx_locks_create(&error))
 	{
 		zbx_error("cannot create locks: %s", error);
@@ -2006,6 +2074,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
+	zbx_shmem_set_slab_mode(config_cache_slab_allocator);
+
 	if (SUCCEED != zbx_open_log(&log_file_cfg, config_log_level, syslog_app_name, &error))
 	{
 		zbx_error("cannot open log: %s", error);
@@ -2151,7 +2221,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_server_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, config_history_cache_shards, config_history_ring_size,
+			&config_trends_cache_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -64,6 +64,7 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxdbhigh/Makefile
 			tests/libs/zbxeval/Makefile
 			tests/libs/zbxhistory/Makefile
+			tests/libs/zbxipcservice/Makefile
 			tests/libs/zbxjson/Makefile
 			tests/libs/zbxmodules/Makefile
 			tests/libs/zbxpoller/Makefile
@@ -83,6 +84,7 @@ AC_DEFUN([CONF_TESTS],
 			tests/zabbix_server/service/Makefile
 			tests/zabbix_server/trapper/Makefile
 			tests/zabbix_server/lld/Makefile
+			tests/zabbix_server/housekeeper/Makefile
 			tests/mocks/Makefile
 			tests/mocks/configcache/Makefile
 			tests/mocks/valuecache/Makefile
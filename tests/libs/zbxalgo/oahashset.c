@@ -0,0 +1,205 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxalgo.h"
+
+#define	RANDOM		1
+#define	ITERATE_REMOVE	2
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	value;
+}
+zbx_oahashset_test_entry_t;
+
+/* deterministic pseudo random generator, so test failures can be reproduced */
+static zbx_uint64_t	test_random(zbx_uint64_t *seed)
+{
+	*seed = *seed * __UINT64_C(6364136223846793005) + __UINT64_C(1442695040888963407);
+
+	return *seed >> 33;
+}
+
+static void	test_compare_sets(zbx_oahashset_t *oahs, zbx_hashset_t *hs)
+{
+	zbx_oahashset_iter_t		oaiter;
+	zbx_hashset_iter_t		iter;
+	zbx_oahashset_test_entry_t	*entry, *found;
+	int				num = 0;
+
+	zbx_mock_assert_int_eq("number of entries", hs->num_data, oahs->num_data);
+
+	zbx_hashset_iter_reset(hs, &iter);
+	while (NULL != (entry = (zbx_oahashset_test_entry_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (NULL == (found = (zbx_oahashset_test_entry_t *)zbx_oahashset_search(oahs, entry)))
+			fail_msg("cannot find itemid " ZBX_FS_UI64, entry->itemid);
+
+		zbx_mock_assert_uint64_eq("entry value", entry->value, found->value);
+	}
+
+	zbx_oahashset_iter_reset(oahs, &oaiter);
+	while (NULL != (entry = (zbx_oahashset_test_entry_t *)zbx_oahashset_iter_next(&oaiter)))
+	{
+		if (NULL == zbx_hashset_search(hs, entry))
+			fail_msg("unexpected itemid " ZBX_FS_UI64, entry->itemid);
+		num++;
+	}
+
+	zbx_mock_assert_int_eq("number of iterated entries", hs->num_data, num);
+}
+
+static void	test_oahashset_random(void)
+{
+	zbx_oahashset_t			oahs;
+	zbx_hashset_t			hs;
+	zbx_oahashset_test_entry_t	local, *entry;
+	zbx_uint64_t			seed, keys, i, operations;
+
+	seed = zbx_mock_get_parameter_uint64("in.seed");
+	keys = zbx_mock_get_parameter_uint64("in.keys");
+	operations = zbx_mock_get_parameter_uint64("in.operations");
+
+	zbx_oahashset_create(&oahs, 0, sizeof(zbx_oahashset_test_entry_t), ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < operations; i++)
+	{
+		local.itemid = test_random(&seed) % keys;
+		local.value = i;
+
+		switch (test_random(&seed) % 3)
+		{
+			case 0:
+			case 1:
+				entry = (zbx_oahashset_test_entry_t *)zbx_oahashset_insert(&oahs, &local, sizeof(local));
+				entry->value = local.value;
+				entry = (zbx_oahashset_test_entry_t *)zbx_hashset_insert(&hs, &local, sizeof(local));
+				entry->value = local.value;
+				break;
+			case 2:
+				zbx_oahashset_remove(&oahs, &local);
+				zbx_hashset_remove(&hs, &local);
+				break;
+		}
+
+		if (0 == i % 1000)
+			test_compare_sets(&oahs, &hs);
+	}
+
+	test_compare_sets(&oahs, &hs);
+
+	zbx_oahashset_clear(&oahs);
+	zbx_mock_assert_int_eq("number of entries after clear", 0, oahs.num_data);
+	zbx_mock_assert_ptr_eq("search after clear", NULL, zbx_oahashset_search(&oahs, &local));
+
+	zbx_hashset_destroy(&hs);
+	zbx_oahashset_destroy(&oahs);
+}
+
+static void	test_oahashset_iterate_remove(void)
+{
+	zbx_oahashset_t			oahs;
+	zbx_oahashset_iter_t		iter;
+	zbx_oahashset_test_entry_t	local, *entry;
+	zbx_uint64_t			seed, keys, i, visited = 0, removed = 0, left = 0;
+
+	seed = zbx_mock_get_parameter_uint64("in.seed");
+	keys = zbx_mock_get_parameter_uint64("in.keys");
+
+	zbx_oahashset_create(&oahs, 0, sizeof(zbx_oahashset_test_entry_t), ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < keys; i++)
+	{
+		local.itemid = i;
+		local.value = test_random(&seed) % 2;
+		zbx_oahashset_insert(&oahs, &local, sizeof(local));
+	}
+
+	/* remove every entry with odd value while iterating, each entry must be visited exactly once */
+	zbx_oahashset_iter_reset(&oahs, &iter);
+	while (NULL != (entry = (zbx_oahashset_test_entry_t *)zbx_oahashset_iter_next(&iter)))
+	{
+		if (0 != (entry->value & 2))
+			fail_msg("itemid " ZBX_FS_UI64 " visited twice", entry->itemid);
+
+		entry->value |= 2;
+		visited++;
+
+		if (0 != (entry->value & 1))
+		{
+			zbx_oahashset_iter_remove(&iter);
+			removed++;
+		}
+	}
+
+	zbx_mock_assert_uint64_eq("visited entries", keys, visited);
+	zbx_mock_assert_int_eq("remaining entries", (int)(keys - removed), oahs.num_data);
+
+	for (i = 0; i < keys; i++)
+	{
+		local.itemid = i;
+
+		if (NULL != (entry = (zbx_oahashset_test_entry_t *)zbx_oahashset_search(&oahs, &local)))
+		{
+			zbx_mock_assert_uint64_eq("remaining entry value", 2, entry->value);
+			left++;
+		}
+	}
+
+	zbx_mock_assert_uint64_eq("found entries", keys - removed, left);
+
+	zbx_oahashset_destroy(&oahs);
+}
+
+static int	get_type(const char *str)
+{
+	if (0 == strcmp(str, "RANDOM"))
+		return RANDOM;
+	if (0 == strcmp(str, "ITERATE_REMOVE"))
+		return ITERATE_REMOVE;
+
+	fail_msg("unknown cmocka step type: %s", str);
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	switch (get_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case RANDOM:
+			test_oahashset_random();
+			break;
+		case ITERATE_REMOVE:
+			test_oahashset_iterate_remove();
+			break;
+		default:
+			fail_msg("unknown cmocka step type: %s", zbx_mock_get_parameter_string("in.type"));
+	}
+}
@@ -0,0 +1,226 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+/*
+ * Compares open addressing hashset with zbx_hashset_t on itemid keyed workload -
+ * inserting sparse itemids, looking up existing and missing itemids and removing
+ * all entries.
+ *
+ * The benchmark is not part of unit tests, it's built with
+ *   make oahashset_bench
+ * and run as
+ *   ./oahashset_bench [keys [lookups [seed]]]
+ */
+
+#include "zbxcommon.h"
+#include "zbxalgo.h"
+#include "zbxtime.h"
+
+#define BENCH_KEYS	200000
+#define BENCH_LOOKUPS	2000000
+#define BENCH_SEED	5
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	value;
+}
+bench_entry_t;
+
+typedef struct
+{
+	double		insert;
+	double		search;
+	double		search_missing;
+	double		remove;
+	zbx_uint64_t	sum;
+}
+bench_result_t;
+
+/* deterministic pseudo random generator, so the runs are comparable */
+static zbx_uint64_t	bench_random(zbx_uint64_t *seed)
+{
+	*seed = *seed * __UINT64_C(6364136223846793005) + __UINT64_C(1442695040888963407);
+
+	return *seed >> 33;
+}
+
+static void	bench_hashset(const zbx_uint64_t *itemids, int keys, const int *lookups, int lookups_num,
+		bench_result_t *result)
+{
+	zbx_hashset_t	hs;
+	bench_entry_t	local, *entry;
+	double		time_start;
+	int		i;
+
+	zbx_hashset_create(&hs, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	time_start = zbx_time();
+
+	for (i = 0; i < keys; i++)
+	{
+		local.itemid = itemids[i];
+		local.value = (zbx_uint64_t)i;
+		zbx_hashset_insert(&hs, &local, sizeof(local));
+	}
+
+	result->insert = zbx_time() - time_start;
+	time_start = zbx_time();
+
+	for (i = 0; i < lookups_num; i++)
+	{
+		local.itemid = itemids[lookups[i]];
+
+		if (NULL != (entry = (bench_entry_t *)zbx_hashset_search(&hs, &local)))
+			result->sum += entry->value;
+	}
+
+	result->search = zbx_time() - time_start;
+	time_start = zbx_time();
+
+	/* itemids are generated with step 3, so itemid + 3 * keys is never found */
+	for (i = 0; i < lookups_num; i++)
+	{
+		local.itemid = itemids[lookups[i]] + 3 * (zbx_uint64_t)keys;
+
+		if (NULL != (entry = (bench_entry_t *)zbx_hashset_search(&hs, &local)))
+			result->sum += entry->value;
+	}
+
+	result->search_missing = zbx_time() - time_start;
+	time_start = zbx_time();
+
+	for (i = 0; i < keys; i++)
+		zbx_hashset_remove(&hs, &itemids[i]);
+
+	result->remove = zbx_time() - time_start;
+
+	zbx_hashset_destroy(&hs);
+}
+
+static void	bench_oahashset(const zbx_uint64_t *itemids, int keys, const int *lookups, int lookups_num,
+		bench_result_t *result)
+{
+	zbx_oahashset_t	hs;
+	bench_entry_t	local, *entry;
+	double		time_start;
+	int		i;
+
+	zbx_oahashset_create(&hs, 0, sizeof(bench_entry_t), ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	time_start = zbx_time();
+
+	for (i = 0; i < keys; i++)
+	{
+		local.itemid = itemids[i];
+		local.value = (zbx_uint64_t)i;
+		zbx_oahashset_insert(&hs, &local, sizeof(local));
+	}
+
+	result->insert = zbx_time() - time_start;
+	time_start = zbx_time();
+
+	for (i = 0; i < lookups_num; i++)
+	{
+		local.itemid = itemids[lookups[i]];
+
+		if (NULL != (entry = (bench_entry_t *)zbx_oahashset_search(&hs, &local)))
+			result->sum += entry->value;
+	}
+
+	result->search = zbx_time() - time_start;
+	time_start = zbx_time();
+
+	for (i = 0; i < lookups_num; i++)
+	{
+		local.itemid = itemids[lookups[i]] + 3 * (zbx_uint64_t)keys;
+
+		if (NULL != (entry = (bench_entry_t *)zbx_oahashset_search(&hs, &local)))
+			result->sum += entry->value;
+	}
+
+	result->search_missing = zbx_time() - time_start;
+	time_start = zbx_time();
+
+	for (i = 0; i < keys; i++)
+		zbx_oahashset_remove(&hs, &itemids[i]);
+
+	result->remove = zbx_time() - time_start;
+
+	zbx_oahashset_destroy(&hs);
+}
+
+static void	bench_print(const char *name, int keys, int lookups_num, const bench_result_t *result)
+{
+	printf("%-10s insert %d: %.6f sec, search %d: %.6f sec, search missing %d: %.6f sec, remove %d: "
+			"%.6f sec\n", name, keys, result->insert, lookups_num, result->search, lookups_num,
+			result->search_missing, keys, result->remove);
+}
+
+int	main(int argc, char **argv)
+{
+	zbx_uint64_t	*itemids, seed = BENCH_SEED;
+	int		i, keys = BENCH_KEYS, lookups_num = BENCH_LOOKUPS, *lookups;
+	bench_result_t	result_hs = {0}, result_oahs = {0};
+
+	if (1 < argc)
+		keys = atoi(argv[1]);
+
+	if (2 < argc)
+		lookups_num = atoi(argv[2]);
+
+	if (3 < argc)
+		seed = (zbx_uint64_t)atoi(argv[3]);
+
+	if (0 >= keys || 0 > lookups_num)
+	{
+		fprintf(stderr, "usage: %s [keys [lookups [seed]]]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	/* itemids are sparse and mostly increasing, like in a real configuration */
+	itemids = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * (size_t)keys);
+
+	for (i = 0; i < keys; i++)
+		itemids[i] = 10000 + (zbx_uint64_t)i * 3 + bench_random(&seed) % 3;
+
+	lookups = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)(0 != lookups_num ? lookups_num : 1));
+
+	for (i = 0; i < lookups_num; i++)
+		lookups[i] = (int)(bench_random(&seed) % (zbx_uint64_t)keys);
+
+	bench_hashset(itemids, keys, lookups, lookups_num, &result_hs);
+	bench_oahashset(itemids, keys, lookups, lookups_num, &result_oahs);
+
+	bench_print("hashset", keys, lookups_num, &result_hs);
+	bench_print("oahashset", keys, lookups_num, &result_oahs);
+
+	zbx_free(lookups);
+	zbx_free(itemids);
+
+	if (result_hs.sum != result_oahs.sum)
+	{
+		fprintf(stderr, "lookup results differ: " ZBX_FS_UI64 " != " ZBX_FS_UI64 "\n", result_hs.sum,
+				result_oahs.sum);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
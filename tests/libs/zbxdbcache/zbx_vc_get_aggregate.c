@@ -0,0 +1,218 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxmutexs.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates aggregate from the values returned by value cache      *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_test_calculate_aggregate(unsigned char value_type, int func, const zbx_vector_history_record_t *values,
+		zbx_history_value_t *value)
+{
+	int	i;
+
+	memset(value, 0, sizeof(zbx_history_value_t));
+
+	for (i = 0; i < values->values_num; i++)
+	{
+		const zbx_history_value_t	*v = &values->values[i].value;
+
+		switch (func)
+		{
+			case ZBX_VC_FUNCTION_SUM:
+			case ZBX_VC_FUNCTION_AVG:
+				if (ITEM_VALUE_TYPE_UINT64 == value_type && ZBX_VC_FUNCTION_SUM == func)
+					value->ui64 += v->ui64;
+				else if (ITEM_VALUE_TYPE_UINT64 == value_type)
+					value->dbl += (double)v->ui64;
+				else
+					value->dbl += v->dbl;
+				break;
+			case ZBX_VC_FUNCTION_MIN:
+				if (ITEM_VALUE_TYPE_UINT64 == value_type)
+				{
+					if (0 == i || v->ui64 < value->ui64)
+						value->ui64 = v->ui64;
+				}
+				else if (0 == i || v->dbl < value->dbl)
+					value->dbl = v->dbl;
+				break;
+			case ZBX_VC_FUNCTION_MAX:
+				if (ITEM_VALUE_TYPE_UINT64 == value_type)
+				{
+					if (0 == i || v->ui64 > value->ui64)
+						value->ui64 = v->ui64;
+				}
+				else if (0 == i || v->dbl > value->dbl)
+					value->dbl = v->dbl;
+				break;
+		}
+	}
+
+	if (ZBX_VC_FUNCTION_AVG == func && 0 != values->values_num)
+		value->dbl /= values->values_num;
+}
+
+static const char	*vc_test_function_name(int func)
+{
+	switch (func)
+	{
+		case ZBX_VC_FUNCTION_COUNT:
+			return "count";
+		case ZBX_VC_FUNCTION_SUM:
+			return "sum";
+		case ZBX_VC_FUNCTION_AVG:
+			return "avg";
+		case ZBX_VC_FUNCTION_MIN:
+			return "min";
+		case ZBX_VC_FUNCTION_MAX:
+			return "max";
+		default:
+			fail_msg("unknown aggregate function %d", func);
+			return NULL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks incrementally maintained aggregates against aggregates     *
+ *          calculated from the values of the same window                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_test_check_aggregates(zbx_uint64_t itemid, unsigned char value_type, int seconds,
+		const zbx_timespec_t *ts)
+{
+	zbx_vector_history_record_t	values;
+	zbx_history_value_t		expected, returned;
+	int				func, values_num, err;
+	char				msg[MAX_STRING_LEN];
+
+	zbx_history_record_vector_create(&values);
+
+	err = zbx_vc_get_values(itemid, value_type, &values, seconds, 0, ts);
+	zbx_mock_assert_result_eq("zbx_vc_get_values()", SUCCEED, err);
+
+	for (func = ZBX_VC_FUNCTION_COUNT; func <= ZBX_VC_FUNCTION_MAX; func++)
+	{
+		zbx_snprintf(msg, sizeof(msg), "zbx_vc_get_aggregate(%s) at %d.%09d", vc_test_function_name(func),
+				ts->sec, ts->ns);
+
+		err = zbx_vc_get_aggregate(itemid, value_type, func, seconds, ts, &returned, &values_num);
+		zbx_mock_assert_result_eq(msg, SUCCEED, err);
+		zbx_mock_assert_int_eq(msg, values.values_num, values_num);
+
+		if (ZBX_VC_FUNCTION_COUNT == func || 0 == values_num)
+			continue;
+
+		vc_test_calculate_aggregate(value_type, func, &values, &expected);
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type && ZBX_VC_FUNCTION_AVG != func)
+			zbx_mock_assert_uint64_eq(msg, expected.ui64, returned.ui64);
+		else
+			zbx_mock_assert_double_eq(msg, expected.dbl, returned.dbl);
+	}
+
+	zbx_history_record_vector_destroy(&values, value_type);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	int			err, seconds, ret_flush;
+	char			*error;
+	zbx_mock_handle_t	hin, hsteps, hstep, hvalues;
+	zbx_mock_error_t	mock_err;
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	zbx_timespec_t		ts;
+	zbx_vector_ptr_t	history;
+	zbx_history_value_t	value;
+
+	ZBX_UNUSED(state);
+
+	set_zbx_config_value_cache_size(ZBX_MEBIBYTE);
+
+	err = zbx_locks_create(&error);
+	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
+
+	err = zbx_vc_init(get_zbx_config_value_cache_size(), &error);
+	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
+
+	zbx_vc_enable();
+	zbx_vcmock_ds_init();
+
+	hin = zbx_mock_get_parameter_handle("in");
+	itemid = zbx_mock_get_object_member_uint64(hin, "itemid");
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(hin, "value type"));
+	seconds = zbx_mock_get_object_member_int(hin, "seconds");
+
+	/* aggregates are not maintained for items not in cache */
+	zbx_vcmock_set_time(hin, "time");
+	ts = zbx_vcmock_get_ts();
+	err = zbx_vc_get_aggregate(itemid, value_type, ZBX_VC_FUNCTION_SUM, seconds, &ts, &value, &ret_flush);
+	zbx_mock_assert_result_eq("zbx_vc_get_aggregate() for uncached item", FAIL, err);
+
+	hsteps = zbx_mock_get_object_member_handle(hin, "steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		if (ZBX_MOCK_SUCCESS != mock_err)
+			fail_msg("Cannot read step: %s", zbx_mock_error_string(mock_err));
+
+		zbx_vcmock_set_time(hstep, "time");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "values", &hvalues))
+		{
+			zbx_vector_ptr_create(&history);
+			zbx_vcmock_get_dc_history(hvalues, &history);
+
+			err = zbx_vc_add_values(&history, &ret_flush);
+			zbx_mock_assert_result_eq("zbx_vc_add_values()", SUCCEED, err);
+
+			zbx_vector_ptr_clear_ext(&history, zbx_vcmock_free_dc_history);
+			zbx_vector_ptr_destroy(&history);
+		}
+
+		ts = zbx_vcmock_get_ts();
+		vc_test_check_aggregates(itemid, value_type, seconds, &ts);
+
+		/* repeated request with the same window end uses the already moved aggregate */
+		vc_test_check_aggregates(itemid, value_type, seconds, &ts);
+	}
+
+	/* aggregates cannot be moved back in time */
+	ts.sec -= seconds;
+	err = zbx_vc_get_aggregate(itemid, value_type, ZBX_VC_FUNCTION_SUM, seconds, &ts, &value, &ret_flush);
+	zbx_mock_assert_result_eq("zbx_vc_get_aggregate() for older window", FAIL, err);
+
+	zbx_vcmock_ds_destroy();
+
+	zbx_vc_reset();
+	zbx_vc_destroy();
+}
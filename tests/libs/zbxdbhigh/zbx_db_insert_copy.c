@@ -0,0 +1,152 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxdbhigh.h"
+#include "zbxstr.h"
+
+static char	*copy_sql = NULL, *copy_data = NULL;
+static size_t	copy_data_len;
+
+int	__wrap_zbx_db_copy_basic(const char *sql, const char *data, size_t data_len);
+
+int	__wrap_zbx_db_copy_basic(const char *sql, const char *data, size_t data_len)
+{
+	copy_sql = zbx_strdup(copy_sql, sql);
+	copy_data = (char *)zbx_realloc(copy_data, data_len);
+	memcpy(copy_data, data, data_len);
+	copy_data_len = data_len;
+
+	return 1;
+}
+
+static void	mock_read_row(zbx_db_insert_t *db_insert, zbx_mock_handle_t hrow)
+{
+	zbx_mock_handle_t	hvalue;
+	zbx_db_value_t		values[ZBX_MAX_FIELDS], *pvalues[ZBX_MAX_FIELDS];
+	int			i;
+	const char		*str;
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hrow, &hvalue); i++)
+	{
+		const zbx_db_field_t	*field = (const zbx_db_field_t *)db_insert->fields.values[i];
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &str))
+			fail_msg("invalid row value");
+
+		switch (field->type)
+		{
+			case ZBX_TYPE_INT:
+				values[i].i32 = atoi(str);
+				break;
+			case ZBX_TYPE_FLOAT:
+				values[i].dbl = atof(str);
+				break;
+			case ZBX_TYPE_ID:
+			case ZBX_TYPE_UINT:
+				ZBX_STR2UINT64(values[i].ui64, str);
+				break;
+			default:
+				values[i].str = (char *)str;
+				break;
+		}
+
+		pvalues[i] = &values[i];
+	}
+
+	zbx_db_insert_add_values_dyn(db_insert, pvalues, i);
+}
+
+static char	*mock_hex(const char *data, size_t len)
+{
+	char	*hex = NULL;
+	size_t	hex_alloc = 0, hex_offset = 0;
+
+	for (size_t i = 0; i < len; i++)
+		zbx_snprintf_alloc(&hex, &hex_alloc, &hex_offset, "%02x", (unsigned char)data[i]);
+
+	return hex;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+#ifdef HAVE_POSTGRESQL
+	zbx_config_dbhigh_t	config_dbhigh = {.config_db_history_copy = 1};
+	zbx_db_insert_t		db_insert;
+	const zbx_db_table_t	*table;
+	const zbx_db_field_t	*fields[ZBX_MAX_FIELDS];
+	zbx_mock_handle_t	hfields, hfield, hrows, hrow;
+	const char		*str;
+	char			*hex;
+	int			fields_num;
+
+	ZBX_UNUSED(state);
+
+	zbx_init_library_dbhigh(&config_dbhigh);
+
+	if (NULL == (table = zbx_db_get_table(zbx_mock_get_parameter_string("in.table"))))
+		fail_msg("unknown table");
+
+	hfields = zbx_mock_get_parameter_handle("in.fields");
+
+	for (fields_num = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfields, &hfield); fields_num++)
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hfield, &str))
+			fail_msg("invalid field name");
+
+		if (NULL == (fields[fields_num] = zbx_db_get_field(table, str)))
+			fail_msg("unknown field '%s'", str);
+	}
+
+	zbx_db_insert_prepare_dyn(&db_insert, table, fields, fields_num);
+	zbx_db_insert_use_copy(&db_insert);
+
+	zbx_mock_assert_int_eq("copy enabled", (int)zbx_mock_get_parameter_uint64("out.copy"), db_insert.copy);
+
+	if (0 == db_insert.copy)
+	{
+		zbx_db_insert_clean(&db_insert);
+		return;
+	}
+
+	hrows = zbx_mock_get_parameter_handle("in.rows");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hrows, &hrow))
+		mock_read_row(&db_insert, hrow);
+
+	zbx_mock_assert_result_eq("insert result", SUCCEED, zbx_db_insert_execute(&db_insert));
+	zbx_db_insert_clean(&db_insert);
+
+	zbx_mock_assert_str_eq("copy statement", zbx_mock_get_parameter_string("out.sql"), copy_sql);
+
+	hex = mock_hex(copy_data, copy_data_len);
+	zbx_mock_assert_str_eq("copy data", zbx_mock_get_parameter_string("out.data"), hex);
+
+	zbx_free(hex);
+	zbx_free(copy_sql);
+	zbx_free(copy_data);
+#else
+	ZBX_UNUSED(state);
+	skip();
+#endif
+}
@@ -0,0 +1,102 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxeval.h"
+#include "mock_eval.h"
+
+static void	compare_values(const zbx_variant_t *expected, const zbx_variant_t *returned)
+{
+	if (ZBX_VARIANT_DBL == expected->type || ZBX_VARIANT_DBL == returned->type)
+	{
+		zbx_variant_t	value_expected, value_returned;
+
+		zbx_variant_copy(&value_expected, expected);
+		zbx_variant_copy(&value_returned, returned);
+
+		if (SUCCEED != zbx_variant_convert(&value_expected, ZBX_VARIANT_DBL) ||
+				SUCCEED != zbx_variant_convert(&value_returned, ZBX_VARIANT_DBL))
+		{
+			fail_msg("Expected value \"%s\" while got \"%s\"", zbx_variant_value_desc(expected),
+					zbx_variant_value_desc(returned));
+		}
+
+		zbx_mock_assert_double_eq("folded expression value", value_expected.data.dbl,
+				value_returned.data.dbl);
+	}
+	else
+	{
+		zbx_mock_assert_str_eq("folded expression value", zbx_variant_value_desc(expected),
+				zbx_variant_value_desc(returned));
+	}
+}
+
+static void	test_fold_constants(void)
+{
+	zbx_eval_context_t	ctx, ctx_folded;
+	char			*error = NULL, *error_folded = NULL;
+	int			ret, ret_folded;
+	zbx_variant_t		value, value_folded;
+	const char		*expression;
+
+	expression = zbx_mock_get_parameter_string("in.expression");
+
+	if (SUCCEED != zbx_eval_parse_expression(&ctx, expression, mock_eval_read_rules("in.rules"), &error))
+		fail_msg("failed to parse expression: %s", error);
+
+	memset(&ctx_folded, 0, sizeof(ctx_folded));
+	zbx_eval_copy(&ctx_folded, &ctx, expression);
+	zbx_eval_fold_constants(&ctx_folded);
+
+	zbx_mock_assert_int_eq("number of folded tokens", (int)zbx_mock_get_parameter_uint64("out.tokens"),
+			ctx_folded.stack.values_num);
+
+	ret = zbx_eval_execute(&ctx, NULL, &value, &error);
+	ret_folded = zbx_eval_execute(&ctx_folded, NULL, &value_folded, &error_folded);
+
+	zbx_mock_assert_result_eq("return value", zbx_mock_str_to_return_code(
+			zbx_mock_get_parameter_string("out.result")), ret_folded);
+	zbx_mock_assert_result_eq("return value of not folded expression", ret, ret_folded);
+
+	if (SUCCEED == ret)
+	{
+		compare_values(&value, &value_folded);
+		zbx_variant_clear(&value);
+		zbx_variant_clear(&value_folded);
+	}
+	else
+		zbx_mock_assert_str_eq("error message", error, error_folded);
+
+	zbx_free(error);
+	zbx_free(error_folded);
+	zbx_eval_clear(&ctx_folded);
+	zbx_eval_clear(&ctx);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	test_fold_constants();
+}
@@ -0,0 +1,125 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+/*
+ * Compares trigger expression evaluation when the expression is deserialized for
+ * every evaluation and when it's copied from prepared context with folded constants.
+ *
+ * The benchmark is not part of unit tests, it's built with
+ *   make zbx_eval_fold_constants_bench
+ * and run as
+ *   ./zbx_eval_fold_constants_bench [evaluations [expression]]
+ */
+
+#include "zbxcommon.h"
+#include "zbxeval.h"
+#include "zbxtime.h"
+#include "zbxvariant.h"
+
+#define BENCH_EVALUATIONS	200000
+#define BENCH_EXPRESSION	"(100 * 1024 * 1024 > 5M and 2K / 8 < 1000 - 24) or " \
+				"(3.5 * 2 = 7 and 90 / 100 * 60 >= 50)"
+
+#define BENCH_RULES	(ZBX_EVAL_PARSE_VAR | ZBX_EVAL_PARSE_MATH | ZBX_EVAL_PARSE_COMPARE | \
+			ZBX_EVAL_PARSE_LOGIC | ZBX_EVAL_PARSE_GROUP)
+
+static double	bench_evaluate(zbx_eval_context_t *ctx)
+{
+	zbx_variant_t	value;
+	char		*error = NULL;
+	double		result;
+
+	if (SUCCEED != zbx_eval_execute(ctx, NULL, &value, &error))
+	{
+		fprintf(stderr, "cannot evaluate expression: %s\n", error);
+		exit(EXIT_FAILURE);
+	}
+
+	zbx_variant_convert(&value, ZBX_VARIANT_DBL);
+	result = value.data.dbl;
+	zbx_variant_clear(&value);
+
+	return result;
+}
+
+int	main(int argc, char **argv)
+{
+	zbx_eval_context_t	ctx, *ctx_eval, *ctx_prepared, ctx_copy;
+	char			*error = NULL;
+	unsigned char		*data;
+	const char		*expression = BENCH_EXPRESSION;
+	int			i, evaluations = BENCH_EVALUATIONS;
+	double			time_start, time_deserialize, time_prepared, sum = 0, sum_prepared = 0;
+
+	if (1 < argc)
+		evaluations = atoi(argv[1]);
+
+	if (2 < argc)
+		expression = argv[2];
+
+	if (SUCCEED != zbx_eval_parse_expression(&ctx, expression, BENCH_RULES, &error))
+	{
+		fprintf(stderr, "cannot parse expression: %s\n", error);
+		return EXIT_FAILURE;
+	}
+
+	zbx_eval_serialize(&ctx, NULL, &data);
+
+	time_start = zbx_time();
+
+	for (i = 0; i < evaluations; i++)
+	{
+		ctx_eval = zbx_eval_deserialize_dyn(data, expression, ZBX_EVAL_EXTRACT_ALL);
+		sum += bench_evaluate(ctx_eval);
+		zbx_eval_clear(ctx_eval);
+		zbx_free(ctx_eval);
+	}
+
+	time_deserialize = zbx_time() - time_start;
+
+	ctx_prepared = zbx_eval_deserialize_dyn(data, expression, ZBX_EVAL_EXTRACT_ALL);
+	zbx_eval_fold_constants(ctx_prepared);
+
+	time_start = zbx_time();
+
+	for (i = 0; i < evaluations; i++)
+	{
+		memset(&ctx_copy, 0, sizeof(ctx_copy));
+		zbx_eval_copy(&ctx_copy, ctx_prepared, expression);
+		sum_prepared += bench_evaluate(&ctx_copy);
+		zbx_eval_clear(&ctx_copy);
+	}
+
+	time_prepared = zbx_time() - time_start;
+
+	printf("deserialized: %d evaluations %.6f sec (%.0f/sec), %d tokens\n", evaluations, time_deserialize,
+			(double)evaluations / time_deserialize, ctx.stack.values_num);
+	printf("prepared:     %d evaluations %.6f sec (%.0f/sec), %d tokens\n", evaluations, time_prepared,
+			(double)evaluations / time_prepared, ctx_prepared->stack.values_num);
+
+	if (sum != sum_prepared)
+		fprintf(stderr, "results differ: %f != %f\n", sum, sum_prepared);
+
+	zbx_eval_clear(ctx_prepared);
+	zbx_free(ctx_prepared);
+	zbx_free(data);
+	zbx_eval_clear(&ctx);
+
+	return sum == sum_prepared ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,60 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "ipc_test_common.h"
+
+static int	get_client_type(const char *str)
+{
+	if (0 == strcmp(str, "SYNC"))
+		return TEST_CLIENT_SYNC;
+	if (0 == strcmp(str, "ASYNC"))
+		return TEST_CLIENT_ASYNC;
+
+	fail_msg("unknown client type: %s", str);
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_ipc_test_t		test;
+	zbx_ipc_test_messages_t	test_messages;
+	zbx_uint32_t		received_num;
+	int			status, invalid_num;
+
+	ZBX_UNUSED(state);
+
+	test_messages.client_type = get_client_type(zbx_mock_get_parameter_string("in.client"));
+	test_messages.messages_num = (zbx_uint32_t)zbx_mock_get_parameter_uint64("in.messages");
+	test_messages.size = (zbx_uint32_t)zbx_mock_get_parameter_uint64("in.size");
+
+	zbx_ipc_set_ring_size(zbx_mock_get_parameter_uint64("in.ring_size"));
+
+	ipc_test_start(&test, ipc_test_send_messages, &test_messages);
+	ipc_test_recv_messages(&test, test_messages.size, &received_num, &invalid_num);
+	status = ipc_test_stop(&test);
+
+	zbx_mock_assert_int_eq("client exit status", 0, status);
+	zbx_mock_assert_int_eq("received messages", test_messages.messages_num, received_num);
+	zbx_mock_assert_int_eq("invalid messages", 0, invalid_num);
+}
@@ -0,0 +1,135 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+/*
+ * Compares IPC message throughput through socket and through shared memory ring
+ * with synchronous and asynchronous clients. Client process sends the messages,
+ * the service receives and checks them. IPC environment can be initialized only
+ * once per process, so every measurement runs in its own process.
+ *
+ * The benchmark is not part of unit tests, it's built with
+ *   make ipc_ring_transport_bench
+ * and run as
+ *   ./ipc_ring_transport_bench [messages [size [ring size]]]
+ */
+
+#include "zbxcommon.h"
+#include "zbxtime.h"
+
+#include "ipc_test_common.h"
+
+#define BENCH_MESSAGES	500000
+#define BENCH_SIZE	128
+#define BENCH_RING_SIZE	ZBX_MEBIBYTE
+
+static int	bench_run(zbx_uint64_t ring_size, int client_type, zbx_uint32_t messages_num, zbx_uint32_t size)
+{
+	zbx_ipc_test_t		test;
+	zbx_ipc_test_messages_t	test_messages;
+	zbx_uint32_t		received_num;
+	int			status, invalid_num;
+	double			time_start, time_total;
+
+	test_messages.client_type = client_type;
+	test_messages.messages_num = messages_num;
+	test_messages.size = size;
+
+	zbx_ipc_set_ring_size(ring_size);
+
+	time_start = zbx_time();
+
+	ipc_test_start(&test, ipc_test_send_messages, &test_messages);
+	ipc_test_recv_messages(&test, size, &received_num, &invalid_num);
+
+	time_total = zbx_time() - time_start;
+	status = ipc_test_stop(&test);
+
+	printf("%-6s %-5s client: %u messages of %u bytes in %.6f sec, %.0f messages/sec, %.2f MB/sec\n",
+			0 == ring_size ? "socket" : "ring", TEST_CLIENT_SYNC == client_type ? "sync" : "async",
+			received_num, size, time_total, received_num / time_total,
+			(double)received_num * (size + 8) / time_total / ZBX_MEBIBYTE);
+
+	if (0 != status || messages_num != received_num || 0 != invalid_num)
+	{
+		fprintf(stderr, "client exit status %d, received %u of %u messages, %d invalid\n", status,
+				received_num, messages_num, invalid_num);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+static int	bench_fork(zbx_uint64_t ring_size, int client_type, zbx_uint32_t messages_num, zbx_uint32_t size)
+{
+	pid_t	pid;
+	int	status;
+
+	fflush(stdout);
+
+	if (-1 == (pid = fork()))
+	{
+		fprintf(stderr, "cannot fork: %s\n", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (0 == pid)
+	{
+		status = bench_run(ring_size, client_type, messages_num, size);
+		fflush(stdout);
+		_exit(SUCCEED == status ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	if (pid != waitpid(pid, &status, 0) || !WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+int	main(int argc, char **argv)
+{
+	const int	client_types[] = {TEST_CLIENT_SYNC, TEST_CLIENT_ASYNC};
+	int		messages_num = BENCH_MESSAGES, size = BENCH_SIZE, i, ret = EXIT_SUCCESS;
+	zbx_uint64_t	ring_size = BENCH_RING_SIZE;
+
+	if (1 < argc)
+		messages_num = atoi(argv[1]);
+
+	if (2 < argc)
+		size = atoi(argv[2]);
+
+	if (3 < argc)
+		ring_size = (zbx_uint64_t)atoi(argv[3]);
+
+	if (0 >= messages_num || 0 > size || 0 == ring_size)
+	{
+		fprintf(stderr, "usage: %s [messages [size [ring size]]]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < (int)ARRSIZE(client_types); i++)
+	{
+		if (SUCCEED != bench_fork(0, client_types[i], (zbx_uint32_t)messages_num, (zbx_uint32_t)size))
+			ret = EXIT_FAILURE;
+
+		if (SUCCEED != bench_fork(ring_size, client_types[i], (zbx_uint32_t)messages_num, (zbx_uint32_t)size))
+			ret = EXIT_FAILURE;
+	}
+
+	return ret;
+}
@@ -0,0 +1,231 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "ipc_test_common.h"
+
+#include "zbxmocktest.h"
+#include "zbxtime.h"
+#include "zbxstr.h"
+
+void	ipc_test_fill_message(unsigned char *data, zbx_uint32_t size, zbx_uint32_t index)
+{
+	zbx_uint32_t	i;
+
+	for (i = 0; i < size; i++)
+		data[i] = (unsigned char)(index * 31 + i);
+}
+
+int	ipc_test_check_message(zbx_uint32_t code, const unsigned char *data, zbx_uint32_t data_size,
+		zbx_uint32_t size, zbx_uint32_t index)
+{
+	zbx_uint32_t	i;
+
+	if (index + 1 != code || size != data_size)
+		return FAIL;
+
+	for (i = 0; i < size; i++)
+	{
+		if ((unsigned char)(index * 31 + i) != data[i])
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts test service in temporary directory and forks client       *
+ *          process                                                           *
+ *                                                                            *
+ * Parameters: test        - [OUT] test environment                           *
+ *             client_func - [IN] client function executed in child process,  *
+ *                                its result is the child exit status         *
+ *             data        - [IN] client function data                        *
+ *                                                                            *
+ ******************************************************************************/
+void	ipc_test_start(zbx_ipc_test_t *test, zbx_ipc_test_client_func_t client_func, void *data)
+{
+	char	*error = NULL;
+
+	/* debug logging of every sent and received message would slow down the tests */
+	zbx_set_log_level(LOG_LEVEL_WARNING);
+
+	zbx_strlcpy(test->tmpdir, "/tmp/zbx_ipc_test_XXXXXX", sizeof(test->tmpdir));
+
+	if (NULL == mkdtemp(test->tmpdir))
+		fail_msg("cannot create temporary directory: %s", zbx_strerror(errno));
+
+	if (SUCCEED != zbx_ipc_service_init_env(test->tmpdir, &error))
+		fail_msg("cannot initialize IPC environment: %s", error);
+
+	if (SUCCEED != zbx_ipc_service_start(&test->service, TEST_SERVICE_NAME, &error))
+		fail_msg("cannot start IPC service: %s", error);
+
+	test->time_start = zbx_time();
+
+	if (-1 == (test->pid = fork()))
+		fail_msg("cannot fork: %s", zbx_strerror(errno));
+
+	if (0 == test->pid)
+		_exit(SUCCEED == client_func(data) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the test has not exceeded its time limit                *
+ *                                                                            *
+ ******************************************************************************/
+int	ipc_test_is_running(const zbx_ipc_test_t *test)
+{
+	return SEC_PER_MIN > zbx_time() - test->time_start ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for client process, stops test service and removes its      *
+ *          temporary directory                                               *
+ *                                                                            *
+ * Return value: The client process exit status.                              *
+ *                                                                            *
+ ******************************************************************************/
+int	ipc_test_stop(zbx_ipc_test_t *test)
+{
+	char	*path;
+	int	status;
+
+	if (test->pid != waitpid(test->pid, &status, 0))
+		fail_msg("cannot wait for client process: %s", zbx_strerror(errno));
+
+	zbx_ipc_service_close(&test->service);
+
+	path = zbx_dsprintf(NULL, "%s/zabbix_%s.sock", test->tmpdir, TEST_SERVICE_NAME);
+	unlink(path);
+	zbx_free(path);
+	rmdir(test->tmpdir);
+
+	return WEXITSTATUS(status);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends test messages to service, runs in child process             *
+ *                                                                            *
+ ******************************************************************************/
+int	ipc_test_send_messages(void *data)
+{
+	const zbx_ipc_test_messages_t	*test_messages = (const zbx_ipc_test_messages_t *)data;
+	unsigned char			*message;
+	zbx_uint32_t			i, messages_num = test_messages->messages_num, size = test_messages->size;
+	char				*error = NULL;
+	int				ret = FAIL;
+
+	message = (unsigned char *)zbx_malloc(NULL, size + 1);
+
+	if (TEST_CLIENT_SYNC == test_messages->client_type)
+	{
+		zbx_ipc_socket_t	csocket;
+
+		if (SUCCEED != zbx_ipc_socket_open(&csocket, TEST_SERVICE_NAME, SEC_PER_MIN, &error))
+			goto out;
+
+		for (i = 0; i < messages_num; i++)
+		{
+			ipc_test_fill_message(message, size, i);
+
+			if (SUCCEED != zbx_ipc_socket_write(&csocket, i + 1, message, size))
+				break;
+		}
+
+		zbx_ipc_socket_close(&csocket);
+	}
+	else
+	{
+		zbx_ipc_async_socket_t	asocket;
+
+		if (SUCCEED != zbx_ipc_async_socket_open(&asocket, TEST_SERVICE_NAME, SEC_PER_MIN, &error))
+			goto out;
+
+		for (i = 0; i < messages_num; i++)
+		{
+			ipc_test_fill_message(message, size, i);
+
+			if (SUCCEED != zbx_ipc_async_socket_send(&asocket, i + 1, message, size))
+				break;
+
+			/* keep the send queue short, like data collectors flushing values */
+			if (0 == (i & 255) && SUCCEED != zbx_ipc_async_socket_flush(&asocket, 0))
+				break;
+		}
+
+		if (i == messages_num && SUCCEED != zbx_ipc_async_socket_flush(&asocket, ZBX_IPC_WAIT_FOREVER))
+			i = 0;
+
+		zbx_ipc_async_socket_close(&asocket);
+	}
+
+	if (i == messages_num)
+		ret = SUCCEED;
+out:
+	zbx_free(error);
+	zbx_free(message);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receives test messages sent by ipc_test_send_messages() until     *
+ *          the client disconnects or the test time limit is exceeded         *
+ *                                                                            *
+ * Parameters: test         - [IN] test environment                           *
+ *             size         - [IN] expected message size                      *
+ *             received_num - [OUT] number of received messages               *
+ *             invalid_num  - [OUT] number of invalid messages                *
+ *                                                                            *
+ ******************************************************************************/
+void	ipc_test_recv_messages(zbx_ipc_test_t *test, zbx_uint32_t size, zbx_uint32_t *received_num,
+		int *invalid_num)
+{
+	zbx_ipc_client_t	*client;
+	zbx_ipc_message_t	*message;
+	zbx_timespec_t		timeout = {1, 0};
+
+	*received_num = 0;
+	*invalid_num = 0;
+
+	while (SUCCEED == ipc_test_is_running(test))
+	{
+		zbx_ipc_service_recv(&test->service, &timeout, &client, &message);
+
+		if (NULL == client)
+			continue;
+
+		if (NULL == message)
+			break;
+
+		if (SUCCEED != ipc_test_check_message(message->code, message->data, message->size, size,
+				(*received_num)++))
+		{
+			(*invalid_num)++;
+		}
+
+		zbx_ipc_message_free(message);
+		zbx_ipc_client_release(client);
+	}
+}
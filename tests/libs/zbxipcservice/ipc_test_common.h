@@ -0,0 +1,61 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_IPC_TEST_COMMON_H
+#define ZABBIX_IPC_TEST_COMMON_H
+
+#include "zbxipcservice.h"
+
+#define TEST_SERVICE_NAME	"ipc_test"
+
+#define TEST_CLIENT_SYNC	0
+#define TEST_CLIENT_ASYNC	1
+
+typedef struct
+{
+	zbx_ipc_service_t	service;
+	char			tmpdir[32];
+	pid_t			pid;
+	double			time_start;
+}
+zbx_ipc_test_t;
+
+typedef struct
+{
+	int		client_type;
+	zbx_uint32_t	messages_num;
+	zbx_uint32_t	size;
+}
+zbx_ipc_test_messages_t;
+
+typedef int	(*zbx_ipc_test_client_func_t)(void *data);
+
+void	ipc_test_fill_message(unsigned char *data, zbx_uint32_t size, zbx_uint32_t index);
+int	ipc_test_check_message(zbx_uint32_t code, const unsigned char *data, zbx_uint32_t data_size,
+		zbx_uint32_t size, zbx_uint32_t index);
+
+void	ipc_test_start(zbx_ipc_test_t *test, zbx_ipc_test_client_func_t client_func, void *data);
+int	ipc_test_is_running(const zbx_ipc_test_t *test);
+int	ipc_test_stop(zbx_ipc_test_t *test);
+
+int	ipc_test_send_messages(void *data);
+void	ipc_test_recv_messages(zbx_ipc_test_t *test, zbx_uint32_t size, zbx_uint32_t *received_num,
+		int *invalid_num);
+
+#endif
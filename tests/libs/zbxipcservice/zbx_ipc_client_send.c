@@ -0,0 +1,151 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "ipc_test_common.h"
+
+typedef struct
+{
+	zbx_uint32_t	messages_num;
+	zbx_uint32_t	request_size;
+	zbx_uint32_t	reply_size;
+}
+zbx_ipc_send_test_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends all requests before reading any reply, so the service must  *
+ *          queue the replies, runs in child process                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	test_send_requests(void *data)
+{
+	const zbx_ipc_send_test_t	*send_test = (const zbx_ipc_send_test_t *)data;
+	zbx_ipc_socket_t		csocket;
+	zbx_ipc_message_t		message;
+	unsigned char			*request;
+	zbx_uint32_t			i;
+	char				*error = NULL;
+	int				ret = FAIL;
+
+	request = (unsigned char *)zbx_malloc(NULL, send_test->request_size + 1);
+
+	if (SUCCEED != zbx_ipc_socket_open(&csocket, TEST_SERVICE_NAME, SEC_PER_MIN, &error))
+		goto out;
+
+	for (i = 0; i < send_test->messages_num; i++)
+	{
+		ipc_test_fill_message(request, send_test->request_size, i);
+
+		if (SUCCEED != zbx_ipc_socket_write(&csocket, i + 1, request, send_test->request_size))
+			goto close;
+	}
+
+	for (i = 0; i < send_test->messages_num; i++)
+	{
+		if (SUCCEED != zbx_ipc_socket_read(&csocket, &message))
+			goto close;
+
+		ret = ipc_test_check_message(message.code, message.data, message.size, send_test->reply_size, i);
+		zbx_ipc_message_clean(&message);
+
+		if (SUCCEED != ret)
+			goto close;
+	}
+
+	ret = SUCCEED;
+close:
+	zbx_ipc_socket_close(&csocket);
+out:
+	zbx_free(error);
+	zbx_free(request);
+
+	return ret;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_ipc_test_t		test;
+	zbx_ipc_send_test_t	send_test;
+	zbx_ipc_client_t	*client;
+	zbx_ipc_message_t	*message;
+	zbx_ipc_client_stats_t	stats = {0};
+	zbx_timespec_t		timeout = {1, 0};
+	zbx_uint32_t		received_num = 0;
+	unsigned char		*reply;
+	int			status, invalid_num = 0, batched;
+
+	ZBX_UNUSED(state);
+
+	send_test.messages_num = (zbx_uint32_t)zbx_mock_get_parameter_uint64("in.messages");
+	send_test.request_size = (zbx_uint32_t)zbx_mock_get_parameter_uint64("in.request_size");
+	send_test.reply_size = (zbx_uint32_t)zbx_mock_get_parameter_uint64("in.reply_size");
+	batched = (0 == strcmp(zbx_mock_get_parameter_string("out.batched"), "YES") ? SUCCEED : FAIL);
+
+	reply = (unsigned char *)zbx_malloc(NULL, send_test.reply_size + 1);
+
+	ipc_test_start(&test, test_send_requests, &send_test);
+
+	while (SUCCEED == ipc_test_is_running(&test))
+	{
+		zbx_ipc_service_recv(&test.service, &timeout, &client, &message);
+
+		if (NULL == client)
+			continue;
+
+		if (NULL == message)
+		{
+			zbx_ipc_client_get_stats(client, &stats);
+			break;
+		}
+
+		if (SUCCEED != ipc_test_check_message(message->code, message->data, message->size,
+				send_test.request_size, received_num))
+		{
+			invalid_num++;
+		}
+
+		ipc_test_fill_message(reply, send_test.reply_size, received_num);
+
+		if (SUCCEED != zbx_ipc_client_send(client, ++received_num, reply, send_test.reply_size))
+			invalid_num++;
+
+		zbx_ipc_message_free(message);
+		zbx_ipc_client_release(client);
+	}
+
+	status = ipc_test_stop(&test);
+	zbx_free(reply);
+
+	zbx_mock_assert_int_eq("client exit status", 0, status);
+	zbx_mock_assert_int_eq("received messages", send_test.messages_num, received_num);
+	zbx_mock_assert_int_eq("invalid messages", 0, invalid_num);
+	zbx_mock_assert_uint64_eq("received message counter", send_test.messages_num, stats.rx_messages);
+	zbx_mock_assert_uint64_eq("sent message counter", send_test.messages_num, stats.tx_messages);
+
+	if (SUCCEED == batched && stats.tx_writes >= stats.tx_messages)
+	{
+		fail_msg("expected fewer writes than sent messages, got " ZBX_FS_UI64 " writes for " ZBX_FS_UI64
+				" messages", stats.tx_writes, stats.tx_messages);
+	}
+}
@@ -0,0 +1,263 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxjson.h"
+#include "zbxstr.h"
+#include "../../../src/libs/zbxjson/json_index.h"
+#include "../../../src/libs/zbxjson/json_parser.h"
+
+#define	NAVIGATE	1
+#define	RELEASE		2
+
+#define TEST_DATA_TAG	"history data"
+
+time_t	__wrap_time(time_t *seconds);
+time_t	__real_time(time_t *seconds);
+
+/* the time returned to index expiration checks, 0 - real time */
+static time_t	test_time;
+
+time_t	__wrap_time(time_t *seconds)
+{
+	if (0 == test_time)
+		return __real_time(seconds);
+
+	if (NULL != seconds)
+		*seconds = test_time;
+
+	return test_time;
+}
+
+static char	*test_build_json(const char *row, int rows)
+{
+	char	*json = NULL;
+	size_t	json_alloc = 0, json_offset = 0;
+	int	i;
+
+	zbx_strcpy_alloc(&json, &json_alloc, &json_offset, "{\"request\":\"history data\",\"" TEST_DATA_TAG "\": [");
+
+	for (i = 0; i < rows; i++)
+	{
+		if (0 != i)
+			zbx_chrcpy_alloc(&json, &json_alloc, &json_offset, ',');
+
+		/* vary row alignment against the 64 byte classification blocks */
+		zbx_strncpy_alloc(&json, &json_alloc, &json_offset, "      ", i % 7);
+		zbx_strcpy_alloc(&json, &json_alloc, &json_offset, row);
+	}
+
+	zbx_strcpy_alloc(&json, &json_alloc, &json_offset, "],\"clock\":1700000000,\"ns\":123}");
+
+	return json;
+}
+
+static void	test_compare_elements(const struct zbx_json_parse *jp, const struct zbx_json_parse *jp_raw, int rows)
+{
+	const char	*p = NULL, *p_raw = NULL;
+	int		num = 0;
+
+	do
+	{
+		p = zbx_json_next(jp, p);
+		p_raw = zbx_json_next(jp_raw, p_raw);
+
+		zbx_mock_assert_ptr_eq("next element", p_raw, p);
+
+		if (NULL != p)
+			num++;
+	}
+	while (NULL != p);
+
+	if (-1 != rows)
+		zbx_mock_assert_int_eq("number of elements", rows, num);
+}
+
+static void	test_navigate_impl(const char *json, int rows, int elements, int indexed)
+{
+	struct zbx_json_parse	jp, jp_raw, jp_data, jp_data_raw, jp_path, jp_path_raw;
+	int			i;
+
+	if (SUCCEED != zbx_json_open(json, &jp))
+		fail_msg("cannot open json: %s", zbx_json_strerror());
+
+	zbx_mock_assert_int_eq("buffer indexed", indexed, NULL != jp.index);
+
+	jp_raw = jp;
+	jp_raw.index = NULL;
+
+	test_compare_elements(&jp, &jp_raw, 4);
+
+	if (SUCCEED != zbx_json_brackets_by_name(&jp, TEST_DATA_TAG, &jp_data))
+		fail_msg("cannot open indexed data: %s", zbx_json_strerror());
+
+	if (SUCCEED != zbx_json_brackets_by_name(&jp_raw, TEST_DATA_TAG, &jp_data_raw))
+		fail_msg("cannot open data: %s", zbx_json_strerror());
+
+	zbx_mock_assert_ptr_eq("data start", jp_data_raw.start, jp_data.start);
+	zbx_mock_assert_ptr_eq("data end", jp_data_raw.end, jp_data.end);
+
+	test_compare_elements(&jp_data, &jp_data_raw, elements);
+
+	/* check the elements of first, middle and last rows */
+	for (i = 0; i < 3; i++)
+	{
+		char	path[64];
+
+		zbx_snprintf(path, sizeof(path), "$['" TEST_DATA_TAG "'][%d]", (rows - 1) * i / 2);
+
+		if (SUCCEED != zbx_json_open_path(&jp, path, &jp_path))
+			fail_msg("cannot open indexed path %s: %s", path, zbx_json_strerror());
+
+		if (SUCCEED != zbx_json_open_path(&jp_raw, path, &jp_path_raw))
+			fail_msg("cannot open path %s: %s", path, zbx_json_strerror());
+
+		zbx_mock_assert_ptr_eq("path start", jp_path_raw.start, jp_path.start);
+		zbx_mock_assert_ptr_eq("path end", jp_path_raw.end, jp_path.end);
+
+		if ('{' == *jp_path.start || '[' == *jp_path.start)
+			test_compare_elements(&jp_path, &jp_path_raw, -1);
+	}
+}
+
+static void	test_navigate(void)
+{
+	const char	*row;
+	char		*json;
+	int		rows, elements, indexed, impl;
+
+	row = zbx_mock_get_parameter_string("in.row");
+	rows = (int)zbx_mock_get_parameter_uint64("in.rows");
+	elements = (int)zbx_mock_get_parameter_uint64("out.elements");
+	indexed = (0 == strcmp(zbx_mock_get_parameter_string("out.indexed"), "yes"));
+
+	json = test_build_json(row, rows);
+
+	for (impl = ZBX_JSON_INDEX_IMPL_SCALAR; impl <= ZBX_JSON_INDEX_IMPL_AVX2; impl++)
+	{
+		if (SUCCEED == json_index_set_impl(impl))
+			test_navigate_impl(json, rows, elements, indexed);
+	}
+
+	json_index_set_impl(ZBX_JSON_INDEX_IMPL_AUTO);
+	zbx_free(json);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check that index memory is released after indexes were not used  *
+ *          for a while and the parsed object can still be navigated          *
+ *                                                                            *
+ ******************************************************************************/
+static void	test_release(void)
+{
+	struct zbx_json_parse	jp, jp_raw, jp_small, jp_data, jp_data_raw;
+	const zbx_json_index_t	*index;
+	char			*json;
+	int			rows;
+
+	rows = (int)zbx_mock_get_parameter_uint64("in.rows");
+	json = test_build_json(zbx_mock_get_parameter_string("in.row"), rows);
+
+	/* start past any expiration time set with real time */
+	test_time = __real_time(NULL) + 10 * ZBX_JSON_INDEX_TTL;
+
+	if (SUCCEED != zbx_json_open(json, &jp))
+		fail_msg("cannot open json: %s", zbx_json_strerror());
+
+	if (NULL == (index = jp.index))
+		fail_msg("buffer was not indexed");
+
+	/* opening other buffers before expiration time keeps index */
+	test_time += ZBX_JSON_INDEX_TTL - 1;
+
+	if (SUCCEED != zbx_json_open("{\"request\":\"ping\"}", &jp_small))
+		fail_msg("cannot open small json: %s", zbx_json_strerror());
+
+	zbx_mock_assert_int_ne("index allocation before expiration", 0, (int)index->alloc);
+
+	/* index used since it was created is kept for another period */
+	test_time++;
+
+	if (SUCCEED != zbx_json_open("{\"request\":\"ping\"}", &jp_small))
+		fail_msg("cannot open small json: %s", zbx_json_strerror());
+
+	zbx_mock_assert_int_ne("index allocation of used index", 0, (int)index->alloc);
+
+	/* index not used during the period is released */
+	test_time += ZBX_JSON_INDEX_TTL;
+
+	if (SUCCEED != zbx_json_open("{\"request\":\"ping\"}", &jp_small))
+		fail_msg("cannot open small json: %s", zbx_json_strerror());
+
+	zbx_mock_assert_int_eq("index allocation of unused index", 0, (int)index->alloc);
+	zbx_mock_assert_ptr_eq("index positions of unused index", NULL, index->pos);
+	zbx_mock_assert_result_eq("released index usable", FAIL, json_index_usable(jp.index, &jp));
+
+	test_time = 0;
+
+	/* the parsed object falls back to plain scanning */
+	jp_raw = jp;
+	jp_raw.index = NULL;
+
+	test_compare_elements(&jp, &jp_raw, 4);
+
+	if (SUCCEED != zbx_json_brackets_by_name(&jp, TEST_DATA_TAG, &jp_data) ||
+			SUCCEED != zbx_json_brackets_by_name(&jp_raw, TEST_DATA_TAG, &jp_data_raw))
+	{
+		fail_msg("cannot open data: %s", zbx_json_strerror());
+	}
+
+	test_compare_elements(&jp_data, &jp_data_raw, rows);
+
+	zbx_free(json);
+}
+
+static int	get_type(const char *str)
+{
+	if (0 == strcmp(str, "NAVIGATE"))
+		return NAVIGATE;
+	if (0 == strcmp(str, "RELEASE"))
+		return RELEASE;
+
+	fail_msg("unknown cmocka step type: %s", str);
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	switch (get_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case NAVIGATE:
+			test_navigate();
+			break;
+		case RELEASE:
+			test_release();
+			break;
+		default:
+			fail_msg("unknown cmocka step type: %s", zbx_mock_get_parameter_string("in.type"));
+	}
+}
@@ -0,0 +1,210 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+/*
+ * Compares processing of large proxy data packet with plain scanning and with
+ * structural index built by every available block classification implementation.
+ * The packet is processed like proxy data - missing sections are looked up and
+ * history rows are iterated, reading one value of every row.
+ *
+ * The benchmark is not part of unit tests, it's built with
+ *   make zbx_json_index_bench
+ * and run as
+ *   ./zbx_json_index_bench [rows [cycles]]
+ *
+ * The best time of all cycles is reported.
+ */
+
+#include "zbxcommon.h"
+#include "zbxjson.h"
+#include "zbxstr.h"
+#include "zbxnum.h"
+#include "zbxtime.h"
+#include "../../../src/libs/zbxjson/json_index.h"
+#include "../../../src/libs/zbxjson/json_parser.h"
+
+#define BENCH_ROWS	200000
+#define BENCH_CYCLES	3
+#define BENCH_DATA_TAG	"history data"
+#define BENCH_ROW	"{\"id\":%d,\"itemid\":%d,\"clock\":1700000000,\"ns\":123456789,\"value\":\"%d.5\"}"
+
+static char	*bench_build_json(int rows)
+{
+	char	*json = NULL;
+	size_t	json_alloc = 0, json_offset = 0;
+	int	i;
+
+	zbx_snprintf_alloc(&json, &json_alloc, &json_offset, "{\"request\":\"proxy data\",\"host\":\"proxy\","
+			"\"session\":\"2bed6a8a3f0c4a6f8e3a6c4ec1ae1d2c\",\"" BENCH_DATA_TAG "\":[");
+
+	for (i = 0; i < rows; i++)
+	{
+		if (0 != i)
+			zbx_chrcpy_alloc(&json, &json_alloc, &json_offset, ',');
+
+		zbx_snprintf_alloc(&json, &json_alloc, &json_offset, BENCH_ROW, i + 1, 10000 + i % 5000, i);
+	}
+
+	zbx_strcpy_alloc(&json, &json_alloc, &json_offset, "],\"clock\":1700000000,\"ns\":123}");
+
+	return json;
+}
+
+/* process the buffer like proxy data is processed - look up the sections and iterate history rows */
+static int	bench_process(const struct zbx_json_parse *jp, zbx_uint64_t *sum)
+{
+	const char		*tags[] = {"interface availability", "discovery data", "auto registration", "tasks",
+				"host data", "version", NULL};
+	struct zbx_json_parse	jp_data, jp_row;
+	const char		*p = NULL;
+	char			buf[MAX_ID_LEN + 1];
+	int			i;
+
+	for (i = 0; NULL != tags[i]; i++)
+	{
+		if (NULL != zbx_json_pair_by_name(jp, tags[i]))
+			return FAIL;
+	}
+
+	if (SUCCEED != zbx_json_brackets_by_name(jp, BENCH_DATA_TAG, &jp_data))
+		return FAIL;
+
+	while (NULL != (p = zbx_json_next(&jp_data, p)))
+	{
+		zbx_uint64_t	value;
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_row))
+			return FAIL;
+
+		if (SUCCEED == zbx_json_value_by_name(&jp_row, "itemid", buf, sizeof(buf), NULL) &&
+				SUCCEED == zbx_is_uint64(buf, &value))
+		{
+			*sum += value;
+		}
+	}
+
+	return SUCCEED;
+}
+
+/* open and process the buffer, with impl 0 the index is not used */
+static int	bench_run(const char *json, int impl, int cycles, double *time_open, double *time_process,
+		zbx_uint64_t *sum)
+{
+	struct zbx_json_parse	jp;
+	double			time_start, time_opened;
+	int			i;
+
+	*time_open = *time_process = 0;
+
+	for (i = 0; i < cycles; i++)
+	{
+		double	time_processed;
+
+		*sum = 0;
+		time_start = zbx_time();
+
+		if (0 == impl)
+		{
+			zbx_int64_t	len;
+
+			/* opening without index costs only the validation */
+			if (0 == (len = zbx_json_validate(json, NULL)))
+				return FAIL;
+
+			jp.start = json;
+			jp.end = json + len - 1;
+			jp.index = NULL;
+		}
+		else if (SUCCEED != zbx_json_open(json, &jp) || NULL == jp.index)
+			return FAIL;
+
+		time_opened = zbx_time();
+
+		if (SUCCEED != bench_process(&jp, sum))
+			return FAIL;
+
+		time_processed = zbx_time();
+
+		if (0 == i || time_opened - time_start < *time_open)
+			*time_open = time_opened - time_start;
+
+		if (0 == i || time_processed - time_opened < *time_process)
+			*time_process = time_processed - time_opened;
+	}
+
+	return SUCCEED;
+}
+
+int	main(int argc, char **argv)
+{
+	const char	*names[] = {"scan", "scalar", "sse2", "avx2"};
+	char		*json;
+	int		rows = BENCH_ROWS, cycles = BENCH_CYCLES, impl, ret = EXIT_SUCCESS;
+	zbx_uint64_t	sum_raw = 0;
+
+	if (1 < argc)
+		rows = atoi(argv[1]);
+
+	if (2 < argc)
+		cycles = atoi(argv[2]);
+
+	if (0 >= rows || 0 >= cycles)
+	{
+		fprintf(stderr, "usage: %s [rows [cycles]]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	json = bench_build_json(rows);
+
+	printf("%d rows, %d bytes\n", rows, (int)strlen(json));
+
+	for (impl = 0; impl <= ZBX_JSON_INDEX_IMPL_AVX2; impl++)
+	{
+		double		time_open, time_process;
+		zbx_uint64_t	sum;
+
+		if (0 != impl && SUCCEED != json_index_set_impl(impl))
+			continue;
+
+		if (SUCCEED != bench_run(json, impl, cycles, &time_open, &time_process, &sum))
+		{
+			fprintf(stderr, "%s: cannot process json: %s\n", names[impl], zbx_json_strerror());
+			ret = EXIT_FAILURE;
+			break;
+		}
+
+		printf("%-6s  open %.6f sec, process %.6f sec, total %.6f sec\n", names[impl], time_open,
+				time_process, time_open + time_process);
+
+		if (0 == impl)
+		{
+			sum_raw = sum;
+		}
+		else if (sum != sum_raw)
+		{
+			fprintf(stderr, "%s: sum of values " ZBX_FS_UI64 " differs from " ZBX_FS_UI64 "\n",
+					names[impl], sum, sum_raw);
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	zbx_free(json);
+
+	return ret;
+}
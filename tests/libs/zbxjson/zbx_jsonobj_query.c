@@ -51,6 +51,53 @@ static void	check_indefinite_path_result(zbx_mock_handle_t handle, const char *r
 	zbx_mock_assert_json_eq("Indefinite query result", expected_output, returned_output);
 }
 
+static void	test_query_paths(zbx_jsonobj_t *obj, const char *path, int expected_ret, const char *expected_output)
+{
+	/* the tested path is mixed with paths sharing and not sharing its prefix */
+	const char		*paths[] = {"$.*", NULL, "$.books[0].price", NULL, "$[0]", "$..id"};
+	zbx_jsonpath_t		jsonpaths[ARRSIZE(paths)];
+	zbx_jsonpath_query_t	queries[ARRSIZE(paths)];
+	int			i;
+
+	if (SUCCEED != zbx_jsonpath_compile(path, &jsonpaths[1]))
+	{
+		zbx_mock_assert_result_eq("zbx_jsonpath_compile() return value", expected_ret, FAIL);
+		return;
+	}
+
+	jsonpaths[3] = jsonpaths[1];
+
+	for (i = 0; i < (int)ARRSIZE(paths); i++)
+	{
+		if (NULL != paths[i] && SUCCEED != zbx_jsonpath_compile(paths[i], &jsonpaths[i]))
+			fail_msg("cannot compile \"%s\": %s", paths[i], zbx_json_strerror());
+
+		queries[i].path = &jsonpaths[i];
+	}
+
+	zbx_jsonobj_query_paths(obj, NULL, queries, ARRSIZE(paths));
+
+	for (i = 1; i <= 3; i += 2)
+	{
+		zbx_mock_assert_result_eq("zbx_jsonobj_query_paths() return value", expected_ret,
+				NULL == queries[i].error ? SUCCEED : FAIL);
+
+		if (NULL == expected_output)
+			zbx_mock_assert_ptr_eq("zbx_jsonobj_query_paths() result", NULL, queries[i].output);
+		else
+			zbx_mock_assert_str_eq("zbx_jsonobj_query_paths() result", expected_output, queries[i].output);
+	}
+
+	for (i = 0; i < (int)ARRSIZE(paths); i++)
+	{
+		zbx_free(queries[i].output);
+		zbx_free(queries[i].error);
+
+		if (3 != i)
+			zbx_jsonpath_clear(&jsonpaths[i]);
+	}
+}
+
 static void	test_query(zbx_jsonobj_t *obj, const char *path, int expected_ret)
 {
 	char			*output = NULL;
@@ -83,6 +130,9 @@ static void	test_query(zbx_jsonobj_t *obj, const char *path, int expected_ret)
 	else
 		zbx_mock_assert_str_ne("tzbx_jsonpath_query() error", "", zbx_json_strerror());
 
+	/* multiple path query must return the same result as single path query */
+	test_query_paths(obj, path, returned_ret, output);
+
 	zbx_free(output);
 
 }
@@ -0,0 +1,267 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbx_item_constants.h"
+#include "module.h"
+#include "libs/zbxpreproc/pp_batch.h"
+
+static const char	*mock_get_optional_string(zbx_mock_handle_t handle, const char *name)
+{
+	zbx_mock_handle_t	member;
+	const char		*str;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(handle, name, &member))
+		return NULL;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_string(member, &str))
+		fail_msg("invalid '%s' field", name);
+
+	return str;
+}
+
+static int	mock_has_member(zbx_mock_handle_t handle, const char *name)
+{
+	zbx_mock_handle_t	member;
+
+	return ZBX_MOCK_SUCCESS == zbx_mock_object_member(handle, name, &member) ? SUCCEED : FAIL;
+}
+
+static AGENT_RESULT	*mock_read_result(zbx_mock_handle_t hvalue)
+{
+	zbx_mock_handle_t	hresult;
+	AGENT_RESULT		*result;
+	const char		*type, *value;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hvalue, "result", &hresult))
+		return NULL;
+
+	result = (AGENT_RESULT *)zbx_malloc(NULL, sizeof(AGENT_RESULT));
+	zbx_init_agent_result(result);
+
+	type = zbx_mock_get_object_member_string(hresult, "type");
+	value = zbx_mock_get_object_member_string(hresult, "value");
+
+	if (0 == strcmp(type, "UI64"))
+	{
+		zbx_uint64_t	ui64;
+
+		ZBX_STR2UINT64(ui64, value);
+		SET_UI64_RESULT(result, ui64);
+	}
+	else if (0 == strcmp(type, "DBL"))
+		SET_DBL_RESULT(result, atof(value));
+	else if (0 == strcmp(type, "STR"))
+		SET_STR_RESULT(result, zbx_strdup(NULL, value));
+	else if (0 == strcmp(type, "TEXT"))
+		SET_TEXT_RESULT(result, zbx_strdup(NULL, value));
+	else if (0 == strcmp(type, "MSG"))
+		SET_MSG_RESULT(result, zbx_strdup(NULL, value));
+	else if (0 == strcmp(type, "LOG"))
+	{
+		zbx_log_t	*log;
+		const char	*source;
+
+		log = (zbx_log_t *)zbx_malloc(NULL, sizeof(zbx_log_t));
+		log->value = zbx_strdup(NULL, value);
+		log->source = (NULL != (source = mock_get_optional_string(hresult, "source")) ?
+				zbx_strdup(NULL, source) : NULL);
+		log->timestamp = zbx_mock_get_object_member_int(hresult, "timestamp");
+		log->severity = zbx_mock_get_object_member_int(hresult, "severity");
+		log->logeventid = zbx_mock_get_object_member_int(hresult, "logeventid");
+		SET_LOG_RESULT(result, log);
+	}
+	else
+		fail_msg("unknown result type: %s", type);
+
+	if (SUCCEED == mock_has_member(hresult, "lastlogsize"))
+	{
+		result->lastlogsize = zbx_mock_get_object_member_uint64(hresult, "lastlogsize");
+		result->mtime = zbx_mock_get_object_member_int(hresult, "mtime");
+		result->type |= AR_META;
+	}
+
+	return result;
+}
+
+static void	mock_read_value(zbx_mock_handle_t hvalue, zbx_preproc_item_value_t *value)
+{
+	memset(value, 0, sizeof(zbx_preproc_item_value_t));
+
+	value->itemid = zbx_mock_get_object_member_uint64(hvalue, "itemid");
+	value->hostid = zbx_mock_get_object_member_uint64(hvalue, "hostid");
+	value->item_value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(hvalue, "value_type"));
+	value->item_flags = (unsigned char)zbx_mock_get_object_member_int(hvalue, "flags");
+	value->state = (0 == strcmp(zbx_mock_get_object_member_string(hvalue, "state"), "NOTSUPPORTED") ?
+			ITEM_STATE_NOTSUPPORTED : ITEM_STATE_NORMAL);
+	value->error = (char *)mock_get_optional_string(hvalue, "error");
+
+	if (SUCCEED == mock_has_member(hvalue, "sec"))
+	{
+		value->ts = (zbx_timespec_t *)zbx_malloc(NULL, sizeof(zbx_timespec_t));
+		value->ts->sec = zbx_mock_get_object_member_int(hvalue, "sec");
+		value->ts->ns = zbx_mock_get_object_member_int(hvalue, "ns");
+	}
+
+	value->result = mock_read_result(hvalue);
+}
+
+static void	mock_value_clear(zbx_preproc_item_value_t *value)
+{
+	zbx_free(value->ts);
+
+	if (NULL != value->result)
+	{
+		zbx_free_agent_result(value->result);
+		zbx_free(value->result);
+	}
+}
+
+static void	check_value(zbx_mock_handle_t hexpected, zbx_pp_batch_value_t *value)
+{
+	const char	*type, *str;
+
+	zbx_mock_assert_uint64_eq("itemid", zbx_mock_get_object_member_uint64(hexpected, "itemid"), value->itemid);
+	zbx_mock_assert_uint64_eq("hostid", zbx_mock_get_object_member_uint64(hexpected, "hostid"), value->hostid);
+	zbx_mock_assert_int_eq("value type", zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(hexpected,
+			"value_type")), value->value_type);
+
+	if (SUCCEED == mock_has_member(hexpected, "sec"))
+	{
+		zbx_mock_assert_int_eq("ts.sec", zbx_mock_get_object_member_int(hexpected, "sec"), value->ts.sec);
+		zbx_mock_assert_int_eq("ts.ns", zbx_mock_get_object_member_int(hexpected, "ns"), value->ts.ns);
+	}
+	else
+		zbx_mock_assert_int_eq("ts.sec", 0, value->ts.sec);
+
+	type = zbx_mock_get_object_member_string(hexpected, "type");
+
+	if (0 == strcmp(type, "ZBX_VARIANT_ERR"))
+		zbx_mock_assert_int_eq("variant type", ZBX_VARIANT_ERR, value->value.type);
+	else
+		zbx_mock_assert_int_eq("variant type", zbx_mock_str_to_variant(type), value->value.type);
+
+	if (NULL != (str = mock_get_optional_string(hexpected, "value")))
+		zbx_mock_assert_str_eq("value", str, zbx_variant_value_desc(&value->value));
+
+	if (SUCCEED == mock_has_member(hexpected, "lastlogsize"))
+	{
+		zbx_mock_assert_int_eq("meta flag", ZBX_PP_VALUE_OPT_META, value->value_opt.flags & ZBX_PP_VALUE_OPT_META);
+		zbx_mock_assert_uint64_eq("lastlogsize", zbx_mock_get_object_member_uint64(hexpected, "lastlogsize"),
+				value->value_opt.lastlogsize);
+		zbx_mock_assert_int_eq("mtime", zbx_mock_get_object_member_int(hexpected, "mtime"),
+				value->value_opt.mtime);
+	}
+	else
+		zbx_mock_assert_int_eq("meta flag", 0, value->value_opt.flags & ZBX_PP_VALUE_OPT_META);
+
+	if (SUCCEED == mock_has_member(hexpected, "timestamp"))
+	{
+		zbx_mock_assert_int_eq("log flag", ZBX_PP_VALUE_OPT_LOG, value->value_opt.flags & ZBX_PP_VALUE_OPT_LOG);
+		zbx_mock_assert_int_eq("timestamp", zbx_mock_get_object_member_int(hexpected, "timestamp"),
+				value->value_opt.timestamp);
+		zbx_mock_assert_int_eq("severity", zbx_mock_get_object_member_int(hexpected, "severity"),
+				value->value_opt.severity);
+		zbx_mock_assert_int_eq("logeventid", zbx_mock_get_object_member_int(hexpected, "logeventid"),
+				value->value_opt.logeventid);
+
+		if (NULL != (str = mock_get_optional_string(hexpected, "source")))
+			zbx_mock_assert_str_eq("source", str, value->value_opt.source);
+		else
+			zbx_mock_assert_ptr_eq("source", NULL, value->value_opt.source);
+	}
+	else
+		zbx_mock_assert_int_eq("log flag", 0, value->value_opt.flags & ZBX_PP_VALUE_OPT_LOG);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_pp_batch_t		batch;
+	zbx_pp_batch_reader_t	reader;
+	zbx_pp_batch_value_t	value;
+	zbx_preproc_item_value_t	item_value;
+	zbx_mock_handle_t	hvalues, hvalue;
+	zbx_mock_error_t	err;
+	unsigned char		*data = NULL;
+	size_t			data_alloc = 0;
+	zbx_uint32_t		size;
+	int			i, repeat, values_num = 0;
+
+	ZBX_UNUSED(state);
+
+	pp_batch_init(&batch);
+
+	/* pack the same values twice to check that cleared batch is reusable */
+	for (repeat = 0; repeat < 2; repeat++)
+	{
+		hvalues = zbx_mock_get_parameter_handle("in.values");
+
+		while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))))
+		{
+			if (ZBX_MOCK_SUCCESS != err)
+				fail_msg("cannot read value: %s", zbx_mock_error_string(err));
+
+			mock_read_value(hvalue, &item_value);
+			zbx_mock_assert_result_eq("add value", SUCCEED, pp_batch_add_value(&batch, &item_value));
+			mock_value_clear(&item_value);
+		}
+
+		size = pp_batch_pack(&batch, &data, &data_alloc);
+		pp_batch_clear(&batch);
+
+		zbx_mock_assert_result_eq("reader init", SUCCEED, pp_batch_reader_init(&reader, data, size));
+		zbx_mock_assert_int_eq("strings", (int)zbx_mock_get_parameter_uint64("out.strings"),
+				(int)reader.strings_num);
+
+		hvalues = zbx_mock_get_parameter_handle("out.values");
+
+		for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))); i++)
+		{
+			if (ZBX_MOCK_SUCCESS != err)
+				fail_msg("cannot read expected value: %s", zbx_mock_error_string(err));
+
+			if (SUCCEED != pp_batch_reader_next(&reader, &value))
+				fail_msg("expected value #%d was not unpacked", i);
+
+			check_value(hvalue, &value);
+
+			zbx_variant_clear(&value.value);
+			zbx_pp_value_opt_clear(&value.value_opt);
+		}
+
+		zbx_mock_assert_result_eq("end of batch", FAIL, pp_batch_reader_next(&reader, &value));
+		pp_batch_reader_clear(&reader);
+
+		if (0 == repeat)
+			values_num = i;
+		else
+			zbx_mock_assert_int_eq("number of values", values_num, i);
+	}
+
+	/* truncated batches must be rejected */
+	zbx_mock_assert_result_eq("truncated batch", FAIL, pp_batch_reader_init(&reader, data, size - 1));
+
+	zbx_free(data);
+	pp_batch_destroy(&batch);
+}
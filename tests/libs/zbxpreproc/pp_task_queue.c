@@ -0,0 +1,304 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxtime.h"
+#include "zbx_item_constants.h"
+#include "libs/zbxpreproc/pp_queue.h"
+#include "libs/zbxpreproc/pp_task.h"
+
+/* user macro handles are not used by the test tasks */
+zbx_dc_um_shared_handle_t	*__wrap_zbx_dc_um_shared_handle_copy(zbx_dc_um_shared_handle_t *handle);
+void	__wrap_zbx_dc_um_shared_handle_release(zbx_dc_um_shared_handle_t *handle);
+
+zbx_dc_um_shared_handle_t	*__wrap_zbx_dc_um_shared_handle_copy(zbx_dc_um_shared_handle_t *handle)
+{
+	return handle;
+}
+
+void	__wrap_zbx_dc_um_shared_handle_release(zbx_dc_um_shared_handle_t *handle)
+{
+	ZBX_UNUSED(handle);
+}
+
+typedef struct
+{
+	zbx_pp_queue_t	*queue;
+	pthread_t	thread;
+	int		index;
+	int		stop;
+
+	/* the next expected value index by item, values must be processed in order */
+	zbx_uint64_t	*next_values;
+	int		*errors_num;
+}
+test_worker_t;
+
+static pthread_mutex_t	test_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void	test_process_value(test_worker_t *worker, zbx_pp_task_t *task)
+{
+	zbx_pp_task_value_t	*d = (zbx_pp_task_value_t *)PP_TASK_DATA(task);
+
+	zbx_variant_set_ui64(&d->result, d->value.data.ui64);
+
+	if (ZBX_PP_TASK_VALUE_SEQ != task->type)
+		return;
+
+	/* tasks of the same item are never processed concurrently, but the lock */
+	/* is still needed to make the checks visible across threads             */
+	pthread_mutex_lock(&test_lock);
+
+	if (worker->next_values[task->itemid] != d->value.data.ui64)
+		(*worker->errors_num)++;
+
+	worker->next_values[task->itemid] = d->value.data.ui64 + 1;
+
+	pthread_mutex_unlock(&test_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: test worker thread, pops tasks in the same way as preprocessing   *
+ *          workers                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	*test_worker_entry(void *args)
+{
+	test_worker_t	*worker = (test_worker_t *)args;
+	zbx_pp_queue_t	*queue = worker->queue;
+	zbx_pp_task_t	*task, *first;
+	char		*error = NULL;
+
+	pp_task_queue_lock(queue);
+	pp_task_queue_register_worker(queue);
+
+	while (0 == worker->stop)
+	{
+		pp_task_queue_unlock(queue);
+
+		while (NULL != (task = pp_task_queue_pop_new(queue, worker->index)))
+		{
+			if (ZBX_PP_TASK_SEQUENCE == task->type)
+			{
+				zbx_pp_task_sequence_t	*d_seq = (zbx_pp_task_sequence_t *)PP_TASK_DATA(task);
+
+				if (SUCCEED == zbx_list_peek(&d_seq->tasks, (void **)&first))
+					test_process_value(worker, first);
+			}
+			else
+				test_process_value(worker, task);
+
+			pp_task_queue_push_finished(queue, worker->index, task);
+		}
+
+		pp_task_queue_lock(queue);
+
+		if (0 != worker->stop)
+			break;
+
+		if (SUCCEED != pp_task_queue_wait(queue, worker->index, &error))
+		{
+			zbx_free(error);
+			worker->stop = 1;
+		}
+	}
+
+	pp_task_queue_deregister_worker(queue);
+	pp_task_queue_unlock(queue);
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: collect finished tasks, requeuing task sequences in the same way  *
+ *          as preprocessing manager                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	test_collect_finished(zbx_pp_queue_t *queue)
+{
+	zbx_pp_task_t	*task, *first;
+	int		finished_num = 0;
+
+	pp_task_queue_lock(queue);
+
+	while (NULL != (task = pp_task_queue_pop_finished(queue)))
+	{
+		if (ZBX_PP_TASK_SEQUENCE == task->type)
+		{
+			zbx_pp_task_sequence_t	*d_seq = (zbx_pp_task_sequence_t *)PP_TASK_DATA(task);
+
+			if (SUCCEED == zbx_list_pop(&d_seq->tasks, (void **)&first))
+			{
+				pp_task_free(first);
+				finished_num++;
+			}
+
+			if (SUCCEED == zbx_list_peek(&d_seq->tasks, (void **)&first))
+			{
+				pp_task_queue_push_immediate(queue, task);
+				pp_task_queue_notify(queue);
+			}
+			else
+			{
+				pp_task_queue_remove_sequence(queue, task->itemid);
+				pp_task_free(task);
+			}
+
+			continue;
+		}
+
+		pp_task_free(task);
+		finished_num++;
+	}
+
+	pp_task_queue_unlock(queue);
+
+	return finished_num;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_pp_queue_t			queue;
+	zbx_pp_item_preproc_t		*preproc;
+	zbx_vector_pp_worker_stats_t	stats;
+	test_worker_t			*workers;
+	zbx_uint64_t			*next_values, pending_num, processing_num, finished_num, steals_num = 0;
+	zbx_timespec_t			ts = {0, 0};
+	struct timespec			poll_delay = {0, 1000000};
+	int				workers_num, items_num, values_num, sequential, i, j, errors_num = 0,
+					tasks_num, done_num = 0, stalled_num = 0;
+	char				*error = NULL;
+	double				time_start;
+
+	ZBX_UNUSED(state);
+
+	workers_num = (int)zbx_mock_get_parameter_uint64("in.workers");
+	items_num = (int)zbx_mock_get_parameter_uint64("in.items");
+	values_num = (int)zbx_mock_get_parameter_uint64("in.values");
+	sequential = (0 == strcmp(zbx_mock_get_parameter_string("in.mode"), "SEQUENTIAL") ? SUCCEED : FAIL);
+	tasks_num = items_num * values_num;
+
+	/* the tasks distributed to stalled workers can be processed only by stealing them */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.stalled"))
+		stalled_num = (int)zbx_mock_get_parameter_uint64("in.stalled");
+
+	if (SUCCEED != pp_task_queue_init(&queue, workers_num, &error))
+		fail_msg("cannot initialize task queue: %s", error);
+
+	preproc = zbx_pp_item_preproc_create(0, ITEM_TYPE_TRAPPER, ITEM_VALUE_TYPE_UINT64, 0);
+	next_values = (zbx_uint64_t *)zbx_calloc(NULL, (size_t)items_num, sizeof(zbx_uint64_t));
+	workers = (test_worker_t *)zbx_calloc(NULL, (size_t)workers_num, sizeof(test_worker_t));
+
+	for (i = 0; i < workers_num; i++)
+	{
+		workers[i].queue = &queue;
+		workers[i].index = i;
+		workers[i].next_values = next_values;
+		workers[i].errors_num = &errors_num;
+
+		if (i < stalled_num)
+			continue;
+
+		if (0 != pthread_create(&workers[i].thread, NULL, test_worker_entry, &workers[i]))
+			fail_msg("cannot create worker thread");
+	}
+
+	time_start = zbx_time();
+
+	/* queue values in batches, interleaving items like values arriving from data collectors */
+	for (j = 0; j < values_num; j++)
+	{
+		pp_task_queue_lock(&queue);
+
+		for (i = 0; i < items_num; i++)
+		{
+			zbx_variant_t	value;
+			zbx_pp_task_t	*task;
+
+			zbx_variant_set_ui64(&value, (zbx_uint64_t)j);
+
+			if (SUCCEED == sequential)
+				task = pp_task_value_seq_create((zbx_uint64_t)i, preproc, NULL, &value, ts, NULL, NULL);
+			else
+				task = pp_task_value_create((zbx_uint64_t)i, preproc, NULL, &value, ts, NULL, NULL);
+
+			pp_task_queue_push(&queue, task);
+		}
+
+		pp_task_queue_notify(&queue);
+		pp_task_queue_unlock(&queue);
+
+		done_num += test_collect_finished(&queue);
+	}
+
+	while (done_num != tasks_num && SEC_PER_MIN > zbx_time() - time_start)
+	{
+		int	num;
+
+		if (0 == (num = test_collect_finished(&queue)))
+			nanosleep(&poll_delay, NULL);
+
+		done_num += num;
+	}
+
+	pp_task_queue_lock(&queue);
+	pp_task_queue_get_stats(&queue, &pending_num, &processing_num, &finished_num);
+
+	for (i = 0; i < workers_num; i++)
+		workers[i].stop = 1;
+
+	pp_task_queue_notify_all(&queue);
+	pp_task_queue_unlock(&queue);
+
+	for (i = stalled_num; i < workers_num; i++)
+		pthread_join(workers[i].thread, NULL);
+
+	zbx_vector_pp_worker_stats_create(&stats);
+	pp_task_queue_get_worker_stats(&queue, &stats);
+
+	for (i = 0; i < stats.values_num; i++)
+		steals_num += stats.values[i].steals_num;
+
+	zbx_mock_assert_int_eq("worker statistics", workers_num, stats.values_num);
+
+	if (1 == workers_num)
+		zbx_mock_assert_uint64_eq("steals by single worker", 0, steals_num);
+
+	if (0 != stalled_num && 0 == steals_num)
+		fail_msg("tasks of stalled workers were not stolen");
+	zbx_vector_pp_worker_stats_destroy(&stats);
+
+	pp_task_queue_destroy(&queue);
+	zbx_pp_item_preproc_release(preproc);
+	zbx_free(workers);
+	zbx_free(next_values);
+
+	zbx_mock_assert_int_eq("processed tasks", tasks_num, done_num);
+	zbx_mock_assert_int_eq("out of order values", 0, errors_num);
+	zbx_mock_assert_uint64_eq("pending tasks", 0, pending_num);
+	zbx_mock_assert_uint64_eq("processing tasks", 0, processing_num);
+	zbx_mock_assert_uint64_eq("finished tasks", 0, finished_num);
+}
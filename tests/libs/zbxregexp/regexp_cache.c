@@ -0,0 +1,121 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxregexp.h"
+#include "zbxstr.h"
+
+#define	CYCLE	1
+#define	INVALID	2
+
+static void	test_regexp_cache_cycle(void)
+{
+	int			patterns, cycles, i, j;
+	char			pattern[64], match[64];
+	const zbx_regexp_t	*regexp, *regexp_cached;
+	char			*error = NULL;
+
+	patterns = (int)zbx_mock_get_parameter_uint64("in.patterns");
+	cycles = (int)zbx_mock_get_parameter_uint64("in.cycles");
+
+	for (i = 0; i < cycles; i++)
+	{
+		for (j = 0; j < patterns; j++)
+		{
+			zbx_snprintf(pattern, sizeof(pattern), "^value%d$", j);
+			zbx_snprintf(match, sizeof(match), "value%d", j);
+
+			if (NULL == zbx_regexp_match(match, pattern, NULL))
+				fail_msg("\"%s\" does not match pattern \"%s\"", match, pattern);
+
+			zbx_snprintf(match, sizeof(match), "value%d", j + 1);
+
+			if (NULL != zbx_regexp_match(match, pattern, NULL))
+				fail_msg("\"%s\" unexpectedly matches pattern \"%s\"", match, pattern);
+		}
+	}
+
+	/* cached regular expression stays valid while other patterns are used */
+	if (SUCCEED != zbx_regexp_compile_cached("^value[0-9]+$", &regexp, &error))
+		fail_msg("cannot compile pattern: %s", error);
+
+	(void)zbx_regexp_match("value1", "^other$", NULL);
+
+	if (SUCCEED != zbx_regexp_compile_cached("^value[0-9]+$", &regexp_cached, &error))
+		fail_msg("cannot compile pattern: %s", error);
+
+	zbx_mock_assert_ptr_eq("cached regexp", regexp, regexp_cached);
+	zbx_mock_assert_int_eq("precompiled match", 0, zbx_regexp_match_precompiled("value123", regexp));
+}
+
+static void	test_regexp_cache_invalid(void)
+{
+	const char		*pattern;
+	const zbx_regexp_t	*regexp;
+	char			*error1 = NULL, *error2 = NULL;
+
+	pattern = zbx_mock_get_parameter_string("in.pattern");
+
+	zbx_mock_assert_int_eq("first compilation", FAIL, zbx_regexp_compile_cached(pattern, &regexp, &error1));
+	zbx_mock_assert_int_eq("second compilation", FAIL, zbx_regexp_compile_cached(pattern, &regexp, &error2));
+
+	zbx_mock_assert_str_eq("cached error", error1, error2);
+
+	zbx_free(error1);
+	zbx_free(error2);
+}
+
+static int	get_type(const char *str)
+{
+	if (0 == strcmp(str, "CYCLE"))
+		return CYCLE;
+	if (0 == strcmp(str, "INVALID"))
+		return INVALID;
+
+	fail_msg("unknown cmocka step type: %s", str);
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_uint64_t	hits, misses;
+
+	ZBX_UNUSED(state);
+
+	switch (get_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case CYCLE:
+			test_regexp_cache_cycle();
+			break;
+		case INVALID:
+			test_regexp_cache_invalid();
+			break;
+		default:
+			fail_msg("unknown cmocka step type: %s", zbx_mock_get_parameter_string("in.type"));
+	}
+
+	zbx_regexp_cache_get_stats(&hits, &misses);
+
+	zbx_mock_assert_uint64_eq("cache hits", zbx_mock_get_parameter_uint64("out.hits"), hits);
+	zbx_mock_assert_uint64_eq("cache misses", zbx_mock_get_parameter_uint64("out.misses"), misses);
+}
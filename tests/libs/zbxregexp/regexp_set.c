@@ -0,0 +1,146 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxregexp.h"
+
+#define	MATCH		1
+
+static void	test_get_regexps(zbx_vector_expression_t *regexps)
+{
+	zbx_mock_handle_t	hregexps, hregexp;
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter("in.regexps", &hregexps))
+		return;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hregexps, &hregexp))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read regular expression: %s", zbx_mock_error_string(err));
+
+		zbx_add_regexp_ex(regexps, zbx_mock_get_object_member_string(hregexp, "name"),
+				zbx_mock_get_object_member_string(hregexp, "expression"),
+				zbx_mock_get_object_member_int(hregexp, "type"),
+				*zbx_mock_get_object_member_string(hregexp, "delimiter"),
+				zbx_mock_get_object_member_int(hregexp, "case_sensitive"));
+	}
+}
+
+static int	test_str_to_result(const char *str)
+{
+	if (0 == strcmp(str, "MATCH"))
+		return ZBX_REGEXP_MATCH;
+	if (0 == strcmp(str, "NO_MATCH"))
+		return ZBX_REGEXP_NO_MATCH;
+	if (0 == strcmp(str, "COMPILE_FAIL"))
+		return ZBX_REGEXP_COMPILE_FAIL;
+
+	fail_msg("unknown match result: %s", str);
+	return FAIL;
+}
+
+static void	test_regexp_set_match(void)
+{
+	zbx_vector_expression_t	regexps;
+	zbx_regexp_set_t	*set;
+	zbx_mock_handle_t	hstrings, hstring;
+	zbx_mock_error_t	err;
+	const char		*pattern, *output_template = NULL;
+	int			case_sensitive;
+
+	zbx_vector_expression_create(&regexps);
+	test_get_regexps(&regexps);
+
+	pattern = zbx_mock_get_parameter_string("in.pattern");
+	case_sensitive = (int)zbx_mock_get_parameter_uint64("in.case_sensitive");
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.template"))
+		output_template = zbx_mock_get_parameter_string("in.template");
+
+	set = zbx_regexp_set_create(&regexps, pattern, case_sensitive);
+
+	hstrings = zbx_mock_get_parameter_handle("in.strings");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hstrings, &hstring))))
+	{
+		const char	*string;
+		char		*output = NULL, *output_seq = NULL, *error = NULL, *error_seq = NULL;
+		int		result, result_seq, expected;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read string: %s", zbx_mock_error_string(err));
+
+		string = zbx_mock_get_object_member_string(hstring, "string");
+		expected = test_str_to_result(zbx_mock_get_object_member_string(hstring, "result"));
+
+		result = zbx_regexp_set_sub(set, string, output_template, &output, &error);
+		result_seq = zbx_regexp_sub_ex2(&regexps, string, pattern, case_sensitive, output_template,
+				&output_seq, &error_seq);
+
+		if (expected != result)
+			fail_msg("string \"%s\" result %d while %d expected", string, result, expected);
+
+		zbx_mock_assert_int_eq("sequential matching result", result_seq, result);
+
+		if (NULL != output_seq || NULL != output)
+			zbx_mock_assert_str_eq("output", output_seq, output);
+
+		if (NULL != error_seq || NULL != error)
+			zbx_mock_assert_str_eq("error", error_seq, error);
+
+		zbx_mock_assert_int_eq("match result", expected, zbx_regexp_set_match(set, string));
+
+		zbx_free(output);
+		zbx_free(output_seq);
+		zbx_free(error);
+		zbx_free(error_seq);
+	}
+
+	zbx_regexp_set_free(set);
+	zbx_regexp_clean_expressions(&regexps);
+	zbx_vector_expression_destroy(&regexps);
+}
+
+static int	get_type(const char *str)
+{
+	if (0 == strcmp(str, "MATCH"))
+		return MATCH;
+
+	fail_msg("unknown cmocka step type: %s", str);
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	switch (get_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case MATCH:
+			test_regexp_set_match();
+			break;
+		default:
+			fail_msg("unknown cmocka step type: %s", zbx_mock_get_parameter_string("in.type"));
+	}
+}
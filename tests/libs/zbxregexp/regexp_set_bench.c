@@ -0,0 +1,249 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+/*
+ * Compares log line matching against global regular expression with several
+ * expressions when every expression is compiled and matched separately and when
+ * the expressions are combined into regular expression set.
+ *
+ * The lines are either generated or read from log file. Log files are processed
+ * in chunks of lines, so multi-GB files are not loaded into memory at once. Like
+ * in log item processing, the regular expression set is created for every chunk.
+ *
+ * The benchmark is not part of unit tests, it's built with
+ *   make regexp_set_bench
+ * and run as
+ *   ./regexp_set_bench [lines [cycles]]
+ * or
+ *   ./regexp_set_bench -f <log file> [chunk lines]
+ */
+
+#include "zbxcommon.h"
+#include "zbxregexp.h"
+#include "zbxstr.h"
+#include "zbxtime.h"
+
+#define BENCH_LINES	100000
+#define BENCH_CYCLES	3
+#define BENCH_PATTERN	"@log"
+
+/* expression types, as defined by global regular expression configuration */
+#define BENCH_TYPE_ANY_INCLUDED	1
+#define BENCH_TYPE_NOT_INCLUDED	2
+#define BENCH_TYPE_TRUE		3
+#define BENCH_TYPE_FALSE	4
+
+typedef struct
+{
+	double		time_seq;
+	double		time_set;
+	zbx_uint64_t	lines_num;
+	zbx_uint64_t	matched_seq;
+	zbx_uint64_t	matched_set;
+}
+bench_result_t;
+
+static void	bench_get_regexps(zbx_vector_expression_t *regexps)
+{
+	zbx_add_regexp_ex(regexps, "log", "(ERROR|WARNING)", BENCH_TYPE_TRUE, ',', ZBX_CASE_SENSITIVE);
+	zbx_add_regexp_ex(regexps, "log", "refused,timeout,full", BENCH_TYPE_ANY_INCLUDED, ',', ZBX_IGNORE_CASE);
+	zbx_add_regexp_ex(regexps, "log", "healthcheck", BENCH_TYPE_NOT_INCLUDED, ',', ZBX_IGNORE_CASE);
+	zbx_add_regexp_ex(regexps, "log", "client 192\\.168\\.1[0-9]+\\.", BENCH_TYPE_FALSE, ',',
+			ZBX_CASE_SENSITIVE);
+}
+
+static void	bench_match(const zbx_vector_expression_t *regexps, char **lines, int lines_num, int cycles,
+		bench_result_t *result)
+{
+	zbx_regexp_set_t	*set;
+	double			time_start;
+	int			i, cycle;
+
+	time_start = zbx_time();
+
+	for (cycle = 0; cycle < cycles; cycle++)
+	{
+		for (i = 0; i < lines_num; i++)
+		{
+			if (ZBX_REGEXP_MATCH == zbx_regexp_sub_ex2(regexps, lines[i], BENCH_PATTERN,
+					ZBX_CASE_SENSITIVE, NULL, NULL, NULL))
+			{
+				result->matched_seq++;
+			}
+		}
+	}
+
+	result->time_seq += zbx_time() - time_start;
+	time_start = zbx_time();
+
+	for (cycle = 0; cycle < cycles; cycle++)
+	{
+		set = zbx_regexp_set_create(regexps, BENCH_PATTERN, ZBX_CASE_SENSITIVE);
+
+		for (i = 0; i < lines_num; i++)
+		{
+			if (ZBX_REGEXP_MATCH == zbx_regexp_set_sub(set, lines[i], NULL, NULL, NULL))
+				result->matched_set++;
+		}
+
+		zbx_regexp_set_free(set);
+	}
+
+	result->time_set += zbx_time() - time_start;
+	result->lines_num += (zbx_uint64_t)lines_num * (zbx_uint64_t)cycles;
+}
+
+static void	bench_free_lines(char **lines, int lines_num)
+{
+	int	i;
+
+	for (i = 0; i < lines_num; i++)
+		zbx_free(lines[i]);
+}
+
+static void	bench_generated(const zbx_vector_expression_t *regexps, int lines_num, int cycles,
+		bench_result_t *result)
+{
+	const char	*levels[] = {"DEBUG", "INFO", "INFO", "INFO", "WARNING", "ERROR"};
+	const char	*messages[] = {"request served in 12 ms", "cache refreshed", "connection to db01 refused",
+				"healthcheck passed", "disk /var is 93% full", "read timeout after 30 s"};
+	char		**lines;
+	int		i;
+
+	lines = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)lines_num);
+
+	for (i = 0; i < lines_num; i++)
+	{
+		lines[i] = zbx_dsprintf(NULL, "2024-03-%02d 12:%02d:%02d.%03d [%5d] %-7s worker #%d: %s, request id"
+				" 0x%08x, client 192.168.%d.%d", i % 28 + 1, i / 60 % 60, i % 60, i % 1000,
+				1000 + i % 37, levels[i % ARRSIZE(levels)], i % 8, messages[i / 3 % ARRSIZE(messages)],
+				(unsigned int)i * 2654435761u, i % 255, i / 255 % 255);
+	}
+
+	bench_match(regexps, lines, lines_num, cycles, result);
+
+	bench_free_lines(lines, lines_num);
+	zbx_free(lines);
+}
+
+static int	bench_file(const zbx_vector_expression_t *regexps, const char *filename, int chunk_lines,
+		bench_result_t *result)
+{
+	FILE	*f;
+	char	**lines, buf[MAX_BUFFER_LEN];
+	int	lines_num = 0;
+
+	if (NULL == (f = fopen(filename, "r")))
+	{
+		fprintf(stderr, "cannot open \"%s\": %s\n", filename, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	lines = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)chunk_lines);
+
+	/* lines longer than buffer are matched in parts, the same way for both methods */
+	while (NULL != fgets(buf, sizeof(buf), f))
+	{
+		zbx_rtrim(buf, "\r\n");
+		lines[lines_num++] = zbx_strdup(NULL, buf);
+
+		if (chunk_lines == lines_num)
+		{
+			bench_match(regexps, lines, lines_num, 1, result);
+			bench_free_lines(lines, lines_num);
+			lines_num = 0;
+		}
+	}
+
+	if (0 != lines_num)
+	{
+		bench_match(regexps, lines, lines_num, 1, result);
+		bench_free_lines(lines, lines_num);
+	}
+
+	zbx_free(lines);
+	fclose(f);
+
+	return SUCCEED;
+}
+
+int	main(int argc, char **argv)
+{
+	zbx_vector_expression_t	regexps;
+	bench_result_t		result = {0};
+	int			lines_num = BENCH_LINES, cycles = BENCH_CYCLES, ret = EXIT_SUCCESS;
+	const char		*filename = NULL;
+
+	if (1 < argc && 0 == strcmp(argv[1], "-f"))
+	{
+		if (2 < argc)
+			filename = argv[2];
+
+		if (3 < argc)
+			lines_num = atoi(argv[3]);
+	}
+	else
+	{
+		if (1 < argc)
+			lines_num = atoi(argv[1]);
+
+		if (2 < argc)
+			cycles = atoi(argv[2]);
+	}
+
+	if ((1 < argc && 0 == strcmp(argv[1], "-f") && NULL == filename) || 0 >= lines_num || 0 >= cycles)
+	{
+		fprintf(stderr, "usage: %s [lines [cycles]]\n       %s -f <log file> [chunk lines]\n", argv[0],
+				argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	zbx_vector_expression_create(&regexps);
+	bench_get_regexps(&regexps);
+
+	if (NULL != filename)
+	{
+		if (SUCCEED != bench_file(&regexps, filename, lines_num, &result))
+			ret = EXIT_FAILURE;
+	}
+	else
+		bench_generated(&regexps, lines_num, cycles, &result);
+
+	zbx_regexp_clean_expressions(&regexps);
+	zbx_vector_expression_destroy(&regexps);
+
+	if (EXIT_SUCCESS != ret)
+		return ret;
+
+	printf("sequential: matched " ZBX_FS_UI64 " of " ZBX_FS_UI64 " lines in %.6f sec (%.0f lines/sec)\n",
+			result.matched_seq, result.lines_num, result.time_seq,
+			(double)result.lines_num / result.time_seq);
+	printf("set:        matched " ZBX_FS_UI64 " of " ZBX_FS_UI64 " lines in %.6f sec (%.0f lines/sec)\n",
+			result.matched_set, result.lines_num, result.time_set,
+			(double)result.lines_num / result.time_set);
+
+	if (result.matched_seq != result.matched_set)
+	{
+		fprintf(stderr, "matched lines differ: " ZBX_FS_UI64 " != " ZBX_FS_UI64 "\n", result.matched_seq,
+				result.matched_set);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
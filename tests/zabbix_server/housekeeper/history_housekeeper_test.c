@@ -0,0 +1,256 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/zabbix_server/housekeeper/history_housekeeper.h"
+
+static int	mock_get_int(const char *path)
+{
+	zbx_mock_error_t	err;
+	int			value;
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_mock_int(zbx_mock_get_parameter_handle(path), &value)))
+		fail_msg("Cannot read parameter at \"%s\": %s", path, zbx_mock_error_string(err));
+
+	return value;
+}
+
+static void	test_parse_bound(void)
+{
+	int	ret, clock_to = 0;
+
+	ret = hk_partition_parse_bound(zbx_mock_get_parameter_string("in.bound"), &clock_to);
+
+	zbx_mock_assert_result_eq("hk_partition_parse_bound() return value",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")), ret);
+
+	if (SUCCEED == ret)
+		zbx_mock_assert_int_eq("clock_to", mock_get_int("out.clock_to"), clock_to);
+}
+
+static void	mock_read_partitions(zbx_vector_hk_partition_ptr_t *partitions)
+{
+	zbx_mock_handle_t	hpartitions, hpartition;
+	zbx_mock_error_t	err;
+
+	hpartitions = zbx_mock_get_parameter_handle("in.partitions");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hpartitions, &hpartition)))
+	{
+		zbx_hk_partition_t	*partition;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read partition: %s", zbx_mock_error_string(err));
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, zbx_mock_get_object_member_string(hpartition, "name"));
+		partition->clock_to = zbx_mock_get_object_member_int(hpartition, "clock_to");
+		zbx_vector_hk_partition_ptr_append(partitions, partition);
+	}
+}
+
+static void	test_create_ranges(void)
+{
+	zbx_vector_hk_partition_ptr_t	partitions;
+	zbx_vector_uint64_pair_t	ranges;
+	zbx_mock_handle_t		hranges, hrange;
+	zbx_mock_error_t		err;
+	int				i = 0;
+
+	zbx_vector_hk_partition_ptr_create(&partitions);
+	zbx_vector_uint64_pair_create(&ranges);
+
+	mock_read_partitions(&partitions);
+
+	hk_partitions_get_create_ranges(&partitions, mock_get_int("in.now"), mock_get_int("in.period"),
+			mock_get_int("in.precreate"), &ranges);
+
+	hranges = zbx_mock_get_parameter_handle("out.ranges");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hranges, &hrange)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read range: %s", zbx_mock_error_string(err));
+
+		if (i >= ranges.values_num)
+			fail_msg("expected more than %d ranges", ranges.values_num);
+
+		zbx_mock_assert_uint64_eq("range lower bound", zbx_mock_get_object_member_uint64(hrange, "from"),
+				ranges.values[i].first);
+		zbx_mock_assert_uint64_eq("range upper bound", zbx_mock_get_object_member_uint64(hrange, "to"),
+				ranges.values[i].second);
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("number of ranges", i, ranges.values_num);
+
+	zbx_vector_uint64_pair_destroy(&ranges);
+	zbx_vector_hk_partition_ptr_clear_ext(&partitions, hk_partition_free);
+	zbx_vector_hk_partition_ptr_destroy(&partitions);
+}
+
+static void	test_expired(void)
+{
+	zbx_vector_hk_partition_ptr_t	partitions;
+	zbx_vector_str_t		expired;
+	zbx_mock_handle_t		hnames, hname;
+	zbx_mock_error_t		err;
+	int				keep_from;
+
+	zbx_vector_hk_partition_ptr_create(&partitions);
+	zbx_vector_str_create(&expired);
+
+	mock_read_partitions(&partitions);
+	keep_from = mock_get_int("in.keep_from");
+
+	for (int i = 0; i < partitions.values_num; i++)
+	{
+		if (SUCCEED == hk_partition_is_expired(partitions.values[i], keep_from))
+			zbx_vector_str_append(&expired, partitions.values[i]->name);
+	}
+
+	hnames = zbx_mock_get_parameter_handle("out.expired");
+
+	for (int i = 0; ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hnames, &hname)); i++)
+	{
+		const char	*name;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_string(hname, &name))
+			fail_msg("Cannot read expired partition name");
+
+		if (i >= expired.values_num)
+			fail_msg("partition \"%s\" is not expired", name);
+
+		zbx_mock_assert_str_eq("expired partition", name, expired.values[i]);
+	}
+
+	zbx_mock_assert_int_eq("number of expired partitions", mock_get_int("out.expired_num"),
+			expired.values_num);
+
+	zbx_vector_str_destroy(&expired);
+	zbx_vector_hk_partition_ptr_clear_ext(&partitions, hk_partition_free);
+	zbx_vector_hk_partition_ptr_destroy(&partitions);
+}
+
+static void	mock_read_uint64_vector(zbx_mock_handle_t hvector, zbx_vector_uint64_t *values)
+{
+	zbx_mock_handle_t	hvalue;
+	zbx_mock_error_t	err;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hvector, &hvalue)))
+	{
+		zbx_uint64_t	value;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(hvalue, &value)))
+			fail_msg("Cannot read vector member: %s", zbx_mock_error_string(err));
+
+		zbx_vector_uint64_append(values, value);
+	}
+}
+
+static void	test_delete_chunks(void)
+{
+	zbx_vector_hk_delete_queue_ptr_t	queue;
+	zbx_vector_uint64_t			itemids, expected_itemids;
+	zbx_mock_handle_t			hqueue, hitem, hchunks, hchunk;
+	zbx_mock_error_t			err;
+	int					index = 0, max_items, chunks_num = 0;
+
+	zbx_vector_hk_delete_queue_ptr_create(&queue);
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_uint64_create(&expected_itemids);
+
+	hqueue = zbx_mock_get_parameter_handle("in.queue");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hqueue, &hitem)))
+	{
+		zbx_hk_delete_queue_t	*item;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read delete queue item: %s", zbx_mock_error_string(err));
+
+		item = (zbx_hk_delete_queue_t *)zbx_malloc(NULL, sizeof(zbx_hk_delete_queue_t));
+		item->itemid = zbx_mock_get_object_member_uint64(hitem, "itemid");
+		item->min_clock = zbx_mock_get_object_member_int(hitem, "min_clock");
+		zbx_vector_hk_delete_queue_ptr_append(&queue, item);
+	}
+
+	max_items = mock_get_int("in.max_items");
+
+	zbx_vector_hk_delete_queue_ptr_sort(&queue, hk_delete_queue_compare);
+
+	hchunks = zbx_mock_get_parameter_handle("out.chunks");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hchunks, &hchunk)))
+	{
+		int	min_clock;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read chunk: %s", zbx_mock_error_string(err));
+
+		if (index >= queue.values_num)
+			fail_msg("expected more than %d chunks", chunks_num);
+
+		min_clock = hk_delete_queue_get_chunk(&queue, &index, max_items, &itemids);
+
+		mock_read_uint64_vector(zbx_mock_get_object_member_handle(hchunk, "itemids"), &expected_itemids);
+
+		zbx_mock_assert_int_eq("chunk cutoff", zbx_mock_get_object_member_int(hchunk, "min_clock"),
+				min_clock);
+		zbx_mock_assert_int_eq("number of chunk items", expected_itemids.values_num, itemids.values_num);
+
+		for (int i = 0; i < itemids.values_num; i++)
+			zbx_mock_assert_uint64_eq("chunk itemid", expected_itemids.values[i], itemids.values[i]);
+
+		zbx_vector_uint64_clear(&itemids);
+		zbx_vector_uint64_clear(&expected_itemids);
+		chunks_num++;
+	}
+
+	zbx_mock_assert_int_eq("processed queue items", queue.values_num, index);
+
+	zbx_vector_uint64_destroy(&expected_itemids);
+	zbx_vector_uint64_destroy(&itemids);
+	zbx_vector_hk_delete_queue_ptr_clear_ext(&queue, (zbx_hk_delete_queue_ptr_free_func_t)zbx_ptr_free);
+	zbx_vector_hk_delete_queue_ptr_destroy(&queue);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*type;
+
+	ZBX_UNUSED(state);
+
+	type = zbx_mock_get_parameter_string("in.type");
+
+	if (0 == strcmp(type, "PARSE_BOUND"))
+		test_parse_bound();
+	else if (0 == strcmp(type, "CREATE_RANGES"))
+		test_create_ranges();
+	else if (0 == strcmp(type, "EXPIRED"))
+		test_expired();
+	else if (0 == strcmp(type, "DELETE_CHUNKS"))
+		test_delete_chunks();
+	else
+		fail_msg("unknown test type: %s", type);
+}
@@ -0,0 +1,183 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/zabbix_server/lld/lld_fingerprint.h"
+
+#define LLD_TEST_ITEMID	1
+
+static const char	*mock_get_optional_string(zbx_mock_handle_t object, const char *name)
+{
+	zbx_mock_handle_t	hmember;
+	const char		*value;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(object, name, &hmember))
+		return NULL;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_string(hmember, &value))
+		fail_msg("Cannot read \"%s\"", name);
+
+	return value;
+}
+
+static int	mock_get_optional_int(zbx_mock_handle_t object, const char *name)
+{
+	zbx_mock_handle_t	hmember;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(object, name, &hmember))
+		return 0;
+
+	return zbx_mock_get_object_member_int(object, name);
+}
+
+static void	test_value_digest(void)
+{
+	md5_byte_t	digest[ZBX_MD5_DIGEST_SIZE];
+	int		ret;
+
+	ret = lld_value_digest(zbx_mock_get_parameter_string("in.value"),
+			(ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.error") ?
+			zbx_mock_get_parameter_string("in.error") : NULL),
+			(unsigned char)(ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.meta") ? 1 : 0), digest);
+
+	zbx_mock_assert_result_eq("lld_value_digest() return value",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return")), ret);
+}
+
+static void	test_value_compare(void)
+{
+	md5_byte_t	digest1[ZBX_MD5_DIGEST_SIZE], digest2[ZBX_MD5_DIGEST_SIZE];
+	int		equal;
+
+	zbx_mock_assert_result_eq("lld_value_digest() return value", SUCCEED,
+			lld_value_digest(zbx_mock_get_parameter_string("in.value1"), NULL, 0, digest1));
+	zbx_mock_assert_result_eq("lld_value_digest() return value", SUCCEED,
+			lld_value_digest(zbx_mock_get_parameter_string("in.value2"), NULL, 0, digest2));
+
+	equal = (0 == memcmp(digest1, digest2, sizeof(digest1)) ? SUCCEED : FAIL);
+
+	zbx_mock_assert_result_eq("digests are equal",
+			zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.equal")), equal);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: simulates discovery rule processing with the same logic as LLD    *
+ *          manager and workers, except the configuration revision and lost   *
+ *          object count are read from test data instead of database          *
+ *                                                                            *
+ ******************************************************************************/
+static void	test_skip(void)
+{
+	zbx_hashset_t		fingerprints;
+	zbx_mock_handle_t	hsteps, hstep, hskipped, hexpected;
+	zbx_mock_error_t	err;
+	int			step = 0;
+
+	lld_fingerprints_init(&fingerprints);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+	hskipped = zbx_mock_get_parameter_handle("out.skipped");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		md5_byte_t	digest[ZBX_MD5_DIGEST_SIZE];
+		const char	*value, *error, *expected;
+		zbx_uint64_t	revision, last_revision, reported_revision;
+		int		has_digest, skipped, ttl;
+		time_t		now;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read step #%d: %s", step, zbx_mock_error_string(err));
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(hskipped, &hexpected) ||
+				ZBX_MOCK_SUCCESS != zbx_mock_string(hexpected, &expected))
+		{
+			fail_msg("Cannot read expected result of step #%d", step);
+		}
+
+		value = zbx_mock_get_object_member_string(hstep, "value");
+		error = mock_get_optional_string(hstep, "error");
+		revision = zbx_mock_get_object_member_uint64(hstep, "revision");
+		now = (time_t)zbx_mock_get_object_member_int(hstep, "time");
+
+		if (0 != (ttl = mock_get_optional_int(hstep, "ttl")))
+			lld_fingerprints_remove_inactive(&fingerprints, now, ttl);
+
+		/* manager */
+		has_digest = (SUCCEED == lld_value_digest(value, error, 0, digest));
+		last_revision = lld_fingerprint_get_revision(&fingerprints, LLD_TEST_ITEMID,
+				0 != has_digest ? digest : NULL);
+
+		/* worker */
+		if (NULL == error && SUCCEED == lld_rule_is_unchanged(last_revision, revision,
+				mock_get_optional_int(hstep, "expired")))
+		{
+			skipped = SUCCEED;
+			reported_revision = last_revision;
+		}
+		else
+		{
+			skipped = FAIL;
+
+			if (NULL != error || NULL != mock_get_optional_string(hstep, "warning"))
+				reported_revision = 0;
+			else if (0 != last_revision)
+				reported_revision = revision;
+			else
+				reported_revision = LLD_RULE_REVISION_UNKNOWN;
+		}
+
+		/* manager */
+		lld_fingerprint_update(&fingerprints, LLD_TEST_ITEMID, 0 != has_digest ? digest : NULL,
+				reported_revision, now);
+
+		if (skipped != zbx_mock_str_to_return_code(expected))
+		{
+			fail_msg("step #%d: expected skipped %s while got %s", step, expected,
+					zbx_result_string(skipped));
+		}
+
+		step++;
+	}
+
+	zbx_hashset_destroy(&fingerprints);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*type;
+
+	ZBX_UNUSED(state);
+
+	type = zbx_mock_get_parameter_string("in.type");
+
+	if (0 == strcmp(type, "DIGEST"))
+		test_value_digest();
+	else if (0 == strcmp(type, "COMPARE"))
+		test_value_compare();
+	else if (0 == strcmp(type, "SKIP"))
+		test_skip();
+	else
+		fail_msg("unknown test type: %s", type);
+}